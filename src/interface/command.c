@@ -2,83 +2,30 @@
 #include <stdlib.h>
 #include <string.h>
 #include "command.h"
+#include "dispatch.h"
 
-// Command handler registry entry
-typedef struct {
-    CommandType type;
-    CommandHandlerFn handler;
-} HandlerEntry;
-
-// Command handler registry
-typedef struct {
-    HandlerEntry* entries;
-    size_t capacity;
-    size_t count;
-    pthread_mutex_t lock;
-} HandlerRegistry;
+_Static_assert(CMD_CUSTOM == DISPATCH_CUSTOM_BASE, "CMD_CUSTOM differs from DISPATCH_CUSTOM_BASE");
+_Static_assert(CMD_ADMIN < DISPATCH_BASE_TYPES, "base command types exceed the direct array");
 
 // Command context stored in program user_data
 typedef struct {
-    HandlerRegistry handlers;
+    DispatchTable handlers;
     uint32_t next_cmd_id;
     pthread_mutex_t lock;
 } CommandContext;
 
-// Initialize handler registry
-static bool init_registry(HandlerRegistry* registry, size_t capacity) {
-    registry->entries = calloc(capacity, sizeof(HandlerEntry));
-    if (!registry->entries) return false;
-
-    registry->capacity = capacity;
-    registry->count = 0;
-
-    if (pthread_mutex_init(&registry->lock, NULL) != 0) {
-        free(registry->entries);
-        return false;
-    }
-
-    return true;
-}
-
-// Cleanup handler registry
-static void cleanup_registry(HandlerRegistry* registry) {
-    pthread_mutex_lock(&registry->lock);
-    free(registry->entries);
-    registry->entries = NULL;
-    registry->count = 0;
-    pthread_mutex_unlock(&registry->lock);
-    pthread_mutex_destroy(&registry->lock);
-}
-
 // Register command handler
 static bool register_handler(Program* program, CommandType type, CommandHandlerFn handler) {
     if (!program || !handler) return false;
 
     CommandContext* ctx = program->user_data;
-    HandlerRegistry* registry = &ctx->handlers;
-
-    pthread_mutex_lock(&registry->lock);
-
-    // Check for existing handler
-    for (size_t i = 0; i < registry->count; i++) {
-        if (registry->entries[i].type == type) {
-            registry->entries[i].handler = handler;
-            pthread_mutex_unlock(&registry->lock);
-            return true;
-        }
-    }
-
-    // Add new handler if space available
-    if (registry->count < registry->capacity) {
-        registry->entries[registry->count].type = type;
-        registry->entries[registry->count].handler = handler;
-        registry->count++;
-        pthread_mutex_unlock(&registry->lock);
-        return true;
-    }
+    return dispatch_set(&ctx->handlers, (uint32_t)type, (DispatchFn)handler);
+}
 
-    pthread_mutex_unlock(&registry->lock);
-    return false;
+// Handler registered for a command's type
+static CommandHandlerFn find_handler(Program* program, const Command* command) {
+    CommandContext* ctx = program->user_data;
+    return (CommandHandlerFn)dispatch_lookup(&ctx->handlers, (uint32_t)command->type);
 }
 
 // Execute command
@@ -89,32 +36,17 @@ static CommandStatus execute_command(Program* program,
         return CMD_STATUS_INVALID;
     }
 
-    CommandContext* ctx = program->user_data;
-    HandlerRegistry* registry = &ctx->handlers;
-    CommandStatus status = CMD_STATUS_INVALID;
-
-    pthread_mutex_lock(&registry->lock);
-
-    // Find handler for command type
-    for (size_t i = 0; i < registry->count; i++) {
-        if (registry->entries[i].type == command->type) {
-            CommandHandlerFn handler = registry->entries[i].handler;
-            pthread_mutex_unlock(&registry->lock);
-            
-            // Initialize response
-            response->command_id = command->id;
-            response->status = CMD_STATUS_ERROR;
-            response->data = NULL;
-            response->data_size = 0;
-
-            // Execute handler
-            status = handler(program, command, response);
-            return status;
-        }
-    }
+    CommandHandlerFn handler = find_handler(program, command);
+    if (!handler) return CMD_STATUS_INVALID;
 
-    pthread_mutex_unlock(&registry->lock);
-    return CMD_STATUS_INVALID;
+    // Initialize response
+    response->command_id = command->id;
+    response->status = CMD_STATUS_ERROR;
+    response->data = NULL;
+    response->data_size = 0;
+
+    // Execute handler
+    return handler(program, command, response);
 }
 
 // Route command to target
@@ -123,41 +55,26 @@ static bool route_command(Program* program,
                          const Command* command) {
     if (!program || !target || !command) return false;
 
-    CommandContext* ctx = program->user_data;
-    HandlerRegistry* registry = &ctx->handlers;
-    bool routed = false;
-
-    pthread_mutex_lock(&registry->lock);
-
-    // Find handler for command type
-    for (size_t i = 0; i < registry->count; i++) {
-        if (registry->entries[i].type == command->type) {
-            CommandHandlerFn handler = registry->entries[i].handler;
-            pthread_mutex_unlock(&registry->lock);
-
-            // Create response structure
-            CommandResponse response = {
-                .command_id = command->id,
-                .status = CMD_STATUS_ERROR,
-                .data = NULL,
-                .data_size = 0
-            };
-
-            // Execute handler and check status
-            CommandStatus status = handler(program, command, &response);
-            routed = (status == CMD_STATUS_SUCCESS);
-
-            // Cleanup response data if allocated
-            if (response.data) {
-                free(response.data);
-            }
-
-            return routed;
-        }
+    CommandHandlerFn handler = find_handler(program, command);
+    if (!handler) return false;
+
+    // Create response structure
+    CommandResponse response = {
+        .command_id = command->id,
+        .status = CMD_STATUS_ERROR,
+        .data = NULL,
+        .data_size = 0
+    };
+
+    // Execute handler and check status
+    CommandStatus status = handler(program, command, &response);
+
+    // Cleanup response data if allocated
+    if (response.data) {
+        free(response.data);
     }
 
-    pthread_mutex_unlock(&registry->lock);
-    return false;
+    return status == CMD_STATUS_SUCCESS;
 }
 
 // Validate command
@@ -205,8 +122,12 @@ bool command_init(Program* program) {
     CommandContext* ctx = calloc(1, sizeof(CommandContext));
     if (!ctx) return false;
 
-    if (!init_registry(&ctx->handlers, 100) ||
-        pthread_mutex_init(&ctx->lock, NULL) != 0) {
+    if (!dispatch_init(&ctx->handlers)) {
+        free(ctx);
+        return false;
+    }
+    if (pthread_mutex_init(&ctx->lock, NULL) != 0) {
+        dispatch_cleanup(&ctx->handlers);
         free(ctx);
         return false;
     }
@@ -221,7 +142,7 @@ void command_cleanup(Program* program) {
 
     CommandContext* ctx = program->user_data;
     if (ctx) {
-        cleanup_registry(&ctx->handlers);
+        dispatch_cleanup(&ctx->handlers);
         pthread_mutex_destroy(&ctx->lock);
         free(ctx);
     }
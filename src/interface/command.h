@@ -68,4 +68,9 @@ typedef struct {
                     const Command* command);
 } CommandInterface;
 
+// Command context setup, stored in the program's user_data
+bool command_init(Program* program);
+void command_cleanup(Program* program);
+const CommandInterface* get_command_interface(void);
+
 #endif // COMMAND_INTERFACE_H
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include <stdlib.h>
+#include <string.h>
+#include "dispatch.h"
+
+// Epochs start at 1 so a reader slot holding 0 is outside any lookup
+uint64_t dispatch_epoch = 1;
+__thread DispatchReader* dispatch_reader;
+
+static DispatchReader dispatch_readers[DISPATCH_MAX_READERS];
+static pthread_key_t reader_key;
+static pthread_once_t reader_once = PTHREAD_ONCE_INIT;
+
+// Give an exiting thread's slot back
+static void reader_release(void* slot) {
+    DispatchReader* reader = slot;
+    __atomic_store_n(&reader->in_use, false, __ATOMIC_RELEASE);
+}
+
+static void reader_key_create(void) {
+    pthread_key_create(&reader_key, reader_release);
+}
+
+DispatchReader* dispatch_reader_claim(void) {
+    pthread_once(&reader_once, reader_key_create);
+    for (int i = 0; i < DISPATCH_MAX_READERS; i++) {
+        DispatchReader* reader = &dispatch_readers[i];
+        bool expected = false;
+        if (__atomic_compare_exchange_n(&reader->in_use, &expected, true, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            pthread_setspecific(reader_key, reader);
+            dispatch_reader = reader;
+            return reader;
+        }
+    }
+    return NULL;
+}
+
+bool dispatch_init(DispatchTable* table) {
+    memset(table, 0, sizeof(*table));
+    table->current = calloc(1, sizeof(DispatchSnapshot));
+    if (!table->current) return false;
+
+    if (pthread_mutex_init(&table->lock, NULL) != 0) {
+        free(table->current);
+        table->current = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Free retired snapshots from the first one retired no later than epoch
+static void free_snapshots(DispatchSnapshot** list, uint64_t epoch) {
+    DispatchSnapshot** link = list;
+    while (*link && (*link)->retired_epoch > epoch) {
+        link = &(*link)->next_retired;
+    }
+
+    DispatchSnapshot* snapshot = *link;
+    __atomic_store_n(link, NULL, __ATOMIC_RELAXED);
+    while (snapshot) {
+        DispatchSnapshot* next = snapshot->next_retired;
+        free(snapshot);
+        snapshot = next;
+    }
+}
+
+static void free_pages(DispatchPage** list, uint64_t epoch) {
+    DispatchPage** link = list;
+    while (*link && (*link)->retired_epoch > epoch) {
+        link = &(*link)->next_retired;
+    }
+
+    DispatchPage* page = *link;
+    __atomic_store_n(link, NULL, __ATOMIC_RELAXED);
+    while (page) {
+        DispatchPage* next = page->next_retired;
+        free(page);
+        page = next;
+    }
+}
+
+// Free what no lookup can still hold, caller holds lock. A lookup that
+// announced an epoch at or past a retirement loaded the snapshot
+// published before it, so only older announcements keep it alive.
+static void reclaim(DispatchTable* table) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&table->overflow_readers, __ATOMIC_ACQUIRE) > 0) return;
+
+    uint64_t oldest = UINT64_MAX;
+    for (int i = 0; i < DISPATCH_MAX_READERS; i++) {
+        uint64_t epoch = __atomic_load_n(&dispatch_readers[i].epoch, __ATOMIC_ACQUIRE);
+        if (epoch && epoch < oldest) oldest = epoch;
+    }
+
+    free_snapshots(&table->retired, oldest);
+    free_pages(&table->retired_pages, oldest);
+}
+
+void dispatch_reclaim(DispatchTable* table) {
+    if (!__atomic_load_n(&table->retired, __ATOMIC_RELAXED) &&
+        !__atomic_load_n(&table->retired_pages, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    // Never wait on an update; it reclaims on its own
+    if (pthread_mutex_trylock(&table->lock) != 0) return;
+    reclaim(table);
+    pthread_mutex_unlock(&table->lock);
+}
+
+// Free every snapshot and page. No reader may still be dispatching.
+void dispatch_cleanup(DispatchTable* table) {
+    if (!table->current) return;
+
+    for (int i = 0; i < DISPATCH_MAX_PAGES; i++) {
+        free(table->current->pages[i]);
+    }
+    free(table->current);
+    table->current = NULL;
+
+    free_snapshots(&table->retired, UINT64_MAX);
+    free_pages(&table->retired_pages, UINT64_MAX);
+    pthread_mutex_destroy(&table->lock);
+}
+
+// Copy the current snapshot, change one slot and publish the copy. A
+// custom page is copied only when the slot lives in it. Superseded
+// snapshots and pages are tagged with the epoch the update moved to and
+// freed once no lookup announced an earlier one.
+bool dispatch_set(DispatchTable* table, uint32_t type, DispatchFn handler) {
+    uint32_t index = type - DISPATCH_CUSTOM_BASE;
+    bool base = type < DISPATCH_BASE_TYPES;
+    if (!base && (type < DISPATCH_CUSTOM_BASE ||
+                  index >= DISPATCH_MAX_PAGES * DISPATCH_PAGE_SIZE)) {
+        return false;
+    }
+
+    pthread_mutex_lock(&table->lock);
+
+    DispatchSnapshot* old = table->current;
+    DispatchSnapshot* next = malloc(sizeof(DispatchSnapshot));
+    if (!next) {
+        pthread_mutex_unlock(&table->lock);
+        return false;
+    }
+    memcpy(next, old, sizeof(DispatchSnapshot));
+    next->next_retired = NULL;
+
+    DispatchPage* old_page = NULL;
+    if (base) {
+        next->base[type] = handler;
+    } else {
+        old_page = old->pages[index / DISPATCH_PAGE_SIZE];
+        DispatchPage* page = old_page ? malloc(sizeof(DispatchPage)) : calloc(1, sizeof(DispatchPage));
+        if (!page) {
+            free(next);
+            pthread_mutex_unlock(&table->lock);
+            return false;
+        }
+        if (old_page) {
+            memcpy(page, old_page, sizeof(DispatchPage));
+        }
+        page->next_retired = NULL;
+        page->handlers[index % DISPATCH_PAGE_SIZE] = handler;
+        next->pages[index / DISPATCH_PAGE_SIZE] = page;
+    }
+
+    // Lookups announcing the new epoch are ordered after the publish
+    __atomic_store_n(&table->current, next, __ATOMIC_RELEASE);
+    uint64_t epoch = __atomic_add_fetch(&dispatch_epoch, 1, __ATOMIC_ACQ_REL);
+
+    old->retired_epoch = epoch;
+    old->next_retired = table->retired;
+    __atomic_store_n(&table->retired, old, __ATOMIC_RELAXED);
+    if (old_page) {
+        old_page->retired_epoch = epoch;
+        old_page->next_retired = table->retired_pages;
+        __atomic_store_n(&table->retired_pages, old_page, __ATOMIC_RELAXED);
+    }
+
+    reclaim(table);
+    pthread_mutex_unlock(&table->lock);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#ifndef DISPATCH_INTERFACE_H
+#define DISPATCH_INTERFACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// Handler tables indexed by message or command type. Base types live in
+// a direct array; types from DISPATCH_CUSTOM_BASE up live in pages of a
+// second-level table. Readers load the published snapshot without
+// locks, writers copy it and publish the copy. Superseded snapshots are
+// freed once every lookup that began before the copy was published has
+// finished, tracked by epochs in per-thread reader slots. MSG_CUSTOM and
+// CMD_CUSTOM are asserted to equal DISPATCH_CUSTOM_BASE where they are
+// dispatched.
+#define DISPATCH_BASE_TYPES 64
+#define DISPATCH_CUSTOM_BASE 1000
+#define DISPATCH_PAGE_SIZE 256
+#define DISPATCH_MAX_PAGES 64
+#define DISPATCH_MAX_READERS 128
+
+// Handlers are stored untyped and cast back by their interface
+typedef void (*DispatchFn)(void);
+
+// One page of custom type handlers
+typedef struct DispatchPage {
+    DispatchFn handlers[DISPATCH_PAGE_SIZE];
+    struct DispatchPage* next_retired;    // Replaced pages, freed once unread
+    uint64_t retired_epoch;               // Epoch it was replaced in
+} DispatchPage;
+
+// Immutable once published
+typedef struct DispatchSnapshot {
+    DispatchFn base[DISPATCH_BASE_TYPES];
+    DispatchPage* pages[DISPATCH_MAX_PAGES];
+    struct DispatchSnapshot* next_retired;
+    uint64_t retired_epoch;
+} DispatchSnapshot;
+
+// Per-thread lookup slot shared by every table. A thread claims one on
+// its first lookup and gives it back when it exits; its own line is the
+// only memory a lookup writes.
+typedef struct {
+    uint64_t epoch;                // Epoch entered, 0 outside a lookup
+    bool in_use;                   // Claimed by a thread
+    char pad[64 - sizeof(uint64_t) - sizeof(bool)];
+} DispatchReader;
+
+typedef struct {
+    DispatchSnapshot* current;     // Published table
+    DispatchSnapshot* retired;     // Superseded snapshots, newest first
+    DispatchPage* retired_pages;   // Superseded custom pages, newest first
+    int overflow_readers;          // Lookups by threads without a slot
+    pthread_mutex_t lock;          // Serializes writers
+} DispatchTable;
+
+// Bumped by every update; readers announce the value they saw
+extern uint64_t dispatch_epoch;
+extern __thread DispatchReader* dispatch_reader;
+
+bool dispatch_init(DispatchTable* table);
+void dispatch_cleanup(DispatchTable* table);
+
+// Set or replace the handler for type, NULL to clear it. Returns false
+// if type falls outside both ranges.
+bool dispatch_set(DispatchTable* table, uint32_t type, DispatchFn handler);
+
+// Free superseded snapshots and pages no lookup can still hold. Updates
+// do this themselves; owners also call it at quiescent points, such as
+// the end of a processing pass, so nothing waits for the next update.
+void dispatch_reclaim(DispatchTable* table);
+
+// Claim this thread's reader slot, NULL once all are taken
+DispatchReader* dispatch_reader_claim(void);
+
+// Handler for type, NULL if none. Safe from any thread at any time. The
+// lookup announces the current epoch in its thread's slot while it holds
+// the snapshot, so updates know which superseded ones it may still read.
+// Threads beyond DISPATCH_MAX_READERS are counted on the table instead.
+static inline DispatchFn dispatch_lookup(DispatchTable* table, uint32_t type) {
+    DispatchReader* reader = dispatch_reader ? dispatch_reader : dispatch_reader_claim();
+    if (reader) {
+        __atomic_store_n(&reader->epoch, __atomic_load_n(&dispatch_epoch, __ATOMIC_ACQUIRE),
+                         __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_add(&table->overflow_readers, 1, __ATOMIC_RELAXED);
+    }
+
+    // Pairs with the fence in reclaim: either the update sees our slot,
+    // or we load the snapshot it published
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    const DispatchSnapshot* snapshot = __atomic_load_n(&table->current, __ATOMIC_ACQUIRE);
+
+    DispatchFn handler = NULL;
+    uint32_t index = type - DISPATCH_CUSTOM_BASE;
+    if (type < DISPATCH_BASE_TYPES) {
+        handler = snapshot->base[type];
+    } else if (type >= DISPATCH_CUSTOM_BASE && index < DISPATCH_MAX_PAGES * DISPATCH_PAGE_SIZE) {
+        const DispatchPage* page = snapshot->pages[index / DISPATCH_PAGE_SIZE];
+        if (page) handler = page->handlers[index % DISPATCH_PAGE_SIZE];
+    }
+
+    if (reader) {
+        __atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+    } else {
+        __atomic_fetch_sub(&table->overflow_readers, 1, __ATOMIC_RELEASE);
+    }
+    return handler;
+}
+
+#endif // DISPATCH_INTERFACE_H
\ No newline at end of file
@@ -2,120 +2,431 @@
 #include <stdlib.h>
 #include <string.h>
 #include "message.h"
-// Internal message queue management
-typedef struct MessageQueue {
-    Message* messages;
-    size_t capacity;
+#include "dispatch.h"
+
+_Static_assert(MSG_CUSTOM == DISPATCH_CUSTOM_BASE, "MSG_CUSTOM differs from DISPATCH_CUSTOM_BASE");
+_Static_assert(MSG_DATA < DISPATCH_BASE_TYPES, "base message types exceed the direct array");
+
+// Payload size classes. Larger payloads bypass the pool.
+#define PAYLOAD_CLASSES 6
+#define PAYLOAD_UNPOOLED PAYLOAD_CLASSES
+#define PAYLOAD_CACHE_MAX 64
+
+static const size_t payload_class_size[PAYLOAD_CLASSES] = {
+    64, 256, 1024, 4096, 16384, 65536
+};
+
+struct MessagePayload {
+    uint32_t refcount;
+    uint32_t size_class;          // Index into payload_class_size
+    MessagePayload* next_free;    // Free list link while pooled
+    uint8_t data[] __attribute__((aligned(16)));
+};
+
+// Free buffers of one size class
+typedef struct {
+    MessagePayload* head;
     size_t count;
-    size_t head;
-    size_t tail;
-    pthread_mutex_t lock;
-} MessageQueue;
+} PayloadList;
+
+// Threads keep up to PAYLOAD_CACHE_MAX free buffers per class and trade
+// half of them with the shared lists when they run dry or overflow
+static PayloadList payload_shared[PAYLOAD_CLASSES];
+static pthread_mutex_t payload_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread PayloadList payload_cache[PAYLOAD_CLASSES];
+static __thread bool payload_cache_registered;
+static pthread_key_t payload_key;
+static pthread_once_t payload_once = PTHREAD_ONCE_INIT;
+// Bounded MPMC ring. Each slot's sequence says whose turn it is: equal
+// to a producer's position when free, one past it once filled, and
+// advanced by a lap when drained. Producers and consumers claim
+// positions with one CAS each and never wait on one another.
+typedef struct {
+    size_t sequence;
+    uint64_t queued_us;      // When the context queued it, 0 for message_queue_push
+    uint64_t arrival;        // Context-wide queueing order, 0 for message_queue_push
+    Message message;
+} QueueSlot;
+
+struct MessageQueue {
+    QueueSlot* slots;
+    size_t mask;
+    char pad0[64];
+    size_t enqueue_pos;      // Next position to fill
+    char pad1[64];
+    size_t dequeue_pos;      // Next position to drain
+    char pad2[64];
+};
+
+// Messages processed per dequeue, and between budget checks
+#define PROCESS_BATCH 64
+
+// Incoming lane capacity, and messages per unit of lane weight
+#define LANE_CAPACITY 1024
+#define LANE_QUANTUM 8
+#define LANE_TYPES (DISPATCH_BASE_TYPES + MESSAGE_LANE_CUSTOM_TYPES)
 
-// Message handler registry
+// Lane counters, written with relaxed atomics
 typedef struct {
-    MessageType type;
-    MessageHandlerFn handler;
-} HandlerEntry;
+    uint64_t dispatched;
+    uint64_t dropped;
+    uint64_t total_wait_us;
+    uint64_t max_wait_us;
+} LaneCounters;
 
+// Messages a worker's queue holds before the processor waits on it
+#define WORKER_CAPACITY 1024
+
+// Handler thread owning the keys that hash to it
 typedef struct {
-    HandlerEntry* entries;
-    size_t count;
-    size_t capacity;
+    MessageContext* ctx;
+    MessageQueue* queue;     // Messages handed over by the processor
+    pthread_t thread;
+    bool running;            // Cleared under lock to stop once drained
+    int sleeping;            // Blocked waiting for messages
+    int blocked;             // Processor waiting for room in the queue
+    uint64_t drains;         // Batches taken from the queue
     pthread_mutex_t lock;
-} HandlerRegistry;
+    pthread_cond_t cond;
+    pthread_cond_t drained;  // Signalled when a blocked processor has room
+} MessageWorker;
 
 // Message context stored in program user_data
-typedef struct {
-    MessageQueue incoming;  // Incoming message queue
-    MessageQueue outgoing;  // Outgoing message queue
-    HandlerRegistry handlers;  // Message handlers
+struct MessageContext {
+    MessageQueue* lanes[MSG_LANE_COUNT];  // Incoming messages by lane
+    uint32_t lane_weights[MSG_LANE_COUNT];  // Share of each dispatch round
+    uint8_t type_lanes[LANE_TYPES];  // Lane by type, see lane_slot
+    LaneCounters lane_counters[MSG_LANE_COUNT];
+    uint64_t arrivals;  // Queueing counter, orders messages across lanes
+    int ordered;  // MSG_FLAG_ORDERED messages received and not yet dispatched
+    Message held[PROCESS_BATCH];  // Taken from a lane, dispatched in arrival order
+    uint64_t held_arrivals[PROCESS_BATCH];
+    size_t held_next;  // First held message not yet dispatched
+    size_t held_left;  // Held messages not yet dispatched
+    MessageQueue* outgoing;  // Outgoing message queue
+    DispatchTable handlers;  // Message handlers by type
     uint32_t next_msg_id;  // Message ID counter
-} MessageContext;
+    Program* program;  // Passed to handlers
+    int waiting;  // Processor is blocked in message_wait or armed a wakeup
+    pthread_mutex_t wait_lock;
+    pthread_cond_t wait_cond;
+    void (*wake)(void* arg);  // Wakes a processor sleeping elsewhere, NULL for none
+    void* wake_arg;
+    MessageWorker* workers;  // Handler threads, NULL to dispatch inline
+    size_t worker_count;
+};
 
-// Queue initialization
-static bool init_queue(MessageQueue* queue, size_t capacity) {
-    queue->messages = calloc(capacity, sizeof(Message));
-    if (!queue->messages) return false;
-    
-    queue->capacity = capacity;
-    queue->count = 0;
-    queue->head = 0;
-    queue->tail = 0;
-    
-    if (pthread_mutex_init(&queue->lock, NULL) != 0) {
-        free(queue->messages);
-        return false;
+static void list_push(PayloadList* list, MessagePayload* payload) {
+    payload->next_free = list->head;
+    list->head = payload;
+    list->count++;
+}
+
+static MessagePayload* list_pop(PayloadList* list) {
+    MessagePayload* payload = list->head;
+    if (payload) {
+        list->head = payload->next_free;
+        list->count--;
     }
-    
+    return payload;
+}
+
+// Move up to count buffers between lists
+static void list_move(PayloadList* from, PayloadList* to, size_t count) {
+    while (count-- > 0 && from->head) {
+        list_push(to, list_pop(from));
+    }
+}
+
+// Hand an exiting thread's cached buffers to the shared lists
+static void payload_cache_flush(void* unused) {
+    (void)unused;
+    pthread_mutex_lock(&payload_lock);
+    for (int i = 0; i < PAYLOAD_CLASSES; i++) {
+        list_move(&payload_cache[i], &payload_shared[i], payload_cache[i].count);
+    }
+    pthread_mutex_unlock(&payload_lock);
+}
+
+static void payload_key_create(void) {
+    pthread_key_create(&payload_key, payload_cache_flush);
+}
+
+// This thread's free list for a class, flushed when the thread exits
+static PayloadList* payload_cache_get(uint32_t size_class) {
+    if (!payload_cache_registered) {
+        pthread_once(&payload_once, payload_key_create);
+        pthread_setspecific(payload_key, payload_cache);
+        payload_cache_registered = true;
+    }
+    return &payload_cache[size_class];
+}
+
+static MessagePayload* payload_alloc(size_t size) {
+    uint32_t size_class = 0;
+    while (size_class < PAYLOAD_CLASSES && payload_class_size[size_class] < size) {
+        size_class++;
+    }
+
+    if (size_class == PAYLOAD_UNPOOLED) {
+        MessagePayload* payload = malloc(sizeof(MessagePayload) + size);
+        if (!payload) return NULL;
+        payload->refcount = 1;
+        payload->size_class = PAYLOAD_UNPOOLED;
+        return payload;
+    }
+
+    PayloadList* cache = payload_cache_get(size_class);
+    if (!cache->head) {
+        pthread_mutex_lock(&payload_lock);
+        list_move(&payload_shared[size_class], cache, PAYLOAD_CACHE_MAX / 2);
+        pthread_mutex_unlock(&payload_lock);
+    }
+
+    MessagePayload* payload = list_pop(cache);
+    if (!payload) {
+        payload = malloc(sizeof(MessagePayload) + payload_class_size[size_class]);
+        if (!payload) return NULL;
+        payload->size_class = size_class;
+    }
+    payload->refcount = 1;
+    return payload;
+}
+
+static void payload_release(MessagePayload* payload) {
+    if (!payload || __sync_sub_and_fetch(&payload->refcount, 1) != 0) return;
+
+    if (payload->size_class == PAYLOAD_UNPOOLED) {
+        free(payload);
+        return;
+    }
+
+    // Buffers go back to the releasing thread's cache
+    PayloadList* cache = payload_cache_get(payload->size_class);
+    list_push(cache, payload);
+    if (cache->count > PAYLOAD_CACHE_MAX) {
+        pthread_mutex_lock(&payload_lock);
+        list_move(cache, &payload_shared[payload->size_class], PAYLOAD_CACHE_MAX / 2);
+        pthread_mutex_unlock(&payload_lock);
+    }
+}
+
+bool message_alloc_data(Message* message, size_t size) {
+    if (!message) return false;
+
+    MessagePayload* payload = payload_alloc(size);
+    if (!payload) return false;
+
+    message->payload = payload;
+    message->data = payload->data;
+    message->data_size = size;
     return true;
 }
 
-// Queue cleanup
-static void cleanup_queue(MessageQueue* queue) {
-    pthread_mutex_lock(&queue->lock);
-    free(queue->messages);
-    queue->messages = NULL;
-    queue->count = 0;
-    pthread_mutex_unlock(&queue->lock);
-    pthread_mutex_destroy(&queue->lock);
+void message_retain(const Message* message) {
+    if (message && message->payload) {
+        __sync_add_and_fetch(&message->payload->refcount, 1);
+    }
 }
 
-// Handler registry initialization
-static bool init_registry(HandlerRegistry* registry, size_t capacity) {
-    registry->entries = calloc(capacity, sizeof(HandlerEntry));
-    if (!registry->entries) return false;
-    
-    registry->capacity = capacity;
-    registry->count = 0;
-    
-    if (pthread_mutex_init(&registry->lock, NULL) != 0) {
-        free(registry->entries);
-        return false;
+void message_release(Message* message) {
+    if (!message) return;
+    payload_release(message->payload);
+    message->payload = NULL;
+    message->data = NULL;
+    message->data_size = 0;
+}
+
+// Create a queue holding at least capacity messages
+MessageQueue* message_queue_create(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+
+    MessageQueue* queue = calloc(1, sizeof(MessageQueue));
+    if (!queue) return NULL;
+    queue->slots = malloc(size * sizeof(QueueSlot));
+    if (!queue->slots) {
+        free(queue);
+        return NULL;
     }
-    
+
+    for (size_t i = 0; i < size; i++) {
+        queue->slots[i].sequence = i;
+    }
+    queue->mask = size - 1;
+    return queue;
+}
+
+void message_queue_destroy(MessageQueue* queue) {
+    if (!queue) return;
+
+    // Queued messages still own their payloads
+    Message message;
+    while (message_queue_pop(queue, &message, 1) == 1) {
+        message_release(&message);
+    }
+    free(queue->slots);
+    free(queue);
+}
+
+// Claim the next free slot. Returns NULL when the queue is full.
+static QueueSlot* queue_reserve(MessageQueue* queue, size_t* pos_out) {
+    size_t pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        QueueSlot* slot = &queue->slots[pos & queue->mask];
+        size_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *pos_out = pos;
+                return slot;
+            }
+        } else if (diff < 0) {
+            return NULL;
+        } else {
+            pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Hand a filled slot to consumers
+static void queue_publish(MessageQueue* queue, size_t pos) {
+    __atomic_store_n(&queue->slots[pos & queue->mask].sequence, pos + 1, __ATOMIC_RELEASE);
+}
+
+bool message_queue_push(MessageQueue* queue, const Message* message) {
+    if (!queue || !message) return false;
+
+    size_t pos;
+    QueueSlot* slot = queue_reserve(queue, &pos);
+    if (!slot) return false;
+    memcpy(&slot->message, message, sizeof(Message));
+    slot->queued_us = 0;
+    slot->arrival = 0;
+    queue_publish(queue, pos);
     return true;
 }
 
-// Handler registry cleanup
-static void cleanup_registry(HandlerRegistry* registry) {
-    pthread_mutex_lock(&registry->lock);
-    free(registry->entries);
-    registry->entries = NULL;
-    registry->count = 0;
-    pthread_mutex_unlock(&registry->lock);
-    pthread_mutex_destroy(&registry->lock);
+// Drain up to max messages, and when queued_us and arrivals are set the
+// time and order each was queued in. A consumer claims every filled slot it finds in a row with a
+// single CAS, so one call costs one atomic operation on the shared
+// position however many messages it takes.
+static size_t queue_take(MessageQueue* queue, Message* messages, uint64_t* queued_us,
+                         uint64_t* arrivals, size_t max) {
+    size_t pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+    size_t ready;
+    for (;;) {
+        ready = 0;
+        while (ready < max && ready <= queue->mask) {
+            QueueSlot* slot = &queue->slots[(pos + ready) & queue->mask];
+            size_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+            if (seq != pos + ready + 1) break;
+            ready++;
+        }
+
+        if (ready == 0) {
+            // Empty, or another consumer took this position first
+            size_t seq = __atomic_load_n(&queue->slots[pos & queue->mask].sequence,
+                                         __ATOMIC_ACQUIRE);
+            if ((intptr_t)seq - (intptr_t)(pos + 1) < 0) return 0;
+            pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        if (__atomic_compare_exchange_n(&queue->dequeue_pos, &pos, pos + ready, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < ready; i++) {
+        QueueSlot* slot = &queue->slots[(pos + i) & queue->mask];
+        memcpy(&messages[i], &slot->message, sizeof(Message));
+        if (queued_us) queued_us[i] = slot->queued_us;
+        if (arrivals) arrivals[i] = slot->arrival;
+        __atomic_store_n(&slot->sequence, pos + i + queue->mask + 1, __ATOMIC_RELEASE);
+    }
+    return ready;
+}
+
+size_t message_queue_pop(MessageQueue* queue, Message* messages, size_t max) {
+    if (!queue || !messages || max == 0) return 0;
+    return queue_take(queue, messages, NULL, NULL, max);
+}
+
+// Approximate number of queued messages
+size_t message_queue_count(const MessageQueue* queue) {
+    if (!queue) return 0;
+    size_t tail = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+    size_t head = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+    return tail > head ? tail - head : 0;
+}
+
+bool message_set_handler(MessageContext* ctx, MessageType type, MessageHandlerFn handler) {
+    if (!ctx) return false;
+    return dispatch_set(&ctx->handlers, (uint32_t)type, (DispatchFn)handler);
 }
 
 // Message registration handler
 static bool register_message_handler(Program* program, MessageType type, MessageHandlerFn handler) {
     if (!program || !handler) return false;
     
-    MessageContext* ctx = program->user_data;
-    HandlerRegistry* registry = &ctx->handlers;
+    return message_set_handler(program->user_data, type, handler);
+}
+
+// Hand a message to the handler registered for its type
+bool message_dispatch(Program* program, const Message* message) {
+    if (!program || !program->user_data || !message) return false;
     
-    pthread_mutex_lock(&registry->lock);
+    MessageContext* ctx = program->user_data;
+    MessageHandlerFn handler = (MessageHandlerFn)dispatch_lookup(&ctx->handlers, (uint32_t)message->type);
+    return handler ? handler(program, message) : false;
+}
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+// Queue a copy of message. The copy shares the sender's payload, or owns
+// a pooled copy of borrowed data. A non-NULL target replaces the
+// message's and gives it a fresh id and timestamp.
+static bool enqueue(MessageContext* ctx, MessageQueue* queue, const char* target,
+                    const Message* message) {
+    MessagePayload* payload = message->payload;
+    if (payload) {
+        message_retain(message);
+    } else if (message->data_size > 0) {
+        payload = payload_alloc(message->data_size);
+        if (!payload) return false;
+        memcpy(payload->data, message->data, message->data_size);
+    }
     
-    // Check for existing handler
-    for (size_t i = 0; i < registry->count; i++) {
-        if (registry->entries[i].type == type) {
-            registry->entries[i].handler = handler;
-            pthread_mutex_unlock(&registry->lock);
-            return true;
-        }
+    // Copy message straight into its slot in the queue
+    size_t pos;
+    QueueSlot* slot = queue_reserve(queue, &pos);
+    if (!slot) {
+        payload_release(payload);
+        return false;
     }
     
-    // Add new handler if space available
-    if (registry->count < registry->capacity) {
-        registry->entries[registry->count].type = type;
-        registry->entries[registry->count].handler = handler;
-        registry->count++;
-        pthread_mutex_unlock(&registry->lock);
-        return true;
+    Message* queued = &slot->message;
+    memcpy(queued, message, sizeof(Message));
+    queued->payload = payload;
+    queued->data = payload ? payload->data : NULL;
+    if (target) {
+        strncpy(queued->target, target, sizeof(queued->target) - 1);
+        queued->id = __sync_fetch_and_add(&ctx->next_msg_id, 1);
+        queued->timestamp = time(NULL);
     }
+    slot->queued_us = now_us();
+    slot->arrival = __atomic_fetch_add(&ctx->arrivals, 1, __ATOMIC_RELAXED);
     
-    pthread_mutex_unlock(&registry->lock);
-    return false;
+    queue_publish(queue, pos);
+    return true;
 }
 
 // Message sending implementation
@@ -123,27 +434,7 @@ static bool send_message(Program* program, const char* target, const Message* me
     if (!program || !target || !message) return false;
     
     MessageContext* ctx = program->user_data;
-    MessageQueue* outgoing = &ctx->outgoing;
-    
-    pthread_mutex_lock(&outgoing->lock);
-    
-    if (outgoing->count >= outgoing->capacity) {
-        pthread_mutex_unlock(&outgoing->lock);
-        return false;
-    }
-    
-    // Copy message to outgoing queue
-    Message* slot = &outgoing->messages[outgoing->tail];
-    memcpy(slot, message, sizeof(Message));
-    strncpy(slot->target, target, sizeof(slot->target) - 1);
-    slot->id = __sync_fetch_and_add(&ctx->next_msg_id, 1);
-    slot->timestamp = time(NULL);
-    
-    outgoing->tail = (outgoing->tail + 1) % outgoing->capacity;
-    outgoing->count++;
-    
-    pthread_mutex_unlock(&outgoing->lock);
-    return true;
+    return enqueue(ctx, ctx->outgoing, target, message);
 }
 
 // Message broadcast implementation
@@ -179,14 +470,158 @@ static bool validate_message(Program* program, const Message* message) {
     return true;
 }
 
+static void put_u16le(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static uint16_t get_u16le(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void put_u32le(uint8_t* p, uint32_t value) {
+    put_u16le(p, (uint16_t)value);
+    put_u16le(p + 2, (uint16_t)(value >> 16));
+}
+
+static uint32_t get_u32le(const uint8_t* p) {
+    return (uint32_t)get_u16le(p) | ((uint32_t)get_u16le(p + 2) << 16);
+}
+
+static void put_u64le(uint8_t* p, uint64_t value) {
+    put_u32le(p, (uint32_t)value);
+    put_u32le(p + 4, (uint32_t)(value >> 32));
+}
+
+static uint64_t get_u64le(const uint8_t* p) {
+    return (uint64_t)get_u32le(p) | ((uint64_t)get_u32le(p + 4) << 32);
+}
+
+static size_t varint_size(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static uint8_t* put_varint(uint8_t* p, uint64_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+// Read a varint from [*p, end). Returns false if it is cut off or
+// longer than 64 bits.
+static bool get_varint(const uint8_t** p, const uint8_t* end, uint64_t* value) {
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64 && *p < end; shift += 7) {
+        uint8_t byte = *(*p)++;
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t message_encoded_size(const Message* message) {
+    if (!message) return 0;
+    size_t source = strnlen(message->source, sizeof(message->source) - 1);
+    size_t target = strnlen(message->target, sizeof(message->target) - 1);
+    return MESSAGE_WIRE_HEADER_SIZE + varint_size(source) + source + varint_size(target) + target +
+           varint_size(message->data_size) + message->data_size;
+}
+
+size_t message_encode(const Message* message, void* buffer, size_t size) {
+    if (!message || !buffer || (message->data_size && !message->data)) return 0;
+    if ((uint32_t)message->type > UINT16_MAX) return 0;
+
+    size_t needed = message_encoded_size(message);
+    if (size < needed) return 0;
+
+    uint8_t* p = buffer;
+    p[0] = MESSAGE_WIRE_VERSION;
+    p[1] = (uint8_t)message->flags;
+    put_u16le(p + 2, (uint16_t)message->type);
+    put_u32le(p + 4, message->id);
+    put_u64le(p + 8, message->timestamp);
+    p += MESSAGE_WIRE_HEADER_SIZE;
+
+    size_t source = strnlen(message->source, sizeof(message->source) - 1);
+    p = put_varint(p, source);
+    memcpy(p, message->source, source);
+    p += source;
+
+    size_t target = strnlen(message->target, sizeof(message->target) - 1);
+    p = put_varint(p, target);
+    memcpy(p, message->target, target);
+    p += target;
+
+    p = put_varint(p, message->data_size);
+    if (message->data_size) {
+        memcpy(p, message->data, message->data_size);
+    }
+    return needed;
+}
+
+// Copy a length-prefixed ID into a NUL-terminated field
+static bool get_id(const uint8_t** p, const uint8_t* end, char* id, size_t id_size) {
+    uint64_t length;
+    if (!get_varint(p, end, &length) || length >= id_size || length > (uint64_t)(end - *p)) {
+        return false;
+    }
+    memcpy(id, *p, length);
+    id[length] = '\0';
+    *p += length;
+    return true;
+}
+
+size_t message_decode(const void* buffer, size_t size, Message* message) {
+    if (!buffer || !message || size < MESSAGE_WIRE_HEADER_SIZE) return 0;
+
+    const uint8_t* start = buffer;
+    const uint8_t* end = start + size;
+    if (start[0] != MESSAGE_WIRE_VERSION) return 0;
+
+    Message decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    // Authentication is established by the receiver, never by the sender
+    decoded.flags = (MessageFlags)(start[1] & ~MSG_FLAG_AUTHENTICATED);
+    decoded.type = (MessageType)get_u16le(start + 2);
+    decoded.id = get_u32le(start + 4);
+    decoded.timestamp = get_u64le(start + 8);
+
+    const uint8_t* p = start + MESSAGE_WIRE_HEADER_SIZE;
+    uint64_t data_size;
+    if (!get_id(&p, end, decoded.source, sizeof(decoded.source)) ||
+        !get_id(&p, end, decoded.target, sizeof(decoded.target)) ||
+        !get_varint(&p, end, &data_size) || data_size > (uint64_t)(end - p)) {
+        return 0;
+    }
+
+    if (data_size) {
+        if (!message_alloc_data(&decoded, (size_t)data_size)) return 0;
+        memcpy(decoded.data, p, (size_t)data_size);
+        p += data_size;
+    }
+
+    *message = decoded;
+    return (size_t)(p - start);
+}
+
 // Message encoding
 static bool encode_message(Program* program, const Message* message, void* buffer, size_t* size) {
     if (!program || !message || !buffer || !size) return false;
-    if (*size < sizeof(Message)) return false;
     
-    // Basic encoding - in real implementation would handle endianness, etc.
-    memcpy(buffer, message, sizeof(Message));
-    *size = sizeof(Message);
+    size_t written = message_encode(message, buffer, *size);
+    if (!written) return false;
+    *size = written;
     
     return true;
 }
@@ -194,12 +629,8 @@ static bool encode_message(Program* program, const Message* message, void* buffe
 // Message decoding
 static bool decode_message(Program* program, const void* buffer, size_t size, Message* message) {
     if (!program || !buffer || !message) return false;
-    if (size < sizeof(Message)) return false;
-    
-    // Basic decoding - in real implementation would handle endianness, etc.
-    memcpy(message, buffer, sizeof(Message));
     
-    return true;
+    return message_decode(buffer, size, message) != 0;
 }
 
 // Message interface instance
@@ -213,17 +644,527 @@ static MessageInterface message_interface = {
     .decode = decode_message
 };
 
-// Message interface initialization
-bool message_init(Program* program) {
+MessageContext* message_create(Program* program) {
     MessageContext* ctx = calloc(1, sizeof(MessageContext));
-    if (!ctx) return false;
+    if (!ctx) return NULL;
     
-    if (!init_queue(&ctx->incoming, 1000) || 
-        !init_queue(&ctx->outgoing, 1000) ||
-        !init_registry(&ctx->handlers, 100)) {
+    ctx->program = program;
+    bool lanes_ok = true;
+    for (int lane = 0; lane < MSG_LANE_COUNT; lane++) {
+        ctx->lanes[lane] = message_queue_create(LANE_CAPACITY);
+        lanes_ok = lanes_ok && ctx->lanes[lane];
+    }
+    ctx->outgoing = message_queue_create(1024);
+    if (!lanes_ok || !ctx->outgoing || !dispatch_init(&ctx->handlers)) {
+        for (int lane = 0; lane < MSG_LANE_COUNT; lane++) {
+            message_queue_destroy(ctx->lanes[lane]);
+        }
+        message_queue_destroy(ctx->outgoing);
         free(ctx);
+        return NULL;
+    }
+    
+    // Control traffic first, bulk data last
+    ctx->lane_weights[MSG_LANE_CONTROL] = 8;
+    ctx->lane_weights[MSG_LANE_NORMAL] = 4;
+    ctx->lane_weights[MSG_LANE_BULK] = 1;
+    memset(ctx->type_lanes, MSG_LANE_NORMAL, sizeof(ctx->type_lanes));
+    ctx->type_lanes[MSG_SYSTEM] = MSG_LANE_CONTROL;
+    ctx->type_lanes[MSG_NODE] = MSG_LANE_CONTROL;
+    ctx->type_lanes[MSG_NETWORK] = MSG_LANE_CONTROL;
+    ctx->type_lanes[MSG_DATA] = MSG_LANE_BULK;
+    
+    // Waits are timed against the monotonic clock
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&ctx->wait_lock, NULL);
+    pthread_cond_init(&ctx->wait_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    
+    return ctx;
+}
+
+static void stop_workers(MessageContext* ctx);
+
+void message_destroy(MessageContext* ctx) {
+    if (!ctx) return;
+    
+    stop_workers(ctx);
+    for (size_t i = 0; i < ctx->held_left; i++) {
+        message_release(&ctx->held[ctx->held_next + i]);
+    }
+    for (int lane = 0; lane < MSG_LANE_COUNT; lane++) {
+        message_queue_destroy(ctx->lanes[lane]);
+    }
+    message_queue_destroy(ctx->outgoing);
+    dispatch_cleanup(&ctx->handlers);
+    pthread_cond_destroy(&ctx->wait_cond);
+    pthread_mutex_destroy(&ctx->wait_lock);
+    free(ctx);
+}
+
+// Entry in type_lanes for type: base types directly, then the first
+// custom types. -1 if type has no entry.
+static int lane_slot(MessageType type) {
+    uint32_t value = (uint32_t)type;
+    if (value < DISPATCH_BASE_TYPES) return (int)value;
+    if (value >= MSG_CUSTOM && value - MSG_CUSTOM < MESSAGE_LANE_CUSTOM_TYPES) {
+        return DISPATCH_BASE_TYPES + (int)(value - MSG_CUSTOM);
+    }
+    return -1;
+}
+
+static MessageLane lane_of(const MessageContext* ctx, const Message* message) {
+    if (message->flags & MSG_FLAG_PRIORITY) return MSG_LANE_CONTROL;
+    int slot = lane_slot(message->type);
+    if (slot < 0) return MSG_LANE_NORMAL;
+    return (MessageLane)__atomic_load_n(&ctx->type_lanes[slot], __ATOMIC_RELAXED);
+}
+
+// Messages waiting across all lanes, held ones included
+static size_t incoming_count(const MessageContext* ctx) {
+    size_t count = __atomic_load_n(&ctx->held_left, __ATOMIC_RELAXED);
+    for (int lane = 0; lane < MSG_LANE_COUNT; lane++) {
+        count += message_queue_count(ctx->lanes[lane]);
+    }
+    return count;
+}
+
+bool message_set_lane(MessageContext* ctx, MessageType type, MessageLane lane) {
+    int slot = lane_slot(type);
+    if (!ctx || slot < 0 || lane < 0 || lane >= MSG_LANE_COUNT) return false;
+    __atomic_store_n(&ctx->type_lanes[slot], (uint8_t)lane, __ATOMIC_RELAXED);
+    return true;
+}
+
+bool message_set_lane_weight(MessageContext* ctx, MessageLane lane, uint32_t weight) {
+    if (!ctx || lane < 0 || lane >= MSG_LANE_COUNT || weight == 0) return false;
+    __atomic_store_n(&ctx->lane_weights[lane], weight, __ATOMIC_RELAXED);
+    return true;
+}
+
+bool message_get_lane_stats(const MessageContext* ctx, MessageLane lane, MessageLaneStats* stats) {
+    if (!ctx || !stats || lane < 0 || lane >= MSG_LANE_COUNT) return false;
+
+    const LaneCounters* counters = &ctx->lane_counters[lane];
+    stats->depth = message_queue_count(ctx->lanes[lane]);
+    stats->dispatched = __atomic_load_n(&counters->dispatched, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&counters->dropped, __ATOMIC_RELAXED);
+    stats->total_wait_us = __atomic_load_n(&counters->total_wait_us, __ATOMIC_RELAXED);
+    stats->max_wait_us = __atomic_load_n(&counters->max_wait_us, __ATOMIC_RELAXED);
+    return true;
+}
+
+bool message_receive(MessageContext* ctx, const Message* message) {
+    if (!ctx || !message) return false;
+
+    // Counted before it is queued, so the processor cannot take it
+    // without seeing the count
+    bool ordered = message->flags & MSG_FLAG_ORDERED;
+    if (ordered) __atomic_fetch_add(&ctx->ordered, 1, __ATOMIC_RELEASE);
+    
+    MessageLane lane = lane_of(ctx, message);
+    if (!enqueue(ctx, ctx->lanes[lane], NULL, message)) {
+        if (ordered) __atomic_fetch_sub(&ctx->ordered, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&ctx->lane_counters[lane].dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    
+    // Wake a sleeping processor. The fence orders the publish before the
+    // check against the processor setting the flag before its own check.
+    // Only the first producer to see the flag pays for the wakeup.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ctx->waiting, __ATOMIC_RELAXED) &&
+        __atomic_exchange_n(&ctx->waiting, 0, __ATOMIC_ACQ_REL)) {
+        if (ctx->wake) {
+            ctx->wake(ctx->wake_arg);
+        }
+        pthread_mutex_lock(&ctx->wait_lock);
+        pthread_cond_signal(&ctx->wait_cond);
+        pthread_mutex_unlock(&ctx->wait_lock);
+    }
+    return true;
+}
+
+void message_set_wakeup(MessageContext* ctx, void (*wake)(void* arg), void* arg) {
+    if (!ctx) return;
+    ctx->wake = wake;
+    ctx->wake_arg = arg;
+}
+
+bool message_arm_wakeup(MessageContext* ctx) {
+    if (!ctx) return false;
+    __atomic_store_n(&ctx->waiting, 1, __ATOMIC_SEQ_CST);
+    if (incoming_count(ctx) == 0) return true;
+
+    // The caller stays awake, so producers need not wake it
+    __atomic_store_n(&ctx->waiting, 0, __ATOMIC_RELAXED);
+    return false;
+}
+
+size_t message_pending(const MessageContext* ctx) {
+    return ctx ? incoming_count(ctx) : 0;
+}
+
+bool message_wait(MessageContext* ctx, uint32_t timeout_ms) {
+    if (!ctx) return false;
+    
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    
+    pthread_mutex_lock(&ctx->wait_lock);
+    __atomic_store_n(&ctx->waiting, 1, __ATOMIC_SEQ_CST);
+    int rc = 0;
+    while (incoming_count(ctx) == 0 && rc == 0) {
+        rc = pthread_cond_timedwait(&ctx->wait_cond, &ctx->wait_lock, &deadline);
+    }
+    __atomic_store_n(&ctx->waiting, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&ctx->wait_lock);
+    
+    return incoming_count(ctx) > 0;
+}
+
+// Dispatch one batch grouped by type, so each handler runs over all of
+// its messages back to back after a single lookup. The grouping is
+// stable, and a batch holding any MSG_FLAG_ORDERED message is dispatched
+// in arrival order instead.
+static void dispatch_batch(MessageContext* ctx, Message* batch, size_t count) {
+    uint8_t order[PROCESS_BATCH];
+    bool ordered = false;
+    for (size_t i = 0; i < count; i++) {
+        order[i] = (uint8_t)i;
+        if (batch[i].flags & MSG_FLAG_ORDERED) ordered = true;
+    }
+    
+    if (!ordered) {
+        for (size_t i = 1; i < count; i++) {
+            uint8_t current = order[i];
+            size_t j = i;
+            while (j > 0 && batch[order[j - 1]].type > batch[current].type) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = current;
+        }
+    }
+    
+    MessageHandlerFn handler = NULL;
+    MessageType handler_type = 0;
+    for (size_t i = 0; i < count; i++) {
+        Message* message = &batch[order[i]];
+        if (i == 0 || message->type != handler_type) {
+            handler_type = message->type;
+            handler = (MessageHandlerFn)dispatch_lookup(&ctx->handlers, (uint32_t)handler_type);
+        }
+        if (handler) {
+            handler(ctx->program, message);
+        }
+        message_release(message);
+    }
+}
+
+// Take up to max messages from lane and record how long they waited
+static size_t take_lane(MessageContext* ctx, MessageLane lane, Message* batch,
+                        uint64_t* arrivals, size_t max) {
+    uint64_t queued_us[PROCESS_BATCH];
+    size_t count = queue_take(ctx->lanes[lane], batch, queued_us, arrivals, max);
+    if (count == 0) return 0;
+
+    uint64_t now = now_us();
+    uint64_t total = 0;
+    uint64_t longest = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t wait = now > queued_us[i] ? now - queued_us[i] : 0;
+        total += wait;
+        if (wait > longest) longest = wait;
+    }
+
+    LaneCounters* counters = &ctx->lane_counters[lane];
+    __atomic_fetch_add(&counters->dispatched, count, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&counters->total_wait_us, total, __ATOMIC_RELAXED);
+    uint64_t seen = __atomic_load_n(&counters->max_wait_us, __ATOMIC_RELAXED);
+    while (longest > seen &&
+           !__atomic_compare_exchange_n(&counters->max_wait_us, &seen, longest, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    return count;
+}
+
+// Arrival of the oldest message in queue, false if it is empty. Only
+// the processor, the sole consumer of the lanes, may rely on it.
+static bool queue_peek(MessageQueue* queue, uint64_t* arrival) {
+    size_t pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+    QueueSlot* slot = &queue->slots[pos & queue->mask];
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != pos + 1) return false;
+    *arrival = slot->arrival;
+    return true;
+}
+
+// Fill batch with the oldest messages across the held ones and the
+// lanes, in the order they arrived
+static size_t take_arrivals(MessageContext* ctx, Message* batch, size_t max) {
+    size_t count = 0;
+    while (count < max) {
+        int next = -1;
+        uint64_t first = UINT64_MAX;
+        if (ctx->held_left > 0) {
+            next = MSG_LANE_COUNT;
+            first = ctx->held_arrivals[ctx->held_next];
+        }
+        for (int lane = 0; lane < MSG_LANE_COUNT; lane++) {
+            uint64_t arrival;
+            if (queue_peek(ctx->lanes[lane], &arrival) && arrival < first) {
+                next = lane;
+                first = arrival;
+            }
+        }
+        
+        if (next == MSG_LANE_COUNT) {
+            batch[count++] = ctx->held[ctx->held_next++];
+            __atomic_store_n(&ctx->held_left, ctx->held_left - 1, __ATOMIC_RELAXED);
+        } else if (next < 0 || take_lane(ctx, (MessageLane)next, &batch[count], &first, 1) == 0) {
+            break;
+        } else {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Take the next batch for lane. While MSG_FLAG_ORDERED messages are
+// queued, messages are taken across lanes in arrival order instead.
+// One may be counted only after the lane was read, so a batch taken
+// from the lane is then held and merged with the others.
+static size_t take_batch(MessageContext* ctx, MessageLane lane, Message* batch, size_t max) {
+    if (ctx->held_left > 0 || __atomic_load_n(&ctx->ordered, __ATOMIC_ACQUIRE) > 0) {
+        return take_arrivals(ctx, batch, max);
+    }
+    
+    uint64_t arrivals[PROCESS_BATCH];
+    size_t count = take_lane(ctx, lane, batch, arrivals, max);
+    if (count > 0 && __atomic_load_n(&ctx->ordered, __ATOMIC_ACQUIRE) > 0) {
+        memcpy(ctx->held, batch, count * sizeof(Message));
+        memcpy(ctx->held_arrivals, arrivals, count * sizeof(uint64_t));
+        ctx->held_next = 0;
+        __atomic_store_n(&ctx->held_left, count, __ATOMIC_RELAXED);
+        return take_arrivals(ctx, batch, max);
+    }
+    return count;
+}
+
+// Worker owning message's key: the source ID, or the target without one
+static MessageWorker* worker_for(MessageContext* ctx, const Message* message) {
+    const char* key = message->source[0] ? message->source : message->target;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < MESSAGE_ID_SIZE && key[i]; i++) {
+        hash = (hash ^ (uint8_t)key[i]) * 16777619u;
+    }
+    return &ctx->workers[hash % ctx->worker_count];
+}
+
+// Wake worker if it sleeps. The fence orders the pushes before the check
+// against the worker setting the flag before its own check.
+static void worker_notify(MessageWorker* worker) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&worker->sleeping, __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&worker->lock);
+        pthread_cond_signal(&worker->cond);
+        pthread_mutex_unlock(&worker->lock);
+    }
+}
+
+static void* worker_main(void* arg) {
+    MessageWorker* worker = arg;
+    Message batch[PROCESS_BATCH];
+    
+    for (;;) {
+        size_t count = message_queue_pop(worker->queue, batch, PROCESS_BATCH);
+        if (count > 0) {
+            // The slots are free now. Counting the drain before checking
+            // blocked pairs with the processor setting it before its check.
+            __atomic_add_fetch(&worker->drains, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&worker->blocked, __ATOMIC_SEQ_CST)) {
+                pthread_mutex_lock(&worker->lock);
+                pthread_cond_broadcast(&worker->drained);
+                pthread_mutex_unlock(&worker->lock);
+            }
+            dispatch_batch(worker->ctx, batch, count);
+            continue;
+        }
+        
+        pthread_mutex_lock(&worker->lock);
+        __atomic_store_n(&worker->sleeping, 1, __ATOMIC_SEQ_CST);
+        while (message_queue_count(worker->queue) == 0 && worker->running) {
+            pthread_cond_wait(&worker->cond, &worker->lock);
+        }
+        __atomic_store_n(&worker->sleeping, 0, __ATOMIC_RELAXED);
+        bool stop = !worker->running && message_queue_count(worker->queue) == 0;
+        pthread_mutex_unlock(&worker->lock);
+        if (stop) return NULL;
+    }
+}
+
+// Push message to worker, sleeping while its queue is full until the
+// worker takes a batch from it
+static void worker_push(MessageWorker* worker, const Message* message) {
+    for (;;) {
+        uint64_t drains = __atomic_load_n(&worker->drains, __ATOMIC_SEQ_CST);
+        if (message_queue_push(worker->queue, message)) return;
+        
+        // The worker may be asleep on messages pushed without a notify
+        worker_notify(worker);
+        pthread_mutex_lock(&worker->lock);
+        __atomic_store_n(&worker->blocked, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&worker->drains, __ATOMIC_SEQ_CST) == drains) {
+            pthread_cond_wait(&worker->drained, &worker->lock);
+        }
+        __atomic_store_n(&worker->blocked, 0, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&worker->lock);
+    }
+}
+
+// Hand a batch to the workers owning each message's key. Each worker
+// sees its messages in batch order, and a full worker queue makes the
+// processor wait rather than reorder or drop.
+static void hand_off(MessageContext* ctx, Message* batch, size_t count) {
+    uint64_t touched = 0;
+    for (size_t i = 0; i < count; i++) {
+        MessageWorker* worker = worker_for(ctx, &batch[i]);
+        worker_push(worker, &batch[i]);
+        touched |= 1ull << (worker - ctx->workers);
+    }
+    
+    for (size_t w = 0; w < ctx->worker_count; w++) {
+        if (touched & (1ull << w)) {
+            worker_notify(&ctx->workers[w]);
+        }
+    }
+}
+
+// Stop the workers once they have handled everything handed to them
+static void stop_workers(MessageContext* ctx) {
+    for (size_t w = 0; w < ctx->worker_count; w++) {
+        MessageWorker* worker = &ctx->workers[w];
+        pthread_mutex_lock(&worker->lock);
+        worker->running = false;
+        pthread_cond_signal(&worker->cond);
+        pthread_mutex_unlock(&worker->lock);
+    }
+    for (size_t w = 0; w < ctx->worker_count; w++) {
+        MessageWorker* worker = &ctx->workers[w];
+        pthread_join(worker->thread, NULL);
+        message_queue_destroy(worker->queue);
+        pthread_cond_destroy(&worker->drained);
+        pthread_cond_destroy(&worker->cond);
+        pthread_mutex_destroy(&worker->lock);
+    }
+    free(ctx->workers);
+    ctx->workers = NULL;
+    ctx->worker_count = 0;
+}
+
+bool message_set_workers(MessageContext* ctx, size_t count) {
+    if (!ctx || count > MESSAGE_MAX_WORKERS) return false;
+    
+    stop_workers(ctx);
+    if (count == 0) return true;
+    
+    MessageWorker* workers = calloc(count, sizeof(MessageWorker));
+    if (!workers) return false;
+    
+    size_t started = 0;
+    for (; started < count; started++) {
+        MessageWorker* worker = &workers[started];
+        worker->ctx = ctx;
+        worker->running = true;
+        worker->queue = message_queue_create(WORKER_CAPACITY);
+        if (!worker->queue) break;
+        pthread_mutex_init(&worker->lock, NULL);
+        pthread_cond_init(&worker->cond, NULL);
+        pthread_cond_init(&worker->drained, NULL);
+        if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0) {
+            message_queue_destroy(worker->queue);
+            pthread_cond_destroy(&worker->drained);
+            pthread_cond_destroy(&worker->cond);
+            pthread_mutex_destroy(&worker->lock);
+            break;
+        }
+    }
+    
+    ctx->workers = workers;
+    ctx->worker_count = started;
+    if (started < count) {
+        stop_workers(ctx);
         return false;
     }
+    return true;
+}
+
+// Weighted round robin over the lanes: each round a lane may dispatch
+// its weight times LANE_QUANTUM messages, and an empty lane's share is
+// not carried over. Control traffic therefore waits at most one round
+// behind a flood, however deep the bulk lane gets. Ordered messages
+// suspend the weighting until they are dispatched, see take_batch.
+static size_t process_lanes(MessageContext* ctx, const MessageBudget* budget) {
+    size_t max_messages = budget && budget->max_messages ? budget->max_messages : SIZE_MAX;
+    uint64_t deadline = budget && budget->max_us ? now_us() + budget->max_us : 0;
+    Message batch[PROCESS_BATCH];
+    size_t processed = 0;
+    
+    while (processed < max_messages) {
+        size_t round = 0;
+        for (int lane = 0; lane < MSG_LANE_COUNT && processed < max_messages; lane++) {
+            size_t share = (size_t)__atomic_load_n(&ctx->lane_weights[lane], __ATOMIC_RELAXED) *
+                           LANE_QUANTUM;
+            while (share > 0 && processed < max_messages) {
+                size_t want = share < PROCESS_BATCH ? share : PROCESS_BATCH;
+                if (max_messages - processed < want) want = max_messages - processed;
+                size_t count = take_batch(ctx, (MessageLane)lane, batch, want);
+                if (count == 0) break;
+                
+                size_t ordered = 0;
+                for (size_t i = 0; i < count; i++) {
+                    if (batch[i].flags & MSG_FLAG_ORDERED) ordered++;
+                }
+                if (ordered) __atomic_fetch_sub(&ctx->ordered, (int)ordered, __ATOMIC_RELAXED);
+                
+                if (ctx->worker_count) {
+                    hand_off(ctx, batch, count);
+                } else {
+                    dispatch_batch(ctx, batch, count);
+                }
+                processed += count;
+                round += count;
+                share -= count;
+                if (deadline && now_us() >= deadline) return processed;
+            }
+        }
+        if (round == 0) break;
+    }
+    return processed;
+}
+
+// Dispatch a budgeted pass, then free handler tables superseded during
+// it that no running lookup can still hold
+size_t message_process_queue(MessageContext* ctx, const MessageBudget* budget) {
+    if (!ctx) return 0;
+    
+    size_t processed = process_lanes(ctx, budget);
+    dispatch_reclaim(&ctx->handlers);
+    return processed;
+}
+
+// Message interface initialization
+bool message_init(Program* program) {
+    MessageContext* ctx = message_create(program);
+    if (!ctx) return false;
     
     program->user_data = ctx;
     return true;
@@ -233,13 +1174,16 @@ bool message_init(Program* program) {
 void message_cleanup(Program* program) {
     if (!program) return;
     
+    message_destroy(program->user_data);
+    program->user_data = NULL;
+}
+
+// Take up to max messages waiting to be sent
+size_t message_drain_outgoing(Program* program, Message* messages, size_t max) {
+    if (!program || !program->user_data) return 0;
+    
     MessageContext* ctx = program->user_data;
-    if (ctx) {
-        cleanup_queue(&ctx->incoming);
-        cleanup_queue(&ctx->outgoing);
-        cleanup_registry(&ctx->handlers);
-        free(ctx);
-    }
+    return message_queue_pop(ctx->outgoing, messages, max);
 }
 
 // Get message interface
@@ -23,21 +23,60 @@ typedef enum {
     MSG_FLAG_RELIABLE = 1,     // Guaranteed delivery
     MSG_FLAG_ORDERED = 2,      // In-order delivery
     MSG_FLAG_ENCRYPTED = 4,    // Content encryption
-    MSG_FLAG_COMPRESSED = 8    // Content compression
+    MSG_FLAG_COMPRESSED = 8,   // Content compression
+    MSG_FLAG_AUTHENTICATED = 16, // Sender verified by frame authentication
+    MSG_FLAG_PRIORITY = 32     // Dispatch in the control lane
 } MessageFlags;
 
+// Incoming priority lanes. Each lane is its own queue, and dispatch
+// takes from them in weighted rounds so a flood in one lane cannot
+// starve the others. Messages keep their order within a lane. While a
+// MSG_FLAG_ORDERED message is queued, dispatch follows arrival order
+// across lanes instead, so it is handled after every message received
+// before it, whatever their lanes.
+typedef enum {
+    MSG_LANE_CONTROL = 0,      // System, node and network status
+    MSG_LANE_NORMAL,           // State changes and program messages
+    MSG_LANE_BULK,             // Generic data
+    MSG_LANE_COUNT
+} MessageLane;
+
+// Per-lane counters since the context was created
+typedef struct {
+    size_t depth;              // Messages waiting now
+    uint64_t dispatched;       // Messages taken for dispatch
+    uint64_t dropped;          // Messages refused because the lane was full
+    uint64_t total_wait_us;    // Queueing time summed over dispatched messages
+    uint64_t max_wait_us;      // Longest queueing time seen
+} MessageLaneStats;
+
+// Refcounted payload buffer, see message_alloc_data
+typedef struct MessagePayload MessagePayload;
+
+#define MESSAGE_ID_SIZE 64
+
 // Message structure
 typedef struct {
     MessageType type;          // Message type
     uint32_t id;              // Message identifier
     MessageFlags flags;        // Message flags
-    char source[64];          // Source identifier
-    char target[64];          // Target identifier
+    char source[MESSAGE_ID_SIZE]; // Source identifier
+    char target[MESSAGE_ID_SIZE]; // Target identifier
     uint64_t timestamp;       // Message timestamp
     void* data;               // Message payload
     size_t data_size;        // Payload size
+    MessagePayload* payload;  // Pooled buffer holding data, NULL if borrowed
 } Message;
 
+// Wire format, all integers little-endian:
+//   u8 version, u8 flags, u16 type, u32 id, u64 timestamp,
+//   varint source length + source, varint target length + target,
+//   varint payload length + payload
+// IDs carry only their used bytes, so a small message costs a few dozen
+// bytes rather than the in-memory struct size.
+#define MESSAGE_WIRE_VERSION 1
+#define MESSAGE_WIRE_HEADER_SIZE 16
+
 // Message handler callback
 typedef bool (*MessageHandlerFn)(Program* program, 
                                const Message* message);
@@ -77,4 +116,122 @@ typedef struct {
                   Message* message);
 } MessageInterface;
 
+// Queues and handlers for one program
+typedef struct MessageContext MessageContext;
+
+// Limits on one message_process_queue call, 0 for no limit
+typedef struct {
+    size_t max_messages;       // Messages to dispatch
+    uint32_t max_us;           // Time to spend, checked between batches
+} MessageBudget;
+
+// Create a context whose handlers are called with program
+MessageContext* message_create(Program* program);
+void message_destroy(MessageContext* ctx);
+
+// Handler for type, NULL to clear it
+bool message_set_handler(MessageContext* ctx, MessageType type, MessageHandlerFn handler);
+
+// Lane for messages of type. Base types and the first
+// MESSAGE_LANE_CUSTOM_TYPES custom types can be assigned; others use
+// MSG_LANE_NORMAL. MSG_FLAG_PRIORITY overrides the type's lane, so a
+// flagged message may overtake earlier ones of its type.
+#define MESSAGE_LANE_CUSTOM_TYPES 256
+bool message_set_lane(MessageContext* ctx, MessageType type, MessageLane lane);
+
+// Share of each dispatch round given to lane, in units of eight
+// messages. Defaults are 8, 4 and 1 from control to bulk.
+bool message_set_lane_weight(MessageContext* ctx, MessageLane lane, uint32_t weight);
+bool message_get_lane_stats(const MessageContext* ctx, MessageLane lane, MessageLaneStats* stats);
+
+// Queue a message in its lane, taking a reference to its payload.
+// Returns false when the lane is full.
+bool message_receive(MessageContext* ctx, const Message* message);
+
+// Dispatch queued messages in batches, taking from each lane in turn by
+// weight, until every lane is empty or the budget is spent. Returns the
+// number dispatched.
+size_t message_process_queue(MessageContext* ctx, const MessageBudget* budget);
+
+// Handler threads. With workers, message_process_queue hands each
+// message to the worker owning its key, the source ID or else the
+// target, instead of calling its handler. One key's messages are
+// handled in order on one thread, MSG_FLAG_ORDERED batches included,
+// while different keys run in parallel, so handlers must be
+// thread-safe. 0, the default, runs handlers on the processing thread.
+// Call from that thread; the old workers finish their queues first.
+#define MESSAGE_MAX_WORKERS 64
+bool message_set_workers(MessageContext* ctx, size_t count);
+
+// Messages waiting for dispatch
+size_t message_pending(const MessageContext* ctx);
+
+// Block until a message is queued or timeout_ms passes. Returns true if
+// messages are waiting.
+bool message_wait(MessageContext* ctx, uint32_t timeout_ms);
+
+// Processors sleeping somewhere other than message_wait, such as an
+// event loop, set a wakeup and arm it before each sleep. The next
+// message queued calls wake once. Arming returns false if messages are
+// already waiting, in which case the caller should not sleep.
+void message_set_wakeup(MessageContext* ctx, void (*wake)(void* arg), void* arg);
+bool message_arm_wakeup(MessageContext* ctx);
+
+// Message context setup, stored in the program's user_data
+bool message_init(Program* program);
+void message_cleanup(Program* program);
+const MessageInterface* get_message_interface(void);
+
+// Call the handler registered for message's type. Returns false if there
+// is none or it fails.
+bool message_dispatch(Program* program, const Message* message);
+
+// Bytes message_encode will write for message
+size_t message_encoded_size(const Message* message);
+
+// Encode message into buffer. Returns the bytes written, 0 if the buffer
+// is too small or the message cannot be encoded.
+size_t message_encode(const Message* message, void* buffer, size_t size);
+
+// Decode one message from the start of buffer into a pooled payload the
+// caller releases. Returns the bytes consumed, 0 if the buffer holds no
+// complete valid message.
+size_t message_decode(const void* buffer, size_t size, Message* message);
+
+// Payload buffers come from size-classed pools with a per-thread cache
+// of free buffers. A message holding a payload owns one reference to it;
+// copies made by send, broadcast and forward share the buffer and take
+// their own reference instead of copying the bytes. Borrowed data (no
+// payload) is copied into a pooled buffer when a message is queued.
+
+// Attach a new buffer of size bytes to message, replacing data
+bool message_alloc_data(Message* message, size_t size);
+
+// Take another reference to message's payload, if any
+void message_retain(const Message* message);
+
+// Drop message's reference to its payload and clear data
+void message_release(Message* message);
+
+// Bounded lock-free queue of messages for any number of producer and
+// consumer threads. Capacity is rounded up to a power of two.
+typedef struct MessageQueue MessageQueue;
+
+MessageQueue* message_queue_create(size_t capacity);
+void message_queue_destroy(MessageQueue* queue);
+
+// Copy a message in, moving its payload reference into the queue.
+// Returns false when the queue is full.
+bool message_queue_push(MessageQueue* queue, const Message* message);
+
+// Copy up to max messages out in queue order, moving each payload
+// reference to the caller. Returns the number taken, 0 when the queue
+// is empty.
+size_t message_queue_pop(MessageQueue* queue, Message* messages, size_t max);
+size_t message_queue_count(const MessageQueue* queue);
+
+// Take up to max messages queued by send, broadcast or forward. The
+// caller releases each one.
+size_t message_drain_outgoing(Program* program, Message* messages, size_t max);
+
 #endif // MESSAGE_INTERFACE_H
\ No newline at end of file
@@ -5,10 +5,19 @@
 #include "message.h"
 #include "command.h"
 #include "state.h"
+#include "../runtime/network/network.h"
+#include "../runtime/event/event.h"
 
 // Maximum number of registered program interfaces
 #define MAX_PROGRAMS 32
 
+// Longest the run loop sleeps, so network timers and auto-save still
+// run; matches NETWORK_POLL_TIMEOUT_MS
+#define RUN_TICK_MS 100
+
+// Event loop tag for the network's poll set
+#define RUN_EVENT_NETWORK EVENT_USER
+
 // Registry for program interfaces
 static struct {
     const ProgramInterface* interfaces[MAX_PROGRAMS];
@@ -42,6 +51,8 @@ static const ProgramInterface* find_interface(const char* name) {
     return NULL;
 }
 
+static void cleanup_runtime(Program* program);
+
 // Initialize program runtime
 static bool init_runtime(Program* program) {
     if (!program || !program->interface) return false;
@@ -82,6 +93,13 @@ static bool init_runtime(Program* program) {
         }
     }
 
+    // Passes run when the network, a queued message or the tick needs one
+    runtime->event_context = event_loop_create();
+    if (!runtime->event_context || !event_loop_set_timer(runtime->event_context, RUN_TICK_MS)) {
+        cleanup_runtime(program);
+        return false;
+    }
+
     runtime->is_running = true;
     return true;
 }
@@ -110,6 +128,13 @@ static void cleanup_runtime(Program* program) {
         runtime->network_context = NULL;
     }
 
+    // Cleanup event loop
+    if (runtime->event_context) {
+        event_loop_destroy(runtime->event_context);
+        runtime->event_context = NULL;
+    }
+    runtime->network_evented = false;
+
     runtime->is_running = false;
 }
 
@@ -152,6 +177,14 @@ bool program_start(Program* program) {
         if (!network_start(runtime->network_context)) {
             return false;
         }
+
+        // Sleep on the network's poll set when the transport offers one
+        int poll_fd = network_get_poll_fd(runtime->network_context);
+        if (!runtime->network_evented &&
+            event_loop_watch(runtime->event_context, poll_fd, RUN_EVENT_NETWORK)) {
+            network_set_poll_timeout(runtime->network_context, 0);
+            runtime->network_evented = true;
+        }
     }
 
     // Load state if present
@@ -209,6 +242,14 @@ void* program_get_cli(Program* program) {
     return program ? program->runtime.cli_context : NULL;
 }
 
+void* program_get_events(Program* program) {
+    return program ? program->runtime.event_context : NULL;
+}
+
+void program_wake(Program* program) {
+    if (program) event_loop_wake(program->runtime.event_context);
+}
+
 // Program management
 static bool dispatch_message(Program* program, const void* message, size_t size) {
     if (!program || !program->interface || !program->interface->handle_message) {
@@ -224,7 +265,7 @@ static bool dispatch_command(Program* program, const char* command, void* respon
     return program->interface->handle_command(program, command, response);
 }
 
-// Main program run loop
+// Main program run loop: one pass, then sleep until the next is needed
 void program_run(Program* program) {
     if (!program || !program->interface) return;
 
@@ -244,4 +285,10 @@ void program_run(Program* program) {
     if (runtime->cli_context) {
         // CLI processing would go here
     }
+
+    // Without a poll set to sleep on, network_run has already waited
+    if (runtime->event_context) {
+        bool waited = runtime->network_context && !runtime->network_evented;
+        event_loop_wait(runtime->event_context, waited ? 0 : -1);
+    }
 }
\ No newline at end of file
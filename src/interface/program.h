@@ -49,6 +49,8 @@ struct ProgramRuntime {
     void* network_context;
     void* state_context;
     void* cli_context;
+    void* event_context;
+    bool network_evented;
     bool is_running;
 };
 
@@ -70,5 +72,9 @@ void program_stop(Program* program);
 void* program_get_network(Program* program);
 void* program_get_state(Program* program);
 void* program_get_cli(Program* program);
+void* program_get_events(Program* program);
+
+// End the run loop's current or next sleep. Safe from any thread.
+void program_wake(Program* program);
 
 #endif // PROGRAM_INTERFACE_H
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cluster.h"
+
+// Send our link advert. A direct one goes to a single connection with no
+// gossip header and introduces us as that neighbour; otherwise it is
+// gossiped to the whole cluster.
+static void advertise_links(Cluster* cluster, NetworkHandle direct) {
+    uint8_t advert[2048];
+    size_t size = routing_encode_links(cluster->routes, advert, sizeof(advert));
+    if (!size) return;
+
+    if (direct == NETWORK_INVALID_HANDLE) {
+        gossip_publish(cluster->gossip, NET_MSG_ROUTE_UPDATE, advert, (uint32_t)size);
+        return;
+    }
+
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + size);
+    if (!msg) return;
+    msg->type = NET_MSG_ROUTE_UPDATE;
+    strcpy(msg->source_id, cluster->gossip->node_id);
+    msg->data_size = (uint32_t)size;
+    memcpy(msg->data, advert, size);
+    network_send_handle(cluster->network, direct, msg);
+    free(msg);
+}
+
+// A neighbour introduced itself. New neighbours get our advert back and
+// the cluster learns our changed links.
+static void handle_greeting(Cluster* cluster, NetworkMessage* msg) {
+    bool known = routing_has_neighbor(cluster->routes, msg->connection);
+    if (!routing_add_neighbor(cluster->routes, msg->source_id, msg->connection)) return;
+    routing_apply_links(cluster->routes, msg->source_id, msg->data, msg->data_size);
+
+    if (!known) {
+        advertise_links(cluster, msg->connection);
+        advertise_links(cluster, NETWORK_INVALID_HANDLE);
+    }
+}
+
+// Send a data frame to the next hop with the delivery it asks for
+static bool send_to_hop(Cluster* cluster, NetworkHandle next_hop, NetworkMessage* msg) {
+    if (msg->datagram) {
+        return network_send_unreliable(cluster->network, &next_hop, 1, msg) == 1;
+    }
+    if (msg->reliable) {
+        return network_send_reliable(cluster->network, next_hop, msg);
+    }
+    return network_send_handle(cluster->network, next_hop, msg);
+}
+
+// Pass a data frame on toward the peer owning its target, straight from
+// the receive buffer. Frames are never sent back where they came from,
+// and keep the delivery they arrived with; local clients are sent them
+// plainly.
+static void forward_data(Cluster* cluster, const NetworkView* view) {
+    char target[64];
+    memcpy(target, view->target_id, view->target_len);
+    target[view->target_len] = '\0';
+
+    RoutingResult route;
+    switch (routing_lookup(cluster->routes, target, &route)) {
+        case ROUTE_LOCAL: {
+            NetworkConnection* conn = network_find_node(cluster->network, target);
+            NetworkView plain = *view;
+            plain.datagram = false;
+            plain.reliable = false;
+            network_forward(cluster->network, network_get_handle(cluster->network, conn), &plain);
+            break;
+        }
+        case ROUTE_REMOTE:
+            if (route.next_hop != view->connection) {
+                network_forward(cluster->network, route.next_hop, view);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Hand frames from peers to the cluster layer. Data frames are forwarded
+// from their view; gossip and link adverts are copied into the scratch
+// message first.
+static void cluster_message(NetworkContext* network, const NetworkView* view) {
+    Cluster* cluster = network->user_data;
+    if (!cluster) return;
+
+    // With authentication on, only frames the network verified are trusted
+    if (cluster->require_auth && !view->authenticated) {
+        cluster->unauthenticated++;
+        return;
+    }
+    if (view->type == NET_MSG_DATA) {
+        if (view->target_len) {
+            forward_data(cluster, view);
+        }
+        return;
+    }
+
+    NetworkMessage* msg = cluster->scratch;
+    network_view_copy(view, msg);
+    if (gossip_receive(cluster->gossip, msg)) return;
+
+    if (msg->type == NET_MSG_ROUTE_UPDATE) {
+        handle_greeting(cluster, msg);
+    }
+}
+
+// A lost neighbour changes our links
+static void cluster_disconnect(NetworkContext* network, NetworkConnection* conn) {
+    Cluster* cluster = network->user_data;
+    if (cluster && routing_remove_neighbor(cluster->routes, network_get_handle(network, conn))) {
+        advertise_links(cluster, NETWORK_INVALID_HANDLE);
+    }
+}
+
+// Place a node in the routing tree. Nodes under a known parent inherit
+// its owner; the rest are claimed by the peer that made them.
+static void route_node(RoutingTable* routes, const char* node_id, const char* parent_id,
+                       const char* owner) {
+    routing_add_node(routes, node_id, parent_id);
+    if (!parent_id || routing_lookup(routes, parent_id, NULL) == ROUTE_UNKNOWN) {
+        routing_set_owner(routes, node_id, owner);
+    }
+}
+
+// Apply tree changes and link adverts from elsewhere in the cluster.
+// Created events carry the node ID, then a NUL and its parent ID.
+static void cluster_event(GossipContext* gossip, const GossipEvent* event, void* user_data) {
+    (void)gossip;
+    Cluster* cluster = user_data;
+
+    if (event->type == NET_MSG_ROUTE_UPDATE) {
+        routing_apply_links(cluster->routes, event->origin, event->data, event->size);
+        return;
+    }
+
+    char node_id[64];
+    char parent_id[64] = "";
+    size_t id_len = strnlen((const char*)event->data, event->size);
+    if (id_len == 0 || id_len >= sizeof(node_id)) return;
+    memcpy(node_id, event->data, id_len);
+    node_id[id_len] = '\0';
+    if (id_len + 1 < event->size && event->size - id_len - 1 < sizeof(parent_id)) {
+        memcpy(parent_id, event->data + id_len + 1, event->size - id_len - 1);
+        parent_id[event->size - id_len - 1] = '\0';
+    }
+
+    bool created = event->type == NET_MSG_NODE_CREATED;
+    if (created) {
+        route_node(cluster->routes, node_id, parent_id[0] ? parent_id : NULL, event->origin);
+    } else if (event->type == NET_MSG_NODE_DELETED) {
+        routing_remove_node(cluster->routes, node_id);
+    } else {
+        return;
+    }
+
+    if (cluster->node_handler) {
+        cluster->node_handler(cluster, node_id, created, event->origin, cluster->user_data);
+    }
+}
+
+// Create the gossip and routing state and take over the network handlers
+Cluster* cluster_create(NetworkContext* network, const char* node_id) {
+    if (!network || !node_id) return NULL;
+
+    Cluster* cluster = calloc(1, sizeof(Cluster));
+    if (!cluster) return NULL;
+
+    cluster->network = network;
+    cluster->gossip = gossip_create(network, node_id);
+    cluster->routes = routing_create(node_id);
+    cluster->scratch = malloc(sizeof(NetworkMessage) + NETWORK_MAX_FRAME_SIZE);
+    if (!cluster->gossip || !cluster->routes || !cluster->scratch) {
+        gossip_destroy(cluster->gossip);
+        routing_destroy(cluster->routes);
+        free(cluster->scratch);
+        free(cluster);
+        return NULL;
+    }
+    gossip_set_handler(cluster->gossip, cluster_event, cluster);
+
+    network->user_data = cluster;
+    network_set_view_handler(network, cluster_message);
+    network_set_disconnect_handler(network, cluster_disconnect);
+    return cluster;
+}
+
+// Detach from the network before freeing, so no poll reaches the freed
+// gossip state or routes
+void cluster_destroy(Cluster* cluster) {
+    if (!cluster) return;
+
+    network_set_view_handler(cluster->network, NULL);
+    network_set_disconnect_handler(cluster->network, NULL);
+    cluster->network->user_data = NULL;
+
+    gossip_destroy(cluster->gossip);
+    routing_destroy(cluster->routes);
+    free(cluster->scratch);
+    free(cluster);
+}
+
+void cluster_set_node_handler(Cluster* cluster, ClusterNodeHandler handler, void* user_data) {
+    if (!cluster) return;
+    cluster->node_handler = handler;
+    cluster->user_data = user_data;
+}
+
+void cluster_require_auth(Cluster* cluster, bool required) {
+    if (cluster) cluster->require_auth = required;
+}
+
+// Greet handshaken connections that have not introduced themselves yet
+void cluster_greet(Cluster* cluster) {
+    time_t now = time(NULL);
+    if (!cluster || now == cluster->last_greeting) return;
+    cluster->last_greeting = now;
+
+    // Every connection may be a neighbour, however many are allowed
+    size_t max = cluster->network->max_connections;
+    NetworkHandle* handles = malloc(max * sizeof(NetworkHandle));
+    if (!handles) return;
+
+    size_t count = network_get_handles(cluster->network, handles, max);
+    for (size_t i = 0; i < count; i++) {
+        if (!routing_has_neighbor(cluster->routes, handles[i])) {
+            advertise_links(cluster, handles[i]);
+        }
+    }
+    free(handles);
+}
+
+// Send a local data frame toward the owner of its target
+bool cluster_route(Cluster* cluster, NetworkMessage* msg) {
+    if (!cluster || !msg) return false;
+
+    RoutingResult route;
+    if (routing_lookup(cluster->routes, msg->target_id, &route) != ROUTE_REMOTE) {
+        return false;
+    }
+    return send_to_hop(cluster, route.next_hop, msg);
+}
+
+// Record a local tree change for routing and spread it to the cluster
+bool cluster_publish_node(Cluster* cluster, bool created, const char* node_id,
+                          const char* parent_id) {
+    if (!cluster || !node_id) return false;
+
+    uint8_t event[128];
+    size_t size = strnlen(node_id, 63);
+    memcpy(event, node_id, size);
+    if (created) {
+        route_node(cluster->routes, node_id, parent_id, cluster->gossip->node_id);
+        if (parent_id && parent_id[0]) {
+            size_t parent_len = strnlen(parent_id, 63);
+            event[size++] = '\0';
+            memcpy(event + size, parent_id, parent_len);
+            size += parent_len;
+        }
+    } else {
+        routing_remove_node(cluster->routes, node_id);
+    }
+
+    return gossip_publish(cluster->gossip,
+                          created ? NET_MSG_NODE_CREATED : NET_MSG_NODE_DELETED,
+                          event, (uint32_t)size);
+}
\ No newline at end of file
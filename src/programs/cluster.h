@@ -0,0 +1,59 @@
+#ifndef PHANTOM_CLUSTER_H
+#define PHANTOM_CLUSTER_H
+
+#include <stdbool.h>
+#include <time.h>
+#include "../runtime/network/network.h"
+#include "../runtime/network/gossip.h"
+#include "../runtime/routing/routing.h"
+
+// Cluster layer of a PhantomID peer. It owns the network's view and
+// disconnect handlers: tree events are gossiped to every peer, link
+// adverts between neighbours build the routing table, and data frames
+// for nodes owned elsewhere are passed on toward their owner straight
+// from the receive buffer. The network's user_data points back at the
+// cluster while it is attached.
+typedef struct Cluster Cluster;
+
+// Tree event applied from elsewhere in the cluster
+typedef void (*ClusterNodeHandler)(Cluster* cluster, const char* node_id, bool created,
+                                   const char* origin, void* user_data);
+
+struct Cluster {
+    NetworkContext* network;     // Network the cluster runs over
+    GossipContext* gossip;       // Tree events and link adverts
+    RoutingTable* routes;        // Node owners and next hops
+    time_t last_greeting;        // Last greet_neighbors pass
+    ClusterNodeHandler node_handler; // Node event callback
+    void* user_data;             // Handler argument
+    bool require_auth;           // Drop frames the network did not verify
+    uint64_t unauthenticated;    // Frames dropped for it
+    NetworkMessage* scratch;     // Gossip and adverts copied out of their views
+};
+
+// Attach a cluster as node_id to network, replacing its view and
+// disconnect handlers. cluster_destroy detaches it again.
+Cluster* cluster_create(NetworkContext* network, const char* node_id);
+void cluster_destroy(Cluster* cluster);
+void cluster_set_node_handler(Cluster* cluster, ClusterNodeHandler handler, void* user_data);
+
+// Act only on frames from connections verifying frame tags: gossip,
+// link adverts and data from anywhere else are dropped unread.
+void cluster_require_auth(Cluster* cluster, bool required);
+
+// Send our link advert to handshaken connections that have not
+// introduced themselves yet. Runs at most once a second.
+void cluster_greet(Cluster* cluster);
+
+// Record a local node creation or deletion and gossip it. Created nodes
+// are owned here unless their parent is already owned elsewhere.
+bool cluster_publish_node(Cluster* cluster, bool created, const char* node_id,
+                          const char* parent_id);
+
+// Send a data frame toward the peer owning its target, reliably,
+// as a datagram or plainly on the connection as its flags ask. Returns
+// false if the target is not owned by a reachable peer or the frame was
+// not accepted for sending.
+bool cluster_route(Cluster* cluster, NetworkMessage* msg);
+
+#endif // PHANTOM_CLUSTER_H
\ No newline at end of file
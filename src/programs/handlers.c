@@ -9,18 +9,17 @@
 
 // Message handler types
 typedef struct {
-    NetworkMessage msg;
     TreeNode* source;
     TreeNode* target;
-} MessageContext;
+} NodeMessageContext;
 
 // Parse message target/source IDs
-static bool parse_message_context(Program* program, const Message* message, MessageContext* ctx) {
+static bool parse_message_context(Program* program, const Message* message, NodeMessageContext* ctx) {
     if (!message->source[0]) {
         return false;
     }
 
-    TreeContext* tree = program_get_tree(program);
+    TreeContext* tree = phantom_get_tree(program);
     ctx->source = tree_find_node(tree, message->source);
     
     if (message->target[0]) {
@@ -33,31 +32,33 @@ static bool parse_message_context(Program* program, const Message* message, Mess
 
 // Handle node creation message
 static bool handle_node_created(Program* program, const Message* message) {
-    MessageContext ctx = {0};
+    NodeMessageContext ctx = {0};
     if (!parse_message_context(program, message, &ctx)) {
         return false;
     }
 
     // Create node under source node
-    TreeNode* new_node = tree_create_node(program_get_tree(program), ctx.source->id);
+    TreeNode* new_node = tree_create_node(phantom_get_tree(program), ctx.source->id);
     if (!new_node) return false;
 
     // Broadcast creation to network
     Message notify = {
-        .type = MSG_NODE_CREATED,
-        .flags = MSG_FLAG_RELIABLE,
-        .data_size = sizeof(new_node->id)
+        .type = (MessageType)PHANTOM_MSG_NODE_CREATED,
+        .flags = MSG_FLAG_RELIABLE
     };
     strncpy(notify.source, new_node->id, sizeof(notify.source));
-    memcpy(notify.data, new_node->id, notify.data_size);
-
-    program_get_message(program)->broadcast(program, &notify);
+    if (message_alloc_data(&notify, sizeof(new_node->id))) {
+        memcpy(notify.data, new_node->id, notify.data_size);
+        get_message_interface()->broadcast(program, &notify);
+        message_release(&notify);
+    }
+    phantom_gossip_node(program, true, new_node->id, ctx.source->id);
     return true;
 }
 
 // Handle node deletion message
 static bool handle_node_deleted(Program* program, const Message* message) {
-    MessageContext ctx = {0};
+    NodeMessageContext ctx = {0};
     if (!parse_message_context(program, message, &ctx)) {
         return false;
     }
@@ -68,73 +69,89 @@ static bool handle_node_deleted(Program* program, const Message* message) {
     }
 
     // Delete node and handle orphans
-    if (!tree_delete_node(program_get_tree(program), ctx.source->id)) {
+    if (!tree_delete_node(phantom_get_tree(program), ctx.source->id)) {
         return false;
     }
 
     // Broadcast deletion
     Message notify = {
-        .type = MSG_NODE_DELETED,
-        .flags = MSG_FLAG_RELIABLE,
-        .data_size = sizeof(ctx.source->id)
+        .type = (MessageType)PHANTOM_MSG_NODE_DELETED,
+        .flags = MSG_FLAG_RELIABLE
     };
     strncpy(notify.source, ctx.source->id, sizeof(notify.source));
-    memcpy(notify.data, ctx.source->id, notify.data_size);
-
-    program_get_message(program)->broadcast(program, &notify);
+    if (message_alloc_data(&notify, sizeof(ctx.source->id))) {
+        memcpy(notify.data, ctx.source->id, notify.data_size);
+        get_message_interface()->broadcast(program, &notify);
+        message_release(&notify);
+    }
+    phantom_gossip_node(program, false, notify.source, NULL);
     return true;
 }
 
 // Handle data message between nodes
 static bool handle_node_message(Program* program, const Message* message) {
-    MessageContext ctx = {0};
+    NodeMessageContext ctx = {0};
+
+    // Targets owned by another peer go to the next hop toward it
+    TreeContext* tree = phantom_get_tree(program);
+    if (message->target[0] && tree_find_node(tree, message->source) &&
+        !tree_find_node(tree, message->target)) {
+        return phantom_route_message(program, message);
+    }
+
     if (!parse_message_context(program, message, &ctx)) {
         return false;
     }
 
     // Check if nodes can communicate
-    if (!tree_can_communicate(program_get_tree(program), 
+    if (!tree_can_communicate(phantom_get_tree(program), 
                             ctx.source->id, ctx.target->id)) {
         return false;
     }
 
-    // Forward message to target
+    // Forward message to target; send shares the payload
     Message forward = {
         .type = MSG_DATA,
         .flags = message->flags,
-        .data_size = message->data_size
+        .data = message->data,
+        .data_size = message->data_size,
+        .payload = message->payload
     };
     strncpy(forward.source, ctx.source->id, sizeof(forward.source));
     strncpy(forward.target, ctx.target->id, sizeof(forward.target));
-    memcpy(forward.data, message->data, message->data_size);
 
-    program_get_message(program)->send(program, ctx.target->id, &forward);
+    get_message_interface()->send(program, ctx.target->id, &forward);
     return true;
 }
 
 // Handle network status message
 static bool handle_network_status(Program* program, const Message* message) {
+    const StateInterface* states = program_get_state(program);
+    if (!states || message->data_size != sizeof(NetworkState)) {
+        return false;
+    }
+
     NetworkState state = {0};
     memcpy(&state, message->data, sizeof(NetworkState));
 
     // Update network state
     StateEntry entry = {
-        .type = PHANTOM_STATE_NETWORK,
+        .type = (StateType)PHANTOM_STATE_NETWORK,
         .data = &state,
         .data_size = sizeof(NetworkState)
     };
     strcpy(entry.id, "network");
 
-    return program_get_state(program)->set_entry(program, &entry);
+    return states->set_entry(program, &entry);
 }
 
 // Main message handler
 bool phantom_handle_message(Program* program, const Message* message) {
-    switch (message->type) {
-        case MSG_NODE_CREATED:
+    switch ((int)message->type) {
+        case PHANTOM_MSG_NODE_CREATED:
             return handle_node_created(program, message);
             
-        case MSG_NODE_DELETED:
+        case PHANTOM_MSG_NODE_DELETED:
             return handle_node_deleted(program, message);
             
         case MSG_DATA:
@@ -154,7 +171,7 @@ static CommandStatus handle_create_command(Program* program,
                                          CommandResponse* response) {
     const char* parent_id = command->data_size > 0 ? command->data : NULL;
     
-    TreeNode* node = tree_create_node(program_get_tree(program), parent_id);
+    TreeNode* node = tree_create_node(phantom_get_tree(program), parent_id);
     if (!node) {
         return CMD_STATUS_ERROR;
     }
@@ -169,12 +186,13 @@ static CommandStatus handle_create_command(Program* program,
 static CommandStatus handle_delete_command(Program* program,
                                          const Command* command,
                                          CommandResponse* response) {
+    (void)response;
     if (!command->data || command->data_size == 0) {
         return CMD_STATUS_INVALID;
     }
 
     const char* node_id = command->data;
-    if (!tree_delete_node(program_get_tree(program), node_id)) {
+    if (!tree_delete_node(phantom_get_tree(program), node_id)) {
         return CMD_STATUS_ERROR;
     }
 
@@ -185,7 +203,8 @@ static CommandStatus handle_delete_command(Program* program,
 static CommandStatus handle_status_command(Program* program,
                                          const Command* command,
                                          CommandResponse* response) {
-    TreeContext* tree = program_get_tree(program);
+    (void)command;
+    TreeContext* tree = phantom_get_tree(program);
     
     char* status = malloc(1024);
     if (!status) return CMD_STATUS_ERROR;
@@ -236,20 +255,29 @@ CommandStatus phantom_handle_command(Program* program,
 
 // Initialize handlers
 bool phantom_handlers_init(Program* program) {
-    program_get_message(program)->register_handler(program, MSG_NODE_CREATED, 
-                                                 phantom_handle_message);
-    program_get_message(program)->register_handler(program, MSG_NODE_DELETED, 
-                                                 phantom_handle_message);
-    program_get_message(program)->register_handler(program, MSG_DATA,
-                                                 phantom_handle_message);
-    program_get_message(program)->register_handler(program, MSG_NETWORK,
-                                                 phantom_handle_message);
+    MessageContext* messages = phantom_get_messages(program);
+    if (!message_set_handler(messages, (MessageType)PHANTOM_MSG_NODE_CREATED,
+                             phantom_handle_message) ||
+        !message_set_handler(messages, (MessageType)PHANTOM_MSG_NODE_DELETED,
+                             phantom_handle_message) ||
+        !message_set_handler(messages, MSG_DATA, phantom_handle_message) ||
+        !message_set_handler(messages, MSG_NETWORK, phantom_handle_message)) {
+        return false;
+    }
+
+    // Membership and status changes are dispatched ahead of queued data
+    message_set_lane(messages, (MessageType)PHANTOM_MSG_NODE_CREATED, MSG_LANE_CONTROL);
+    message_set_lane(messages, (MessageType)PHANTOM_MSG_NODE_DELETED, MSG_LANE_CONTROL);
+    message_set_lane(messages, (MessageType)PHANTOM_MSG_NODE_JOIN, MSG_LANE_CONTROL);
+    message_set_lane(messages, (MessageType)PHANTOM_MSG_NODE_LEAVE, MSG_LANE_CONTROL);
+    message_set_lane(messages, (MessageType)PHANTOM_MSG_NET_STATUS, MSG_LANE_CONTROL);
+    message_set_lane(messages, (MessageType)PHANTOM_MSG_ERROR, MSG_LANE_CONTROL);
 
     // Add command handlers to command interface
-    program_get_command(program)->register_handler(program, CMD_NODE,
-                                                 phantom_handle_command);
-    program_get_command(program)->register_handler(program, CMD_PROGRAM,
-                                                 phantom_handle_command);
+    get_command_interface()->register_handler(program, CMD_NODE,
+                                              phantom_handle_command);
+    get_command_interface()->register_handler(program, CMD_PROGRAM,
+                                              phantom_handle_command);
 
     return true;
 }
\ No newline at end of file
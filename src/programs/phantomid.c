@@ -2,30 +2,61 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include "../interface/program.h"
 #include "../interface/message.h"
 #include "../interface/command.h"
 #include "../interface/state.h"
 #include "../runtime/tree/tree.h"
 #include "../runtime/network/network.h"
+#include "../runtime/routing/routing.h"
+#include "cluster.h"
 #include "phantomid.h"
 
+// Program features are negotiated as network handshake features
+_Static_assert(PHANTOM_FEATURE_ENCRYPTION == NET_FEATURE_ENCRYPTION, "feature bits differ");
+_Static_assert(PHANTOM_FEATURE_COMPRESSION == NET_FEATURE_COMPRESSION, "feature bits differ");
+_Static_assert(PHANTOM_FEATURE_AUTH == NET_FEATURE_AUTH, "feature bits differ");
+_Static_assert(PHANTOM_FEATURE_PERSISTENCE == NET_FEATURE_PERSISTENCE, "feature bits differ");
+
 // Program user data structure
 typedef struct {
     TreeContext* tree;
     MessageContext* messages;
+    MessageBudget message_budget;
+    Cluster* cluster;
     NetworkConfig network_config;
     StateConfig state_config;
     bool verbose_logging;
 } PhantomIDContext;
 
+static bool validate_message(const Message* msg);
+static bool parse_command(const char* cmd_str, Command* cmd);
+
 // Initialize program configuration
 static bool init_config(PhantomIDContext* context) {
     // Network configuration
     context->network_config.port = 8888;
     context->network_config.max_connections = 1000;
     context->network_config.timeout_ms = 1000;
-    context->network_config.backlog = 10;
+    context->network_config.backlog = 1024;
+    strncpy(context->network_config.unix_path, "/tmp/phantomid.sock",
+            sizeof(context->network_config.unix_path) - 1);
+    const char* auth_key_file = getenv("PHANTOM_AUTH_KEY_FILE");
+    if (auth_key_file) {
+        strncpy(context->network_config.auth_key_file, auth_key_file,
+                sizeof(context->network_config.auth_key_file) - 1);
+    }
+    const char* peers = getenv("PHANTOM_PEERS");
+    if (peers) {
+        strncpy(context->network_config.peers, peers, sizeof(context->network_config.peers) - 1);
+    }
+    const char* datagrams = getenv("PHANTOM_DATAGRAMS");
+    context->network_config.datagrams = datagrams && strcmp(datagrams, "1") == 0;
+
+    // Message processing per run-loop pass
+    context->message_budget.max_messages = 4096;
+    context->message_budget.max_us = 2000;
 
     // State configuration
     context->state_config.auto_save = true;
@@ -36,6 +67,11 @@ static bool init_config(PhantomIDContext* context) {
     return true;
 }
 
+// Queued messages end the run loop's sleep
+static void wake_program(void* program) {
+    program_wake(program);
+}
+
 // Initialize program components
 static bool init_components(Program* program, PhantomIDContext* context) {
     // Initialize tree
@@ -43,15 +79,73 @@ static bool init_components(Program* program, PhantomIDContext* context) {
     if (!context->tree) return false;
 
     // Initialize message system
-    context->messages = message_create();
+    context->messages = message_create(program);
     if (!context->messages) {
         tree_destroy(context->tree);
         return false;
     }
+    message_set_wakeup(context->messages, wake_program, program);
+
+    return true;
+}
+
+// Load the shared frame authentication secret
+static bool load_auth_key(NetworkContext* network, const char* path) {
+    uint8_t secret[AUTH_MAX_SECRET];
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+
+    size_t size = fread(secret, 1, sizeof(secret), file);
+    fclose(file);
+
+    bool loaded = network_set_auth_key(network, secret, size);
+    memset(secret, 0, sizeof(secret));
+    return loaded;
+}
+
+// Log tree changes made elsewhere in the cluster
+static void log_cluster_node(Cluster* cluster, const char* node_id, bool created,
+                             const char* origin, void* user_data) {
+    (void)cluster;
+    if (phantom_get_verbose(user_data)) {
+        printf("Cluster: node %s %s by %s\n", node_id, created ? "created" : "deleted", origin);
+    }
+}
 
+// Join the cluster: register peers and start gossiping tree events
+static bool init_cluster(Program* program, PhantomIDContext* context, NetworkContext* network) {
+    char node_id[64];
+    char host[48] = "localhost";
+    gethostname(host, sizeof(host) - 1);
+    snprintf(node_id, sizeof(node_id), "%s:%u", host, (unsigned)context->network_config.port);
+
+    context->cluster = cluster_create(network, node_id);
+    if (!context->cluster) return false;
+    cluster_set_node_handler(context->cluster, log_cluster_node, program);
+    cluster_require_auth(context->cluster, context->network_config.auth_key_file[0] != '\0');
+
+    // Peers are host:port separated by commas
+    char peers[sizeof(context->network_config.peers)];
+    strcpy(peers, context->network_config.peers);
+    char* save = NULL;
+    for (char* entry = strtok_r(peers, ",", &save); entry; entry = strtok_r(NULL, ",", &save)) {
+        char* colon = strrchr(entry, ':');
+        if (!colon || colon == entry) continue;
+        *colon = '\0';
+        long port = strtol(colon + 1, NULL, 10);
+        if (port > 0 && port <= 65535) {
+            network_add_peer(network, entry, (uint16_t)port);
+        }
+    }
     return true;
 }
 
+// Detach the cluster layer from the network and free it
+static void leave_cluster(PhantomIDContext* context) {
+    cluster_destroy(context->cluster);
+    context->cluster = NULL;
+}
+
 // Program initialization
 static bool phantom_init(Program* program) {
     PhantomIDContext* context = calloc(1, sizeof(PhantomIDContext));
@@ -69,8 +163,37 @@ static bool phantom_init(Program* program) {
         return false;
     }
 
+    // Apply network configuration before the runtime starts listening
+    NetworkContext* network = program_get_network(program);
+    if (network) {
+        uint32_t timeout = context->network_config.timeout_ms;
+        network_set_backlog(network, context->network_config.backlog);
+        network_set_timeouts(network, timeout, timeout / 3, timeout);
+        network_set_unix_path(network, context->network_config.unix_path);
+        if (context->network_config.datagrams) {
+            network_set_datagram(network, true);
+        }
+    }
+
+    // Once a secret is configured, unauthenticated peers are refused
+    if (context->network_config.auth_key_file[0] &&
+        (!network || !load_auth_key(network, context->network_config.auth_key_file))) {
+        message_destroy(context->messages);
+        tree_destroy(context->tree);
+        free(context);
+        return false;
+    }
+
+    if (network && !init_cluster(program, context, network)) {
+        message_destroy(context->messages);
+        tree_destroy(context->tree);
+        free(context);
+        return false;
+    }
+
     // Initialize handlers
     if (!phantom_handlers_init(program)) {
+        leave_cluster(context);
         message_destroy(context->messages);
         tree_destroy(context->tree);
         free(context);
@@ -79,6 +202,7 @@ static bool phantom_init(Program* program) {
 
     // Initialize state management
     if (!phantom_state_init(program)) {
+        leave_cluster(context);
         message_destroy(context->messages);
         tree_destroy(context->tree);
         free(context);
@@ -102,6 +226,7 @@ static void phantom_cleanup(Program* program) {
         phantom_state_cleanup(program);
 
         // Cleanup components
+        leave_cluster(context);
         message_destroy(context->messages);
         tree_destroy(context->tree);
         
@@ -110,6 +235,15 @@ static void phantom_cleanup(Program* program) {
     }
 }
 
+// One status line for verbose logging
+static void print_network_status(NetworkContext* network) {
+    NetworkStats stats;
+    network_get_stats(network, &stats);
+    printf("Network: %zu connections, %llu frames in, %llu frames out, %llu dropped\n",
+           network->active_connections, (unsigned long long)stats.frames_received,
+           (unsigned long long)stats.frames_sent, (unsigned long long)stats.frames_dropped);
+}
+
 // Program main loop
 static void phantom_run(Program* program) {
     PhantomIDContext* context = program->user_data;
@@ -117,27 +251,40 @@ static void phantom_run(Program* program) {
     // Check for state save
     phantom_check_state(program);
 
-    // Process messages
-    message_process_queue(context->messages);
+    // Process messages, in bounded batches so the duties below still run
+    message_process_queue(context->messages, &context->message_budget);
+
+    // Introduce ourselves to new cluster connections
+    cluster_greet(context->cluster);
 
     // Update network status
-    if (context->verbose_logging) {
-        network_print_status(program_get_network(program));
+    NetworkContext* network = program_get_network(program);
+    if (context->verbose_logging && network) {
+        print_network_status(network);
     }
 
-    // Small sleep to prevent CPU spinning
-    usleep(10000); // 10ms
+    // The run loop sleeps only when idle and the next queued message
+    // wakes it. Without one, wait here instead.
+    if (program_get_events(program)) {
+        if (!message_arm_wakeup(context->messages)) {
+            program_wake(program);
+        }
+    } else if (message_pending(context->messages) == 0) {
+        message_wait(context->messages, 10);
+    }
 }
 
 // Message handling wrapper
 static bool phantom_handle_message_wrapper(Program* program, const void* message, size_t size) {
     const Message* msg = message;
+    const PhantomIDContext* context = program->user_data;
     
-    if (size < sizeof(Message) || !validate_message(msg)) {
+    if (!context || size < sizeof(Message) || !validate_message(msg)) {
         return false;
     }
 
-    return phantom_handle_message(program, msg);
+    // Handled in batches by the run loop
+    return message_receive(context->messages, msg);
 }
 
 // Command handling wrapper
@@ -186,6 +333,44 @@ MessageContext* phantom_get_messages(Program* program) {
     return context ? context->messages : NULL;
 }
 
+// Record a local tree change for routing and spread it to the cluster
+bool phantom_gossip_node(Program* program, bool created, const char* node_id,
+                         const char* parent_id) {
+    PhantomIDContext* context = program->user_data;
+    if (!context) return false;
+
+    return cluster_publish_node(context->cluster, created, node_id, parent_id);
+}
+
+// Send a data message toward the peer owning its target. Returns false
+// if the target is not known to be owned by a reachable peer, or the
+// message does not fit in a frame.
+bool phantom_route_message(Program* program, const Message* message) {
+    PhantomIDContext* context = program->user_data;
+    if (!context || !context->cluster || !message->target[0] ||
+        (message->data_size && !message->data) || message->data_size > NETWORK_MAX_FRAME_SIZE) {
+        return false;
+    }
+
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + message->data_size);
+    if (!msg) return false;
+    msg->type = NET_MSG_DATA;
+    strncpy(msg->source_id, message->source, sizeof(msg->source_id) - 1);
+    strncpy(msg->target_id, message->target, sizeof(msg->target_id) - 1);
+    msg->data_size = (uint32_t)message->data_size;
+    if (message->data_size) {
+        memcpy(msg->data, message->data, message->data_size);
+    }
+
+    // Reliable messages are acknowledged; the rest go on the connection,
+    // or as datagrams where the cluster is configured to use them
+    msg->reliable = (message->flags & MSG_FLAG_RELIABLE) != 0;
+    msg->datagram = !msg->reliable && context->network_config.datagrams;
+    bool sent = cluster_route(context->cluster, msg);
+    free(msg);
+    return sent;
+}
+
 // Configuration getters/setters
 void phantom_set_verbose(Program* program, bool verbose) {
     PhantomIDContext* context = program->user_data;
@@ -211,12 +396,12 @@ static bool validate_message(const Message* msg) {
     // Basic validation
     if (!msg->source[0]) return false;
     if (msg->data_size > 0 && !msg->data) return false;
-    if (msg->timestamp > time(NULL)) return false;
+    if (msg->timestamp > (uint64_t)time(NULL)) return false;
 
     // Type-specific validation
-    switch (msg->type) {
-        case MSG_NODE_CREATED:
-        case MSG_NODE_DELETED:
+    switch ((int)msg->type) {
+        case PHANTOM_MSG_NODE_CREATED:
+        case PHANTOM_MSG_NODE_DELETED:
             if (!msg->data || msg->data_size != sizeof(char[64])) return false;
             break;
 
@@ -5,6 +5,7 @@
 #include "../interface/program.h"
 #include "../interface/message.h"
 #include "../interface/command.h"
+#include "../interface/state.h"
 #include "../runtime/tree/tree.h"
 
 // Network configuration
@@ -13,6 +14,10 @@ typedef struct {
     size_t max_connections;     // Maximum allowed connections
     uint32_t timeout_ms;        // Connection timeout in milliseconds
     size_t backlog;            // Connection backlog size
+    char unix_path[108];       // Local socket for same-host clients, empty disables
+    char auth_key_file[256];   // Shared frame authentication secret, empty disables
+    char peers[512];           // Cluster peers as host:port,host:port, empty for none
+    bool datagrams;            // Send unreliable cluster messages over UDP
 } NetworkConfig;
 
 // State configuration
@@ -48,6 +53,13 @@ bool phantom_check_state(Program* program);
 TreeContext* phantom_get_tree(Program* program);
 MessageContext* phantom_get_messages(Program* program);
 
+// Spread a local node creation or deletion to the cluster
+bool phantom_gossip_node(Program* program, bool created, const char* node_id,
+                         const char* parent_id);
+
+// Forward a data message to the remote peer owning its target
+bool phantom_route_message(Program* program, const Message* message);
+
 // Configuration
 void phantom_set_verbose(Program* program, bool verbose);
 bool phantom_get_verbose(Program* program);
@@ -68,9 +80,26 @@ typedef enum {
     PHANTOM_MSG_NODE_LEAVE,                 // Node leaving network
     PHANTOM_MSG_NODE_UPDATE,                // Node state update
     PHANTOM_MSG_NET_STATUS,                 // Network status update
-    PHANTOM_MSG_ERROR                       // Error notification
+    PHANTOM_MSG_ERROR,                      // Error notification
+    PHANTOM_MSG_NODE_CREATED,               // Node created under the source
+    PHANTOM_MSG_NODE_DELETED                // Source node deleted
 } PhantomMessageType;
 
+// State types (extending base types)
+typedef enum {
+    PHANTOM_STATE_NODE = STATE_CUSTOM,      // Tree node
+    PHANTOM_STATE_NETWORK,                  // Network status
+    PHANTOM_STATE_CONFIG                    // Program configuration
+} PhantomStateType;
+
+// Network status carried by MSG_NETWORK messages and state entries
+typedef struct {
+    uint16_t port;
+    size_t max_connections;
+    time_t last_activity;
+    size_t active_connections;
+} NetworkState;
+
 // Command types (extending base types)
 typedef enum {
     PHANTOM_CMD_NODE_ADD = CMD_CUSTOM,      // Add new node
@@ -7,13 +7,6 @@
 #include "../runtime/tree/tree.h"
 #include "phantomid.h"
 
-// Program state types
-typedef enum {
-    PHANTOM_STATE_NODE = STATE_CUSTOM,
-    PHANTOM_STATE_NETWORK,
-    PHANTOM_STATE_CONFIG
-} PhantomStateType;
-
 // Node state structure
 typedef struct {
     char id[64];
@@ -25,14 +18,6 @@ typedef struct {
     size_t max_children;
 } NodeState;
 
-// Network state structure
-typedef struct {
-    uint16_t port;
-    size_t max_connections;
-    time_t last_activity;
-    size_t active_connections;
-} NetworkState;
-
 // Configuration state structure
 typedef struct {
     bool verbose_logging;
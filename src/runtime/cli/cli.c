@@ -109,13 +109,19 @@ CommandResult cli_execute_network(CLIContext* ctx, int argc, char** argv) {
             return CMD_ERROR_ARGS;
         }
         
-        NetworkMessage msg = {
-            .type = MSG_DATA,
-            .data_size = strlen(argv[3])
-        };
-        memcpy(msg.data, argv[3], msg.data_size);
+        size_t size = strlen(argv[3]);
+        NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + size);
+        if (!msg) {
+            set_error(ctx, "Out of memory");
+            return CMD_ERROR_EXEC;
+        }
+        msg->type = NET_MSG_DATA;
+        msg->data_size = (uint32_t)size;
+        memcpy(msg->data, argv[3], size);
         
-        if (network_send(ctx->network, argv[2], &msg)) {
+        bool sent = network_send(ctx->network, argv[2], msg);
+        free(msg);
+        if (sent) {
             printf("Message sent to %s\n", argv[2]);
             return CMD_SUCCESS;
         }
@@ -130,18 +136,26 @@ CommandResult cli_execute_network(CLIContext* ctx, int argc, char** argv) {
             return CMD_ERROR_ARGS;
         }
         
-        NetworkMessage msg = {
-            .type = MSG_DATA,
-            .data_size = strlen(argv[2])
-        };
-        memcpy(msg.data, argv[2], msg.data_size);
+        size_t size = strlen(argv[2]);
+        NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + size);
+        if (!msg) {
+            set_error(ctx, "Out of memory");
+            return CMD_ERROR_EXEC;
+        }
+        msg->type = NET_MSG_DATA;
+        msg->data_size = (uint32_t)size;
+        memcpy(msg->data, argv[2], size);
         
-        if (network_broadcast(ctx->network, &msg)) {
-            printf("Message broadcast to all nodes\n");
+        NetworkBroadcastResult result;
+        bool sent = network_broadcast(ctx->network, msg, &result);
+        free(msg);
+        if (sent) {
+            printf("Message broadcast to all nodes (%zu delivered, %zu queued)\n",
+                   result.delivered, result.queued);
             return CMD_SUCCESS;
         }
         
-        set_error(ctx, "Failed to broadcast message");
+        set_error(ctx, "Failed to broadcast message (%zu dropped)", result.dropped);
         return CMD_ERROR_EXEC;
     }
 
@@ -0,0 +1,113 @@
+#include "event.h"
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+// Ready descriptors taken per wait; level triggering reports the rest
+// on the next one
+#define EVENT_BATCH 32
+
+struct EventLoop {
+    int epoll_fd;                // Watched descriptors, wake_fd and timer_fd
+    int wake_fd;                 // eventfd written by event_loop_wake
+    int timer_fd;                // Periodic timer
+    int wake_pending;            // A wake is written and not yet consumed
+};
+
+static bool add_fd(int epoll_fd, int fd, uint32_t tag) {
+    struct epoll_event ev = {0};
+    ev.events = EPOLLIN;
+    ev.data.u64 = tag;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+EventLoop* event_loop_create(void) {
+    EventLoop* loop = calloc(1, sizeof(EventLoop));
+    if (!loop) return NULL;
+
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    loop->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (loop->epoll_fd == -1 || loop->wake_fd == -1 || loop->timer_fd == -1 ||
+        !add_fd(loop->epoll_fd, loop->wake_fd, EVENT_WAKE) ||
+        !add_fd(loop->epoll_fd, loop->timer_fd, EVENT_TIMER)) {
+        event_loop_destroy(loop);
+        return NULL;
+    }
+    return loop;
+}
+
+void event_loop_destroy(EventLoop* loop) {
+    if (!loop) return;
+
+    if (loop->timer_fd >= 0) close(loop->timer_fd);
+    if (loop->wake_fd >= 0) close(loop->wake_fd);
+    if (loop->epoll_fd >= 0) close(loop->epoll_fd);
+    free(loop);
+}
+
+bool event_loop_watch(EventLoop* loop, int fd, uint32_t tag) {
+    if (!loop || fd < 0 || tag < EVENT_USER) return false;
+    return add_fd(loop->epoll_fd, fd, tag);
+}
+
+void event_loop_unwatch(EventLoop* loop, int fd) {
+    if (!loop || fd < 0) return;
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+bool event_loop_set_timer(EventLoop* loop, uint32_t interval_ms) {
+    if (!loop) return false;
+
+    struct itimerspec spec = {0};
+    spec.it_interval.tv_sec = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    return timerfd_settime(loop->timer_fd, 0, &spec, NULL) == 0;
+}
+
+void event_loop_wake(EventLoop* loop) {
+    if (!loop) return;
+
+    // One write per sleep is enough; the rest would only add syscalls
+    if (__atomic_exchange_n(&loop->wake_pending, 1, __ATOMIC_ACQ_REL)) return;
+
+    uint64_t one = 1;
+    ssize_t written;
+    do {
+        written = write(loop->wake_fd, &one, sizeof(one));
+    } while (written < 0 && errno == EINTR);
+}
+
+uint32_t event_loop_wait(EventLoop* loop, int timeout_ms) {
+    if (!loop) return 0;
+
+    struct epoll_event events[EVENT_BATCH];
+    int count;
+    do {
+        count = epoll_wait(loop->epoll_fd, events, EVENT_BATCH, timeout_ms);
+    } while (count < 0 && errno == EINTR);
+
+    uint32_t ready = 0;
+    for (int i = 0; i < count; i++) {
+        ready |= (uint32_t)events[i].data.u64;
+    }
+
+    // Consume the counters so they stop reporting. A wake landing
+    // between the read and the clear skips its write, but its work was
+    // queued before it and the caller is about to look.
+    uint64_t value;
+    if (ready & EVENT_WAKE) {
+        while (read(loop->wake_fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+        }
+        __atomic_store_n(&loop->wake_pending, 0, __ATOMIC_RELEASE);
+    }
+    if (ready & EVENT_TIMER) {
+        while (read(loop->timer_fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+        }
+    }
+    return ready;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Single blocking point for a run loop. One epoll set holds the watched
+// descriptors, an eventfd other threads signal when they queue work, and
+// a timerfd for periodic duties. The loop sleeps until one of them is
+// ready instead of waking on a fixed interval.
+typedef struct EventLoop EventLoop;
+
+// Sources reported by event_loop_wait
+typedef enum {
+    EVENT_WAKE = 1,              // event_loop_wake was called
+    EVENT_TIMER = 2,             // The periodic timer expired
+    EVENT_USER = 0x100           // First bit free for watched descriptors
+} EventFlags;
+
+// Loop lifecycle
+EventLoop* event_loop_create(void);
+void event_loop_destroy(EventLoop* loop);
+
+// Report tag from event_loop_wait while fd is readable. Level
+// triggered: a descriptor left unread keeps reporting.
+bool event_loop_watch(EventLoop* loop, int fd, uint32_t tag);
+void event_loop_unwatch(EventLoop* loop, int fd);
+
+// Expire every interval_ms, 0 to disarm
+bool event_loop_set_timer(EventLoop* loop, uint32_t interval_ms);
+
+// End the current or next wait. Safe from any thread; wakes issued
+// before the loop gets to run collapse into one.
+void event_loop_wake(EventLoop* loop);
+
+// Block until a source is ready or timeout_ms passes, -1 to wait
+// indefinitely. Returns the EventFlags and tags of the ready sources,
+// 0 on timeout.
+uint32_t event_loop_wait(EventLoop* loop, int timeout_ms);
+
+#endif // EVENT_H
\ No newline at end of file
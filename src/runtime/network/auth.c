@@ -0,0 +1,238 @@
+#include <string.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include "auth.h"
+
+#define AUTH_LABEL "phantom frame auth v1"
+#define AUTH_MAX_HELLO 64
+
+// Lane-parallel state. Without 256-bit integer vectors the 64-bit
+// rotates cost more than lanes save, so lanes are used only with AVX2.
+typedef uint64_t AuthLanes __attribute__((vector_size(AUTH_LANES * sizeof(uint64_t))));
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define LANE_TARGET __attribute__((target("avx2")))
+    #define LANES_SUPPORTED() __builtin_cpu_supports("avx2")
+#else
+    #define LANE_TARGET
+    #define LANES_SUPPORTED() false
+#endif
+
+// Works on scalars and lanes alike
+#define ROTL(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+#define SIPROUND(v0, v1, v2, v3) do {                                   \
+        v0 += v1; v1 = ROTL(v1, 13); v1 ^= v0; v0 = ROTL(v0, 32);       \
+        v2 += v3; v3 = ROTL(v3, 16); v3 ^= v2;                          \
+        v0 += v3; v3 = ROTL(v3, 21); v3 ^= v0;                          \
+        v2 += v1; v1 = ROTL(v1, 17); v1 ^= v2; v2 = ROTL(v2, 32);       \
+    } while (0)
+
+static uint64_t load64(const uint8_t* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+static void store64(uint8_t* p, uint64_t value) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    memcpy(p, &value, sizeof(value));
+}
+
+// Message word w of a frame: the sequence number, then frame bytes
+static uint64_t frame_word(const AuthFrame* frame, uint64_t seq, size_t w) {
+    return w == 0 ? seq : load64(frame->data + (w - 1) * 8);
+}
+
+// Whole words in sequence number plus frame
+static size_t frame_words(const AuthFrame* frame) {
+    return 1 + frame->size / 8;
+}
+
+// Final block: trailing bytes and the message length
+static uint64_t frame_last(const AuthFrame* frame) {
+    size_t tail = frame->size & 7;
+    const uint8_t* p = frame->data + (frame->size & ~(size_t)7);
+    uint64_t b = (uint64_t)((frame->size + 8) & 0xff) << 56;
+    for (size_t i = 0; i < tail; i++) {
+        b |= (uint64_t)p[i] << (8 * i);
+    }
+    return b;
+}
+
+// Tag up to AUTH_LANES frames together. Words all frames have are
+// absorbed in lanes; longer frames finish their extra words alone.
+LANE_TARGET static void tag_lanes(const AuthKey* key, uint64_t first_seq,
+                                  const AuthFrame* frames, size_t count,
+                                  uint8_t (*tags)[AUTH_TAG_SIZE]) {
+    AuthFrame lane[AUTH_LANES];
+    uint64_t seq[AUTH_LANES];
+    size_t common = SIZE_MAX;
+    for (size_t l = 0; l < AUTH_LANES; l++) {
+        // Spare lanes repeat the first frame
+        size_t i = l < count ? l : 0;
+        lane[l] = frames[i];
+        seq[l] = first_seq + i;
+        if (frame_words(&lane[l]) < common) common = frame_words(&lane[l]);
+    }
+
+    AuthLanes v0 = (AuthLanes){0} + (key->k0 ^ 0x736f6d6570736575ull);
+    AuthLanes v1 = (AuthLanes){0} + (key->k1 ^ 0x646f72616e646f6dull ^ 0xee);
+    AuthLanes v2 = (AuthLanes){0} + (key->k0 ^ 0x6c7967656e657261ull);
+    AuthLanes v3 = (AuthLanes){0} + (key->k1 ^ 0x7465646279746573ull);
+
+    for (size_t w = 0; w < common; w++) {
+        AuthLanes m;
+        for (size_t l = 0; l < AUTH_LANES; l++) {
+            m[l] = frame_word(&lane[l], seq[l], w);
+        }
+        v3 ^= m;
+        SIPROUND(v0, v1, v2, v3);
+        SIPROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    for (size_t l = 0; l < count; l++) {
+        size_t words = frame_words(&lane[l]);
+        if (words == common) continue;
+
+        uint64_t s0 = v0[l], s1 = v1[l], s2 = v2[l], s3 = v3[l];
+        for (size_t w = common; w < words; w++) {
+            uint64_t m = frame_word(&lane[l], seq[l], w);
+            s3 ^= m;
+            SIPROUND(s0, s1, s2, s3);
+            SIPROUND(s0, s1, s2, s3);
+            s0 ^= m;
+        }
+        v0[l] = s0;
+        v1[l] = s1;
+        v2[l] = s2;
+        v3[l] = s3;
+    }
+
+    AuthLanes b;
+    for (size_t l = 0; l < AUTH_LANES; l++) {
+        b[l] = frame_last(&lane[l]);
+    }
+    v3 ^= b;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    v0 ^= b;
+
+    v2 ^= 0xee;
+    for (int r = 0; r < 4; r++) SIPROUND(v0, v1, v2, v3);
+    AuthLanes out0 = v0 ^ v1 ^ v2 ^ v3;
+    v1 ^= 0xdd;
+    for (int r = 0; r < 4; r++) SIPROUND(v0, v1, v2, v3);
+    AuthLanes out1 = v0 ^ v1 ^ v2 ^ v3;
+
+    for (size_t l = 0; l < count; l++) {
+        store64(tags[l], out0[l]);
+        store64(tags[l] + 8, out1[l]);
+    }
+}
+
+bool auth_random(void* buffer, size_t size) {
+    return buffer && RAND_bytes(buffer, (int)size) == 1;
+}
+
+// Binding both handshakes into the key makes a tampered or replayed
+// handshake produce keys that never verify
+bool auth_derive_key(AuthKey* key, const uint8_t* secret, size_t secret_size,
+                     const uint8_t* sender_hello, size_t sender_size,
+                     const uint8_t* receiver_hello, size_t receiver_size) {
+    if (!key || !secret || secret_size < AUTH_MIN_SECRET || secret_size > AUTH_MAX_SECRET ||
+        sender_size > AUTH_MAX_HELLO || receiver_size > AUTH_MAX_HELLO) {
+        return false;
+    }
+
+    uint8_t input[sizeof(AUTH_LABEL) + 2 * AUTH_MAX_HELLO];
+    size_t length = sizeof(AUTH_LABEL);
+    memcpy(input, AUTH_LABEL, sizeof(AUTH_LABEL));
+    memcpy(input + length, sender_hello, sender_size);
+    length += sender_size;
+    memcpy(input + length, receiver_hello, receiver_size);
+    length += receiver_size;
+
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_size = 0;
+    if (!HMAC(EVP_sha256(), secret, (int)secret_size, input, length, digest, &digest_size) ||
+        digest_size < AUTH_KEY_SIZE) {
+        return false;
+    }
+
+    key->k0 = load64(digest);
+    key->k1 = load64(digest + 8);
+    OPENSSL_cleanse(digest, sizeof(digest));
+    return true;
+}
+
+void auth_sign(const AuthKey* key, uint64_t seq, const void* data, size_t size,
+               uint8_t tag[AUTH_TAG_SIZE]) {
+    AuthFrame frame = {data, size};
+    uint64_t v0 = key->k0 ^ 0x736f6d6570736575ull;
+    uint64_t v1 = key->k1 ^ 0x646f72616e646f6dull ^ 0xee;
+    uint64_t v2 = key->k0 ^ 0x6c7967656e657261ull;
+    uint64_t v3 = key->k1 ^ 0x7465646279746573ull;
+
+    size_t words = frame_words(&frame);
+    for (size_t w = 0; w < words; w++) {
+        uint64_t m = frame_word(&frame, seq, w);
+        v3 ^= m;
+        SIPROUND(v0, v1, v2, v3);
+        SIPROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    uint64_t b = frame_last(&frame);
+    v3 ^= b;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    v0 ^= b;
+
+    v2 ^= 0xee;
+    for (int r = 0; r < 4; r++) SIPROUND(v0, v1, v2, v3);
+    store64(tag, v0 ^ v1 ^ v2 ^ v3);
+    v1 ^= 0xdd;
+    for (int r = 0; r < 4; r++) SIPROUND(v0, v1, v2, v3);
+    store64(tag + 8, v0 ^ v1 ^ v2 ^ v3);
+}
+
+// A lone frame is cheaper without the lane setup
+void auth_sign_batch(const AuthKey* key, uint64_t first_seq, const AuthFrame* frames,
+                     size_t count, uint8_t (*tags)[AUTH_TAG_SIZE]) {
+    bool vector = LANES_SUPPORTED();
+    for (size_t i = 0; i < count; i += AUTH_LANES) {
+        size_t lanes = count - i < AUTH_LANES ? count - i : AUTH_LANES;
+        if (!vector) {
+            for (size_t l = 0; l < lanes; l++) {
+                auth_sign(key, first_seq + i + l, frames[i + l].data, frames[i + l].size,
+                          tags[i + l]);
+            }
+        } else if (lanes == 1) {
+            auth_sign(key, first_seq + i, frames[i].data, frames[i].size, tags[i]);
+        } else {
+            tag_lanes(key, first_seq + i, frames + i, lanes, tags + i);
+        }
+    }
+}
+
+size_t auth_verify_batch(const AuthKey* key, uint64_t first_seq, const AuthFrame* frames,
+                         size_t count, const uint8_t* const* tags) {
+    uint8_t expected[AUTH_LANES][AUTH_TAG_SIZE];
+
+    for (size_t i = 0; i < count; i += AUTH_LANES) {
+        size_t lanes = count - i < AUTH_LANES ? count - i : AUTH_LANES;
+        auth_sign_batch(key, first_seq + i, frames + i, lanes, expected);
+        for (size_t l = 0; l < lanes; l++) {
+            if (CRYPTO_memcmp(expected[l], tags[i + l], AUTH_TAG_SIZE) != 0) return i + l;
+        }
+    }
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef AUTH_H
+#define AUTH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Frame authentication. Tags are SipHash-2-4 with 128-bit output over an
+// implicit 64-bit sequence number followed by the frame bytes, so a
+// replayed, dropped or reordered frame fails to verify. Per-direction
+// keys come from HMAC-SHA256 over a shared secret and both handshakes.
+// Bursts are tagged several frames at a time in vector lanes.
+#define AUTH_KEY_SIZE 16
+#define AUTH_TAG_SIZE 16
+#define AUTH_NONCE_SIZE 16
+#define AUTH_MIN_SECRET 16
+#define AUTH_MAX_SECRET 64
+#define AUTH_LANES 4
+
+// Directional frame key
+typedef struct {
+    uint64_t k0;                 // Key words, little-endian
+    uint64_t k1;
+} AuthKey;
+
+// One frame of a batch
+typedef struct {
+    const uint8_t* data;         // Frame bytes
+    size_t size;                 // Frame size
+} AuthFrame;
+
+// Fill buffer from the system CSPRNG
+bool auth_random(void* buffer, size_t size);
+
+// Derive the key for frames travelling from the sender of sender_hello
+// to the sender of receiver_hello
+bool auth_derive_key(AuthKey* key, const uint8_t* secret, size_t secret_size,
+                     const uint8_t* sender_hello, size_t sender_size,
+                     const uint8_t* receiver_hello, size_t receiver_size);
+
+// Tag one frame with sequence number seq
+void auth_sign(const AuthKey* key, uint64_t seq, const void* data, size_t size,
+               uint8_t tag[AUTH_TAG_SIZE]);
+
+// Tag count frames numbered first_seq onwards
+void auth_sign_batch(const AuthKey* key, uint64_t first_seq, const AuthFrame* frames,
+                     size_t count, uint8_t (*tags)[AUTH_TAG_SIZE]);
+
+// Verify count frames numbered first_seq onwards against the tags at
+// tags[i], in constant time per tag. Returns how many leading frames
+// verified.
+size_t auth_verify_batch(const AuthKey* key, uint64_t first_seq, const AuthFrame* frames,
+                         size_t count, const uint8_t* const* tags);
+
+#endif // AUTH_H
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include <string.h>
+#include "compress.h"
+
+#define MIN_MATCH 4
+#define LAST_LITERALS 5     // Block ends with at least this many literals
+#define MATCH_START_LIMIT 12 // Last match starts at least this far from the end
+#define SKIP_TRIGGER 6      // Misses before the search starts stepping faster
+
+static uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t hash32(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - COMPRESS_HASH_LOG);
+}
+
+// Append LZ4 length continuation bytes
+static uint8_t* put_length(uint8_t* op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+// Read LZ4 length continuation bytes. Returns false on truncated input.
+static bool get_length(const uint8_t** ip, const uint8_t* end, size_t* length) {
+    uint8_t byte;
+    do {
+        if (*ip >= end) return false;
+        byte = *(*ip)++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// Emit one sequence: literals, then a match unless offset is 0.
+// Returns NULL if dst would overflow.
+static uint8_t* put_sequence(uint8_t* op, const uint8_t* op_end, const uint8_t* literals,
+                             size_t literal_len, uint32_t offset, size_t match_len) {
+    size_t need = 1 + literal_len / 255 + 1 + literal_len + 2 + match_len / 255 + 1;
+    if (need > (size_t)(op_end - op)) return NULL;
+
+    uint8_t* token = op++;
+    *token = (uint8_t)((literal_len >= 15 ? 15 : literal_len) << 4);
+    if (literal_len >= 15) op = put_length(op, literal_len - 15);
+    memcpy(op, literals, literal_len);
+    op += literal_len;
+
+    if (offset == 0) return op;
+
+    *op++ = (uint8_t)offset;
+    *op++ = (uint8_t)(offset >> 8);
+    size_t extra = match_len - MIN_MATCH;
+    *token |= (uint8_t)(extra >= 15 ? 15 : extra);
+    if (extra >= 15) op = put_length(op, extra - 15);
+    return op;
+}
+
+void compress_init(CompressContext* cc) {
+    if (!cc) return;
+    memset(cc, 0, sizeof(*cc));
+}
+
+// FNV-1a over the dictionary, so peers can check they share one
+uint32_t compress_dictionary_id(const void* dict, size_t size) {
+    if (!dict || size == 0) return 0;
+
+    const uint8_t* p = dict;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+// Prime the window with a dictionary, NULL to clear. Only its last
+// COMPRESS_MAX_DICTIONARY bytes are reachable; the caller keeps it alive.
+void compress_set_dictionary(CompressContext* cc, const void* dict, size_t size) {
+    if (!cc) return;
+
+    memset(cc->dict_table, 0, sizeof(cc->dict_table));
+    cc->dict_id = compress_dictionary_id(dict, size);
+    if (!dict || size < MIN_MATCH) {
+        cc->dict = NULL;
+        cc->dict_size = 0;
+        return;
+    }
+
+    const uint8_t* p = dict;
+    if (size > COMPRESS_MAX_DICTIONARY) {
+        p += size - COMPRESS_MAX_DICTIONARY;
+        size = COMPRESS_MAX_DICTIONARY;
+    }
+    cc->dict = p;
+    cc->dict_size = size;
+    for (size_t i = 0; i + MIN_MATCH <= size; i++) {
+        cc->dict_table[hash32(read32(p + i))] = (uint32_t)i + 1;
+    }
+}
+
+// Positions are offsets into the dictionary followed by the block, so one
+// table covers both; a candidate is verified against the bytes it names
+size_t compress_block(CompressContext* cc, const void* src, size_t size,
+                      void* dst, size_t capacity) {
+    if (!cc || !src || !dst) return 0;
+
+    const uint8_t* in = src;
+    const uint8_t* ip = in;
+    const uint8_t* anchor = in;
+    const uint8_t* in_end = in + size;
+    uint8_t* op = dst;
+    const uint8_t* op_end = op + capacity;
+    uint32_t base = (uint32_t)cc->dict_size;
+
+    if (cc->dict_size) {
+        memcpy(cc->table, cc->dict_table, sizeof(cc->table));
+    } else {
+        memset(cc->table, 0, sizeof(cc->table));
+    }
+
+    if (size >= MATCH_START_LIMIT + 1) {
+        const uint8_t* match_limit = in_end - LAST_LITERALS;
+        const uint8_t* search_end = in_end - MATCH_START_LIMIT;
+        uint32_t misses = 0;
+
+        while (ip <= search_end) {
+            uint32_t sequence = read32(ip);
+            uint32_t h = hash32(sequence);
+            uint32_t pos = base + (uint32_t)(ip - in);
+            uint32_t entry = cc->table[h];
+            cc->table[h] = pos + 1;
+
+            const uint8_t* ref = NULL;
+            uint32_t ref_pos = entry - 1;
+            size_t max_len = (size_t)(match_limit - ip);
+            if (entry != 0 && pos - ref_pos <= COMPRESS_WINDOW) {
+                if (ref_pos >= base) {
+                    ref = in + (ref_pos - base);
+                } else {
+                    // Matches stop at the dictionary end
+                    ref = cc->dict + ref_pos;
+                    if (cc->dict_size - ref_pos < max_len) max_len = cc->dict_size - ref_pos;
+                }
+                if (read32(ref) != sequence) ref = NULL;
+            }
+
+            if (!ref) {
+                ip += 1 + (misses++ >> SKIP_TRIGGER);
+                continue;
+            }
+            misses = 0;
+
+            size_t len = MIN_MATCH;
+            while (len < max_len && ref[len] == ip[len]) len++;
+
+            op = put_sequence(op, op_end, anchor, (size_t)(ip - anchor), pos - ref_pos, len);
+            if (!op) return 0;
+
+            ip += len;
+            anchor = ip;
+
+            // Index a position inside the match for the next search
+            if (ip - 2 >= in && ip <= search_end) {
+                cc->table[hash32(read32(ip - 2))] = base + (uint32_t)(ip - 2 - in) + 1;
+            }
+        }
+    }
+
+    op = put_sequence(op, op_end, anchor, (size_t)(in_end - anchor), 0, 0);
+    if (!op) return 0;
+    return (size_t)(op - (uint8_t*)dst);
+}
+
+// Matches reaching back past the output continue into the dictionary's tail
+bool decompress_block(const void* src, size_t size, void* dst, size_t capacity,
+                      size_t* out_size, const void* dict, size_t dict_size) {
+    if (!src || !dst || !out_size) return false;
+
+    const uint8_t* ip = src;
+    const uint8_t* in_end = ip + size;
+    uint8_t* out = dst;
+    uint8_t* op = out;
+    const uint8_t* op_end = out + capacity;
+    const uint8_t* dict_bytes = dict;
+    if (!dict_bytes) dict_size = 0;
+
+    while (ip < in_end) {
+        uint8_t token = *ip++;
+
+        size_t literal_len = token >> 4;
+        if (literal_len == 15 && !get_length(&ip, in_end, &literal_len)) return false;
+        if (literal_len > (size_t)(in_end - ip) || literal_len > (size_t)(op_end - op)) {
+            return false;
+        }
+        memcpy(op, ip, literal_len);
+        op += literal_len;
+        ip += literal_len;
+
+        // Last sequence carries literals only
+        if (ip == in_end) break;
+
+        if (in_end - ip < 2) return false;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0) return false;
+
+        size_t match_len = token & 15;
+        if (match_len == 15 && !get_length(&ip, in_end, &match_len)) return false;
+        match_len += MIN_MATCH;
+        if (match_len > (size_t)(op_end - op)) return false;
+
+        size_t produced = (size_t)(op - out);
+        const uint8_t* ref;
+        if (offset > produced) {
+            size_t back = offset - produced;
+            if (back > dict_size) return false;
+
+            size_t from_dict = back < match_len ? back : match_len;
+            memcpy(op, dict_bytes + dict_size - back, from_dict);
+            op += from_dict;
+            match_len -= from_dict;
+            ref = out;
+        } else {
+            ref = op - offset;
+        }
+
+        // Overlapping matches repeat the last offset bytes
+        if ((size_t)(op - ref) >= match_len) {
+            memcpy(op, ref, match_len);
+            op += match_len;
+        } else {
+            while (match_len--) *op++ = *ref++;
+        }
+    }
+
+    *out_size = (size_t)(op - out);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Block compression in the LZ4 block format: greedy single-probe hash
+// matching, 64 KiB window. A dictionary primes the window so short
+// blocks full of recurring ID strings find matches from the first byte;
+// both sides must use the same dictionary.
+#define COMPRESS_HASH_LOG 12
+#define COMPRESS_HASH_SIZE (1 << COMPRESS_HASH_LOG)
+#define COMPRESS_WINDOW 65535
+#define COMPRESS_MAX_DICTIONARY (64 * 1024)
+
+// Reusable compressor state
+typedef struct {
+    uint32_t table[COMPRESS_HASH_SIZE];      // Last position + 1 per hash, 0 if empty
+    uint32_t dict_table[COMPRESS_HASH_SIZE]; // Table after hashing the dictionary
+    const uint8_t* dict;                     // Dictionary tail in use, not owned
+    size_t dict_size;                        // Dictionary bytes in use
+    uint32_t dict_id;                        // Dictionary checksum, 0 for none
+} CompressContext;
+
+// Worst-case compressed size of size input bytes
+#define COMPRESS_BOUND(size) ((size) + (size) / 255 + 16)
+
+void compress_init(CompressContext* cc);
+void compress_set_dictionary(CompressContext* cc, const void* dict, size_t size);
+uint32_t compress_dictionary_id(const void* dict, size_t size);
+
+// Compress src into dst. Returns compressed size, 0 if dst is too small.
+size_t compress_block(CompressContext* cc, const void* src, size_t size,
+                      void* dst, size_t capacity);
+
+// Decompress src into dst against an optional dictionary. Returns false
+// on malformed input or if the output exceeds capacity.
+bool decompress_block(const void* src, size_t size, void* dst, size_t capacity,
+                      size_t* out_size, const void* dict, size_t dict_size);
+
+#endif // COMPRESS_H
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "datagram.h"
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+
+// Open a non-blocking UDP socket on port
+int datagram_open(uint16_t port, uint16_t* bound) {
+    int sock = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock == -1) return -1;
+
+    // Bursts from many peers queue in the kernel until the next poll
+    int yes = 1;
+    int rcvbuf = DATAGRAM_RCVBUF;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    socklen_t addr_len = sizeof(addr);
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) == -1 ||
+        getsockname(sock, (struct sockaddr*)&addr, &addr_len) == -1) {
+        close(sock);
+        return -1;
+    }
+
+    if (bound) *bound = ntohs(addr.sin_port);
+    return sock;
+}
+
+void datagram_close(int sock) {
+    if (sock >= 0) close(sock);
+}
+
+// Send count datagrams, DATAGRAM_BATCH per system call
+size_t datagram_send(int sock, const DatagramOut* out, size_t count) {
+    struct mmsghdr msgs[DATAGRAM_BATCH];
+    struct iovec iov[DATAGRAM_BATCH][2];
+    struct sockaddr_in addrs[DATAGRAM_BATCH];
+    size_t sent = 0;
+
+    while (sent < count) {
+        size_t batch = count - sent < DATAGRAM_BATCH ? count - sent : DATAGRAM_BATCH;
+        for (size_t i = 0; i < batch; i++) {
+            const DatagramOut* d = &out[sent + i];
+            memset(&addrs[i], 0, sizeof(addrs[i]));
+            addrs[i].sin_family = AF_INET;
+            addrs[i].sin_addr.s_addr = d->addr;
+            addrs[i].sin_port = d->port;
+
+            iov[i][0].iov_base = (void*)d->frame;
+            iov[i][0].iov_len = d->frame_size;
+            iov[i][1].iov_base = (void*)d->trailer;
+            iov[i][1].iov_len = d->trailer ? d->trailer_size : 0;
+
+            memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            msgs[i].msg_hdr.msg_iov = iov[i];
+            msgs[i].msg_hdr.msg_iovlen = d->trailer ? 2 : 1;
+        }
+
+        int n = sendmmsg(sock, msgs, (unsigned int)batch, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+
+        sent += (size_t)n;
+        if ((size_t)n < batch) break;
+    }
+    return sent;
+}
+
+// Receive up to DATAGRAM_BATCH waiting datagrams
+size_t datagram_receive(int sock, DatagramBatch* batch) {
+    struct mmsghdr msgs[DATAGRAM_BATCH];
+    struct iovec iov[DATAGRAM_BATCH];
+    struct sockaddr_in addrs[DATAGRAM_BATCH];
+
+    memset(msgs, 0, sizeof(msgs));
+    for (size_t i = 0; i < DATAGRAM_BATCH; i++) {
+        iov[i].iov_base = batch->data[i];
+        iov[i].iov_len = DATAGRAM_MAX_SIZE;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int n;
+    do {
+        n = recvmmsg(sock, msgs, DATAGRAM_BATCH, MSG_DONTWAIT, NULL);
+    } while (n < 0 && errno == EINTR);
+
+    batch->count = n > 0 ? (size_t)n : 0;
+    for (size_t i = 0; i < batch->count; i++) {
+        bool truncated = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+        batch->size[i] = truncated ? 0 : msgs[i].msg_len;
+        batch->addr[i] = addrs[i].sin_addr.s_addr;
+        batch->port[i] = addrs[i].sin_port;
+    }
+    return batch->count;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef DATAGRAM_H
+#define DATAGRAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Batched UDP I/O for the unreliable channel. Each datagram is one wire
+// frame plus an optional per-destination trailer, and whole batches move
+// with one sendmmsg or recvmmsg call. Datagrams stay under a typical
+// path MTU so they are never fragmented.
+#define DATAGRAM_MAX_SIZE 1400
+#define DATAGRAM_BATCH 32
+#define DATAGRAM_RCVBUF (1024 * 1024)
+
+// Datagram to send: frame bytes shared by a batch, then a trailer
+typedef struct {
+    uint32_t addr;                // IPv4 address, network byte order
+    uint16_t port;                // Port, network byte order
+    const void* frame;            // Frame bytes
+    size_t frame_size;
+    const void* trailer;          // Per-destination bytes, NULL for none
+    size_t trailer_size;
+} DatagramOut;
+
+// Datagrams received by one call
+typedef struct {
+    uint8_t data[DATAGRAM_BATCH][DATAGRAM_MAX_SIZE];
+    size_t size[DATAGRAM_BATCH];  // Bytes received, 0 if truncated
+    uint32_t addr[DATAGRAM_BATCH];// Sender address, network byte order
+    uint16_t port[DATAGRAM_BATCH];// Sender port, network byte order
+    size_t count;                 // Valid entries
+} DatagramBatch;
+
+// Open a non-blocking UDP socket on port, 0 for any. Returns -1 on
+// failure; *bound receives the port actually bound, host byte order.
+int datagram_open(uint16_t port, uint16_t* bound);
+void datagram_close(int sock);
+
+// Send count datagrams, DATAGRAM_BATCH per system call. Returns how many
+// the kernel took; the rest are dropped, as a full socket buffer would.
+size_t datagram_send(int sock, const DatagramOut* out, size_t count);
+
+// Receive up to DATAGRAM_BATCH waiting datagrams into batch. Returns the
+// number received, 0 if none were waiting.
+size_t datagram_receive(int sock, DatagramBatch* batch);
+
+#endif // DATAGRAM_H
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gossip.h"
+
+#define MAX_CANDIDATES 1024
+
+static void put_u32le(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t get_u32le(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_u64le(uint8_t* p, uint64_t value) {
+    put_u32le(p, (uint32_t)value);
+    put_u32le(p + 4, (uint32_t)(value >> 32));
+}
+
+static uint64_t get_u64le(const uint8_t* p) {
+    return (uint64_t)get_u32le(p) | ((uint64_t)get_u32le(p + 4) << 32);
+}
+
+static uint64_t xorshift64(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+// Only tree events and routing adverts are gossiped
+static bool is_event_type(NetworkMessageType type) {
+    return type == NET_MSG_NODE_CREATED || type == NET_MSG_NODE_DELETED ||
+           type == NET_MSG_NODE_UPDATED || type == NET_MSG_ROUTE_UPDATE;
+}
+
+// Identity of an event: FNV-1a of the origin, mixed with its sequence
+static uint64_t event_digest(const char* origin, uint64_t seq) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (const char* p = origin; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 0x100000001b3ull;
+    }
+    h ^= seq * 0x9e3779b97f4a7c15ull;
+    h ^= h >> 31;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 29;
+    return h ? h : 1;
+}
+
+// Record an event, returning true if it was already seen. Evicted events
+// could be relayed again, but their hop count still runs out. Caller
+// holds lock.
+static bool seen_insert(GossipContext* gossip, uint64_t digest) {
+    uint64_t* set = gossip->seen[digest % GOSSIP_SEEN_SETS];
+    if (set[0] == digest || set[1] == digest) return true;
+
+    set[1] = set[0];
+    set[0] = digest;
+    return false;
+}
+
+// Send msg to up to fanout random handshaken peers other than exclude.
+// With no more candidates than the fanout, every one is sent a copy.
+static uint32_t spread(GossipContext* gossip, NetworkMessage* msg, NetworkHandle exclude,
+                       uint32_t fanout, uint64_t seed) {
+    NetworkHandle candidates[MAX_CANDIDATES];
+    size_t count = network_get_handles(gossip->network, candidates, MAX_CANDIDATES);
+
+    for (size_t i = 0; i < count; i++) {
+        if (candidates[i] == exclude) {
+            candidates[i] = candidates[--count];
+            break;
+        }
+    }
+
+    // Partial Fisher-Yates: the first picks are a uniform sample
+    uint32_t sent = 0;
+    for (size_t i = 0; i < count && sent < fanout; i++) {
+        size_t j = i + (size_t)(xorshift64(&seed) % (count - i));
+        NetworkHandle handle = candidates[j];
+        candidates[j] = candidates[i];
+        if (network_send_reliable(gossip->network, handle, msg)) {
+            sent++;
+        }
+    }
+    return sent;
+}
+
+// Create gossip state publishing as node_id
+GossipContext* gossip_create(NetworkContext* network, const char* node_id) {
+    if (!network || !node_id || !node_id[0] || strlen(node_id) >= 64) return NULL;
+
+    GossipContext* gossip = calloc(1, sizeof(GossipContext));
+    if (!gossip) return NULL;
+
+    gossip->network = network;
+    strcpy(gossip->node_id, node_id);
+    gossip->fanout = GOSSIP_DEFAULT_FANOUT;
+    gossip->max_hops = GOSSIP_DEFAULT_MAX_HOPS;
+
+    // A random start keeps a restarted node's events apart from the
+    // ones peers still remember
+    if (!auth_random(&gossip->next_seq, sizeof(gossip->next_seq))) {
+        gossip->next_seq = (uint64_t)time(NULL) << 32;
+    }
+    gossip->rng = event_digest(node_id, gossip->next_seq);
+
+    if (pthread_mutex_init(&gossip->lock, NULL) != 0) {
+        free(gossip);
+        return NULL;
+    }
+    return gossip;
+}
+
+void gossip_destroy(GossipContext* gossip) {
+    if (!gossip) return;
+
+    pthread_mutex_destroy(&gossip->lock);
+    free(gossip);
+}
+
+// Set peers per relay and the hop limit, 0 keeps each current value
+void gossip_set_fanout(GossipContext* gossip, uint32_t fanout, uint32_t max_hops) {
+    if (!gossip) return;
+
+    pthread_mutex_lock(&gossip->lock);
+    if (fanout) gossip->fanout = fanout;
+    if (max_hops) gossip->max_hops = max_hops < 255 ? max_hops : 255;
+    pthread_mutex_unlock(&gossip->lock);
+}
+
+void gossip_set_handler(GossipContext* gossip, GossipHandler handler, void* user_data) {
+    if (!gossip) return;
+
+    pthread_mutex_lock(&gossip->lock);
+    gossip->handler = handler;
+    gossip->user_data = user_data;
+    pthread_mutex_unlock(&gossip->lock);
+}
+
+// Publish an event. The local handler is not called for own events.
+bool gossip_publish(GossipContext* gossip, NetworkMessageType type, const void* data, uint32_t size) {
+    if (!gossip || !is_event_type(type) || (size && !data) || size > GOSSIP_MAX_DATA) {
+        return false;
+    }
+
+    NetworkMessage* msg = malloc(sizeof(NetworkMessage) + GOSSIP_HEADER_SIZE + size);
+    if (!msg) return false;
+
+    pthread_mutex_lock(&gossip->lock);
+    uint64_t seq = gossip->next_seq++;
+    uint64_t seed = xorshift64(&gossip->rng);
+    uint32_t fanout = gossip->fanout;
+    seen_insert(gossip, event_digest(gossip->node_id, seq));
+    gossip->stats.published++;
+    pthread_mutex_unlock(&gossip->lock);
+
+    memset(msg, 0, sizeof(NetworkMessage));
+    msg->type = type;
+    strcpy(msg->source_id, gossip->node_id);
+    msg->data_size = GOSSIP_HEADER_SIZE + size;
+    put_u32le(msg->data, GOSSIP_MAGIC);
+    put_u64le(msg->data + 4, seq);
+    memset(msg->data + 12, 0, 4);
+    if (size) {
+        memcpy(msg->data + GOSSIP_HEADER_SIZE, data, size);
+    }
+
+    uint32_t sent = spread(gossip, msg, NETWORK_INVALID_HANDLE, fanout, seed);
+    free(msg);
+
+    pthread_mutex_lock(&gossip->lock);
+    gossip->stats.relayed += sent;
+    pthread_mutex_unlock(&gossip->lock);
+    return true;
+}
+
+// Deliver a first-seen event and relay it with the hop count raised in
+// place. Runs on the network poll thread.
+bool gossip_receive(GossipContext* gossip, NetworkMessage* msg) {
+    if (!gossip || !msg || !is_event_type(msg->type) || msg->target_id[0] ||
+        msg->data_size < GOSSIP_HEADER_SIZE || get_u32le(msg->data) != GOSSIP_MAGIC) {
+        return false;
+    }
+
+    uint64_t seq = get_u64le(msg->data + 4);
+    uint8_t hops = msg->data[12];
+
+    pthread_mutex_lock(&gossip->lock);
+    gossip->stats.received++;
+    bool duplicate = seen_insert(gossip, event_digest(msg->source_id, seq));
+    if (duplicate) {
+        gossip->stats.duplicates++;
+        pthread_mutex_unlock(&gossip->lock);
+        return true;
+    }
+    gossip->stats.delivered++;
+    GossipHandler handler = gossip->handler;
+    void* user_data = gossip->user_data;
+    uint64_t seed = xorshift64(&gossip->rng);
+    uint32_t fanout = gossip->fanout;
+    bool relay = (uint32_t)hops + 1 < gossip->max_hops;
+    pthread_mutex_unlock(&gossip->lock);
+
+    if (handler) {
+        GossipEvent event = {
+            .type = msg->type,
+            .origin = msg->source_id,
+            .seq = seq,
+            .hops = hops,
+            .data = msg->data + GOSSIP_HEADER_SIZE,
+            .size = msg->data_size - GOSSIP_HEADER_SIZE
+        };
+        handler(gossip, &event, user_data);
+    }
+
+    if (relay) {
+        msg->data[12] = (uint8_t)(hops + 1);
+        uint32_t sent = spread(gossip, msg, msg->connection, fanout, seed);
+
+        pthread_mutex_lock(&gossip->lock);
+        gossip->stats.relayed += sent;
+        pthread_mutex_unlock(&gossip->lock);
+    }
+    return true;
+}
+
+void gossip_get_stats(GossipContext* gossip, GossipStats* stats) {
+    if (!gossip || !stats) return;
+
+    pthread_mutex_lock(&gossip->lock);
+    *stats = gossip->stats;
+    pthread_mutex_unlock(&gossip->lock);
+}
\ No newline at end of file
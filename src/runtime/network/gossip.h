@@ -0,0 +1,85 @@
+#ifndef GOSSIP_H
+#define GOSSIP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "network.h"
+
+// Epidemic dissemination of tree events and routing adverts. Each node relays an event the
+// first time it sees it to at most fanout random handshaken peers other
+// than the one it came from, so an event reaches a connected cluster in
+// O(log N) relay rounds with each node sending at most fanout copies.
+// Nodes with no more peers than the fanout relay to all of them; in
+// larger neighbourhoods full coverage is probabilistic and likely once
+// the fanout exceeds ln N.
+//
+// Events travel as ordinary data frames of their own NetworkMessageType
+// with the origin node as source and an empty target; the payload
+// starts with a GOSSIP_HEADER_SIZE header: u32 LE magic, u64 LE origin
+// sequence number, u8 hop count, three reserved bytes. Relays are sent reliably
+// to peers that negotiate it, so a lost frame is resent rather than
+// leaving its side of the fanout uncovered.
+#define GOSSIP_MAGIC 0x31534750u        // "PGS1"
+#define GOSSIP_HEADER_SIZE 16
+#define GOSSIP_DEFAULT_FANOUT 4
+#define GOSSIP_DEFAULT_MAX_HOPS 16
+#define GOSSIP_SEEN_SETS 4096           // Two recent events per set
+#define GOSSIP_MAX_DATA (NETWORK_MAX_FRAME_SIZE - GOSSIP_HEADER_SIZE - NETWORK_RELIABLE_SIZE - 128)
+
+typedef struct GossipContext GossipContext;
+
+// Event delivered once per node
+typedef struct {
+    NetworkMessageType type;     // Event type
+    const char* origin;          // Node that published it
+    uint64_t seq;                // Origin's event number
+    uint8_t hops;                // Relays before reaching this node
+    const uint8_t* data;         // Event payload
+    uint32_t size;               // Payload size
+} GossipEvent;
+
+typedef void (*GossipHandler)(GossipContext* gossip, const GossipEvent* event, void* user_data);
+
+// Gossip statistics
+typedef struct {
+    uint64_t published;          // Events originated here
+    uint64_t received;           // Event frames received
+    uint64_t duplicates;         // Of which already seen
+    uint64_t delivered;          // Events passed to the handler
+    uint64_t relayed;            // Event frames sent, own and relayed
+} GossipStats;
+
+struct GossipContext {
+    NetworkContext* network;     // Transport for events
+    char node_id[64];            // Origin ID of events published here
+    uint32_t fanout;             // Peers each event is relayed to
+    uint32_t max_hops;           // Events this far from origin stop
+    uint64_t next_seq;           // Sequence number of the next event
+    uint64_t rng;                // Peer selection state
+    uint64_t seen[GOSSIP_SEEN_SETS][2]; // Event digests, newest first
+    GossipHandler handler;       // Delivery callback
+    void* user_data;             // Handler argument
+    GossipStats stats;           // Statistics
+    pthread_mutex_t lock;        // Guards everything above
+};
+
+// Lifecycle
+GossipContext* gossip_create(NetworkContext* network, const char* node_id);
+void gossip_destroy(GossipContext* gossip);
+
+// Configuration
+void gossip_set_fanout(GossipContext* gossip, uint32_t fanout, uint32_t max_hops);
+void gossip_set_handler(GossipContext* gossip, GossipHandler handler, void* user_data);
+
+// Originate an event and spread it to the cluster
+bool gossip_publish(GossipContext* gossip, NetworkMessageType type, const void* data, uint32_t size);
+
+// Feed a received network message. Returns true if it was an event,
+// which is delivered and relayed, false if it is for the caller.
+bool gossip_receive(GossipContext* gossip, NetworkMessage* msg);
+
+void gossip_get_stats(GossipContext* gossip, GossipStats* stats);
+
+#endif // GOSSIP_H
\ No newline at end of file
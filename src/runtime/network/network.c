@@ -1,10 +1,12 @@
 #include "network.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <pthread.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <time.h>
 
 #ifdef _WIN32
     #include <winsock2.h>
@@ -16,7 +18,11 @@
     typedef SOCKET socket_t;
 #else
     #include <unistd.h>
+    #include <poll.h>
+    #include <sys/epoll.h>
     #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <sys/un.h>
     #include <netinet/in.h>
     #include <arpa/inet.h>
     #define CLOSE_SOCKET close
@@ -25,257 +31,3051 @@
     typedef int socket_t;
 #endif
 
-#define MAX_BACKLOG 10
+#define DEFAULT_BACKLOG 1024
+#define ACCEPT_BATCH_MAX 256
+#define ACCEPT_RATE_WINDOW_MS 1000
+#define MAX_CONNECTIONS 1024
 #define BUFFER_SIZE 4096
+#define OUT_QUEUE_DEPTH 256
+#define IOV_BATCH 64
+#define DEFAULT_IO_THREADS 2
+#define OUT_CONTROL_RESERVE 16
+#define DEFAULT_CONN_OUTBOUND (4 * 1024 * 1024)
+#define DEFAULT_MAX_OUTBOUND (256 * 1024 * 1024)
+#define TIMER_TICK_MS 10
+#define DEFAULT_IDLE_TIMEOUT_MS 30000
+#define DEFAULT_HEARTBEAT_MS 10000
+#define DEFAULT_HANDSHAKE_TIMEOUT_MS 5000
+#define DEFAULT_RECONNECT_MIN_MS 100
+#define DEFAULT_RECONNECT_MAX_MS 30000
+#define AUTH_BATCH 32
+#define RX_FRAME_MAX (NETWORK_FRAME_HEADER_SIZE + NETWORK_MAX_FRAME_SIZE + AUTH_TAG_SIZE)
+#define DATAGRAM_TRAILER_SIZE (8 + AUTH_TAG_SIZE)
+#define DATAGRAM_SEQ_BIT (1ull << 63)
+#define DATAGRAM_POLL_BATCHES 8
+#define RELIABLE_ACK_SIZE 12
+#define RELIABLE_ACK_EVERY 16
+#define RELIABLE_ACK_DELAY_MS 20
 
-// Helper to set socket non-blocking
-static bool set_nonblocking(socket_t sock) {
-#ifdef _WIN32
-    unsigned long mode = 1;
-    return ioctlsocket(sock, FIONBIO, &mode) == 0;
-#else
-    int flags = fcntl(sock, F_GETFL, 0);
-    if (flags == -1) return false;
-    return fcntl(sock, F_SETFL, flags | O_NONBLOCK) != -1;
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
 #endif
+
+#define NODE_INDEX_EMPTY -1
+#define NODE_INDEX_TOMBSTONE -2
+
+// Monotonic clock in milliseconds
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+// Hash len bytes of a node ID (FNV-1a), never returns 0
+static uint32_t hash_id(const char* id, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)id[i];
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+static uint32_t hash_node_id(const char* node_id) {
+    return hash_id(node_id, strlen(node_id));
+}
+
+// Initialize node index sized for the connection table
+static bool index_init(NetworkNodeIndex* index, size_t max_connections) {
+    size_t capacity = 16;
+    while (capacity < max_connections * 2) {
+        capacity <<= 1;
+    }
+
+    index->entries = malloc(capacity * sizeof(NetworkIndexEntry));
+    if (!index->entries) return false;
+
+    for (size_t i = 0; i < capacity; i++) {
+        index->entries[i].hash = 0;
+        index->entries[i].conn_index = NODE_INDEX_EMPTY;
+    }
+    index->capacity = capacity;
+    index->count = 0;
+    index->tombstones = 0;
+    return true;
+}
+
+// Find index slot holding node ID, or -1
+static int32_t index_lookup(NetworkContext* ctx, const char* node_id, uint32_t hash) {
+    NetworkNodeIndex* index = &ctx->node_index;
+    size_t mask = index->capacity - 1;
+
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        NetworkIndexEntry* entry = &index->entries[i];
+        if (entry->conn_index == NODE_INDEX_EMPTY) {
+            return -1;
+        }
+        if (entry->conn_index >= 0 && entry->hash == hash &&
+            strcmp(ctx->connections[entry->conn_index].node_id, node_id) == 0) {
+            return (int32_t)i;
+        }
+    }
+}
+
+// Insert connection into index, returns slot used
+static int32_t index_insert(NetworkContext* ctx, uint32_t hash, int32_t conn_index) {
+    NetworkNodeIndex* index = &ctx->node_index;
+    size_t mask = index->capacity - 1;
+
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        NetworkIndexEntry* entry = &index->entries[i];
+        if (entry->conn_index < 0) {
+            if (entry->conn_index == NODE_INDEX_TOMBSTONE) {
+                index->tombstones--;
+            }
+            entry->hash = hash;
+            entry->conn_index = conn_index;
+            index->count++;
+            return (int32_t)i;
+        }
+    }
+}
+
+// Rebuild index to clear tombstones
+static void index_rebuild(NetworkContext* ctx) {
+    NetworkNodeIndex* index = &ctx->node_index;
+
+    for (size_t i = 0; i < index->capacity; i++) {
+        index->entries[i].hash = 0;
+        index->entries[i].conn_index = NODE_INDEX_EMPTY;
+    }
+    index->count = 0;
+    index->tombstones = 0;
+
+    for (size_t i = 0; i < ctx->max_connections; i++) {
+        NetworkConnection* conn = &ctx->connections[i];
+        if (conn->index_slot >= 0) {
+            conn->index_slot = index_insert(ctx, hash_node_id(conn->node_id), (int32_t)i);
+        }
+    }
+}
+
+// Remove connection from index via its reverse slot
+static void index_remove(NetworkContext* ctx, NetworkConnection* conn) {
+    NetworkNodeIndex* index = &ctx->node_index;
+    if (conn->index_slot < 0) return;
+
+    index->entries[conn->index_slot].conn_index = NODE_INDEX_TOMBSTONE;
+    index->count--;
+    index->tombstones++;
+    conn->index_slot = -1;
+
+    // Keep probe chains short once deletions pile up
+    if (index->tombstones > index->capacity / 4) {
+        index_rebuild(ctx);
+    }
+}
+
+// Build free list covering every inactive slot
+static void slots_init(NetworkContext* ctx) {
+    ctx->free_head = -1;
+    for (size_t i = ctx->max_connections; i-- > 0;) {
+        if (!ctx->connections[i].is_active) {
+            ctx->connections[i].next_free = ctx->free_head;
+            ctx->free_head = (int32_t)i;
+        }
+    }
+}
+
+// Pop free connection slot, caller holds lock
+static NetworkConnection* slot_acquire(NetworkContext* ctx) {
+    if (ctx->free_head < 0) return NULL;
+
+    NetworkConnection* conn = &ctx->connections[ctx->free_head];
+    ctx->free_head = conn->next_free;
+    conn->next_free = -1;
+    return conn;
+}
+
+// Return slot to free list and invalidate outstanding handles, caller holds lock
+static void slot_release(NetworkContext* ctx, NetworkConnection* conn) {
+    // Generation 0 is reserved so a valid handle is never NETWORK_INVALID_HANDLE
+    if (++conn->generation == 0) {
+        conn->generation = 1;
+    }
+    conn->next_free = ctx->free_head;
+    ctx->free_head = (int32_t)(conn - ctx->connections);
+}
+
+// Little-endian helpers for the frame header
+static void put_u32le(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t get_u32le(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_u64le(uint8_t* p, uint64_t value) {
+    put_u32le(p, (uint32_t)value);
+    put_u32le(p + 4, (uint32_t)(value >> 32));
+}
+
+static uint64_t get_u64le(const uint8_t* p) {
+    return (uint64_t)get_u32le(p) | ((uint64_t)get_u32le(p + 4) << 32);
+}
+
+// Serialize a frame into a buffer holding one reference, with extra
+// zeroed bytes between the IDs and the payload
+static NetworkBuffer* encode_frame(const NetworkView* view, size_t extra) {
+    size_t length = (size_t)view->source_len + view->target_len + extra + view->data_size;
+    if (length > NETWORK_MAX_FRAME_SIZE) return NULL;
+
+    NetworkBuffer* buffer = malloc(sizeof(NetworkBuffer) + NETWORK_FRAME_HEADER_SIZE + length);
+    if (!buffer) return NULL;
+
+    buffer->refcount = 1;
+    buffer->size = (uint32_t)(NETWORK_FRAME_HEADER_SIZE + length);
+    buffer->key = 0;
+
+    uint8_t* p = buffer->data;
+    put_u32le(p, (uint32_t)length);
+    p[4] = (uint8_t)view->type;
+    p[5] = 0;
+    p[6] = view->source_len;
+    p[7] = view->target_len;
+    p += NETWORK_FRAME_HEADER_SIZE;
+
+    memcpy(p, view->source_id, view->source_len);
+    p += view->source_len;
+    memcpy(p, view->target_id, view->target_len);
+    p += view->target_len;
+    memset(p, 0, extra);
+    p += extra;
+    if (view->data_size > 0) {
+        memcpy(p, view->data, view->data_size);
+    }
+
+    // Same type between the same nodes coalesces under NET_SLOW_COALESCE
+    buffer->key = hash_id(view->source_id, view->source_len) ^
+                  (hash_id(view->target_id, view->target_len) * 31u) ^
+                  ((uint32_t)view->type * 0x9e3779b1u);
+    return buffer;
+}
+
+// View of an outgoing message, for encoding
+static void message_view(const NetworkMessage* msg, NetworkView* view) {
+    view->type = msg->type;
+    view->source_id = msg->source_id;
+    view->target_id = msg->target_id;
+    view->source_len = (uint8_t)strnlen(msg->source_id, sizeof(msg->source_id) - 1);
+    view->target_len = (uint8_t)strnlen(msg->target_id, sizeof(msg->target_id) - 1);
+    view->connection = msg->connection;
+    view->authenticated = msg->authenticated;
+    view->datagram = msg->datagram;
+    view->reliable = msg->reliable;
+    view->data_size = msg->data_size;
+    view->data = msg->data;
+}
+
+// Serialize message into a frame buffer holding one reference
+NetworkBuffer* network_buffer_encode(const NetworkMessage* msg) {
+    if (!msg) return NULL;
+
+    NetworkView view;
+    message_view(msg, &view);
+    return encode_frame(&view, 0);
+}
+
+// Copy a received frame into msg, NUL-terminating the IDs. The payload
+// is already in place when it was inflated into msg.
+void network_view_copy(const NetworkView* view, NetworkMessage* msg) {
+    msg->type = view->type;
+    memcpy(msg->source_id, view->source_id, view->source_len);
+    msg->source_id[view->source_len] = '\0';
+    memcpy(msg->target_id, view->target_id, view->target_len);
+    msg->target_id[view->target_len] = '\0';
+    msg->connection = view->connection;
+    msg->authenticated = view->authenticated;
+    msg->datagram = view->datagram;
+    msg->reliable = view->reliable;
+    msg->data_size = view->data_size;
+    if (view->data != msg->data && view->data_size > 0) {
+        memcpy(msg->data, view->data, view->data_size);
+    }
+}
+
+// Copy a received frame that must outlive its handler call
+NetworkMessage* network_view_retain(const NetworkView* view) {
+    if (!view) return NULL;
+
+    NetworkMessage* msg = malloc(sizeof(NetworkMessage) + view->data_size);
+    if (msg) {
+        network_view_copy(view, msg);
+    }
+    return msg;
+}
+
+// Take an additional reference
+void network_buffer_retain(NetworkBuffer* buffer) {
+    if (buffer) __sync_add_and_fetch(&buffer->refcount, 1);
+}
+
+// Drop a reference, freeing the frame with the last one
+void network_buffer_release(NetworkBuffer* buffer) {
+    if (buffer && __sync_sub_and_fetch(&buffer->refcount, 1) == 0) {
+        free(buffer);
+    }
+}
+
+// Encode control frame with optional payload
+static NetworkBuffer* encode_control(NetworkControlType type, const void* payload, uint32_t size) {
+    NetworkBuffer* buffer = malloc(sizeof(NetworkBuffer) + NETWORK_FRAME_HEADER_SIZE + size);
+    if (!buffer) return NULL;
+
+    buffer->refcount = 1;
+    buffer->size = NETWORK_FRAME_HEADER_SIZE + size;
+    buffer->key = 0;
+    put_u32le(buffer->data, size);
+    buffer->data[4] = (uint8_t)type;
+    buffer->data[5] = NET_FRAME_FLAG_CONTROL;
+    buffer->data[6] = 0;
+    buffer->data[7] = 0;
+    if (size > 0) {
+        memcpy(buffer->data + NETWORK_FRAME_HEADER_SIZE, payload, size);
+    }
+    return buffer;
+}
+
+// Decode frame header
+static void decode_frame_header(const uint8_t* p, NetworkFrameHeader* header) {
+    header->length = get_u32le(p);
+    header->type = p[4];
+    header->flags = p[5];
+    header->source_len = p[6];
+    header->target_len = p[7];
+}
+
+// I/O shard owning a connection
+static NetworkIOThread* conn_shard(NetworkContext* ctx, const NetworkConnection* conn) {
+    size_t shards = ctx->io_thread_count ? ctx->io_thread_count : 1;
+    return &ctx->io_threads[(size_t)(conn - ctx->connections) % shards];
+}
+
+// Wake I/O thread
+static void io_wake(NetworkIOThread* io) {
+    if (!io->started) return;
+
+    char byte = 1;
+    ssize_t ignored = write(io->wake_fds[1], &byte, 1);
+    (void)ignored;
+}
+
+// Frame at ring position i, 0 being the oldest
+static NetworkBuffer** out_at(NetworkConnection* conn, uint32_t i) {
+    return &conn->out_ring[(conn->out_head + i) % OUT_QUEUE_DEPTH];
+}
+
+// Control frames bypass credit and slow-consumer policy
+static bool is_control_frame(const NetworkBuffer* buffer) {
+    return (buffer->data[5] & NET_FRAME_FLAG_CONTROL) != 0;
+}
+
+// Reliable frames each carry their own sequence number and never coalesce
+static bool is_reliable_frame(const NetworkBuffer* buffer) {
+    return (buffer->data[5] & NET_FRAME_FLAG_RELIABLE) != 0;
+}
+
+// HELLO frames are never tagged, they carry the key material
+static bool is_hello_frame(const NetworkBuffer* buffer) {
+    return is_control_frame(buffer) && buffer->data[4] == NET_CONTROL_HELLO;
+}
+
+// Whether frame goes out followed by a tag
+static bool is_tagged(const NetworkConnection* conn, const NetworkBuffer* buffer) {
+    return conn->auth && !is_hello_frame(buffer);
+}
+
+// Bytes frame occupies on the wire
+static size_t wire_size(const NetworkConnection* conn, const NetworkBuffer* buffer) {
+    return buffer->size + (is_tagged(conn, buffer) ? AUTH_TAG_SIZE : 0);
+}
+
+// Account queued bytes on connection and context
+static void out_account(NetworkIOThread* io, NetworkConnection* conn, int64_t delta) {
+    conn->out_bytes = (size_t)((int64_t)conn->out_bytes + delta);
+    __sync_add_and_fetch(&io->ctx->outbound_bytes, delta);
+}
+
+// Drop every queued frame, caller holds shard lock
+static void out_clear(NetworkIOThread* io, NetworkConnection* conn) {
+    while (conn->out_count > 0) {
+        NetworkBuffer* buffer = *out_at(conn, 0);
+        out_account(io, conn, -(int64_t)buffer->size);
+        network_buffer_release(buffer);
+        conn->out_head = (conn->out_head + 1) % OUT_QUEUE_DEPTH;
+        conn->out_count--;
+    }
+    conn->out_head = 0;
+    conn->out_offset = 0;
+    conn->out_sealed = 0;
+    conn->out_state = NET_OUT_IDLE;
+}
+
+// Remove unsent frame at ring position i (never the head being written)
+static void out_remove(NetworkIOThread* io, NetworkConnection* conn, uint32_t i) {
+    NetworkBuffer* buffer = *out_at(conn, i);
+    out_account(io, conn, -(int64_t)buffer->size);
+    network_buffer_release(buffer);
+
+    for (; i + 1 < conn->out_count; i++) {
+        *out_at(conn, i) = *out_at(conn, i + 1);
+    }
+    conn->out_count--;
+}
+
+// First ring position not yet touched by the socket or given a sequence
+// number; frames before it keep their place
+static uint32_t out_first_unsent(const NetworkConnection* conn) {
+    uint32_t touched = conn->out_offset > 0 ? 1 : 0;
+    return conn->out_sealed > touched ? conn->out_sealed : touched;
+}
+
+// Whether buffer was written in full: it left the queue of a connection
+// that is still up, rather than being cleared with it
+static bool out_written(const NetworkConnection* conn, const NetworkBuffer* buffer) {
+    if (!conn->is_active || __atomic_load_n(&conn->close_pending, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < conn->out_count; i++) {
+        if (conn->out_ring[(conn->out_head + i) % OUT_QUEUE_DEPTH] == buffer) return false;
+    }
+    return true;
+}
+
+// Replace a queued, unsent frame carrying the same coalesce key
+static bool out_coalesce(NetworkIOThread* io, NetworkConnection* conn, NetworkBuffer* buffer) {
+    for (uint32_t i = conn->out_count; i-- > out_first_unsent(conn);) {
+        NetworkBuffer** slot = out_at(conn, i);
+        if ((*slot)->key != buffer->key || is_control_frame(*slot) || is_reliable_frame(*slot)) {
+            continue;
+        }
+        if (memcmp((*slot)->data + 4, buffer->data + 4, 4) != 0 ||
+            memcmp((*slot)->data + NETWORK_FRAME_HEADER_SIZE, buffer->data + NETWORK_FRAME_HEADER_SIZE,
+                   (size_t)buffer->data[6] + buffer->data[7]) != 0) {
+            continue;
+        }
+
+        out_account(io, conn, (int64_t)buffer->size - (int64_t)(*slot)->size);
+        network_buffer_release(*slot);
+        network_buffer_retain(buffer);
+        *slot = buffer;
+        return true;
+    }
+    return false;
+}
+
+// Evict oldest unsent data frames until size more bytes fit the budgets
+static bool out_make_room(NetworkIOThread* io, NetworkConnection* conn, size_t size) {
+    NetworkContext* ctx = io->ctx;
+    uint32_t i = out_first_unsent(conn);
+
+    while (conn->out_bytes + size > ctx->max_conn_outbound ||
+           (size_t)ctx->outbound_bytes + size > ctx->max_outbound ||
+           conn->out_count >= OUT_QUEUE_DEPTH - OUT_CONTROL_RESERVE) {
+        while (i < conn->out_count && is_control_frame(*out_at(conn, i))) i++;
+        if (i >= conn->out_count) return false;
+
+        out_remove(io, conn, i);
+        io->frames_evicted++;
+    }
+    return true;
+}
+
+// Mark connection dirty so its I/O thread flushes it.
+// Returns true if the thread needs waking.
+static bool out_mark_dirty(NetworkIOThread* io, NetworkConnection* conn) {
+    if (conn->out_state != NET_OUT_IDLE) return false;
+
+    conn->out_state = NET_OUT_PENDING;
+    if (!conn->out_listed) {
+        conn->out_listed = true;
+        io->dirty[io->dirty_count++] = (int32_t)(conn - io->ctx->connections);
+    }
+    return true;
+}
+
+// Queue frame reference on connection, applying budgets and the
+// slow-consumer policy, caller holds shard lock. Returns true if the
+// connection became dirty and its thread needs waking.
+static bool out_enqueue(NetworkIOThread* io, NetworkConnection* conn,
+                        NetworkBuffer* buffer, bool* queued) {
+    NetworkContext* ctx = io->ctx;
+    *queued = false;
+
+    if (!conn->out_ring) {
+        conn->out_ring = calloc(OUT_QUEUE_DEPTH, sizeof(NetworkBuffer*));
+        if (!conn->out_ring) return false;
+    }
+
+    // Never send the peer more than it accepts
+    if (buffer->size - NETWORK_FRAME_HEADER_SIZE > conn->max_frame) return false;
+
+    bool over_budget = conn->out_bytes + buffer->size > ctx->max_conn_outbound ||
+                       (size_t)ctx->outbound_bytes + buffer->size > ctx->max_outbound ||
+                       conn->out_count >= OUT_QUEUE_DEPTH - OUT_CONTROL_RESERVE;
+
+    if (over_budget) {
+        switch (ctx->slow_policy) {
+            case NET_SLOW_COALESCE:
+                if (!is_reliable_frame(buffer) && out_coalesce(io, conn, buffer)) {
+                    io->frames_coalesced++;
+                    *queued = true;
+                    return out_mark_dirty(io, conn);
+                }
+                if (!out_make_room(io, conn, buffer->size)) return false;
+                break;
+
+            case NET_SLOW_DROP_OLDEST:
+                if (!out_make_room(io, conn, buffer->size)) return false;
+                break;
+
+            case NET_SLOW_DISCONNECT:
+            default:
+                // Stop feeding a peer that cannot keep up
+                io->slow_disconnects++;
+                out_clear(io, conn);
+                __atomic_store_n(&conn->close_pending, true, __ATOMIC_RELEASE);
+                return false;
+        }
+    }
+
+    network_buffer_retain(buffer);
+    *out_at(conn, conn->out_count) = buffer;
+    conn->out_count++;
+    out_account(io, conn, buffer->size);
+    *queued = true;
+
+    return out_mark_dirty(io, conn);
+}
+
+// Queue control frame ahead of data, behind any partially written frame.
+// Control frames ignore budgets but use a reserved part of the ring.
+static bool out_enqueue_control(NetworkIOThread* io, NetworkConnection* conn,
+                                NetworkBuffer* buffer, bool* queued) {
+    *queued = false;
+    if (!conn->out_ring) {
+        conn->out_ring = calloc(OUT_QUEUE_DEPTH, sizeof(NetworkBuffer*));
+        if (!conn->out_ring) return false;
+    }
+    if (conn->out_count >= OUT_QUEUE_DEPTH) return false;
+
+    // Skip past control frames already queued so they stay in order
+    uint32_t position = out_first_unsent(conn);
+    while (position < conn->out_count && is_control_frame(*out_at(conn, position))) {
+        position++;
+    }
+
+    for (uint32_t i = conn->out_count; i > position; i--) {
+        *out_at(conn, i) = *out_at(conn, i - 1);
+    }
+    network_buffer_retain(buffer);
+    *out_at(conn, position) = buffer;
+    conn->out_count++;
+    out_account(io, conn, buffer->size);
+    *queued = true;
+
+    return out_mark_dirty(io, conn);
+}
+
+// Send credit left for data frames under flow control
+static int64_t send_credit(const NetworkConnection* conn) {
+    if (!conn->send_window) return INT64_MAX;
+    return (int64_t)conn->send_window + (int64_t)conn->peer_consumed - (int64_t)conn->data_sent;
+}
+
+// Tag queued frames up to ring position count in one batch. Numbering at
+// write time keeps sequence numbers in wire order however the queue was
+// reshuffled before. Caller holds shard lock.
+static void seal_frames(NetworkConnection* conn, uint32_t count) {
+    AuthFrame frames[IOV_BATCH];
+    uint32_t slots[IOV_BATCH];
+    uint8_t tags[IOV_BATCH][AUTH_TAG_SIZE];
+    size_t n = 0;
+
+    for (uint32_t i = conn->out_sealed; i < count; i++) {
+        NetworkBuffer* buffer = *out_at(conn, i);
+        if (!is_tagged(conn, buffer)) continue;
+        frames[n].data = buffer->data;
+        frames[n].size = buffer->size;
+        slots[n++] = (conn->out_head + i) % OUT_QUEUE_DEPTH;
+    }
+
+    auth_sign_batch(&conn->send_key, conn->send_seq, frames, n, tags);
+    for (size_t k = 0; k < n; k++) {
+        memcpy(conn->out_tags[slots[k]], tags[k], AUTH_TAG_SIZE);
+    }
+    conn->send_seq += n;
+    conn->out_sealed = count;
+}
+
+// Write queued frames until drained, the transport would block or credit
+// runs out, caller holds shard lock. Returns the new outbound state.
+static NetworkOutState write_queue(NetworkIOThread* io, NetworkConnection* conn) {
+    if (!conn->is_active) {
+        out_clear(io, conn);
+        return NET_OUT_IDLE;
+    }
+
+    // With authentication required nothing but HELLO leaves before the
+    // frame keys exist
+    bool hold = io->ctx->auth_secret_size > 0 && !conn->auth;
+
+    while (conn->out_count > 0) {
+        struct iovec iov[IOV_BATCH];
+        int iov_count = 0;
+        int64_t credit = send_credit(conn);
+        uint32_t frames = 0;
+
+        while (frames < conn->out_count && frames < IOV_BATCH / 2) {
+            NetworkBuffer* buffer = *out_at(conn, frames);
+            if (hold && !is_hello_frame(buffer)) break;
+            if (!is_control_frame(buffer)) {
+                if ((int64_t)buffer->size > credit) break;
+                credit -= buffer->size;
+            }
+            frames++;
+        }
+
+        if (frames == 0) {
+            if (hold) return NET_OUT_WAIT_HANDSHAKE;
+
+            // Head data frame waits for the peer to grant more credit
+            io->credit_stalls++;
+            return NET_OUT_WAIT_CREDIT;
+        }
+
+        if (conn->auth && frames > conn->out_sealed) {
+            seal_frames(conn, frames);
+        }
+
+        for (uint32_t i = 0; i < frames; i++) {
+            NetworkBuffer* buffer = *out_at(conn, i);
+            size_t skip = i == 0 ? conn->out_offset : 0;
+            if (skip < buffer->size) {
+                iov[iov_count].iov_base = buffer->data + skip;
+                iov[iov_count].iov_len = buffer->size - skip;
+                iov_count++;
+                skip = 0;
+            } else {
+                skip -= buffer->size;
+            }
+            if (is_tagged(conn, buffer)) {
+                uint32_t slot = (conn->out_head + i) % OUT_QUEUE_DEPTH;
+                iov[iov_count].iov_base = conn->out_tags[slot] + skip;
+                iov[iov_count].iov_len = AUTH_TAG_SIZE - skip;
+                iov_count++;
+            }
+        }
+
+        ssize_t written;
+        if (conn->shm) {
+            written = (ssize_t)shm_channel_write(conn->shm, iov, iov_count);
+            if (written == 0) return NET_OUT_BLOCKED;
+        } else {
+            NetworkTransport* transport = io->ctx->transport;
+            written = transport->write(transport, conn->socket, iov, iov_count);
+        }
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return NET_OUT_BLOCKED;
+
+            // Peer is gone; the poll loop tears the connection down
+            io->send_errors++;
+            out_clear(io, conn);
+            __atomic_store_n(&conn->close_pending, true, __ATOMIC_RELEASE);
+            return NET_OUT_IDLE;
+        }
+
+        io->bytes_sent += (uint64_t)written;
+        size_t remaining = (size_t)written;
+        while (remaining > 0) {
+            NetworkBuffer* head = *out_at(conn, 0);
+            size_t left = wire_size(conn, head) - conn->out_offset;
+            if (remaining < left) {
+                conn->out_offset += (uint32_t)remaining;
+                break;
+            }
+
+            remaining -= left;
+            if (!is_control_frame(head)) {
+                conn->data_sent += head->size;
+            }
+            out_account(io, conn, -(int64_t)head->size);
+            network_buffer_release(head);
+            conn->out_head = (conn->out_head + 1) % OUT_QUEUE_DEPTH;
+            conn->out_count--;
+            conn->out_offset = 0;
+            if (conn->out_sealed > 0) conn->out_sealed--;
+            io->frames_sent++;
+        }
+    }
+
+    return NET_OUT_IDLE;
+}
+
+// Flush a connection, waking a shared-memory peer once per flush
+static NetworkOutState flush_connection(NetworkIOThread* io, NetworkConnection* conn) {
+    uint64_t before = io->bytes_sent;
+    NetworkOutState state = write_queue(io, conn);
+    if (conn->shm && io->bytes_sent != before) {
+        shm_channel_notify(conn->shm);
+    }
+    return state;
+}
+
+// Flush pending connections of a shard and compact its dirty list,
+// caller holds shard lock
+static void shard_flush(NetworkContext* ctx, NetworkIOThread* io) {
+    size_t kept = 0;
+
+    for (size_t i = 0; i < io->dirty_count; i++) {
+        NetworkConnection* conn = &ctx->connections[io->dirty[i]];
+        if (conn->out_state == NET_OUT_PENDING) {
+            conn->out_state = flush_connection(io, conn);
+        }
+
+        if (conn->out_state == NET_OUT_IDLE) {
+            conn->out_listed = false;
+        } else {
+            io->dirty[kept++] = io->dirty[i];
+        }
+    }
+
+    io->dirty_count = kept;
+}
+
+// I/O thread: flush dirty connections, then sleep in poll until woken or
+// until a blocked socket becomes writable
+static void* io_thread_main(void* arg) {
+    NetworkIOThread* io = arg;
+    NetworkContext* ctx = io->ctx;
+
+    for (;;) {
+        pthread_mutex_lock(&io->lock);
+        if (!io->running) {
+            pthread_mutex_unlock(&io->lock);
+            break;
+        }
+
+        nfds_t count = 1;
+        bool has_pending = false;
+        io->poll_fds[0].fd = io->wake_fds[0];
+        io->poll_fds[0].events = POLLIN;
+        for (size_t i = 0; i < io->dirty_count; i++) {
+            NetworkConnection* conn = &ctx->connections[io->dirty[i]];
+            // Other waits are resumed by the poll loop
+            if (conn->out_state == NET_OUT_BLOCKED && !conn->shm && ctx->transport->pollable) {
+                io->poll_fds[count].fd = conn->socket;
+                io->poll_fds[count].events = POLLOUT;
+                io->poll_map[count] = (uint32_t)io->dirty[i];
+                count++;
+            } else if (conn->out_state == NET_OUT_PENDING) {
+                has_pending = true;
+            }
+        }
+        pthread_mutex_unlock(&io->lock);
+
+        if (poll(io->poll_fds, count, has_pending ? 0 : -1) < 0 && errno != EINTR) {
+            continue;
+        }
+
+        if (io->poll_fds[0].revents & POLLIN) {
+            char drain[64];
+            while (read(io->wake_fds[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        pthread_mutex_lock(&io->lock);
+        for (nfds_t i = 1; i < count; i++) {
+            NetworkConnection* conn = &ctx->connections[io->poll_map[i]];
+            if (io->poll_fds[i].revents && conn->out_state == NET_OUT_BLOCKED &&
+                conn->socket == io->poll_fds[i].fd) {
+                conn->out_state = NET_OUT_PENDING;
+            }
+        }
+        shard_flush(ctx, io);
+        pthread_mutex_unlock(&io->lock);
+    }
+
+    return NULL;
+}
+
+// Allocate I/O shards; threads are started by network_start
+static bool io_init(NetworkContext* ctx) {
+    size_t shards = ctx->io_thread_count ? ctx->io_thread_count : 1;
+
+    ctx->io_threads = calloc(shards, sizeof(NetworkIOThread));
+    if (!ctx->io_threads) return false;
+
+    for (size_t i = 0; i < shards; i++) {
+        NetworkIOThread* io = &ctx->io_threads[i];
+        io->ctx = ctx;
+        io->wake_fds[0] = io->wake_fds[1] = -1;
+        io->dirty = calloc(ctx->max_connections, sizeof(int32_t));
+        io->poll_fds = calloc(ctx->max_connections + 1, sizeof(struct pollfd));
+        io->poll_map = calloc(ctx->max_connections + 1, sizeof(uint32_t));
+        if (!io->dirty || !io->poll_fds || !io->poll_map ||
+            pthread_mutex_init(&io->lock, NULL) != 0) {
+            free(io->dirty);
+            free(io->poll_fds);
+            free(io->poll_map);
+            while (i-- > 0) {
+                pthread_mutex_destroy(&ctx->io_threads[i].lock);
+                free(ctx->io_threads[i].dirty);
+                free(ctx->io_threads[i].poll_fds);
+                free(ctx->io_threads[i].poll_map);
+            }
+            free(ctx->io_threads);
+            ctx->io_threads = NULL;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Release I/O shards
+static void io_free(NetworkContext* ctx) {
+    if (!ctx->io_threads) return;
+
+    size_t shards = ctx->io_thread_count ? ctx->io_thread_count : 1;
+    for (size_t i = 0; i < shards; i++) {
+        NetworkIOThread* io = &ctx->io_threads[i];
+        pthread_mutex_destroy(&io->lock);
+        free(io->dirty);
+        free(io->poll_fds);
+        free(io->poll_map);
+    }
+    free(ctx->io_threads);
+    ctx->io_threads = NULL;
+}
+
+// Start I/O worker threads
+static bool io_start(NetworkContext* ctx) {
+    for (size_t i = 0; i < ctx->io_thread_count; i++) {
+        NetworkIOThread* io = &ctx->io_threads[i];
+
+        if (pipe(io->wake_fds) != 0) return false;
+        fcntl(io->wake_fds[0], F_SETFL, O_NONBLOCK);
+        fcntl(io->wake_fds[1], F_SETFL, O_NONBLOCK);
+
+        io->running = true;
+        if (pthread_create(&io->thread, NULL, io_thread_main, io) != 0) {
+            io->running = false;
+            return false;
+        }
+        io->started = true;
+    }
+    return true;
+}
+
+// Stop I/O worker threads and drop queued frames
+static void io_stop(NetworkContext* ctx) {
+    if (!ctx->io_threads) return;
+
+    size_t shards = ctx->io_thread_count ? ctx->io_thread_count : 1;
+    for (size_t i = 0; i < shards; i++) {
+        NetworkIOThread* io = &ctx->io_threads[i];
+
+        if (io->started) {
+            pthread_mutex_lock(&io->lock);
+            io->running = false;
+            pthread_mutex_unlock(&io->lock);
+            io_wake(io);
+            pthread_join(io->thread, NULL);
+            io->started = false;
+        }
+        if (io->wake_fds[0] >= 0) {
+            close(io->wake_fds[0]);
+            close(io->wake_fds[1]);
+            io->wake_fds[0] = io->wake_fds[1] = -1;
+        }
+
+        for (size_t j = 0; j < io->dirty_count; j++) {
+            NetworkConnection* conn = &ctx->connections[io->dirty[j]];
+            out_clear(io, conn);
+            conn->out_listed = false;
+        }
+        io->dirty_count = 0;
+    }
+}
+
+// Create network context
+NetworkContext* network_create(uint16_t port) {
+    NetworkContext* ctx = calloc(1, sizeof(NetworkContext));
+    if (!ctx) return NULL;
+
+    ctx->port = port;
+    ctx->server_socket = INVALID_SOCKET;
+    ctx->unix_socket = INVALID_SOCKET;
+    ctx->datagram_socket = INVALID_SOCKET;
+    ctx->poll_fd = INVALID_SOCKET;
+    ctx->poll_timeout_ms = NETWORK_POLL_TIMEOUT_MS;
+    ctx->transport = network_socket_transport();
+    ctx->backlog = DEFAULT_BACKLOG;
+    ctx->io_thread_count = DEFAULT_IO_THREADS;
+    ctx->idle_timeout_ms = DEFAULT_IDLE_TIMEOUT_MS;
+    ctx->heartbeat_ms = DEFAULT_HEARTBEAT_MS;
+    ctx->handshake_timeout_ms = DEFAULT_HANDSHAKE_TIMEOUT_MS;
+    ctx->max_conn_outbound = DEFAULT_CONN_OUTBOUND;
+    ctx->max_outbound = DEFAULT_MAX_OUTBOUND;
+    ctx->slow_policy = NET_SLOW_DROP_OLDEST;
+    ctx->features = NET_FEATURE_FLOW_CONTROL | NET_FEATURE_RELIABLE;
+    ctx->reconnect_min_ms = DEFAULT_RECONNECT_MIN_MS;
+    ctx->reconnect_max_ms = DEFAULT_RECONNECT_MAX_MS;
+    ctx->jitter_state = (uint32_t)now_ms() ^ (uint32_t)(uintptr_t)ctx;
+    if (!ctx->jitter_state) ctx->jitter_state = 1;
+    ctx->max_connections = MAX_CONNECTIONS;
+    ctx->connections = calloc(ctx->max_connections, sizeof(NetworkConnection));
+    ctx->sessions = calloc(ctx->max_connections, sizeof(NetworkSession));
+    if (!ctx->connections || !ctx->sessions) {
+        free(ctx->sessions);
+        free(ctx->connections);
+        free(ctx);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < ctx->max_connections; i++) {
+        ctx->connections[i].socket = INVALID_SOCKET;
+        ctx->connections[i].index_slot = -1;
+        ctx->connections[i].peer_slot = -1;
+        ctx->connections[i].session = -1;
+        ctx->connections[i].generation = 1;
+    }
+    slots_init(ctx);
+
+    ctx->rx_message = malloc(sizeof(NetworkMessage) + NETWORK_MAX_FRAME_SIZE);
+    ctx->ping_frame = encode_control(NET_CONTROL_PING, NULL, 0);
+    ctx->pong_frame = encode_control(NET_CONTROL_PONG, NULL, 0);
+    if (!ctx->rx_message || !ctx->ping_frame || !ctx->pong_frame) {
+        network_buffer_release(ctx->ping_frame);
+        network_buffer_release(ctx->pong_frame);
+        free(ctx->rx_message);
+        free(ctx->sessions);
+        free(ctx->connections);
+        free(ctx);
+        return NULL;
+    }
+    timer_wheel_init(&ctx->timers, TIMER_TICK_MS, now_ms());
+
+    if (!index_init(&ctx->node_index, ctx->max_connections)) {
+        network_buffer_release(ctx->ping_frame);
+        network_buffer_release(ctx->pong_frame);
+        free(ctx->rx_message);
+        free(ctx->sessions);
+        free(ctx->connections);
+        free(ctx);
+        return NULL;
+    }
+
+    // Recursive so handlers invoked from the poll loop may call network_send
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    if (pthread_mutex_init(&ctx->lock, &attr) != 0) {
+        pthread_mutexattr_destroy(&attr);
+        free(ctx->node_index.entries);
+        network_buffer_release(ctx->ping_frame);
+        network_buffer_release(ctx->pong_frame);
+        free(ctx->rx_message);
+        free(ctx->sessions);
+        free(ctx->connections);
+        free(ctx);
+        return NULL;
+    }
+    pthread_mutexattr_destroy(&attr);
+
+#ifdef _WIN32
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2,2), &wsa_data) != 0) {
+        free(ctx->connections);
+        free(ctx);
+        return NULL;
+    }
+#endif
+
+    return ctx;
+}
+
+// Open the datagram socket on the server port and offer the channel
+static bool open_datagram(NetworkContext* ctx) {
+    ctx->datagram_rx = malloc(sizeof(DatagramBatch));
+    if (!ctx->datagram_rx) return false;
+
+    ctx->datagram_socket = datagram_open(ctx->port, &ctx->datagram_port);
+    if (ctx->datagram_socket == INVALID_SOCKET) {
+        free(ctx->datagram_rx);
+        ctx->datagram_rx = NULL;
+        return false;
+    }
+    ctx->features |= NET_FEATURE_DATAGRAM;
+    return true;
+}
+
+static void close_datagram(NetworkContext* ctx) {
+    ctx->features &= ~(uint32_t)NET_FEATURE_DATAGRAM;
+    if (ctx->datagram_socket != INVALID_SOCKET) {
+        datagram_close(ctx->datagram_socket);
+        ctx->datagram_socket = INVALID_SOCKET;
+    }
+    free(ctx->datagram_rx);
+    ctx->datagram_rx = NULL;
+}
+
+// Start network server
+bool network_start(NetworkContext* ctx) {
+    if (!ctx) return false;
+
+    // Sockets are registered with the poll set as the poll loop meets
+    // them; the set outlives restarts and closing a socket leaves it
+    if (ctx->poll_fd == INVALID_SOCKET) {
+        ctx->poll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (ctx->poll_fd == INVALID_SOCKET) return false;
+    }
+    ctx->poll_listeners = 0;
+
+    // Reliable sequence numbers start over, so peers must not take this
+    // run for a reconnect of the last one
+    if (!auth_random(&ctx->instance, sizeof(ctx->instance))) {
+        ctx->instance = ((uint64_t)now_ms() << 32) ^ (uint64_t)(uintptr_t)ctx ^ (ctx->instance + 1);
+    }
+    if (!ctx->instance) ctx->instance = 1;
+
+    // Open listeners on the configured transport
+    NetworkTransport* transport = ctx->transport;
+    if (!transport->listen(transport, ctx)) {
+        return false;
+    }
+    if (ctx->datagram_enabled && !open_datagram(ctx)) {
+        transport->unlisten(transport, ctx);
+        return false;
+    }
+
+    // Bring up outbound I/O shards
+    if (!io_init(ctx)) {
+        close_datagram(ctx);
+        transport->unlisten(transport, ctx);
+        return false;
+    }
+    if (!io_start(ctx)) {
+        io_stop(ctx);
+        io_free(ctx);
+        close_datagram(ctx);
+        transport->unlisten(transport, ctx);
+        return false;
+    }
+
+    ctx->rate_window_start = now_ms();
+
+    // Registered peers are dialed from the first poll
+    pthread_mutex_lock(&ctx->lock);
+    for (size_t i = 0; i < NETWORK_MAX_PEERS; i++) {
+        if (ctx->peers[i].in_use) {
+            ctx->peers[i].backoff_ms = ctx->reconnect_min_ms;
+            timer_arm(&ctx->timers, &ctx->peers[i].retry_timer, ctx->rate_window_start);
+        }
+    }
+    pthread_mutex_unlock(&ctx->lock);
+
+    return true;
+}
+
+static bool send_hello(NetworkContext* ctx, NetworkConnection* conn);
+
+// Admit new connection into a free slot. Dialed connections greet the
+// peer before the connect handler can queue anything.
+static NetworkConnection* admit_connection(NetworkContext* ctx, int client_sock,
+                                           bool dialed, int32_t peer_slot) {
+    pthread_mutex_lock(&ctx->lock);
+    NetworkConnection* conn = slot_acquire(ctx);
+    if (conn) {
+        conn->socket = client_sock;
+        conn->is_active = true;
+        conn->established = false;
+        conn->last_rx_ms = now_ms();
+        conn->out_bytes = 0;
+        conn->data_sent = 0;
+        conn->peer_consumed = 0;
+        conn->rx_consumed = 0;
+        conn->rx_granted = 0;
+        conn->passed_count = 0;
+        conn->negotiated = false;
+        conn->version = 0;
+        conn->features = 0;
+        conn->max_batch = 0;
+        conn->max_frame = NETWORK_MAX_FRAME_SIZE;
+        conn->send_window = 0;
+        conn->recv_window = 0;
+        conn->hello_sent = false;
+        conn->auth = false;
+        conn->send_seq = 0;
+        conn->recv_seq = 0;
+        conn->datagram_port = 0;
+        conn->datagram_send_seq = 0;
+        conn->datagram_recv_seq = 0;
+        conn->peer_slot = peer_slot;
+        conn->session = -1;
+        conn->poll_events = 0;
+        conn->poll_shm = false;
+        ctx->active_connections++;
+
+        // Peer must speak before the handshake deadline
+        if (ctx->handshake_timeout_ms) {
+            timer_arm(&ctx->timers, &conn->idle_timer,
+                      conn->last_rx_ms + ctx->handshake_timeout_ms);
+        }
+
+        // A greeting that cannot be queued closes from the poll loop
+        if (dialed && !send_hello(ctx, conn)) {
+            __atomic_store_n(&conn->close_pending, true, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&ctx->lock);
+
+    if (!conn) {
+        ctx->transport->close(ctx->transport, client_sock);
+        return NULL;
+    }
+
+    // Notify connection handler
+    if (ctx->connect_handler) {
+        ctx->connect_handler(ctx, conn);
+    }
+
+    return conn;
+}
+
+// Update admission rate window
+static void update_accept_rate(NetworkContext* ctx, uint32_t admitted) {
+    uint64_t now = now_ms();
+    ctx->rate_window_count += admitted;
+
+    uint64_t elapsed = now - ctx->rate_window_start;
+    if (elapsed >= ACCEPT_RATE_WINDOW_MS) {
+        ctx->stats.accept_rate = (double)ctx->rate_window_count * 1000.0 / (double)elapsed;
+        ctx->rate_window_start = now;
+        ctx->rate_window_count = 0;
+    }
+}
+
+// Drain pending connections from the listen queue. Bounded per wakeup so
+// a reconnect storm cannot starve reads on established connections.
+static void accept_connections(NetworkContext* ctx, int listener) {
+    NetworkTransport* transport = ctx->transport;
+    uint32_t admitted = 0;
+    uint32_t batch = 0;
+
+    while (batch < ACCEPT_BATCH_MAX) {
+        int client_sock = transport->accept(transport, listener);
+        if (client_sock < 0) {
+            int err = SOCKET_ERROR_CODE;
+            if (err == EINTR || err == ECONNABORTED) continue;
+            if (err != EAGAIN && err != EWOULDBLOCK) {
+                pthread_mutex_lock(&ctx->lock);
+                ctx->stats.accept_errors++;
+                pthread_mutex_unlock(&ctx->lock);
+            }
+            break;
+        }
+
+        batch++;
+        if (admit_connection(ctx, client_sock, false, -1)) {
+            admitted++;
+        } else {
+            pthread_mutex_lock(&ctx->lock);
+            ctx->stats.rejected++;
+            pthread_mutex_unlock(&ctx->lock);
+        }
+    }
+
+    pthread_mutex_lock(&ctx->lock);
+    ctx->stats.accept_wakeups++;
+    ctx->stats.accepted += admitted;
+    if (batch > ctx->stats.max_accept_batch) {
+        ctx->stats.max_accept_batch = batch;
+    }
+    update_accept_rate(ctx, admitted);
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+// Close shared-memory channel and unclaimed passed descriptors
+static void release_local(NetworkConnection* conn) {
+    if (conn->shm) {
+        shm_channel_close(conn->shm);
+        free(conn->shm);
+        conn->shm = NULL;
+    }
+    for (uint32_t i = 0; i < conn->passed_count; i++) {
+        close(conn->passed_fds[i]);
+    }
+    conn->passed_count = 0;
+}
+
+// Arm a peer's next redial after its backoff plus up to half again of
+// jitter, so peers dropped together do not redial in lockstep. Caller
+// holds lock.
+static void schedule_redial(NetworkContext* ctx, NetworkPeer* peer) {
+    peer->handle = NETWORK_INVALID_HANDLE;
+    if (!peer->in_use) return;
+
+    uint32_t x = ctx->jitter_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ctx->jitter_state = x;
+
+    uint32_t delay = peer->backoff_ms + x % (peer->backoff_ms / 2 + 1);
+    timer_arm(&ctx->timers, &peer->retry_timer, now_ms() + delay);
+
+    uint32_t next = peer->backoff_ms * 2;
+    peer->backoff_ms = next < ctx->reconnect_max_ms && next > peer->backoff_ms ? next : ctx->reconnect_max_ms;
+}
+
+// Open an outbound connection and greet the peer. Caller holds lock.
+static NetworkConnection* dial(NetworkContext* ctx, const char* host, uint16_t port,
+                               int32_t peer_slot) {
+    NetworkTransport* transport = ctx->transport;
+    if (!transport->connect || !ctx->io_threads) return NULL;
+
+    ctx->stats.dials++;
+    int sock = transport->connect(transport, host, port);
+    if (sock < 0) {
+        ctx->stats.dial_failures++;
+        return NULL;
+    }
+
+    NetworkConnection* conn = admit_connection(ctx, sock, true, peer_slot);
+    if (!conn) {
+        ctx->stats.rejected++;
+    }
+    return conn;
+}
+
+// Dial a registered peer, scheduling a redial if it cannot be reached.
+// Caller holds lock.
+static void dial_peer(NetworkContext* ctx, NetworkPeer* peer) {
+    NetworkConnection* conn = dial(ctx, peer->host, peer->port, (int32_t)(peer - ctx->peers));
+    if (conn) {
+        peer->handle = network_get_handle(ctx, conn);
+    } else {
+        schedule_redial(ctx, peer);
+    }
+}
+
+static void detach_session(NetworkContext* ctx, NetworkConnection* conn, NetworkHandle handle);
+
+// Handle disconnection
+static void handle_disconnect(NetworkContext* ctx, NetworkConnection* conn) {
+    if (!conn->is_active) return;
+    NetworkHandle handle = network_get_handle(ctx, conn);
+
+    // Notify disconnect handler
+    if (ctx->disconnect_handler) {
+        ctx->disconnect_handler(ctx, conn);
+    }
+
+    pthread_mutex_lock(&ctx->lock);
+    if (conn->peer_slot >= 0) {
+        if (!conn->established) {
+            ctx->stats.dial_failures++;
+        }
+        schedule_redial(ctx, &ctx->peers[conn->peer_slot]);
+        conn->peer_slot = -1;
+    }
+    index_remove(ctx, conn);
+    timer_cancel(&ctx->timers, &conn->idle_timer);
+    timer_cancel(&ctx->timers, &conn->heartbeat_timer);
+    conn->node_id[0] = '\0';
+    conn->established = false;
+    conn->rx_length = 0;
+    __atomic_store_n(&conn->close_pending, false, __ATOMIC_RELAXED);
+
+    // Drop queued output before the socket can be reused
+    NetworkIOThread* io = conn_shard(ctx, conn);
+    pthread_mutex_lock(&io->lock);
+    out_clear(io, conn);
+    release_local(conn);
+    ctx->transport->close(ctx->transport, conn->socket);
+    conn->is_active = false;
+    conn->socket = INVALID_SOCKET;
+    pthread_mutex_unlock(&io->lock);
+
+    detach_session(ctx, conn, handle);
+    ctx->active_connections--;
+    slot_release(ctx, conn);
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+// Switch connection from handshake deadline to idle/heartbeat timers
+static void establish_connection(NetworkContext* ctx, NetworkConnection* conn) {
+    conn->established = true;
+
+    // A peer that answered restarts its backoff
+    if (conn->peer_slot >= 0) {
+        ctx->peers[conn->peer_slot].backoff_ms = ctx->reconnect_min_ms;
+    }
+
+    if (ctx->idle_timeout_ms) {
+        timer_arm(&ctx->timers, &conn->idle_timer, conn->last_rx_ms + ctx->idle_timeout_ms);
+    } else {
+        timer_cancel(&ctx->timers, &conn->idle_timer);
+    }
+    if (ctx->heartbeat_ms) {
+        timer_arm(&ctx->timers, &conn->heartbeat_timer, conn->last_rx_ms + ctx->heartbeat_ms);
+    }
+}
+
+static bool send_buffer(NetworkContext* ctx, NetworkConnection* conn, NetworkBuffer* buffer);
+
+// Peer reported consuming more data; resume a stalled queue
+static void grant_credit(NetworkContext* ctx, NetworkConnection* conn, uint64_t consumed) {
+    NetworkIOThread* io = conn_shard(ctx, conn);
+    bool wake = false;
+
+    pthread_mutex_lock(&io->lock);
+    if (consumed > conn->peer_consumed) {
+        conn->peer_consumed = consumed;
+        if (conn->out_state == NET_OUT_WAIT_CREDIT) {
+            conn->out_state = NET_OUT_PENDING;
+            wake = io->started;
+        }
+    }
+    pthread_mutex_unlock(&io->lock);
+
+    if (wake) {
+        io_wake(io);
+    }
+}
+
+// Move connection onto the shared-memory channel whose descriptors came
+// with the attach frame. The echo is the first frame on the new channel,
+// so the peer knows where socket traffic ends.
+static bool attach_shm(NetworkContext* ctx, NetworkConnection* conn) {
+    if (conn->shm || conn->passed_count != 3) return false;
+
+    ShmChannel* channel = malloc(sizeof(ShmChannel));
+    if (!channel) return false;
+
+    conn->passed_count = 0;
+    if (!shm_channel_open(channel, conn->passed_fds[0], conn->passed_fds[1],
+                          conn->passed_fds[2])) {
+        free(channel);
+        return false;
+    }
+
+    // A half-written frame would be split across transports
+    NetworkIOThread* io = conn_shard(ctx, conn);
+    pthread_mutex_lock(&io->lock);
+    bool switched = conn->out_offset == 0;
+    bool wake = false;
+    if (switched) {
+        conn->shm = channel;
+        if (conn->out_state == NET_OUT_BLOCKED) {
+            conn->out_state = NET_OUT_PENDING;
+            wake = io->started;
+        }
+    }
+    pthread_mutex_unlock(&io->lock);
+
+    if (wake) {
+        io_wake(io);
+    }
+
+    if (!switched) {
+        shm_channel_close(channel);
+        free(channel);
+        return false;
+    }
+
+    ctx->stats.shm_attached++;
+    NetworkBuffer* echo = encode_control(NET_CONTROL_SHM_ATTACH, NULL, 0);
+    bool sent = echo && send_buffer(ctx, conn, echo);
+    network_buffer_release(echo);
+    return sent;
+}
+
+// Frames held by reliable senders are buffer references
+static void release_frame(void* frame) {
+    network_buffer_release(frame);
+}
+
+// Session whose frames a send callback queues
+typedef struct {
+    NetworkContext* ctx;
+    NetworkSession* session;
+} SessionSend;
+
+// Acknowledgement of the peer's frames received so far
+static void put_ack(uint8_t* p, const ReliableReceiver* recv) {
+    put_u32le(p, recv->expected);
+    put_u64le(p + 4, recv->received);
+}
+
+// An acknowledgement went out, the delayed one is not needed
+static void ack_sent(NetworkContext* ctx, NetworkSession* session) {
+    session->recv.unacked = 0;
+    timer_cancel(&ctx->timers, &session->ack_timer);
+}
+
+// Queue a reliable frame on the session's connection with a fresh
+// acknowledgement. A frame still queued from its last send is not lost
+// and only counts as sent. Caller holds lock.
+static bool session_send(void* frame, uint32_t seq, bool resend, void* arg) {
+    SessionSend* out = arg;
+    NetworkBuffer* buffer = frame;
+    (void)seq;
+
+    NetworkConnection* conn = network_resolve(out->ctx, out->session->handle);
+    if (!conn) return false;
+    if (__atomic_load_n(&buffer->refcount, __ATOMIC_ACQUIRE) > 1) return true;
+
+    // Only this sender holds the frame, so the fields can change in place
+    uint8_t* fields = buffer->data + NETWORK_FRAME_HEADER_SIZE + buffer->data[6] + buffer->data[7];
+    put_ack(fields + 4, &out->session->recv);
+    if (!send_buffer(out->ctx, conn, buffer)) return false;
+
+    ack_sent(out->ctx, out->session);
+    if (resend) {
+        out->ctx->stats.reliable_retransmits++;
+    }
+    return true;
+}
+
+// Send what the window allows and re-arm the retransmit timer. Frames a
+// full queue refused are retried after a timeout too. Caller holds lock.
+static void session_pump(NetworkContext* ctx, NetworkSession* session) {
+    SessionSend out = {ctx, session};
+    uint64_t now = now_ms();
+    reliable_transmit(&session->send, now, session_send, &out);
+
+    uint64_t deadline = reliable_deadline(&session->send);
+    if (!deadline && reliable_held(&session->send)) {
+        deadline = now + session->send.rto_ms;
+    }
+    if (deadline && network_resolve(ctx, session->handle)) {
+        timer_arm(&ctx->timers, &session->retransmit_timer, deadline);
+    } else {
+        timer_cancel(&ctx->timers, &session->retransmit_timer);
+    }
+}
+
+// Send a standalone acknowledgement, caller holds lock
+static void send_ack(NetworkContext* ctx, NetworkSession* session) {
+    NetworkConnection* conn = network_resolve(ctx, session->handle);
+    if (!conn) return;
+
+    uint8_t payload[RELIABLE_ACK_SIZE];
+    put_ack(payload, &session->recv);
+    NetworkBuffer* ack = encode_control(NET_CONTROL_ACK, payload, sizeof(payload));
+    if (ack && send_buffer(ctx, conn, ack)) {
+        ack_sent(ctx, session);
+    }
+    network_buffer_release(ack);
+}
+
+// Forget a session and whatever it still held, caller holds lock
+static void session_free(NetworkContext* ctx, NetworkSession* session) {
+    ctx->stats.reliable_expired += reliable_held(&session->send);
+    reliable_sender_free(&session->send, release_frame);
+    timer_cancel(&ctx->timers, &session->retransmit_timer);
+    timer_cancel(&ctx->timers, &session->ack_timer);
+    timer_cancel(&ctx->timers, &session->expire_timer);
+    session->in_use = false;
+    session->peer_instance = 0;
+    session->handle = NETWORK_INVALID_HANDLE;
+}
+
+// Bind conn to the session of the peer's instance, creating one
+// if needed. With every entry taken, one whose peer is gone makes room.
+// The newest connection carries the session, and frames in flight on an
+// older one go out again. Caller holds lock.
+static void attach_session(NetworkContext* ctx, NetworkConnection* conn, uint64_t instance) {
+    NetworkSession* session = NULL;
+    NetworkSession* unused = NULL;
+    NetworkSession* orphan = NULL;
+
+    for (size_t i = 0; i < ctx->max_connections && !session; i++) {
+        NetworkSession* entry = &ctx->sessions[i];
+        if (entry->in_use && entry->peer_instance == instance) {
+            session = entry;
+        } else if (!entry->in_use) {
+            if (!unused) unused = entry;
+        } else if (!orphan && !network_resolve(ctx, entry->handle)) {
+            orphan = entry;
+        }
+    }
+
+    if (!session) {
+        session = unused ? unused : orphan;
+        if (!session) return;
+        if (session->in_use) {
+            session_free(ctx, session);
+        }
+        if (!reliable_sender_init(&session->send)) return;
+        memset(&session->recv, 0, sizeof(session->recv));
+        session->in_use = true;
+        session->peer_instance = instance;
+    }
+
+    conn->session = (int32_t)(session - ctx->sessions);
+    session->handle = network_get_handle(ctx, conn);
+    timer_cancel(&ctx->timers, &session->expire_timer);
+    reliable_rewind(&session->send);
+    session_pump(ctx, session);
+}
+
+// Move a session off a closing connection, onto another connection to
+// the same peer if there is one, else leave it waiting for the peer to
+// return. Caller holds lock.
+static void detach_session(NetworkContext* ctx, NetworkConnection* conn, NetworkHandle handle) {
+    int32_t index = conn->session;
+    if (index < 0) return;
+
+    NetworkSession* session = &ctx->sessions[index];
+    conn->session = -1;
+    if (session->handle != handle) return;
+
+    session->handle = NETWORK_INVALID_HANDLE;
+    for (size_t i = 0; i < ctx->max_connections; i++) {
+        if (ctx->connections[i].is_active && ctx->connections[i].session == index) {
+            session->handle = network_get_handle(ctx, &ctx->connections[i]);
+            break;
+        }
+    }
+
+    if (session->handle != NETWORK_INVALID_HANDLE) {
+        reliable_rewind(&session->send);
+        session_pump(ctx, session);
+        return;
+    }
+    timer_cancel(&ctx->timers, &session->retransmit_timer);
+    timer_cancel(&ctx->timers, &session->ack_timer);
+    timer_arm(&ctx->timers, &session->expire_timer, now_ms() + NETWORK_SESSION_LINGER_MS);
+}
+
+// Apply the peer's acknowledgement and send into the window it opened.
+// Returns false if it acknowledges frames never sent.
+static bool session_acked(NetworkContext* ctx, NetworkConnection* conn, uint32_t ack, uint64_t sack) {
+    if (conn->session < 0) return false;
+
+    NetworkSession* session = &ctx->sessions[conn->session];
+    if (!reliable_ack(&session->send, ack, sack, now_ms(), release_frame)) return false;
+    session_pump(ctx, session);
+    return true;
+}
+
+// Sequence a reliable frame from the peer and apply the acknowledgement
+// it carries. Sets fresh to false for a duplicate, which is acknowledged
+// at once since the peer evidently missed the last acknowledgement.
+// Others are acknowledged with the next reliable frame back, every
+// RELIABLE_ACK_EVERY frames, or after RELIABLE_ACK_DELAY_MS. Returns
+// false on a protocol error.
+static bool receive_reliable(NetworkContext* ctx, NetworkConnection* conn,
+                             const uint8_t* fields, bool* fresh) {
+    if (!session_acked(ctx, conn, get_u32le(fields + 4), get_u64le(fields + 8))) return false;
+
+    NetworkSession* session = &ctx->sessions[conn->session];
+    *fresh = reliable_accept(&session->recv, get_u32le(fields));
+    if (!*fresh) {
+        ctx->stats.reliable_duplicates++;
+        send_ack(ctx, session);
+    } else if (++session->recv.unacked >= RELIABLE_ACK_EVERY) {
+        send_ack(ctx, session);
+    } else if (!timer_is_armed(&session->ack_timer)) {
+        timer_arm(&ctx->timers, &session->ack_timer, now_ms() + RELIABLE_ACK_DELAY_MS);
+    }
+    return true;
+}
+
+// Session timer expiry, caller holds lock
+static void on_session_timer(NetworkContext* ctx, NetworkSession* session, TimerEntry* entry) {
+    if (!session->in_use) return;
+
+    if (entry == &session->retransmit_timer) {
+        SessionSend out = {ctx, session};
+        reliable_retransmit(&session->send, now_ms(), session_send, &out);
+        session_pump(ctx, session);
+    } else if (entry == &session->ack_timer) {
+        send_ack(ctx, session);
+    } else if (entry == &session->expire_timer && !network_resolve(ctx, session->handle)) {
+        session_free(ctx, session);
+    }
+}
+
+// Encode HELLO payload
+static void put_hello(uint8_t* p, const NetworkHello* hello) {
+    p[0] = hello->version;
+    p[1] = hello->min_version;
+    p[2] = (uint8_t)hello->max_batch;
+    p[3] = (uint8_t)(hello->max_batch >> 8);
+    put_u32le(p + 4, hello->features);
+    put_u32le(p + 8, hello->max_frame);
+    put_u32le(p + 12, hello->flow_window);
+    put_u32le(p + 16, hello->dictionary);
+    memcpy(p + 20, hello->nonce, AUTH_NONCE_SIZE);
+    p[20 + AUTH_NONCE_SIZE] = (uint8_t)hello->datagram_port;
+    p[21 + AUTH_NONCE_SIZE] = (uint8_t)(hello->datagram_port >> 8);
+    put_u64le(p + 22 + AUTH_NONCE_SIZE, hello->instance);
+}
+
+// Encode HELLO control frame into frame. Returns its size, 0 if it does
+// not fit.
+size_t network_encode_hello(const NetworkHello* hello, uint8_t* frame, size_t size) {
+    if (!hello || !frame || size < NETWORK_FRAME_HEADER_SIZE + NETWORK_HELLO_SIZE) return 0;
+
+    put_u32le(frame, NETWORK_HELLO_SIZE);
+    frame[4] = NET_CONTROL_HELLO;
+    frame[5] = NET_FRAME_FLAG_CONTROL;
+    frame[6] = 0;
+    frame[7] = 0;
+    put_hello(frame + NETWORK_FRAME_HEADER_SIZE, hello);
+    return NETWORK_FRAME_HEADER_SIZE + NETWORK_HELLO_SIZE;
+}
+
+// Decode HELLO payload, ignoring trailing fields from newer peers
+bool network_decode_hello(const uint8_t* payload, size_t size, NetworkHello* hello) {
+    if (!payload || !hello || size < NETWORK_HELLO_MIN_SIZE) return false;
+
+    hello->version = payload[0];
+    hello->min_version = payload[1];
+    hello->max_batch = (uint16_t)(payload[2] | (payload[3] << 8));
+    hello->features = get_u32le(payload + 4);
+    hello->max_frame = get_u32le(payload + 8);
+    hello->flow_window = get_u32le(payload + 12);
+    hello->dictionary = size >= 20 ? get_u32le(payload + 16) : 0;
+    if (size >= 20 + AUTH_NONCE_SIZE) {
+        memcpy(hello->nonce, payload + 20, AUTH_NONCE_SIZE);
+    } else {
+        memset(hello->nonce, 0, AUTH_NONCE_SIZE);
+    }
+    hello->datagram_port = size >= 22 + AUTH_NONCE_SIZE ?
+        (uint16_t)(payload[20 + AUTH_NONCE_SIZE] | (payload[21 + AUTH_NONCE_SIZE] << 8)) : 0;
+    hello->instance = size >= 30 + AUTH_NONCE_SIZE ? get_u64le(payload + 22 + AUTH_NONCE_SIZE) : 0;
+    return true;
+}
+
+// Build our handshake parameters into conn->hello
+static bool prepare_hello(NetworkContext* ctx, NetworkConnection* conn) {
+    NetworkHello hello = {
+        .version = NETWORK_PROTOCOL_VERSION,
+        .min_version = NETWORK_PROTOCOL_MIN_VERSION,
+        .max_batch = 0,
+        .features = ctx->features,
+        .max_frame = NETWORK_MAX_FRAME_SIZE,
+        .flow_window = ctx->flow_window,
+        .dictionary = ctx->compressor ? ctx->compressor->dict_id : 0,
+        .datagram_port = ctx->datagram_socket != INVALID_SOCKET ? ctx->datagram_port : 0,
+        .instance = ctx->instance
+    };
+
+    if (ctx->auth_secret_size && !auth_random(hello.nonce, sizeof(hello.nonce))) {
+        return false;
+    }
+    put_hello(conn->hello, &hello);
+    conn->hello_sent = true;
+    return true;
+}
+
+// Send our handshake parameters
+static bool send_hello(NetworkContext* ctx, NetworkConnection* conn) {
+    if (!conn->hello_sent && !prepare_hello(ctx, conn)) return false;
+
+    NetworkBuffer* frame = encode_control(NET_CONTROL_HELLO, conn->hello, sizeof(conn->hello));
+    bool sent = frame && send_buffer(ctx, conn, frame);
+    network_buffer_release(frame);
+    return sent;
+}
+
+// Key both directions from the two HELLO payloads and start tagging.
+// Output held for the keys is released. Caller holds lock.
+static bool start_auth(NetworkContext* ctx, NetworkConnection* conn,
+                       const uint8_t* peer_hello, uint32_t length) {
+    if (!conn->out_tags) {
+        conn->out_tags = calloc(OUT_QUEUE_DEPTH, AUTH_TAG_SIZE);
+        if (!conn->out_tags) return false;
+    }
+
+    AuthKey send_key, recv_key;
+    if (!auth_derive_key(&send_key, ctx->auth_secret, ctx->auth_secret_size,
+                         conn->hello, sizeof(conn->hello), peer_hello, length) ||
+        !auth_derive_key(&recv_key, ctx->auth_secret, ctx->auth_secret_size,
+                         peer_hello, length, conn->hello, sizeof(conn->hello))) {
+        return false;
+    }
+
+    conn->recv_key = recv_key;
+    conn->recv_seq = 0;
+
+    NetworkIOThread* io = conn_shard(ctx, conn);
+    bool wake = false;
+    pthread_mutex_lock(&io->lock);
+    conn->send_key = send_key;
+    conn->send_seq = 0;
+    conn->auth = true;
+    if (conn->out_state == NET_OUT_WAIT_HANDSHAKE) {
+        conn->out_state = NET_OUT_PENDING;
+        wake = io->started;
+    }
+    pthread_mutex_unlock(&io->lock);
+
+    if (wake) {
+        io_wake(io);
+    }
+    return true;
+}
+
+// Negotiate with the peer's HELLO, answering it if the peer spoke first.
+// Returns false if no protocol version is shared.
+static bool handle_hello(NetworkContext* ctx, NetworkConnection* conn,
+                         const uint8_t* body, uint32_t length) {
+    NetworkHello peer;
+    if (conn->auth || !network_decode_hello(body, length, &peer)) return false;
+    if (peer.version < NETWORK_PROTOCOL_MIN_VERSION ||
+        peer.min_version > NETWORK_PROTOCOL_VERSION) {
+        return false;
+    }
+
+    bool answer = !conn->hello_sent;
+    if (answer && !prepare_hello(ctx, conn)) return false;
+    conn->negotiated = true;
+    conn->version = peer.version < NETWORK_PROTOCOL_VERSION ? peer.version : NETWORK_PROTOCOL_VERSION;
+    conn->features = peer.features & ctx->features;
+
+    // Compressed frames only decode against the same dictionary
+    if (peer.dictionary != (ctx->compressor ? ctx->compressor->dict_id : 0)) {
+        conn->features &= ~(uint32_t)NET_FEATURE_COMPRESSION;
+    }
+    conn->max_batch = (conn->features & NET_FEATURE_BATCH) ? peer.max_batch : 0;
+
+    // Datagrams go to the peer's address at the port it advertised
+    if ((conn->features & NET_FEATURE_DATAGRAM) && peer.datagram_port) {
+        struct sockaddr_in addr;
+        socklen_t addr_len = sizeof(addr);
+        if (getpeername(conn->socket, (struct sockaddr*)&addr, &addr_len) == 0 &&
+            addr.sin_family == AF_INET) {
+            conn->datagram_addr = addr.sin_addr.s_addr;
+            conn->datagram_port = htons(peer.datagram_port);
+        }
+    }
+
+    // Credit windows apply only if both sides speak flow control; the
+    // counters run from connection start, so early data stays accounted
+    bool flow = (conn->features & NET_FEATURE_FLOW_CONTROL) != 0;
+    NetworkIOThread* io = conn_shard(ctx, conn);
+    pthread_mutex_lock(&io->lock);
+    if (peer.max_frame > 0 && peer.max_frame < NETWORK_MAX_FRAME_SIZE) {
+        conn->max_frame = peer.max_frame;
+    }
+    conn->send_window = flow ? peer.flow_window : 0;
+    pthread_mutex_unlock(&io->lock);
+    conn->recv_window = flow ? ctx->flow_window : 0;
+
+    // The answer is queued before held output is released so it leaves
+    // first. A peer without the secret, or one that strips the offer, is
+    // refused.
+    if (answer && !send_hello(ctx, conn)) return false;
+    if (ctx->auth_secret_size &&
+        (!(conn->features & NET_FEATURE_AUTH) || !start_auth(ctx, conn, body, length))) {
+        ctx->stats.auth_failures++;
+        return false;
+    }
+
+    // Reliable delivery picks up where the peer's last connection left off
+    if ((conn->features & NET_FEATURE_RELIABLE) && peer.instance) {
+        attach_session(ctx, conn, peer.instance);
+    }
+
+    ctx->stats.handshakes++;
+    return true;
+}
+
+// Report consumed bytes once half the window has been used
+static void return_credit(NetworkContext* ctx, NetworkConnection* conn) {
+    if (!conn->recv_window || conn->rx_consumed - conn->rx_granted < conn->recv_window / 2) {
+        return;
+    }
+
+    uint8_t payload[8];
+    put_u32le(payload, (uint32_t)conn->rx_consumed);
+    put_u32le(payload + 4, (uint32_t)(conn->rx_consumed >> 32));
+
+    NetworkBuffer* credit = encode_control(NET_CONTROL_CREDIT, payload, sizeof(payload));
+    if (credit && send_buffer(ctx, conn, credit)) {
+        conn->rx_granted = conn->rx_consumed;
+    }
+    network_buffer_release(credit);
+}
+
+// Handle runtime control frame
+static bool handle_control(NetworkContext* ctx, NetworkConnection* conn,
+                           const NetworkFrameHeader* header, const uint8_t* body) {
+    switch (header->type) {
+        case NET_CONTROL_PING:
+            send_buffer(ctx, conn, ctx->pong_frame);
+            return true;
+
+        case NET_CONTROL_PONG:
+            // Receipt already refreshed last_rx_ms
+            return true;
+
+        case NET_CONTROL_SHM_ATTACH:
+            return attach_shm(ctx, conn);
+
+        case NET_CONTROL_CREDIT:
+            if (header->length != 8) return false;
+            grant_credit(ctx, conn, (uint64_t)get_u32le(body) | ((uint64_t)get_u32le(body + 4) << 32));
+            return true;
+
+        case NET_CONTROL_HELLO:
+            return handle_hello(ctx, conn, body, header->length);
+
+        case NET_CONTROL_ACK:
+            if (header->length != RELIABLE_ACK_SIZE) return false;
+            return session_acked(ctx, conn, get_u32le(body), get_u64le(body + 4));
+
+        default:
+            // Newer control types are ignored so peers can add them freely
+            return true;
+    }
+}
+
+// Decompress a payload of packed_size bytes into the scratch message and
+// point view at it. Returns false on malformed input or an unnegotiated
+// peer.
+static bool inflate_payload(NetworkContext* ctx, const NetworkConnection* conn,
+                            const uint8_t* packed, uint32_t packed_size, NetworkView* view) {
+    if (!(conn->features & NET_FEATURE_COMPRESSION) || !ctx->compressor || packed_size < 4) {
+        return false;
+    }
+
+    uint32_t raw_size = get_u32le(packed);
+    size_t out_size;
+    if (raw_size > NETWORK_MAX_FRAME_SIZE ||
+        !decompress_block(packed + 4, packed_size - 4, ctx->rx_message->data, raw_size, &out_size,
+                          ctx->compressor->dict, ctx->compressor->dict_size) ||
+        out_size != raw_size) {
+        return false;
+    }
+    view->data = ctx->rx_message->data;
+    view->data_size = raw_size;
+    return true;
+}
+
+// Point view at a data frame's IDs and payload where they lie in body
+static bool unpack_view(NetworkContext* ctx, const NetworkConnection* conn,
+                        const NetworkFrameHeader* header, const uint8_t* body, NetworkView* view) {
+    size_t ids_len = (size_t)header->source_len + header->target_len;
+    size_t skip = (header->flags & NET_FRAME_FLAG_RELIABLE) ? NETWORK_RELIABLE_SIZE : 0;
+    if (ids_len + skip > header->length ||
+        header->source_len >= sizeof(ctx->rx_message->source_id) ||
+        header->target_len >= sizeof(ctx->rx_message->target_id)) {
+        return false;
+    }
+
+    view->type = (NetworkMessageType)header->type;
+    view->source_id = (const char*)body;
+    view->source_len = header->source_len;
+    view->target_id = (const char*)body + header->source_len;
+    view->target_len = header->target_len;
+    view->connection = network_get_handle(ctx, conn);
+    view->authenticated = conn->auth;
+    view->datagram = false;
+    view->reliable = skip > 0;
+    view->data = body + ids_len + skip;
+    view->data_size = header->length - (uint32_t)(ids_len + skip);
+    if (header->flags & NET_FRAME_FLAG_COMPRESSED) {
+        return inflate_payload(ctx, conn, view->data, view->data_size, view);
+    }
+    return true;
+}
+
+// Hand a received frame to the view handler in place, or copied into the
+// scratch message to the message handler
+static void handle_frame(NetworkContext* ctx, const NetworkView* view) {
+    if (ctx->view_handler) {
+        ctx->view_handler(ctx, view);
+    } else if (ctx->message_handler) {
+        network_view_copy(view, ctx->rx_message);
+        ctx->message_handler(ctx, ctx->rx_message);
+    }
+}
+
+// Deliver one complete frame to the handlers
+static bool deliver_frame(NetworkContext* ctx, NetworkConnection* conn,
+                          const NetworkFrameHeader* header, const uint8_t* body) {
+    if (!conn->established) {
+        establish_connection(ctx, conn);
+    }
+
+    if (header->flags & NET_FRAME_FLAG_CONTROL) {
+        return handle_control(ctx, conn, header, body);
+    }
+    NetworkView view;
+    if (!unpack_view(ctx, conn, header, body, &view)) return false;
+
+    // Duplicates are dropped here but still count toward credit
+    bool fresh = true;
+    if ((header->flags & NET_FRAME_FLAG_RELIABLE) &&
+        !receive_reliable(ctx, conn, body + header->source_len + header->target_len, &fresh)) {
+        return false;
+    }
+    if (fresh) {
+        ctx->stats.frames_received++;
+        handle_frame(ctx, &view);
+    }
+
+    // Handler may have closed the connection
+    if (conn->is_active) {
+        conn->rx_consumed += NETWORK_FRAME_HEADER_SIZE + header->length;
+        return_credit(ctx, conn);
+    }
+    return true;
+}
+
+// Grow receive buffer toward the largest frame. Returns false on allocation failure.
+static bool reserve_rx(NetworkConnection* conn) {
+    if (conn->rx_capacity - conn->rx_length < BUFFER_SIZE / 2 && conn->rx_capacity < RX_FRAME_MAX) {
+        size_t capacity = conn->rx_capacity ? conn->rx_capacity * 2 : BUFFER_SIZE;
+        if (capacity > RX_FRAME_MAX) {
+            capacity = RX_FRAME_MAX;
+        }
+        uint8_t* grown = realloc(conn->rx_buffer, capacity);
+        if (!grown) return false;
+        conn->rx_buffer = grown;
+        conn->rx_capacity = capacity;
+    }
+    return true;
+}
+
+// Verify a burst of complete tagged frames at p together, then deliver
+// those that passed. Sets used to the bytes consumed, 0 if no frame is
+// complete. Returns false on a bad tag, after delivering the frames
+// before it; the handler may also have closed the connection.
+static bool deliver_tagged(NetworkContext* ctx, NetworkConnection* conn,
+                           const uint8_t* p, size_t size, size_t* used) {
+    NetworkFrameHeader headers[AUTH_BATCH];
+    AuthFrame frames[AUTH_BATCH];
+    const uint8_t* tags[AUTH_BATCH];
+    size_t count = 0;
+    size_t offset = 0;
+    *used = 0;
+
+    while (count < AUTH_BATCH && size - offset >= NETWORK_FRAME_HEADER_SIZE) {
+        decode_frame_header(p + offset, &headers[count]);
+        if (headers[count].length > NETWORK_MAX_FRAME_SIZE) return false;
+
+        size_t frame_size = NETWORK_FRAME_HEADER_SIZE + headers[count].length;
+        if (size - offset < frame_size + AUTH_TAG_SIZE) break;
+
+        frames[count].data = p + offset;
+        frames[count].size = frame_size;
+        tags[count] = p + offset + frame_size;
+        offset += frame_size + AUTH_TAG_SIZE;
+        count++;
+    }
+    if (count == 0) return true;
+
+    size_t verified = auth_verify_batch(&conn->recv_key, conn->recv_seq, frames, count, tags);
+
+    NetworkHandle handle = network_get_handle(ctx, conn);
+    for (size_t i = 0; i < count; i++) {
+        if (i == verified) {
+            ctx->stats.auth_failures++;
+            return false;
+        }
+
+        conn->recv_seq++;
+        *used += frames[i].size + AUTH_TAG_SIZE;
+        if (!deliver_frame(ctx, conn, &headers[i], frames[i].data + NETWORK_FRAME_HEADER_SIZE)) {
+            return false;
+        }
+        if (network_resolve(ctx, handle) != conn) return true;
+    }
+    return true;
+}
+
+// Deliver every complete buffered frame, caller holds lock. Returns false
+// on a protocol error; the handler may also have closed the connection.
+static bool deliver_buffered(NetworkContext* ctx, NetworkConnection* conn) {
+    size_t offset = 0;
+    NetworkHandle handle = network_get_handle(ctx, conn);
+    while (conn->rx_length - offset >= NETWORK_FRAME_HEADER_SIZE) {
+        if (conn->auth) {
+            size_t used;
+            if (!deliver_tagged(ctx, conn, conn->rx_buffer + offset, conn->rx_length - offset, &used)) {
+                return false;
+            }
+            if (network_resolve(ctx, handle) != conn) return true;
+            if (used == 0) break;
+            offset += used;
+            continue;
+        }
+
+        NetworkFrameHeader header;
+        decode_frame_header(conn->rx_buffer + offset, &header);
+        if (header.length > NETWORK_MAX_FRAME_SIZE) return false;
+        if (conn->rx_length - offset < NETWORK_FRAME_HEADER_SIZE + header.length) break;
+
+        // Until frames are keyed only the peer's HELLO may arrive
+        if (ctx->auth_secret_size &&
+            !((header.flags & NET_FRAME_FLAG_CONTROL) && header.type == NET_CONTROL_HELLO)) {
+            ctx->stats.auth_failures++;
+            return false;
+        }
+
+        if (!deliver_frame(ctx, conn, &header, conn->rx_buffer + offset + NETWORK_FRAME_HEADER_SIZE)) {
+            return false;
+        }
+        offset += NETWORK_FRAME_HEADER_SIZE + header.length;
+
+        // Handler may have closed the connection
+        if (network_resolve(ctx, handle) != conn) return true;
+    }
+
+    if (offset > 0) {
+        memmove(conn->rx_buffer, conn->rx_buffer + offset, conn->rx_length - offset);
+        conn->rx_length -= offset;
+    }
+    return true;
+}
+
+// Read available transport bytes and deliver every complete frame, caller
+// holds lock. Returns false if the connection must be closed.
+static bool receive_frames(NetworkContext* ctx, NetworkConnection* conn) {
+    if (!reserve_rx(conn)) return false;
+
+    NetworkTransport* transport = ctx->transport;
+    ssize_t bytes = transport->read(transport, conn->socket, conn->rx_buffer + conn->rx_length,
+                                    conn->rx_capacity - conn->rx_length, conn);
+    if (bytes <= 0) {
+        return bytes < 0 && (SOCKET_ERROR_CODE == EAGAIN || SOCKET_ERROR_CODE == EINTR);
+    }
+
+    // After attaching, the socket only signals peer exit
+    if (conn->shm) return false;
+
+    conn->rx_length += (size_t)bytes;
+    conn->last_rx_ms = now_ms();
+    return deliver_buffered(ctx, conn);
+}
+
+// Connection whose peer sends datagrams from addr and port
+static NetworkConnection* datagram_peer(NetworkContext* ctx, uint32_t addr, uint16_t port) {
+    for (size_t i = 0; i < ctx->max_connections; i++) {
+        NetworkConnection* conn = &ctx->connections[i];
+        if (conn->is_active && conn->datagram_port == port && conn->datagram_addr == addr) {
+            return conn;
+        }
+    }
+    return NULL;
+}
+
+// Verify and deliver one datagram, caller holds lock. Returns false if
+// it was discarded.
+static bool deliver_datagram(NetworkContext* ctx, NetworkConnection* conn,
+                             const uint8_t* p, size_t size) {
+    if (size < NETWORK_FRAME_HEADER_SIZE) return false;
+
+    NetworkFrameHeader header;
+    decode_frame_header(p, &header);
+    size_t frame_size = NETWORK_FRAME_HEADER_SIZE + header.length;
+    size_t trailer = conn->auth ? DATAGRAM_TRAILER_SIZE : 0;
+    if (header.length > NETWORK_MAX_FRAME_SIZE || size != frame_size + trailer ||
+        (header.flags & (NET_FRAME_FLAG_CONTROL | NET_FRAME_FLAG_COMPRESSED | NET_FRAME_FLAG_RELIABLE))) {
+        return false;
+    }
+
+    // Replays, and datagrams overtaken by a newer one, fail here
+    if (conn->auth) {
+        uint64_t seq = get_u64le(p + frame_size);
+        AuthFrame frame = {p, frame_size};
+        const uint8_t* tag = p + frame_size + 8;
+        if (!(seq & DATAGRAM_SEQ_BIT) || seq <= conn->datagram_recv_seq ||
+            auth_verify_batch(&conn->recv_key, seq, &frame, 1, &tag) != 1) {
+            ctx->stats.auth_failures++;
+            return false;
+        }
+        conn->datagram_recv_seq = seq;
+    }
+
+    NetworkView view;
+    if (!unpack_view(ctx, conn, &header, p + NETWORK_FRAME_HEADER_SIZE, &view)) return false;
+
+    view.datagram = true;
+    ctx->stats.datagrams_received++;
+    handle_frame(ctx, &view);
+    return true;
+}
+
+// Drain waiting datagrams a batch per system call, caller holds lock.
+// Senders are matched to connections by address; strangers are dropped.
+static void receive_datagrams(NetworkContext* ctx) {
+    DatagramBatch* batch = ctx->datagram_rx;
+    for (int round = 0; round < DATAGRAM_POLL_BATCHES; round++) {
+        size_t count = datagram_receive(ctx->datagram_socket, batch);
+        for (size_t i = 0; i < count; i++) {
+            NetworkConnection* conn = datagram_peer(ctx, batch->addr[i], batch->port[i]);
+            if (!conn || !deliver_datagram(ctx, conn, batch->data[i], batch->size[i])) {
+                ctx->stats.datagrams_dropped++;
+            }
+        }
+        if (count < DATAGRAM_BATCH) break;
+    }
+}
+
+// Drain the shared-memory ring until empty and resume output blocked on
+// a full peer ring, caller holds lock. Returns false to close.
+static bool receive_shm(NetworkContext* ctx, NetworkConnection* conn) {
+    NetworkHandle handle = network_get_handle(ctx, conn);
+    shm_channel_drain(conn->shm);
+
+    NetworkIOThread* io = conn_shard(ctx, conn);
+    pthread_mutex_lock(&io->lock);
+    bool wake = conn->out_state == NET_OUT_BLOCKED && shm_channel_writable(conn->shm);
+    if (wake) {
+        conn->out_state = NET_OUT_PENDING;
+        wake = io->started;
+    }
+    pthread_mutex_unlock(&io->lock);
+    if (wake) {
+        io_wake(io);
+    }
+
+    for (;;) {
+        if (!reserve_rx(conn)) return false;
+        size_t bytes = shm_channel_read(conn->shm, conn->rx_buffer + conn->rx_length,
+                                        conn->rx_capacity - conn->rx_length);
+        if (bytes == 0) return true;
+
+        conn->rx_length += bytes;
+        conn->last_rx_ms = now_ms();
+        if (!deliver_buffered(ctx, conn)) return false;
+        if (network_resolve(ctx, handle) != conn) return true;
+    }
+}
+
+// Connection timer expiry; idle timers are re-armed lazily from
+// last_rx_ms so receiving a frame never touches the wheel. Peer redial
+// and session timers share the wheel.
+static void on_connection_timer(TimerEntry* entry, void* user_data) {
+    NetworkContext* ctx = user_data;
+    if ((char*)entry >= (char*)ctx->peers && (char*)entry < (char*)(ctx->peers + NETWORK_MAX_PEERS)) {
+        NetworkPeer* peer = &ctx->peers[((char*)entry - (char*)ctx->peers) / sizeof(NetworkPeer)];
+        if (peer->in_use && !network_resolve(ctx, peer->handle)) {
+            dial_peer(ctx, peer);
+        }
+        return;
+    }
+    if ((char*)entry >= (char*)ctx->sessions &&
+        (char*)entry < (char*)(ctx->sessions + ctx->max_connections)) {
+        size_t offset = (size_t)((char*)entry - (char*)ctx->sessions);
+        on_session_timer(ctx, &ctx->sessions[offset / sizeof(NetworkSession)], entry);
+        return;
+    }
+
+    size_t offset = (size_t)((char*)entry - (char*)ctx->connections);
+    NetworkConnection* conn = &ctx->connections[offset / sizeof(NetworkConnection)];
+    if (!conn->is_active) return;
+
+    uint64_t now = now_ms();
+    uint64_t quiet = now - conn->last_rx_ms;
+
+    if (entry == &conn->idle_timer) {
+        if (!conn->established || quiet >= ctx->idle_timeout_ms) {
+            ctx->stats.timeouts++;
+            handle_disconnect(ctx, conn);
+        } else {
+            timer_arm(&ctx->timers, entry, conn->last_rx_ms + ctx->idle_timeout_ms);
+        }
+    } else if (entry == &conn->heartbeat_timer) {
+        if (quiet >= ctx->heartbeat_ms) {
+            ctx->stats.pings_sent++;
+            send_buffer(ctx, conn, ctx->ping_frame);
+            timer_arm(&ctx->timers, entry, now + ctx->heartbeat_ms);
+        } else {
+            timer_arm(&ctx->timers, entry, conn->last_rx_ms + ctx->heartbeat_ms);
+        }
+    }
+}
+
+// Mark blocked connections the I/O threads cannot wait on themselves,
+// so the transport poll reports their writability
+static void collect_write_interest(NetworkContext* ctx) {
+    bool inline_io = ctx->io_thread_count == 0;
+    size_t shards = inline_io ? 1 : ctx->io_thread_count;
+
+    for (size_t s = 0; s < shards; s++) {
+        NetworkIOThread* io = &ctx->io_threads[s];
+        pthread_mutex_lock(&io->lock);
+        for (size_t i = 0; i < io->dirty_count; i++) {
+            NetworkConnection* conn = &ctx->connections[io->dirty[i]];
+            conn->want_write = conn->out_state == NET_OUT_BLOCKED && !conn->shm &&
+                               (inline_io || !ctx->transport->pollable);
+        }
+        pthread_mutex_unlock(&io->lock);
+    }
+}
+
+// Requeue blocked output whose transport became writable
+static void resume_writable(NetworkContext* ctx, NetworkConnection* conn) {
+    NetworkIOThread* io = conn_shard(ctx, conn);
+    bool wake = false;
+
+    pthread_mutex_lock(&io->lock);
+    if (conn->out_state == NET_OUT_BLOCKED) {
+        conn->out_state = NET_OUT_PENDING;
+        wake = io->started;
+    }
+    pthread_mutex_unlock(&io->lock);
+
+    if (wake) {
+        io_wake(io);
+    }
+}
+
+// Register fd with the poll set for events, or change its events.
+// Falls back to the other operation when registered is stale.
+static bool poll_register(NetworkContext* ctx, int fd, bool registered,
+                          uint32_t events, uint64_t key) {
+    struct epoll_event ev = {0};
+    ev.events = events;
+    ev.data.u64 = key;
+    if (epoll_ctl(ctx->poll_fd, registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev) == 0) {
+        return true;
+    }
+    if (errno == ENOENT) return epoll_ctl(ctx->poll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+    if (errno == EEXIST) return epoll_ctl(ctx->poll_fd, EPOLL_CTL_MOD, fd, &ev) == 0;
+    return false;
+}
+
+static void poll_register_listener(NetworkContext* ctx, int fd, uint32_t listener) {
+    if (fd == INVALID_SOCKET || (ctx->poll_listeners & listener)) return;
+    if (poll_register(ctx, fd, false, EPOLLIN, NET_POLL_KEY(NET_POLL_LISTENER, listener))) {
+        ctx->poll_listeners |= listener;
+    }
+}
+
+// Bring the poll set up to date with listeners, connections and write
+// interest. Only changes cost a system call. Caller holds lock.
+static void poll_sync(NetworkContext* ctx) {
+    if (!ctx->transport->pollable || ctx->poll_fd == INVALID_SOCKET) return;
+
+    poll_register_listener(ctx, ctx->server_socket, NET_LISTENER_SERVER);
+    poll_register_listener(ctx, ctx->unix_socket, NET_LISTENER_UNIX);
+    poll_register_listener(ctx, ctx->datagram_socket, NET_LISTENER_DATAGRAM);
+
+    for (size_t i = 0; i < ctx->max_connections; i++) {
+        NetworkConnection* conn = &ctx->connections[i];
+        if (!conn->is_active) continue;
+
+        uint32_t events = EPOLLIN | (conn->want_write ? EPOLLOUT : 0);
+        if (conn->poll_events != events &&
+            poll_register(ctx, conn->socket, conn->poll_events != 0, events,
+                          NET_POLL_KEY(NET_POLL_SOCKET, i))) {
+            conn->poll_events = events;
+        }
+        if (conn->shm && !conn->poll_shm) {
+            conn->poll_shm = poll_register(ctx, conn->shm->rx_event, false, EPOLLIN,
+                                           NET_POLL_KEY(NET_POLL_SHM, i));
+        }
+    }
+}
+
+// Poll for network activity
+static void poll_connections(NetworkContext* ctx) {
+    NetworkTransport* transport = ctx->transport;
+
+    pthread_mutex_lock(&ctx->lock);
+    for (size_t i = 0; i < ctx->max_connections; i++) {
+        ctx->connections[i].want_write = 0;
+        ctx->connections[i].ready = 0;
+    }
+    if (ctx->io_threads) {
+        collect_write_interest(ctx);
+    }
+    ctx->listen_ready = 0;
+    poll_sync(ctx);
+    pthread_mutex_unlock(&ctx->lock);
+
+    int activity = transport->poll(transport, ctx, ctx->poll_timeout_ms);
+    if (activity > 0) {
+        // Check for new connections
+        if (ctx->listen_ready & NET_LISTENER_SERVER) {
+            accept_connections(ctx, ctx->server_socket);
+        }
+        if (ctx->listen_ready & NET_LISTENER_UNIX) {
+            accept_connections(ctx, ctx->unix_socket);
+        }
+
+        // Check existing connections
+        pthread_mutex_lock(&ctx->lock);
+        if (ctx->listen_ready & NET_LISTENER_DATAGRAM) {
+            receive_datagrams(ctx);
+        }
+        for (size_t i = 0; i < ctx->max_connections; i++) {
+            NetworkConnection* conn = &ctx->connections[i];
+            uint8_t ready = conn->ready;
+            if (!conn->is_active || !ready) continue;
+
+            if (ready & NET_READY_WRITE) {
+                resume_writable(ctx, conn);
+            }
+            if ((ready & NET_READY_EVENT) && conn->shm && !receive_shm(ctx, conn)) {
+                handle_disconnect(ctx, conn);
+            }
+            if ((ready & NET_READY_READ) && conn->is_active && !receive_frames(ctx, conn)) {
+                handle_disconnect(ctx, conn);
+            }
+        }
+        pthread_mutex_unlock(&ctx->lock);
+    }
+
+    // Reap connections whose writes failed on an I/O thread
+    pthread_mutex_lock(&ctx->lock);
+    for (size_t i = 0; i < ctx->max_connections; i++) {
+        NetworkConnection* conn = &ctx->connections[i];
+        if (conn->is_active && __atomic_load_n(&conn->close_pending, __ATOMIC_ACQUIRE)) {
+            handle_disconnect(ctx, conn);
+        }
+    }
+
+    // Fire due timeouts and heartbeats
+    timer_wheel_advance(&ctx->timers, now_ms(), on_connection_timer, ctx);
+
+    // Callers waiting on poll_fd between runs must see the sockets
+    // admitted by this one
+    poll_sync(ctx);
+    pthread_mutex_unlock(&ctx->lock);
+
+    // Without I/O threads the poll loop flushes outbound queues itself
+    if (ctx->io_thread_count == 0 && ctx->io_threads) {
+        NetworkIOThread* io = &ctx->io_threads[0];
+        pthread_mutex_lock(&io->lock);
+        shard_flush(ctx, io);
+        pthread_mutex_unlock(&io->lock);
+    }
+}
+
+// Compressed copy of a data frame, NULL if its payload is under the
+// threshold or does not shrink. IDs stay plain for routing and
+// coalescing. Caller holds lock.
+static NetworkBuffer* compress_frame(NetworkContext* ctx, const NetworkBuffer* plain) {
+    size_t prefix = NETWORK_FRAME_HEADER_SIZE + (size_t)plain->data[6] + plain->data[7];
+    size_t payload = plain->size - prefix;
+    if (!ctx->compressor || payload < ctx->compress_threshold) return NULL;
+
+    size_t capacity = prefix + 4 + COMPRESS_BOUND(payload);
+    NetworkBuffer* buffer = malloc(sizeof(NetworkBuffer) + capacity);
+    if (!buffer) return NULL;
+
+    size_t packed = compress_block(ctx->compressor, plain->data + prefix, payload,
+                                   buffer->data + prefix + 4, capacity - prefix - 4);
+    if (packed == 0 || packed + 4 >= payload) {
+        free(buffer);
+        return NULL;
+    }
+
+    memcpy(buffer->data, plain->data, prefix);
+    put_u32le(buffer->data, (uint32_t)(prefix - NETWORK_FRAME_HEADER_SIZE + 4 + packed));
+    buffer->data[5] |= NET_FRAME_FLAG_COMPRESSED;
+    put_u32le(buffer->data + prefix, (uint32_t)payload);
+    buffer->refcount = 1;
+    buffer->size = (uint32_t)(prefix + 4 + packed);
+    buffer->key = plain->key;
+
+    // Give back the worst-case slack while the frame sits in queues
+    NetworkBuffer* shrunk = realloc(buffer, sizeof(NetworkBuffer) + buffer->size);
+    if (shrunk) buffer = shrunk;
+
+    ctx->stats.frames_compressed++;
+    ctx->stats.compress_saved += plain->size - buffer->size;
+    return buffer;
+}
+
+// Encodings of one message: plain, and compressed once a peer wants it
+typedef struct {
+    NetworkBuffer* plain;        // Plain frame
+    NetworkBuffer* packed;       // Compressed frame, NULL if not built or not smaller
+    bool tried;                  // Compression attempted
+} NetworkFrames;
+
+// Frame to queue on conn, caller holds lock
+static NetworkBuffer* frame_for(NetworkContext* ctx, const NetworkConnection* conn,
+                                NetworkFrames* frames) {
+    if (!(conn->features & NET_FEATURE_COMPRESSION)) return frames->plain;
+
+    if (!frames->tried) {
+        frames->tried = true;
+        frames->packed = compress_frame(ctx, frames->plain);
+    }
+    return frames->packed ? frames->packed : frames->plain;
+}
+
+// Queue frame on one connection and flush it from the caller when the
+// queue was empty, so unicast latency stays a single send. Caller holds lock.
+static bool send_buffer(NetworkContext* ctx, NetworkConnection* conn, NetworkBuffer* buffer) {
+    NetworkIOThread* io = conn_shard(ctx, conn);
+    bool queued;
+
+    pthread_mutex_lock(&io->lock);
+    bool dirty = is_control_frame(buffer) ? out_enqueue_control(io, conn, buffer, &queued)
+                                          : out_enqueue(io, conn, buffer, &queued);
+    if (dirty) {
+        conn->out_state = flush_connection(io, conn);
+        dirty = conn->out_state == NET_OUT_BLOCKED;
+    }
+    if (!queued) {
+        ctx->stats.frames_dropped++;
+    }
+    pthread_mutex_unlock(&io->lock);
+
+    if (dirty) {
+        io_wake(io);
+    }
+    return queued;
+}
+
+// Send message to specific node
+bool network_send(NetworkContext* ctx, const char* node_id, NetworkMessage* msg) {
+    if (!ctx || !node_id || !msg || !ctx->io_threads) return false;
+
+    NetworkBuffer* buffer = network_buffer_encode(msg);
+    if (!buffer) return false;
+
+    NetworkFrames frames = {buffer, NULL, false};
+    bool sent = false;
+    pthread_mutex_lock(&ctx->lock);
+
+    NetworkConnection* conn = network_find_node(ctx, node_id);
+    if (conn) {
+        sent = send_buffer(ctx, conn, frame_for(ctx, conn, &frames));
+    }
+
+    pthread_mutex_unlock(&ctx->lock);
+    network_buffer_release(frames.packed);
+    network_buffer_release(buffer);
+    return sent;
 }
 
-// Helper to set socket options
-static bool set_socket_options(socket_t sock) {
-    int yes = 1;
-    if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (void*)&yes, sizeof(yes)) == -1) {
-        return false;
+// Broadcast message to all nodes. The frame is serialized once and a
+// reference queued on every connection; each I/O thread then writes its
+// own shard. Without I/O threads each connection is flushed here and
+// counted delivered once the frame is off its queue. Returns false if any
+// target had to be dropped.
+bool network_broadcast(NetworkContext* ctx, NetworkMessage* msg, NetworkBroadcastResult* result) {
+    NetworkBroadcastResult counts = {0};
+    if (result) *result = counts;
+    if (!ctx || !msg || !ctx->io_threads) return false;
+
+    NetworkBuffer* buffer = network_buffer_encode(msg);
+    if (!buffer) return false;
+
+    NetworkFrames frames = {buffer, NULL, false};
+    size_t shards = ctx->io_thread_count ? ctx->io_thread_count : 1;
+    pthread_mutex_lock(&ctx->lock);
+
+    for (size_t s = 0; s < shards; s++) {
+        NetworkIOThread* io = &ctx->io_threads[s];
+        bool wake = false;
+
+        pthread_mutex_lock(&io->lock);
+        for (size_t i = s; i < ctx->max_connections; i += shards) {
+            NetworkConnection* conn = &ctx->connections[i];
+            if (!conn->is_active) continue;
+
+            bool queued;
+            NetworkBuffer* frame = frame_for(ctx, conn, &frames);
+            wake |= out_enqueue(io, conn, frame, &queued);
+            if (!queued) {
+                counts.dropped++;
+                continue;
+            }
+
+            // Inline mode writes here, reporting whether our frame left
+            if (!io->started && conn->out_state == NET_OUT_PENDING) {
+                conn->out_state = flush_connection(io, conn);
+            }
+            if (!io->started && out_written(conn, frame)) {
+                counts.delivered++;
+            } else {
+                counts.queued++;
+            }
+        }
+
+        // Settle the dirty list, flushing frames left from earlier sends
+        if (!io->started) {
+            shard_flush(ctx, io);
+        }
+        pthread_mutex_unlock(&io->lock);
+
+        if (wake) {
+            io_wake(io);
+        }
     }
-    
-    struct linger ling = {0, 0}; // Disable linger
-    if (setsockopt(sock, SOL_SOCKET, SO_LINGER, (void*)&ling, sizeof(ling)) == -1) {
-        return false;
+
+    ctx->stats.frames_dropped += counts.dropped;
+    pthread_mutex_unlock(&ctx->lock);
+    network_buffer_release(frames.packed);
+    network_buffer_release(buffer);
+
+    if (result) *result = counts;
+    return counts.dropped == 0;
+}
+
+// Get generation-tagged handle for connection
+NetworkHandle network_get_handle(NetworkContext* ctx, const NetworkConnection* conn) {
+    if (!ctx || !conn || !conn->is_active) return NETWORK_INVALID_HANDLE;
+
+    uint64_t index = (uint64_t)(conn - ctx->connections);
+    return ((uint64_t)conn->generation << 32) | index;
+}
+
+// Resolve handle to its connection, NULL if the slot was released since
+NetworkConnection* network_resolve(NetworkContext* ctx, NetworkHandle handle) {
+    if (!ctx || handle == NETWORK_INVALID_HANDLE) return NULL;
+
+    uint32_t index = (uint32_t)handle;
+    uint32_t generation = (uint32_t)(handle >> 32);
+    if (index >= ctx->max_connections) return NULL;
+
+    NetworkConnection* conn = &ctx->connections[index];
+    if (!conn->is_active || conn->generation != generation) return NULL;
+    return conn;
+}
+
+// Send a frame over the connection identified by handle, releasing the
+// caller's reference
+static bool send_frame(NetworkContext* ctx, NetworkHandle handle, NetworkBuffer* buffer) {
+    if (!buffer) return false;
+
+    NetworkFrames frames = {buffer, NULL, false};
+    bool sent = false;
+    pthread_mutex_lock(&ctx->lock);
+
+    NetworkConnection* conn = network_resolve(ctx, handle);
+    if (conn) {
+        sent = send_buffer(ctx, conn, frame_for(ctx, conn, &frames));
     }
-    
-    return true;
+
+    pthread_mutex_unlock(&ctx->lock);
+    network_buffer_release(frames.packed);
+    network_buffer_release(buffer);
+    return sent;
 }
 
-// Create network context
-NetworkContext* network_create(uint16_t port) {
-    NetworkContext* ctx = calloc(1, sizeof(NetworkContext));
-    if (!ctx) return NULL;
+// Send message over connection identified by handle
+bool network_send_handle(NetworkContext* ctx, NetworkHandle handle, NetworkMessage* msg) {
+    if (!ctx || !msg || !ctx->io_threads) return false;
+    return send_frame(ctx, handle, network_buffer_encode(msg));
+}
 
-    ctx->port = port;
-    ctx->max_connections = MAX_CONNECTIONS;
-    ctx->connections = calloc(ctx->max_connections, sizeof(NetworkConnection));
-    if (!ctx->connections) {
-        free(ctx);
-        return NULL;
+// Send a frame reliably over connection identified by handle
+static bool send_reliable(NetworkContext* ctx, NetworkHandle handle, const NetworkView* view) {
+    pthread_mutex_lock(&ctx->lock);
+    NetworkConnection* conn = network_resolve(ctx, handle);
+    if (!conn || conn->session < 0) {
+        bool sent = conn && send_frame(ctx, handle, encode_frame(view, 0));
+        pthread_mutex_unlock(&ctx->lock);
+        return sent;
     }
 
-    if (pthread_mutex_init(&ctx->lock, NULL) != 0) {
-        free(ctx->connections);
-        free(ctx);
-        return NULL;
+    // Held frames must fit every connection the session may move to
+    NetworkSession* session = &ctx->sessions[conn->session];
+    NetworkBuffer* buffer = encode_frame(view, NETWORK_RELIABLE_SIZE);
+    uint32_t seq;
+    bool held = buffer && buffer->size - NETWORK_FRAME_HEADER_SIZE <= conn->max_frame &&
+                reliable_push(&session->send, buffer, &seq);
+
+    if (held) {
+        buffer->data[5] |= NET_FRAME_FLAG_RELIABLE;
+        put_u32le(buffer->data + NETWORK_FRAME_HEADER_SIZE + buffer->data[6] + buffer->data[7], seq);
+        ctx->stats.reliable_sent++;
+        session_pump(ctx, session);
+    } else {
+        network_buffer_release(buffer);
+        ctx->stats.frames_dropped++;
     }
+    pthread_mutex_unlock(&ctx->lock);
+    return held;
+}
 
-#ifdef _WIN32
-    WSADATA wsa_data;
-    if (WSAStartup(MAKEWORD(2,2), &wsa_data) != 0) {
-        free(ctx->connections);
-        free(ctx);
-        return NULL;
+// Send message reliably over connection identified by handle
+bool network_send_reliable(NetworkContext* ctx, NetworkHandle handle, NetworkMessage* msg) {
+    if (!ctx || !msg || !ctx->io_threads) return false;
+
+    NetworkView view;
+    message_view(msg, &view);
+    return send_reliable(ctx, handle, &view);
+}
+
+// Dial host:port once. Returns the connection's handle, or
+// NETWORK_INVALID_HANDLE if it could not be started; a connection still
+// in progress that later fails is reported through the disconnect handler.
+NetworkHandle network_connect(NetworkContext* ctx, const char* host, uint16_t port) {
+    if (!ctx) return NETWORK_INVALID_HANDLE;
+
+    pthread_mutex_lock(&ctx->lock);
+    NetworkHandle handle = network_get_handle(ctx, dial(ctx, host, port, -1));
+    pthread_mutex_unlock(&ctx->lock);
+    return handle;
+}
+
+// Hand a batch of datagrams to the kernel, caller holds lock
+static size_t flush_datagrams(NetworkContext* ctx, const DatagramOut* out, size_t count) {
+    size_t sent = count ? datagram_send(ctx->datagram_socket, out, count) : 0;
+    ctx->stats.datagrams_sent += sent;
+    ctx->stats.datagrams_dropped += count - sent;
+    return sent;
+}
+
+// Send a frame to each handle, as a datagram where the peer has the
+// channel and over its connection otherwise, releasing the caller's
+// reference. Returns the connections it was sent or queued to.
+static size_t send_unreliable(NetworkContext* ctx, const NetworkHandle* handles,
+                              size_t count, NetworkBuffer* buffer) {
+    if (!buffer) return 0;
+
+    DatagramOut out[DATAGRAM_BATCH];
+    uint8_t trailers[DATAGRAM_BATCH][DATAGRAM_TRAILER_SIZE];
+    NetworkFrames frames = {buffer, NULL, false};
+    bool fits = buffer->size + DATAGRAM_TRAILER_SIZE <= DATAGRAM_MAX_SIZE;
+    size_t pending = 0;
+    size_t sent = 0;
+
+    pthread_mutex_lock(&ctx->lock);
+    for (size_t i = 0; i < count; i++) {
+        NetworkConnection* conn = network_resolve(ctx, handles[i]);
+        if (!conn) continue;
+
+        if (!fits || !conn->datagram_port || ctx->datagram_socket == INVALID_SOCKET) {
+            sent += send_buffer(ctx, conn, frame_for(ctx, conn, &frames)) ? 1 : 0;
+            continue;
+        }
+
+        DatagramOut* d = &out[pending];
+        d->addr = conn->datagram_addr;
+        d->port = conn->datagram_port;
+        d->frame = buffer->data;
+        d->frame_size = buffer->size;
+        d->trailer = NULL;
+        d->trailer_size = 0;
+        if (conn->auth) {
+            uint64_t seq = DATAGRAM_SEQ_BIT | ++conn->datagram_send_seq;
+            put_u64le(trailers[pending], seq);
+            auth_sign(&conn->send_key, seq, buffer->data, buffer->size, trailers[pending] + 8);
+            d->trailer = trailers[pending];
+            d->trailer_size = DATAGRAM_TRAILER_SIZE;
+        }
+
+        if (++pending == DATAGRAM_BATCH) {
+            sent += flush_datagrams(ctx, out, pending);
+            pending = 0;
+        }
     }
-#endif
+    sent += flush_datagrams(ctx, out, pending);
 
-    return ctx;
+    pthread_mutex_unlock(&ctx->lock);
+    network_buffer_release(frames.packed);
+    network_buffer_release(buffer);
+    return sent;
 }
 
-// Start network server
-bool network_start(NetworkContext* ctx) {
-    if (!ctx) return false;
+// Send msg to each handle unreliably
+size_t network_send_unreliable(NetworkContext* ctx, const NetworkHandle* handles,
+                               size_t count, NetworkMessage* msg) {
+    if (!ctx || !handles || !msg || !ctx->io_threads) return 0;
+    return send_unreliable(ctx, handles, count, network_buffer_encode(msg));
+}
 
-    // Create server socket
-    ctx->server_socket = socket(AF_INET, SOCK_STREAM, 0);
-    if (ctx->server_socket == INVALID_SOCKET) {
-        return false;
+// Send a received frame on with the delivery it arrived with. The frame
+// is encoded straight from the view, so its payload is copied once, into
+// the outgoing buffer.
+bool network_forward(NetworkContext* ctx, NetworkHandle handle, const NetworkView* view) {
+    if (!ctx || !view || !ctx->io_threads) return false;
+
+    if (view->datagram) {
+        return send_unreliable(ctx, &handle, 1, encode_frame(view, 0)) == 1;
     }
+    if (view->reliable) {
+        return send_reliable(ctx, handle, view);
+    }
+    return send_frame(ctx, handle, encode_frame(view, 0));
+}
 
-    // Set socket options
-    if (!set_socket_options(ctx->server_socket) || !set_nonblocking(ctx->server_socket)) {
-        CLOSE_SOCKET(ctx->server_socket);
-        return false;
+// Find a registered peer, caller holds lock
+static NetworkPeer* find_peer(NetworkContext* ctx, const char* host, uint16_t port) {
+    for (size_t i = 0; i < NETWORK_MAX_PEERS; i++) {
+        NetworkPeer* peer = &ctx->peers[i];
+        if (peer->in_use && peer->port == port && strcmp(peer->host, host) == 0) {
+            return peer;
+        }
     }
+    return NULL;
+}
 
-    // Bind socket
-    struct sockaddr_in server_addr = {0};
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(ctx->port);
+// Keep a connection to host:port, dialing from the next poll and
+// redialing after every drop. Adding a registered peer is a no-op.
+bool network_add_peer(NetworkContext* ctx, const char* host, uint16_t port) {
+    if (!ctx || !host || strlen(host) >= sizeof(ctx->peers[0].host)) return false;
 
-    if (bind(ctx->server_socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) == -1) {
-        CLOSE_SOCKET(ctx->server_socket);
-        return false;
+    pthread_mutex_lock(&ctx->lock);
+    bool added = find_peer(ctx, host, port) != NULL;
+    for (size_t i = 0; i < NETWORK_MAX_PEERS && !added; i++) {
+        NetworkPeer* peer = &ctx->peers[i];
+        if (peer->in_use) continue;
+
+        strcpy(peer->host, host);
+        peer->port = port;
+        peer->handle = NETWORK_INVALID_HANDLE;
+        peer->backoff_ms = ctx->reconnect_min_ms;
+        peer->in_use = true;
+        if (ctx->io_threads) {
+            timer_arm(&ctx->timers, &peer->retry_timer, now_ms());
+        }
+        added = true;
     }
+    pthread_mutex_unlock(&ctx->lock);
+    return added;
+}
 
-    // Listen for connections
-    if (listen(ctx->server_socket, MAX_BACKLOG) == -1) {
-        CLOSE_SOCKET(ctx->server_socket);
-        return false;
+// Stop redialing a peer and close its connection
+bool network_remove_peer(NetworkContext* ctx, const char* host, uint16_t port) {
+    if (!ctx || !host) return false;
+
+    pthread_mutex_lock(&ctx->lock);
+    NetworkPeer* peer = find_peer(ctx, host, port);
+    if (peer) {
+        peer->in_use = false;
+        timer_cancel(&ctx->timers, &peer->retry_timer);
+        NetworkConnection* conn = network_resolve(ctx, peer->handle);
+        peer->handle = NETWORK_INVALID_HANDLE;
+        if (conn) {
+            conn->peer_slot = -1;
+            handle_disconnect(ctx, conn);
+        }
     }
+    pthread_mutex_unlock(&ctx->lock);
+    return peer != NULL;
+}
 
-    return true;
+// Set the first redial delay and its cap in milliseconds. Applies from
+// each peer's next connection.
+void network_set_reconnect(NetworkContext* ctx, uint32_t min_ms, uint32_t max_ms) {
+    if (!ctx || !min_ms || max_ms < min_ms) return;
+
+    pthread_mutex_lock(&ctx->lock);
+    ctx->reconnect_min_ms = min_ms;
+    ctx->reconnect_max_ms = max_ms;
+    pthread_mutex_unlock(&ctx->lock);
 }
 
-// Accept new connection
-static bool accept_connection(NetworkContext* ctx) {
-    struct sockaddr_in client_addr;
-    socklen_t addr_len = sizeof(client_addr);
-    
-    socket_t client_sock = accept(ctx->server_socket, (struct sockaddr*)&client_addr, &addr_len);
-    if (client_sock == INVALID_SOCKET) {
-        return false;
+// Fill handles with connections that completed a handshake, up to max.
+// Returns how many were written.
+size_t network_get_handles(NetworkContext* ctx, NetworkHandle* handles, size_t max) {
+    if (!ctx || !handles) return 0;
+
+    size_t count = 0;
+    pthread_mutex_lock(&ctx->lock);
+    for (size_t i = 0; i < ctx->max_connections && count < max; i++) {
+        NetworkConnection* conn = &ctx->connections[i];
+        if (conn->is_active && conn->negotiated) {
+            handles[count++] = network_get_handle(ctx, conn);
+        }
     }
+    pthread_mutex_unlock(&ctx->lock);
+    return count;
+}
+
+// Send the attach frame with the channel's memfd and eventfds. The server
+// echoes the frame as the first one on the channel, or closes the socket.
+bool network_offer_shm(int socket, const ShmChannel* channel) {
+    if (socket < 0 || !channel || !channel->base) return false;
+
+    uint8_t frame[NETWORK_FRAME_HEADER_SIZE] = {0};
+    frame[4] = NET_CONTROL_SHM_ATTACH;
+    frame[5] = NET_FRAME_FLAG_CONTROL;
+
+    // Server maps rings from (memfd, client event, server event)
+    int fds[3] = {channel->mem_fd, channel->rx_event, channel->tx_event};
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(fds))];
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct iovec iov = {frame, sizeof(frame)};
+    struct msghdr hdr = {0};
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control.buf;
+    hdr.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
 
-    // Set client socket non-blocking
-    if (!set_nonblocking(client_sock)) {
-        CLOSE_SOCKET(client_sock);
+    return sendmsg(socket, &hdr, MSG_NOSIGNAL) == (ssize_t)sizeof(frame);
+}
+
+// Bind node ID to connection, replacing any previous binding of either
+bool network_bind_node(NetworkContext* ctx, NetworkConnection* conn, const char* node_id) {
+    if (!ctx || !conn || !node_id || !node_id[0]) return false;
+    if (strlen(node_id) >= sizeof(conn->node_id)) return false;
+
+    pthread_mutex_lock(&ctx->lock);
+
+    if (!conn->is_active) {
+        pthread_mutex_unlock(&ctx->lock);
         return false;
     }
 
-    // Find free connection slot
+    // A node reconnecting takes over its ID from the stale connection
+    uint32_t hash = hash_node_id(node_id);
+    int32_t slot = index_lookup(ctx, node_id, hash);
+    if (slot >= 0) {
+        NetworkConnection* previous = &ctx->connections[ctx->node_index.entries[slot].conn_index];
+        index_remove(ctx, previous);
+        previous->node_id[0] = '\0';
+    }
+
+    index_remove(ctx, conn);
+    strcpy(conn->node_id, node_id);
+    conn->index_slot = index_insert(ctx, hash, (int32_t)(conn - ctx->connections));
+
+    pthread_mutex_unlock(&ctx->lock);
+    return true;
+}
+
+// Remove node ID binding from connection
+void network_unbind_node(NetworkContext* ctx, NetworkConnection* conn) {
+    if (!ctx || !conn) return;
+
+    pthread_mutex_lock(&ctx->lock);
+    index_remove(ctx, conn);
+    conn->node_id[0] = '\0';
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+// Find active connection bound to node ID
+NetworkConnection* network_find_node(NetworkContext* ctx, const char* node_id) {
+    if (!ctx || !node_id || !node_id[0]) return NULL;
+
     pthread_mutex_lock(&ctx->lock);
     NetworkConnection* conn = NULL;
-    for (size_t i = 0; i < ctx->max_connections; i++) {
-        if (!ctx->connections[i].is_active) {
-            conn = &ctx->connections[i];
-            conn->socket = client_sock;
-            conn->is_active = true;
-            ctx->active_connections++;
-            break;
-        }
+    int32_t slot = index_lookup(ctx, node_id, hash_node_id(node_id));
+    if (slot >= 0) {
+        conn = &ctx->connections[ctx->node_index.entries[slot].conn_index];
     }
     pthread_mutex_unlock(&ctx->lock);
 
-    if (!conn) {
-        CLOSE_SOCKET(client_sock);
-        return false;
-    }
+    return conn;
+}
 
-    // Notify connection handler
-    if (ctx->connect_handler) {
-        ctx->connect_handler(ctx, conn);
-    }
+// Set listen backlog, applied on next network_start
+void network_set_backlog(NetworkContext* ctx, size_t backlog) {
+    if (ctx && backlog > 0) ctx->backlog = backlog;
+}
 
+// Set AF_UNIX listener path for same-host clients, applied on next
+// network_start. NULL or empty disables it.
+bool network_set_unix_path(NetworkContext* ctx, const char* path) {
+    if (!ctx) return false;
+    if (!path) path = "";
+    if (strlen(path) >= sizeof(ctx->unix_path)) return false;
+
+    strcpy(ctx->unix_path, path);
     return true;
 }
 
-// Handle disconnection
-static void handle_disconnect(NetworkContext* ctx, NetworkConnection* conn) {
-    if (!conn->is_active) return;
+// Select transport backend, NULL restores sockets. Only effective while
+// the network is stopped. Encrypting transports offer NET_FEATURE_ENCRYPTION.
+bool network_set_transport(NetworkContext* ctx, NetworkTransport* transport) {
+    if (!ctx || ctx->io_threads) return false;
 
-    // Notify disconnect handler
-    if (ctx->disconnect_handler) {
-        ctx->disconnect_handler(ctx, conn);
+    ctx->transport = transport ? transport : network_socket_transport();
+    if (ctx->transport != network_socket_transport()) {
+        ctx->datagram_enabled = false;
     }
+    if (ctx->transport->encrypted) {
+        ctx->features |= NET_FEATURE_ENCRYPTION;
+    } else {
+        ctx->features &= ~(uint32_t)NET_FEATURE_ENCRYPTION;
+    }
+    return true;
+}
+
+// Offer the datagram channel from the next start. Only the plain socket
+// transport can carry it.
+bool network_set_datagram(NetworkContext* ctx, bool enabled) {
+    if (!ctx || ctx->io_threads) return false;
+    if (enabled && ctx->transport != network_socket_transport()) return false;
+
+    ctx->datagram_enabled = enabled;
+    return true;
+}
+
+// Set number of I/O threads, 0 flushes from the poll loop. Only
+// effective while the network is stopped.
+void network_set_io_threads(NetworkContext* ctx, size_t count) {
+    if (ctx && !ctx->io_threads) ctx->io_thread_count = count;
+}
+
+// Set idle timeout, heartbeat interval and handshake deadline in
+// milliseconds, 0 disables each. Applies to connections accepted later.
+void network_set_timeouts(NetworkContext* ctx, uint32_t idle_ms,
+                          uint32_t heartbeat_ms, uint32_t handshake_ms) {
+    if (!ctx) return;
 
     pthread_mutex_lock(&ctx->lock);
-    CLOSE_SOCKET(conn->socket);
-    conn->is_active = false;
-    conn->socket = INVALID_SOCKET;
-    ctx->active_connections--;
+    ctx->idle_timeout_ms = idle_ms;
+    ctx->heartbeat_ms = heartbeat_ms;
+    ctx->handshake_timeout_ms = handshake_ms;
     pthread_mutex_unlock(&ctx->lock);
 }
 
-// Poll for network activity
-static void poll_connections(NetworkContext* ctx) {
-    fd_set readfds;
-    struct timeval tv = {0, 100000}; // 100ms timeout
-    socket_t max_fd = ctx->server_socket;
+// Set outbound byte budgets and what happens to peers exceeding them
+void network_set_outbound_limits(NetworkContext* ctx, size_t conn_bytes,
+                                 size_t total_bytes, NetworkSlowPolicy policy) {
+    if (!ctx || !conn_bytes || !total_bytes) return;
 
-    FD_ZERO(&readfds);
-    FD_SET(ctx->server_socket, &readfds);
+    pthread_mutex_lock(&ctx->lock);
+    ctx->max_conn_outbound = conn_bytes;
+    ctx->max_outbound = total_bytes;
+    ctx->slow_policy = policy;
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+// Set receive window offered in handshakes, 0 offers none. Applies to
+// peers that negotiate flow control after the call.
+void network_set_flow_window(NetworkContext* ctx, uint32_t window) {
+    if (!ctx) return;
 
-    // Add active connections to set
     pthread_mutex_lock(&ctx->lock);
-    for (size_t i = 0; i < ctx->max_connections; i++) {
-        if (ctx->connections[i].is_active) {
-            FD_SET(ctx->connections[i].socket, &readfds);
-            if (ctx->connections[i].socket > max_fd) {
-                max_fd = ctx->connections[i].socket;
-            }
-        }
-    }
+    ctx->flow_window = window;
     pthread_mutex_unlock(&ctx->lock);
+}
 
-    int activity = select(max_fd + 1, &readfds, NULL, NULL, &tv);
-    if (activity > 0) {
-        // Check for new connections
-        if (FD_ISSET(ctx->server_socket, &readfds)) {
-            accept_connection(ctx);
-        }
+// Set feature bits offered in handshakes. Authentication is only
+// offered once network_set_auth_key has configured a secret.
+void network_set_features(NetworkContext* ctx, uint32_t features) {
+    if (!ctx) return;
 
-        // Check existing connections
-        pthread_mutex_lock(&ctx->lock);
-        for (size_t i = 0; i < ctx->max_connections; i++) {
-            NetworkConnection* conn = &ctx->connections[i];
-            if (conn->is_active && FD_ISSET(conn->socket, &readfds)) {
-                char buffer[BUFFER_SIZE];
-                ssize_t bytes = recv(conn->socket, buffer, sizeof(buffer) - 1, 0);
-
-                if (bytes <= 0) {
-                    handle_disconnect(ctx, conn);
-                } else if (ctx->message_handler) {
-                    NetworkMessage msg = {
-                        .type = MSG_DATA,
-                        .data_size = bytes
-                    };
-                    memcpy(msg.data, buffer, bytes);
-                    ctx->message_handler(ctx, &msg);
-                }
-            }
-        }
-        pthread_mutex_unlock(&ctx->lock);
+    pthread_mutex_lock(&ctx->lock);
+    if (!ctx->auth_secret_size) {
+        features &= ~(uint32_t)NET_FEATURE_AUTH;
     }
+    ctx->features = features;
+    pthread_mutex_unlock(&ctx->lock);
 }
 
-// Send message to specific node
-bool network_send(NetworkContext* ctx, const char* node_id, NetworkMessage* msg) {
-    if (!ctx || !node_id || !msg) return false;
+// Compress data frames whose payload is at least threshold bytes for
+// peers that negotiate compression, 0 disables. Peers must configure the
+// same dictionary (copied here), or compression is not negotiated with
+// them. Call before network_start.
+bool network_set_compression(NetworkContext* ctx, uint32_t threshold,
+                             const void* dictionary, size_t size) {
+    if (!ctx || (size > 0 && !dictionary)) return false;
 
-    bool sent = false;
-    pthread_mutex_lock(&ctx->lock);
-    
-    for (size_t i = 0; i < ctx->max_connections; i++) {
-        NetworkConnection* conn = &ctx->connections[i];
-        if (conn->is_active && strcmp(conn->node_id, node_id) == 0) {
-            ssize_t result = send(conn->socket, msg->data, msg->data_size, 0);
-            sent = (result == msg->data_size);
-            break;
+    CompressContext* compressor = NULL;
+    uint8_t* copy = NULL;
+    if (threshold > 0) {
+        compressor = malloc(sizeof(CompressContext));
+        copy = size > 0 ? malloc(size) : NULL;
+        if (!compressor || (size > 0 && !copy)) {
+            free(compressor);
+            free(copy);
+            return false;
         }
+        if (size > 0) memcpy(copy, dictionary, size);
+        compress_init(compressor);
+        compress_set_dictionary(compressor, copy, size);
     }
 
+    pthread_mutex_lock(&ctx->lock);
+    free(ctx->compressor);
+    free(ctx->dictionary);
+    ctx->compressor = compressor;
+    ctx->dictionary = copy;
+    ctx->compress_threshold = threshold;
+    if (compressor) {
+        ctx->features |= NET_FEATURE_COMPRESSION;
+    } else {
+        ctx->features &= ~(uint32_t)NET_FEATURE_COMPRESSION;
+    }
     pthread_mutex_unlock(&ctx->lock);
-    return sent;
+    return true;
 }
 
-// Broadcast message to all nodes
-bool network_broadcast(NetworkContext* ctx, NetworkMessage* msg) {
-    if (!ctx || !msg) return false;
+// Require peers to tag every frame with keys derived from secret, shared
+// by all nodes; NULL disables. Peers without it are refused at the
+// handshake. Call before network_start.
+bool network_set_auth_key(NetworkContext* ctx, const void* secret, size_t size) {
+    if (!ctx || (secret && (size < AUTH_MIN_SECRET || size > AUTH_MAX_SECRET))) return false;
 
     pthread_mutex_lock(&ctx->lock);
-    
-    for (size_t i = 0; i < ctx->max_connections; i++) {
-        NetworkConnection* conn = &ctx->connections[i];
-        if (conn->is_active) {
-            send(conn->socket, msg->data, msg->data_size, 0);
-        }
+    memset(ctx->auth_secret, 0, sizeof(ctx->auth_secret));
+    ctx->auth_secret_size = secret ? size : 0;
+    if (secret) {
+        memcpy(ctx->auth_secret, secret, size);
+        ctx->features |= NET_FEATURE_AUTH;
+    } else {
+        ctx->features &= ~(uint32_t)NET_FEATURE_AUTH;
     }
-
     pthread_mutex_unlock(&ctx->lock);
     return true;
 }
 
+// Copy runtime statistics
+void network_get_stats(NetworkContext* ctx, NetworkStats* stats) {
+    if (!ctx || !stats) return;
+
+    pthread_mutex_lock(&ctx->lock);
+    *stats = ctx->stats;
+    stats->outbound_bytes = __sync_add_and_fetch(&ctx->outbound_bytes, 0);
+
+    size_t shards = ctx->io_thread_count ? ctx->io_thread_count : 1;
+    for (size_t i = 0; ctx->io_threads && i < shards; i++) {
+        NetworkIOThread* io = &ctx->io_threads[i];
+        pthread_mutex_lock(&io->lock);
+        stats->frames_sent += io->frames_sent;
+        stats->bytes_sent += io->bytes_sent;
+        stats->send_errors += io->send_errors;
+        stats->frames_evicted += io->frames_evicted;
+        stats->frames_coalesced += io->frames_coalesced;
+        stats->slow_disconnects += io->slow_disconnects;
+        stats->credit_stalls += io->credit_stalls;
+        pthread_mutex_unlock(&io->lock);
+    }
+    pthread_mutex_unlock(&ctx->lock);
+}
+
 // Set message handler
 void network_set_message_handler(NetworkContext* ctx, MessageHandler handler) {
     if (ctx) ctx->message_handler = handler;
 }
 
+// Set view handler
+void network_set_view_handler(NetworkContext* ctx, ViewHandler handler) {
+    if (ctx) ctx->view_handler = handler;
+}
+
 // Set connection handler
 void network_set_connect_handler(NetworkContext* ctx, ConnectionHandler handler) {
     if (ctx) ctx->connect_handler = handler;
@@ -290,22 +3090,55 @@ void network_set_disconnect_handler(NetworkContext* ctx, ConnectionHandler handl
 void network_stop(NetworkContext* ctx) {
     if (!ctx) return;
 
+    // Stop I/O threads first so nothing writes to closing sockets
+    io_stop(ctx);
+
     pthread_mutex_lock(&ctx->lock);
     
     // Close client connections
     for (size_t i = 0; i < ctx->max_connections; i++) {
+        timer_cancel(&ctx->timers, &ctx->connections[i].idle_timer);
+        timer_cancel(&ctx->timers, &ctx->connections[i].heartbeat_timer);
+        ctx->connections[i].established = false;
+        ctx->connections[i].rx_length = 0;
+        ctx->connections[i].close_pending = false;
         if (ctx->connections[i].is_active) {
-            CLOSE_SOCKET(ctx->connections[i].socket);
+            release_local(&ctx->connections[i]);
+            ctx->transport->close(ctx->transport, ctx->connections[i].socket);
             ctx->connections[i].is_active = false;
+            ctx->connections[i].socket = INVALID_SOCKET;
+            ctx->connections[i].node_id[0] = '\0';
+            ctx->connections[i].index_slot = -1;
+            ctx->connections[i].peer_slot = -1;
+            ctx->connections[i].session = -1;
+            if (++ctx->connections[i].generation == 0) {
+                ctx->connections[i].generation = 1;
+            }
         }
     }
+    ctx->active_connections = 0;
+    index_rebuild(ctx);
+    slots_init(ctx);
+
+    // Peers stay registered and are redialed on the next start
+    for (size_t i = 0; i < NETWORK_MAX_PEERS; i++) {
+        timer_cancel(&ctx->timers, &ctx->peers[i].retry_timer);
+        ctx->peers[i].handle = NETWORK_INVALID_HANDLE;
+    }
 
-    // Close server socket
-    if (ctx->server_socket != INVALID_SOCKET) {
-        CLOSE_SOCKET(ctx->server_socket);
-        ctx->server_socket = INVALID_SOCKET;
+    // Reliable delivery does not survive a restart of the network
+    for (size_t i = 0; i < ctx->max_connections; i++) {
+        if (ctx->sessions[i].in_use) {
+            session_free(ctx, &ctx->sessions[i]);
+        }
     }
 
+    // Close listeners
+    ctx->transport->unlisten(ctx->transport, ctx);
+    close_datagram(ctx);
+    ctx->poll_listeners = 0;
+
+    io_free(ctx);
     pthread_mutex_unlock(&ctx->lock);
 }
 
@@ -316,6 +3149,19 @@ void network_destroy(NetworkContext* ctx) {
     network_stop(ctx);
     
     pthread_mutex_destroy(&ctx->lock);
+    if (ctx->poll_fd != INVALID_SOCKET) close(ctx->poll_fd);
+    for (size_t i = 0; i < ctx->max_connections; i++) {
+        free(ctx->connections[i].out_ring);
+        free(ctx->connections[i].out_tags);
+        free(ctx->connections[i].rx_buffer);
+    }
+    free(ctx->node_index.entries);
+    network_buffer_release(ctx->ping_frame);
+    network_buffer_release(ctx->pong_frame);
+    free(ctx->rx_message);
+    free(ctx->compressor);
+    free(ctx->dictionary);
+    free(ctx->sessions);
     free(ctx->connections);
     free(ctx);
 
@@ -328,4 +3174,14 @@ void network_destroy(NetworkContext* ctx) {
 void network_run(NetworkContext* ctx) {
     if (!ctx) return;
     poll_connections(ctx);
+}
+
+// Poll set for callers waiting on the network themselves
+int network_get_poll_fd(NetworkContext* ctx) {
+    if (!ctx || !ctx->transport->waitable) return INVALID_SOCKET;
+    return ctx->poll_fd;
+}
+
+void network_set_poll_timeout(NetworkContext* ctx, int timeout_ms) {
+    if (ctx) ctx->poll_timeout_ms = timeout_ms < 0 ? 0 : timeout_ms;
 }
\ No newline at end of file
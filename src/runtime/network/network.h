@@ -2,48 +2,451 @@
 #define NETWORK_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "timer.h"
+#include "shm.h"
+#include "compress.h"
+#include "auth.h"
+#include "datagram.h"
+#include "reliable.h"
 
 // Network message types
 typedef enum {
-    MSG_CONNECT,         // New connection
-    MSG_DISCONNECT,      // Connection closed
-    MSG_NODE_CREATED,    // New node created
-    MSG_NODE_DELETED,    // Node deleted
-    MSG_NODE_UPDATED,    // Node state changed
-    MSG_DATA            // Generic data message
-} MessageType;
+    NET_MSG_CONNECT,         // New connection
+    NET_MSG_DISCONNECT,      // Connection closed
+    NET_MSG_NODE_CREATED,    // New node created
+    NET_MSG_NODE_DELETED,    // Node deleted
+    NET_MSG_NODE_UPDATED,    // Node state changed
+    NET_MSG_DATA,            // Generic data message
+    NET_MSG_ROUTE_UPDATE     // Routing link advert
+} NetworkMessageType;
+
+// Generation-tagged connection handle: slot index in the low 32 bits,
+// slot generation in the high 32 bits. Stale handles fail to resolve.
+typedef uint64_t NetworkHandle;
+#define NETWORK_INVALID_HANDLE ((NetworkHandle)0)
 
 // Network message structure
 typedef struct {
-    MessageType type;            // Message type
+    NetworkMessageType type;     // Message type
     char source_id[64];         // Source node ID
     char target_id[64];         // Target node ID 
+    NetworkHandle connection;   // Receiving connection (incoming only)
+    bool authenticated;         // Arrived on a connection verifying frame tags
+    bool datagram;              // Arrived on the unreliable datagram channel
+    bool reliable;              // Arrived with reliable delivery
     uint32_t data_size;         // Size of data
     uint8_t data[];             // Flexible array for message data
 } NetworkMessage;
 
+// Read-only view of a received data frame. The IDs are not
+// NUL-terminated, and the IDs and payload point into the connection's
+// receive buffer, the datagram batch, or for compressed frames the
+// network's inflate scratch. A view is valid only for the handler call
+// it is passed to; network_view_retain copies one that must outlive it.
+typedef struct {
+    NetworkMessageType type;     // Message type
+    const char* source_id;       // Source node ID, source_len bytes
+    const char* target_id;       // Target node ID, target_len bytes
+    uint8_t source_len;          // Source ID length
+    uint8_t target_len;          // Target ID length
+    NetworkHandle connection;    // Receiving connection
+    bool authenticated;          // Arrived on a connection verifying frame tags
+    bool datagram;               // Arrived on the unreliable datagram channel
+    bool reliable;               // Arrived with reliable delivery
+    uint32_t data_size;          // Size of data
+    const uint8_t* data;         // Payload
+} NetworkView;
+
+// Wire frame: 8-byte little-endian header, then source ID, target ID
+// and payload. length counts everything after the header.
+#define NETWORK_FRAME_HEADER_SIZE 8
+#define NETWORK_MAX_FRAME_SIZE (64 * 1024)
+
+typedef struct {
+    uint32_t length;             // Bytes following the header
+    uint8_t type;                // Message type
+    uint8_t flags;               // Frame flags
+    uint8_t source_len;          // Source ID length
+    uint8_t target_len;          // Target ID length
+} NetworkFrameHeader;
+
+// Frame flags
+typedef enum {
+    NET_FRAME_FLAG_NONE = 0,
+    NET_FRAME_FLAG_CONTROL = 1,    // Runtime control frame, type is NetworkControlType
+    NET_FRAME_FLAG_COMPRESSED = 2, // Payload is u32 LE raw size, then a compressed block
+    NET_FRAME_FLAG_RELIABLE = 4    // IDs are followed by a NETWORK_RELIABLE_SIZE header
+} NetworkFrameFlags;
+
+// Control frame types, handled inside the network runtime
+typedef enum {
+    NET_CONTROL_PING = 1,          // Liveness probe
+    NET_CONTROL_PONG = 2,          // Liveness reply
+    NET_CONTROL_CREDIT = 3,        // Flow credit, u64 LE cumulative bytes consumed
+    NET_CONTROL_SHM_ATTACH = 4,    // Switch to shared memory (fds via SCM_RIGHTS), echoed on success
+    NET_CONTROL_HELLO = 5,         // Handshake, payload NetworkHello
+    NET_CONTROL_ACK = 6            // Reliable acknowledgement, u32 LE ack then u64 LE bitmap
+} NetworkControlType;
+
+// Protocol versions spoken in handshakes
+#define NETWORK_PROTOCOL_VERSION 1
+#define NETWORK_PROTOCOL_MIN_VERSION 1
+
+// Feature bits; the first four mirror PHANTOM_FEATURE_*
+typedef enum {
+    NET_FEATURE_ENCRYPTION = 0x01,   // Encrypted transport
+    NET_FEATURE_COMPRESSION = 0x02,  // Compressed payloads
+    NET_FEATURE_AUTH = 0x04,         // Authenticated frames
+    NET_FEATURE_PERSISTENCE = 0x08,  // Persistent state sync
+    NET_FEATURE_FLOW_CONTROL = 0x10, // Credit frames
+    NET_FEATURE_BATCH = 0x20,        // Batched messages, up to max_batch per frame
+    NET_FEATURE_DATAGRAM = 0x40,     // Unreliable frames over UDP
+    NET_FEATURE_RELIABLE = 0x80      // Acknowledged, retransmitted frames
+} NetworkFeature;
+
+// Handshake parameters. The connecting side sends a HELLO first and the
+// accepting side answers with its own. Encoded little-endian; fields
+// past the first 16 bytes are optional and longer payloads carry future
+// fields. Peers that never send one are legacy: no features, unlimited
+// credit.
+//
+// With NET_FEATURE_AUTH negotiated, every later frame in each direction
+// is followed by an AUTH_TAG_SIZE tag not counted in its length. Tags
+// cover an implicit per-direction sequence number starting at 0, and
+// keys are bound to both HELLO payloads including their nonces.
+//
+// With NET_FEATURE_DATAGRAM negotiated, unreliable frames may arrive as
+// UDP datagrams from the peer's address and advertised port. Each holds
+// one frame; with auth it is followed by a u64 LE sequence number with
+// the top bit set, increasing per datagram, and a tag over it.
+//
+// With NET_FEATURE_RELIABLE negotiated, frames sent reliably carry
+// NET_FRAME_FLAG_RELIABLE and, after the IDs, a u32 LE sequence number
+// then the sender's acknowledgement of the other direction: u32 LE next
+// sequence number expected and u64 LE bitmap of the ones after it
+// already received (reliable.h). ACK control frames carry the same
+// acknowledgement when no reliable frame is going the other way soon.
+// Sequence numbers run per pair of peers, told apart by the HELLO
+// instance IDs that change with every network_start, and continue
+// across their connections.
+#define NETWORK_HELLO_SIZE (30 + AUTH_NONCE_SIZE)
+#define NETWORK_HELLO_MIN_SIZE 16
+#define NETWORK_RELIABLE_SIZE 16
+
+typedef struct {
+    uint8_t version;             // Highest protocol version spoken
+    uint8_t min_version;         // Lowest protocol version accepted
+    uint16_t max_batch;          // Messages accepted per batch frame
+    uint32_t features;           // NetworkFeature bits offered
+    uint32_t max_frame;          // Largest frame payload accepted
+    uint32_t flow_window;        // Receive window offered, 0 for none
+    uint32_t dictionary;         // Compression dictionary ID, 0 for none
+    uint8_t nonce[AUTH_NONCE_SIZE]; // Fresh per connection when offering auth
+    uint16_t datagram_port;      // UDP port for unreliable frames, 0 for none
+    uint64_t instance;           // Sender's run, the same on every connection, 0 for none
+} NetworkHello;
+
+// Serialized frame shared by every connection it is queued on
+typedef struct {
+    uint32_t refcount;           // Outstanding references
+    uint32_t size;               // Frame size in bytes
+    uint32_t key;                // Coalesce key (type, source and target)
+    uint8_t data[];              // Encoded frame
+} NetworkBuffer;
+
+// Outbound queue state of a connection
+typedef enum {
+    NET_OUT_IDLE = 0,            // Nothing queued
+    NET_OUT_PENDING,             // Queued, ready to write
+    NET_OUT_BLOCKED,             // Queued, waiting for socket writability
+    NET_OUT_WAIT_CREDIT,         // Queued, waiting for peer flow credit
+    NET_OUT_WAIT_HANDSHAKE       // Queued, waiting for frame keys
+} NetworkOutState;
+
+// What to do when a peer's outbound queue exceeds its budget
+typedef enum {
+    NET_SLOW_DROP_OLDEST = 0,    // Evict oldest unsent data frames
+    NET_SLOW_COALESCE,           // Replace queued frame with same key, else drop oldest
+    NET_SLOW_DISCONNECT          // Close the connection
+} NetworkSlowPolicy;
+
+// Broadcast outcome
+typedef struct {
+    size_t delivered;            // Targets fully written before returning (inline I/O only)
+    size_t queued;               // Targets still queued for writing
+    size_t dropped;              // Targets skipped (over budget)
+} NetworkBroadcastResult;
+
 // Network connection state
 typedef struct NetworkConnection {
     int socket;                  // Connection socket
     bool is_active;             // Connection status
     char node_id[64];           // Associated node ID
+    int32_t index_slot;         // Reverse index into node index, -1 if unbound
+    uint32_t generation;        // Bumped each time the slot is released
+    int32_t next_free;          // Next slot in free list, -1 at end
+    NetworkBuffer** out_ring;   // Outbound frame references
+    uint32_t out_head;          // Oldest queued frame
+    uint32_t out_count;         // Queued frames
+    uint32_t out_offset;        // Bytes of oldest frame already written
+    NetworkOutState out_state;  // Outbound queue state
+    size_t out_bytes;           // Bytes referenced by queued frames
+    bool out_listed;            // On its I/O thread's dirty list
+    bool close_pending;         // Set on write failure or slow peer, reaped by poll loop
+    uint64_t data_sent;         // Data frame bytes fully written
+    uint64_t peer_consumed;     // Data frame bytes the peer reported consumed
+    uint64_t rx_consumed;       // Data frame bytes delivered locally
+    uint64_t rx_granted;        // rx_consumed last reported to the peer
+    ShmChannel* shm;            // Shared-memory transport, NULL for the socket
+    int passed_fds[3];          // Descriptors received with SCM_RIGHTS
+    uint32_t passed_count;      // Valid entries in passed_fds
+    bool negotiated;            // Handshake completed
+    uint8_t version;            // Negotiated protocol version, 0 for legacy
+    uint16_t max_batch;         // Messages per batch frame the peer accepts
+    uint32_t features;          // Features both sides support
+    uint32_t max_frame;         // Largest frame payload the peer accepts
+    uint32_t send_window;       // Peer's credit window, 0 for unlimited
+    uint32_t recv_window;       // Window granted to the peer, 0 for none
+    bool hello_sent;            // Our HELLO is queued
+    uint8_t hello[NETWORK_HELLO_SIZE]; // Our HELLO payload, bound into frame keys
+    bool auth;                  // Frames carry tags both ways
+    AuthKey send_key;           // Tags frames we send
+    AuthKey recv_key;           // Verifies frames we receive
+    uint64_t send_seq;          // Sequence number of the next frame tagged
+    uint64_t recv_seq;          // Sequence number of the next frame verified
+    uint8_t (*out_tags)[AUTH_TAG_SIZE]; // Tags of sealed frames, by ring slot
+    uint32_t out_sealed;        // Leading queued frames already tagged
+    uint32_t datagram_addr;     // Peer's datagram address, network byte order
+    uint16_t datagram_port;     // Peer's datagram port, network byte order, 0 for none
+    uint64_t datagram_send_seq; // Sequence number of the next datagram tagged
+    uint64_t datagram_recv_seq; // Newest datagram sequence number verified
+    int32_t peer_slot;          // Entry in peers if we dialed it, else -1
+    int32_t session;            // Entry in sessions once reliable delivery is negotiated, else -1
+    bool established;           // First frame received from peer
+    uint64_t last_rx_ms;        // Last frame received
+    TimerEntry idle_timer;      // Handshake deadline, then idle timeout
+    TimerEntry heartbeat_timer; // Ping when the peer goes quiet
+    uint8_t* rx_buffer;         // Partial incoming frames
+    size_t rx_length;           // Bytes buffered
+    size_t rx_capacity;         // Buffer capacity
+    uint8_t want_write;         // Blocked output waits on the poll loop
+    uint8_t ready;              // NetworkReadyFlags from the last transport poll
+    uint32_t poll_events;       // Socket events registered with the context's poll_fd
+    bool poll_shm;              // shm rx_event registered with it too
     void* user_data;            // Custom data attachment
 } NetworkConnection;
 
+struct pollfd;
+
+// I/O thread owning the outbound queues of one connection shard
+typedef struct NetworkIOThread {
+    pthread_t thread;            // Worker thread
+    bool started;                // Thread running (false in inline mode)
+    bool running;                // Cleared to stop the thread
+    int wake_fds[2];             // Wakeup pipe
+    pthread_mutex_t lock;        // Guards shard outbound queues
+    int32_t* dirty;              // Connections with queued output
+    size_t dirty_count;          // Entries in dirty list
+    struct pollfd* poll_fds;     // Scratch pollfd array
+    uint32_t* poll_map;          // Scratch pollfd to connection map
+    uint64_t frames_sent;        // Frames fully written
+    uint64_t bytes_sent;         // Bytes written
+    uint64_t send_errors;        // Connections failed while writing
+    uint64_t frames_evicted;     // Queued frames dropped for newer ones
+    uint64_t frames_coalesced;   // Queued frames replaced by same-key frames
+    uint64_t slow_disconnects;   // Connections closed by slow-consumer policy
+    uint64_t credit_stalls;      // Flushes stopped waiting for flow credit
+    struct NetworkContext* ctx;  // Owning context
+} NetworkIOThread;
+
+// Node ID index entry (open addressing, linear probing)
+typedef struct {
+    uint32_t hash;               // Cached node ID hash
+    int32_t conn_index;          // Connection slot, or NODE_INDEX_EMPTY/TOMBSTONE
+} NetworkIndexEntry;
+
+// Node ID to connection index
+typedef struct {
+    NetworkIndexEntry* entries;  // Probe table
+    size_t capacity;             // Table size (power of two)
+    size_t count;                // Bound node IDs
+    size_t tombstones;           // Deleted entries awaiting rebuild
+} NetworkNodeIndex;
+
+// Network runtime statistics
+typedef struct {
+    uint64_t accepted;           // Connections admitted
+    uint64_t rejected;           // Connections refused (table full)
+    uint64_t accept_errors;      // Failed accept calls
+    uint64_t accept_wakeups;     // Poll wakeups with pending accepts
+    uint32_t max_accept_batch;   // Largest batch drained in one wakeup
+    double accept_rate;          // Admissions per second, last window
+    uint64_t frames_received;    // Frames delivered to the message handler
+    uint64_t frames_sent;        // Frames fully written
+    uint64_t bytes_sent;         // Bytes written
+    uint64_t frames_dropped;     // Frames not queued (over budget)
+    uint64_t frames_evicted;     // Queued frames dropped for newer ones
+    uint64_t frames_coalesced;   // Queued frames replaced by same-key frames
+    uint64_t slow_disconnects;   // Connections closed by slow-consumer policy
+    uint64_t credit_stalls;      // Flushes stopped waiting for flow credit
+    int64_t outbound_bytes;      // Bytes currently queued across connections
+    uint64_t send_errors;        // Connections failed while writing
+    uint64_t timeouts;           // Connections evicted by idle or handshake timeout
+    uint64_t pings_sent;         // Heartbeat pings sent
+    uint64_t shm_attached;       // Connections switched to shared memory
+    uint64_t handshakes;         // Handshakes completed
+    uint64_t frames_compressed;  // Data frames encoded compressed
+    uint64_t compress_saved;     // Bytes saved by those encodings
+    uint64_t auth_failures;      // Connections closed for bad tags or refusing auth
+    uint64_t dials;              // Outbound connection attempts
+    uint64_t dial_failures;      // Attempts closed before the peer spoke
+    uint64_t datagrams_sent;     // Frames sent as datagrams
+    uint64_t datagrams_received; // Datagrams delivered to the message handler
+    uint64_t datagrams_dropped;  // Datagrams not sent, or received and discarded
+    uint64_t reliable_sent;      // Messages accepted for reliable delivery
+    uint64_t reliable_retransmits; // Reliable frames sent again
+    uint64_t reliable_duplicates;  // Reliable frames received again and discarded
+    uint64_t reliable_expired;   // Reliable messages dropped with a peer that never returned
+} NetworkStats;
+
+// Peer redialed whenever its connection drops, with exponential backoff
+#define NETWORK_MAX_PEERS 64
+
+typedef struct {
+    bool in_use;                 // Entry registered
+    char host[256];              // Host name or address
+    uint16_t port;               // Port
+    NetworkHandle handle;        // Current connection, invalid while down
+    uint32_t backoff_ms;         // Delay before the next redial
+    TimerEntry retry_timer;      // Pending redial
+} NetworkPeer;
+
+// Reliable delivery to one peer. It outlives the peer's connections:
+// frames unacknowledged when one drops are resent on the next, and the
+// peer's sequence numbers still recognise duplicates.
+#define NETWORK_SESSION_LINGER_MS 60000
+
+typedef struct {
+    bool in_use;                 // Entry holds a peer
+    uint64_t peer_instance;      // Peer's HELLO instance ID
+    NetworkHandle handle;        // Newest connection to the peer, invalid while it has none
+    ReliableSender send;         // Our frames awaiting acknowledgement
+    ReliableReceiver recv;       // The peer's frames received
+    TimerEntry retransmit_timer; // Oldest unacknowledged frame due
+    TimerEntry ack_timer;        // Delayed acknowledgement due
+    TimerEntry expire_timer;     // Forget a peer without connections this long
+} NetworkSession;
+
+typedef struct NetworkContext NetworkContext;
+
+// Readiness reported by a transport poll
+typedef enum {
+    NET_READY_READ = 1,          // Readable, or closed by peer
+    NET_READY_WRITE = 2,         // Writable, reported only with want_write
+    NET_READY_EVENT = 4          // Shared-memory channel signalled
+} NetworkReadyFlags;
+
+// Listeners reported by a transport poll
+#define NET_LISTENER_SERVER 1    // server_socket has pending connections
+#define NET_LISTENER_UNIX 2      // unix_socket has pending connections
+#define NET_LISTENER_DATAGRAM 4  // datagram_socket has datagrams waiting
+
+// Keys of poll_fd entries: a source in the high word, and the listener
+// bit or connection slot in the low word
+#define NET_POLL_LISTENER 1ull   // Listening or datagram socket
+#define NET_POLL_SOCKET 2ull     // Connection socket
+#define NET_POLL_SHM 3ull        // Connection's shared-memory event
+#define NET_POLL_KEY(source, index) (((source) << 32) | (uint32_t)(index))
+
+// Transport backend. Handles are non-negative ints (descriptors for the
+// socket transport). Operations follow socket conventions: -1 with errno
+// set, EAGAIN/EWOULDBLOCK when they would block, read returns 0 at EOF.
+// connect returns a handle whose connection may still be in progress.
+typedef struct NetworkTransport {
+    const char* name;            // Backend name
+    bool pollable;               // Handles are fds the I/O threads can poll()
+    bool encrypted;              // Bytes are encrypted on the wire
+    bool waitable;               // All poll readiness shows on the context's poll_fd
+    bool (*listen)(struct NetworkTransport* transport, NetworkContext* ctx);
+    void (*unlisten)(struct NetworkTransport* transport, NetworkContext* ctx);
+    int (*accept)(struct NetworkTransport* transport, int listener);
+    int (*connect)(struct NetworkTransport* transport, const char* host, uint16_t port);
+    ssize_t (*read)(struct NetworkTransport* transport, int handle, void* buffer,
+                    size_t size, NetworkConnection* conn);
+    ssize_t (*write)(struct NetworkTransport* transport, int handle,
+                     const struct iovec* iov, int count);
+    void (*close)(struct NetworkTransport* transport, int handle);
+    int (*poll)(struct NetworkTransport* transport, NetworkContext* ctx, int timeout_ms);
+    void* state;                 // Backend private data
+} NetworkTransport;
+
+// Network callbacks
+typedef void (*MessageHandler)(NetworkContext* ctx, NetworkMessage* msg);
+typedef void (*ViewHandler)(NetworkContext* ctx, const NetworkView* view);
+typedef void (*ConnectionHandler)(NetworkContext* ctx, NetworkConnection* conn);
+
 // Network context managing all connections
-typedef struct NetworkContext {
+struct NetworkContext {
     int server_socket;           // Server listening socket
     uint16_t port;              // Server port
+    int unix_socket;             // Local listening socket, -1 if unused
+    char unix_path[108];         // Local socket path, empty disables
+    NetworkTransport* transport; // Listen/accept/read/write backend
+    uint32_t listen_ready;       // NET_LISTENER_* bits from the last poll
+    int poll_fd;                 // epoll set of the fd transports, -1 before start
+    uint32_t poll_listeners;     // NET_LISTENER_* sockets registered with poll_fd
+    int poll_timeout_ms;         // Longest a transport poll waits
+    int datagram_socket;         // UDP socket for unreliable frames, -1 if unused
+    uint16_t datagram_port;      // Port it is bound to
+    bool datagram_enabled;       // Open it on start
+    DatagramBatch* datagram_rx;  // Receive batch
     NetworkConnection* connections; // Array of connections
     size_t max_connections;      // Maximum allowed connections
     size_t active_connections;   // Current active connections
+    size_t backlog;              // Listen backlog
+    int32_t free_head;           // First free connection slot, -1 if full
+    NetworkNodeIndex node_index; // Node ID to connection index
+    MessageHandler message_handler;       // Incoming message callback
+    ViewHandler view_handler;             // Incoming frame view callback
+    ConnectionHandler connect_handler;    // New connection callback
+    ConnectionHandler disconnect_handler; // Connection closed callback
+    void* user_data;             // Handler owner's data
+    NetworkIOThread* io_threads; // Outbound I/O shards
+    size_t io_thread_count;      // Worker threads, 0 flushes inline
+    NetworkMessage* rx_message;  // Scratch message and inflate buffer for incoming frames
+    TimerWheel timers;           // Connection timeouts and heartbeats
+    uint32_t idle_timeout_ms;    // Evict peers silent this long, 0 disables
+    uint32_t heartbeat_ms;       // Ping peers silent this long, 0 disables
+    uint32_t handshake_timeout_ms; // Evict peers not speaking this soon, 0 disables
+    NetworkBuffer* ping_frame;   // Shared ping control frame
+    NetworkBuffer* pong_frame;   // Shared pong control frame
+    size_t max_conn_outbound;    // Per-connection queued byte budget
+    size_t max_outbound;         // Queued byte budget across connections
+    int64_t outbound_bytes;      // Bytes queued across connections
+    NetworkSlowPolicy slow_policy; // Over-budget behaviour
+    uint32_t flow_window;        // Receive window offered in handshakes, 0 for none
+    uint32_t features;           // Features offered in handshakes
+    CompressContext* compressor; // Frame compressor, NULL if disabled
+    uint8_t* dictionary;         // Compression dictionary (owned)
+    uint32_t compress_threshold; // Smallest payload worth compressing
+    uint8_t auth_secret[AUTH_MAX_SECRET]; // Shared frame authentication secret
+    size_t auth_secret_size;     // Secret bytes, 0 disables authentication
+    NetworkPeer peers[NETWORK_MAX_PEERS]; // Peers kept connected
+    uint32_t reconnect_min_ms;   // First redial delay
+    uint32_t reconnect_max_ms;   // Redial delay cap
+    uint32_t jitter_state;       // Redial jitter generator
+    uint64_t instance;           // Identifies this run of the network to peers across connections
+    NetworkSession* sessions;    // Reliable delivery per peer, max_connections entries
+    NetworkStats stats;          // Runtime statistics
+    uint64_t rate_window_start;  // Accept rate window start (ms)
+    uint64_t rate_window_count;  // Admissions in current window
     pthread_mutex_t lock;        // Thread safety lock
-} NetworkContext;
-
-// Network callbacks
-typedef void (*MessageHandler)(NetworkContext* ctx, NetworkMessage* msg);
-typedef void (*ConnectionHandler)(NetworkContext* ctx, NetworkConnection* conn);
+};
 
 // Basic network operations
 NetworkContext* network_create(uint16_t port);
@@ -52,11 +455,129 @@ void network_destroy(NetworkContext* ctx);
 // Connection operations
 bool network_start(NetworkContext* ctx);
 void network_stop(NetworkContext* ctx);
+void network_run(NetworkContext* ctx);
+
+// Event-driven callers. network_get_poll_fd returns a descriptor that is
+// readable whenever network_run has socket work to do, or -1 if the
+// transport cannot offer one. A caller blocking on it sets a 0 poll
+// timeout and still runs the network every NETWORK_POLL_TIMEOUT_MS so
+// connection timers and redials fire.
+#define NETWORK_POLL_TIMEOUT_MS 100
+int network_get_poll_fd(NetworkContext* ctx);
+void network_set_poll_timeout(NetworkContext* ctx, int timeout_ms);
 bool network_send(NetworkContext* ctx, const char* node_id, NetworkMessage* msg);
-bool network_broadcast(NetworkContext* ctx, NetworkMessage* msg);
+bool network_broadcast(NetworkContext* ctx, NetworkMessage* msg, NetworkBroadcastResult* result);
+
+// Outbound connections. The dialing side sends its HELLO first.
+// network_connect dials once; peers added with network_add_peer are
+// redialed whenever their connection drops, waiting twice as long after
+// each attempt that fails. Dialing needs a started context.
+NetworkHandle network_connect(NetworkContext* ctx, const char* host, uint16_t port);
+bool network_add_peer(NetworkContext* ctx, const char* host, uint16_t port);
+bool network_remove_peer(NetworkContext* ctx, const char* host, uint16_t port);
+void network_set_reconnect(NetworkContext* ctx, uint32_t min_ms, uint32_t max_ms);
+size_t network_get_handles(NetworkContext* ctx, NetworkHandle* handles, size_t max);
+
+// Unreliable delivery. Once enabled before network_start, a UDP socket
+// shares the server port and peers that negotiate NET_FEATURE_DATAGRAM
+// are sent frames as datagrams, batched per call. Frames too large for a
+// datagram, and peers without the channel, use the connection instead.
+// Datagrams may be lost or reordered and are never compressed. Only the
+// plain socket transport carries them.
+bool network_set_datagram(NetworkContext* ctx, bool enabled);
+size_t network_send_unreliable(NetworkContext* ctx, const NetworkHandle* handles,
+                               size_t count, NetworkMessage* msg);
+
+// Reliable delivery. To a peer that negotiated NET_FEATURE_RELIABLE, msg
+// is numbered and held until acknowledged, resent while it is not, and
+// handed to the peer's message handler once. RELIABLE_WINDOW frames are
+// in flight at a time and up to RELIABLE_QUEUE held in all; returns
+// false when the queue is full. Held frames wait out a dropped
+// connection for the peer's next one, up to NETWORK_SESSION_LINGER_MS.
+// Frames resent after a loss may arrive out of order, and are never
+// compressed. Other peers are sent msg as by network_send_handle.
+bool network_send_reliable(NetworkContext* ctx, NetworkHandle handle, NetworkMessage* msg);
+
+// Received frames. network_forward sends a viewed frame on over handle
+// with the delivery it arrived with, encoding it straight from the view.
+// network_view_copy fills msg, whose data must hold view->data_size
+// bytes; network_view_retain copies into a message the caller frees.
+bool network_forward(NetworkContext* ctx, NetworkHandle handle, const NetworkView* view);
+void network_view_copy(const NetworkView* view, NetworkMessage* msg);
+NetworkMessage* network_view_retain(const NetworkView* view);
+
+// Frame buffers
+NetworkBuffer* network_buffer_encode(const NetworkMessage* msg);
+void network_buffer_retain(NetworkBuffer* buffer);
+void network_buffer_release(NetworkBuffer* buffer);
+
+// Connection handles
+NetworkHandle network_get_handle(NetworkContext* ctx, const NetworkConnection* conn);
+NetworkConnection* network_resolve(NetworkContext* ctx, NetworkHandle handle);
+bool network_send_handle(NetworkContext* ctx, NetworkHandle handle, NetworkMessage* msg);
+
+// Node binding
+bool network_bind_node(NetworkContext* ctx, NetworkConnection* conn, const char* node_id);
+void network_unbind_node(NetworkContext* ctx, NetworkConnection* conn);
+NetworkConnection* network_find_node(NetworkContext* ctx, const char* node_id);
+
+// Transports. The memory transport is an in-process fabric: contexts
+// using it listen on their port within the fabric, and clients in the
+// same process connect with network_memory_connect.
+NetworkTransport* network_socket_transport(void);
+NetworkTransport* network_memory_transport_create(void);
+void network_memory_transport_destroy(NetworkTransport* transport);
+int network_memory_connect(NetworkTransport* transport, uint16_t port);
+bool network_set_transport(NetworkContext* ctx, NetworkTransport* transport);
+
+// TLS 1.3 over the socket transport. Servers need a certificate and key;
+// clients verify peers only when ca_file is set. Client sessions are
+// cached per host and port so reconnects resume without a full handshake.
+typedef struct {
+    const char* cert_file;       // PEM certificate chain, NULL for client only
+    const char* key_file;        // PEM private key
+    const char* ca_file;         // Trusted CAs for verifying peers, NULL skips
+    bool ktls;                   // Hand record encryption to the kernel if supported
+    bool no_resume;              // Always run full handshakes as a client
+} NetworkTlsConfig;
+
+typedef struct {
+    uint64_t handshakes;         // Handshakes completed
+    uint64_t resumed;            // Of which resumed a cached session
+    uint64_t ktls_send;          // Of which send through kernel TLS
+    uint64_t failures;           // Handshakes or records that failed
+} NetworkTlsStats;
+
+NetworkTransport* network_tls_transport_create(const NetworkTlsConfig* config);
+void network_tls_transport_destroy(NetworkTransport* transport);
+void network_tls_get_stats(NetworkTransport* transport, NetworkTlsStats* stats);
+
+// Same-host clients: offer a shared-memory channel over a connected
+// AF_UNIX socket. Frames then flow through the channel's rings.
+bool network_offer_shm(int socket, const ShmChannel* channel);
+
+// Configuration and statistics
+void network_set_backlog(NetworkContext* ctx, size_t backlog);
+bool network_set_unix_path(NetworkContext* ctx, const char* path);
+void network_set_io_threads(NetworkContext* ctx, size_t count);
+void network_set_timeouts(NetworkContext* ctx, uint32_t idle_ms,
+                          uint32_t heartbeat_ms, uint32_t handshake_ms);
+void network_set_outbound_limits(NetworkContext* ctx, size_t conn_bytes,
+                                 size_t total_bytes, NetworkSlowPolicy policy);
+void network_set_flow_window(NetworkContext* ctx, uint32_t window);
+void network_set_features(NetworkContext* ctx, uint32_t features);
+bool network_set_compression(NetworkContext* ctx, uint32_t threshold,
+                             const void* dictionary, size_t size);
+bool network_set_auth_key(NetworkContext* ctx, const void* secret, size_t size);
+size_t network_encode_hello(const NetworkHello* hello, uint8_t* frame, size_t size);
+bool network_decode_hello(const uint8_t* payload, size_t size, NetworkHello* hello);
+void network_get_stats(NetworkContext* ctx, NetworkStats* stats);
 
-// Set handlers
+// Set handlers. A view handler is handed data frames in place of the
+// message handler, which then sees none; without one each frame is
+// copied into a scratch message for the message handler.
 void network_set_message_handler(NetworkContext* ctx, MessageHandler handler);
+void network_set_view_handler(NetworkContext* ctx, ViewHandler handler);
 void network_set_connect_handler(NetworkContext* ctx, ConnectionHandler handler);
 void network_set_disconnect_handler(NetworkContext* ctx, ConnectionHandler handler);
 
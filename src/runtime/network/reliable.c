@@ -0,0 +1,192 @@
+#include <stdlib.h>
+#include <string.h>
+#include "reliable.h"
+
+// Selective acknowledgements cover the whole window
+_Static_assert(RELIABLE_WINDOW <= 64, "window exceeds the acknowledgement bitmap");
+_Static_assert((RELIABLE_QUEUE & (RELIABLE_QUEUE - 1)) == 0, "queue must be a power of two");
+
+// Entry holding sequence number seq. The ring size divides 2^32, so
+// slots stay consistent across wraparound.
+static ReliableEntry* entry_at(const ReliableSender* sender, uint32_t seq) {
+    return &sender->entries[seq % RELIABLE_QUEUE];
+}
+
+// Whether seq is held, in flight or waiting
+static bool is_held(const ReliableSender* sender, uint32_t seq) {
+    return seq - sender->una < sender->tail - sender->una;
+}
+
+// Initialize empty sender
+bool reliable_sender_init(ReliableSender* sender) {
+    memset(sender, 0, sizeof(*sender));
+    sender->entries = calloc(RELIABLE_QUEUE, sizeof(ReliableEntry));
+    sender->rto_ms = RELIABLE_INITIAL_RTO_MS;
+    return sender->entries != NULL;
+}
+
+// Release every held frame and the ring
+void reliable_sender_free(ReliableSender* sender, ReliableReleaseFn release) {
+    if (!sender->entries) return;
+
+    for (uint32_t seq = sender->una; seq != sender->tail; seq++) {
+        ReliableEntry* entry = entry_at(sender, seq);
+        if (entry->frame && release) {
+            release(entry->frame);
+        }
+    }
+    free(sender->entries);
+    memset(sender, 0, sizeof(*sender));
+}
+
+bool reliable_push(ReliableSender* sender, void* frame, uint32_t* seq) {
+    if (!frame || sender->tail - sender->una >= RELIABLE_QUEUE) return false;
+
+    ReliableEntry* entry = entry_at(sender, sender->tail);
+    entry->frame = frame;
+    entry->sent_ms = 0;
+    entry->sends = 0;
+    *seq = sender->tail++;
+    return true;
+}
+
+size_t reliable_transmit(ReliableSender* sender, uint64_t now_ms,
+                         ReliableSendFn send, void* arg) {
+    size_t sent = 0;
+
+    while (sender->next != sender->tail && sender->next - sender->una < RELIABLE_WINDOW) {
+        ReliableEntry* entry = entry_at(sender, sender->next);
+
+        // Acknowledged selectively before a rewind brought it back
+        if (entry->frame) {
+            if (!send(entry->frame, sender->next, entry->sends > 0, arg)) break;
+            entry->sent_ms = now_ms;
+            entry->sends++;
+            sent++;
+        }
+        sender->next++;
+    }
+    return sent;
+}
+
+size_t reliable_retransmit(ReliableSender* sender, uint64_t now_ms,
+                           ReliableSendFn send, void* arg) {
+    size_t resent = 0;
+
+    for (uint32_t seq = sender->una; seq != sender->next; seq++) {
+        ReliableEntry* entry = entry_at(sender, seq);
+        if (!entry->frame || entry->sent_ms + sender->rto_ms > now_ms) continue;
+
+        if (!send(entry->frame, seq, true, arg)) break;
+        entry->sent_ms = now_ms;
+        entry->sends++;
+        resent++;
+    }
+
+    // Exponential backoff until an acknowledgement gives a fresh sample
+    if (resent > 0) {
+        sender->rto_ms = sender->rto_ms * 2 < RELIABLE_MAX_RTO_MS ? sender->rto_ms * 2
+                                                                  : RELIABLE_MAX_RTO_MS;
+    }
+    return resent;
+}
+
+void reliable_rewind(ReliableSender* sender) {
+    sender->next = sender->una;
+}
+
+// Release entry's frame, keeping its send time if it is a clean sample
+static void release_entry(ReliableEntry* entry, ReliableReleaseFn release, uint64_t* sampled) {
+    if (!entry->frame) return;
+
+    // Karn: a resent frame's acknowledgement may answer either copy
+    if (entry->sends == 1 && entry->sent_ms > *sampled) {
+        *sampled = entry->sent_ms;
+    }
+    if (release) {
+        release(entry->frame);
+    }
+    entry->frame = NULL;
+}
+
+bool reliable_ack(ReliableSender* sender, uint32_t ack, uint64_t sack,
+                  uint64_t now_ms, ReliableReleaseFn release) {
+    // An old acknowledgement may trail una, never pass the frames held
+    if ((int32_t)(ack - sender->una) > (int32_t)(sender->tail - sender->una)) return false;
+
+    uint64_t sampled = 0;
+    while ((int32_t)(ack - sender->una) > 0) {
+        release_entry(entry_at(sender, sender->una), release, &sampled);
+        sender->una++;
+    }
+
+    // After a rewind the peer may acknowledge frames due to go out again
+    if ((int32_t)(sender->next - sender->una) < 0) {
+        sender->next = sender->una;
+    }
+    for (uint32_t i = 0; sack && i < RELIABLE_WINDOW; i++, sack >>= 1) {
+        uint32_t seq = ack + 1 + i;
+        if ((sack & 1) && is_held(sender, seq)) {
+            release_entry(entry_at(sender, seq), release, &sampled);
+        }
+    }
+
+    // Round trip estimate as TCP keeps it, in milliseconds
+    if (sampled && now_ms >= sampled) {
+        uint32_t rtt = (uint32_t)(now_ms - sampled);
+        if (!sender->timed) {
+            sender->timed = true;
+            sender->srtt_ms = rtt;
+            sender->rttvar_ms = rtt / 2;
+        } else {
+            uint32_t diff = rtt > sender->srtt_ms ? rtt - sender->srtt_ms : sender->srtt_ms - rtt;
+            sender->rttvar_ms = (3 * sender->rttvar_ms + diff) / 4;
+            sender->srtt_ms = (7 * sender->srtt_ms + rtt) / 8;
+        }
+
+        uint32_t rto = sender->srtt_ms + 4 * sender->rttvar_ms;
+        if (rto < RELIABLE_MIN_RTO_MS) rto = RELIABLE_MIN_RTO_MS;
+        if (rto > RELIABLE_MAX_RTO_MS) rto = RELIABLE_MAX_RTO_MS;
+        sender->rto_ms = rto;
+    }
+    return true;
+}
+
+size_t reliable_held(const ReliableSender* sender) {
+    return sender->tail - sender->una;
+}
+
+uint64_t reliable_deadline(const ReliableSender* sender) {
+    uint64_t oldest = 0;
+
+    for (uint32_t seq = sender->una; seq != sender->next; seq++) {
+        const ReliableEntry* entry = entry_at(sender, seq);
+        if (entry->frame && (!oldest || entry->sent_ms < oldest)) {
+            oldest = entry->sent_ms;
+        }
+    }
+    return oldest ? oldest + sender->rto_ms : 0;
+}
+
+bool reliable_accept(ReliableReceiver* receiver, uint32_t seq) {
+    uint32_t ahead = seq - receiver->expected;
+
+    if (ahead == 0) {
+        // Slide past the run of numbers that arrived early
+        receiver->expected++;
+        while (receiver->received & 1) {
+            receiver->received >>= 1;
+            receiver->expected++;
+        }
+        receiver->received >>= 1;
+        return true;
+    }
+
+    // Behind expected wraps to a large distance and is a duplicate
+    if (ahead - 1 >= RELIABLE_WINDOW) return false;
+
+    uint64_t bit = 1ull << (ahead - 1);
+    if (receiver->received & bit) return false;
+    receiver->received |= bit;
+    return true;
+}
\ No newline at end of file
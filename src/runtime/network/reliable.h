@@ -0,0 +1,89 @@
+#ifndef RELIABLE_H
+#define RELIABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Sequencing for reliable delivery between two peers. The sender numbers
+// its frames and holds each until acknowledged; at most RELIABLE_WINDOW
+// are in flight and the rest of RELIABLE_QUEUE wait their turn. The
+// receiver acknowledges with the next sequence number it expects, all
+// before it having arrived, plus a bitmap of the RELIABLE_WINDOW numbers
+// after that, so duplicates are recognised and only the gaps are resent.
+// Sequence numbers are u32 and wrap.
+#define RELIABLE_WINDOW 64
+#define RELIABLE_QUEUE 1024
+#define RELIABLE_INITIAL_RTO_MS 300
+#define RELIABLE_MIN_RTO_MS 50
+#define RELIABLE_MAX_RTO_MS 8000
+
+// Frame held by the sender
+typedef struct {
+    void* frame;                 // Caller's frame, NULL once acknowledged
+    uint64_t sent_ms;            // Last transmission
+    uint32_t sends;              // Transmissions so far
+} ReliableEntry;
+
+// Sending half. Sequence numbers from una to next are in flight, from
+// next to tail waiting.
+typedef struct {
+    ReliableEntry* entries;      // RELIABLE_QUEUE ring indexed by sequence number
+    uint32_t una;                // Oldest unacknowledged
+    uint32_t next;               // Next to transmit
+    uint32_t tail;               // Next to assign
+    bool timed;                  // A round trip has been sampled
+    uint32_t srtt_ms;            // Smoothed round trip
+    uint32_t rttvar_ms;          // Round trip variation
+    uint32_t rto_ms;             // Retransmit timeout, backed off while unanswered
+} ReliableSender;
+
+// Receiving half
+typedef struct {
+    uint32_t expected;           // Every number before it has arrived
+    uint64_t received;           // Bit i: expected + 1 + i has arrived
+    uint32_t unacked;            // Arrivals since the last acknowledgement
+} ReliableReceiver;
+
+// Transmit frame as seq, resend when it went out before. Returns false
+// if it could not be queued; the sender stops and tries again later.
+typedef bool (*ReliableSendFn)(void* frame, uint32_t seq, bool resend, void* arg);
+typedef void (*ReliableReleaseFn)(void* frame);
+
+// Sender lifecycle
+bool reliable_sender_init(ReliableSender* sender);
+void reliable_sender_free(ReliableSender* sender, ReliableReleaseFn release);
+
+// Hold frame for sending. Returns false if RELIABLE_QUEUE frames are
+// already held; *seq receives its sequence number.
+bool reliable_push(ReliableSender* sender, void* frame, uint32_t* seq);
+
+// Send waiting frames the window has room for
+size_t reliable_transmit(ReliableSender* sender, uint64_t now_ms,
+                         ReliableSendFn send, void* arg);
+
+// Resend in-flight frames unacknowledged for a timeout, backing the
+// timeout off if any were. Returns the number resent.
+size_t reliable_retransmit(ReliableSender* sender, uint64_t now_ms,
+                           ReliableSendFn send, void* arg);
+
+// Treat every in-flight frame as waiting again, for a new path to the
+// peer that may not have seen them
+void reliable_rewind(ReliableSender* sender);
+
+// Release frames covered by an acknowledgement and sample the round
+// trip. Returns false if it acknowledges frames not held.
+bool reliable_ack(ReliableSender* sender, uint32_t ack, uint64_t sack,
+                  uint64_t now_ms, ReliableReleaseFn release);
+
+// Frames held, in flight or waiting
+size_t reliable_held(const ReliableSender* sender);
+
+// Time the oldest in-flight frame is due for resending, 0 if none is
+uint64_t reliable_deadline(const ReliableSender* sender);
+
+// Record seq as received. Returns false for a duplicate, or a number
+// beyond the window that a well-behaved sender never sends.
+bool reliable_accept(ReliableReceiver* receiver, uint32_t seq);
+
+#endif // RELIABLE_H
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "shm.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+
+// Ring stride in the region, header plus data rounded to a cache line
+static size_t ring_stride(uint32_t ring_size) {
+    return (sizeof(ShmRing) + ring_size + 63) & ~(size_t)63;
+}
+
+static size_t region_size(uint32_t ring_size) {
+    return 64 + 2 * ring_stride(ring_size);
+}
+
+static bool valid_ring_size(uint32_t ring_size) {
+    return ring_size >= SHM_MIN_RING_SIZE && ring_size <= SHM_MAX_RING_SIZE &&
+           (ring_size & (ring_size - 1)) == 0;
+}
+
+// Map region and point rings; ring 0 carries client to server
+static bool map_region(ShmChannel* channel, uint32_t ring_size, bool client) {
+    channel->map_size = region_size(ring_size);
+    channel->base = mmap(NULL, channel->map_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, channel->mem_fd, 0);
+    if (channel->base == MAP_FAILED) {
+        channel->base = NULL;
+        return false;
+    }
+
+    ShmRing* to_server = (ShmRing*)((uint8_t*)channel->base + 64);
+    ShmRing* to_client = (ShmRing*)((uint8_t*)to_server + ring_stride(ring_size));
+    channel->ring_size = ring_size;
+    channel->tx = client ? to_server : to_client;
+    channel->rx = client ? to_client : to_server;
+    return true;
+}
+
+static void reset_channel(ShmChannel* channel) {
+    memset(channel, 0, sizeof(*channel));
+    channel->mem_fd = channel->rx_event = channel->tx_event = -1;
+}
+
+// Create a channel as the connecting side
+bool shm_channel_create(ShmChannel* channel, uint32_t ring_size) {
+    if (!channel) return false;
+    reset_channel(channel);
+    if (!valid_ring_size(ring_size)) return false;
+
+    channel->mem_fd = memfd_create("phantom-shm", MFD_CLOEXEC);
+    channel->rx_event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    channel->tx_event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (channel->mem_fd < 0 || channel->rx_event < 0 || channel->tx_event < 0 ||
+        ftruncate(channel->mem_fd, (off_t)region_size(ring_size)) != 0 ||
+        !map_region(channel, ring_size, true)) {
+        shm_channel_close(channel);
+        return false;
+    }
+
+    ShmHeader* header = channel->base;
+    header->ring_size = ring_size;
+    __atomic_store_n(&header->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Open a channel from descriptors received from the connecting side.
+// Takes ownership of the descriptors, closing them on failure.
+bool shm_channel_open(ShmChannel* channel, int mem_fd, int client_event, int server_event) {
+    if (!channel) return false;
+    reset_channel(channel);
+    channel->mem_fd = mem_fd;
+    channel->rx_event = server_event;
+    channel->tx_event = client_event;
+
+    struct stat st;
+    if (mem_fd < 0 || client_event < 0 || server_event < 0 ||
+        fstat(mem_fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmHeader)) {
+        shm_channel_close(channel);
+        return false;
+    }
+
+    // Read the header before trusting its ring size
+    ShmHeader header;
+    if (pread(mem_fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        header.magic != SHM_MAGIC || !valid_ring_size(header.ring_size) ||
+        (size_t)st.st_size < region_size(header.ring_size) ||
+        !map_region(channel, header.ring_size, false)) {
+        shm_channel_close(channel);
+        return false;
+    }
+    return true;
+}
+
+// Unmap region and close descriptors
+void shm_channel_close(ShmChannel* channel) {
+    if (!channel) return;
+
+    if (channel->base) munmap(channel->base, channel->map_size);
+    if (channel->mem_fd >= 0) close(channel->mem_fd);
+    if (channel->rx_event >= 0) close(channel->rx_event);
+    if (channel->tx_event >= 0) close(channel->tx_event);
+    reset_channel(channel);
+}
+
+// Copy iovecs into the tx ring. A full ring flags the writer as waiting
+// so the reader signals once it frees space.
+size_t shm_channel_write(ShmChannel* channel, const struct iovec* iov, int count) {
+    ShmRing* ring = channel->tx;
+    uint32_t mask = channel->ring_size - 1;
+    uint64_t head = ring->head;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    size_t space = channel->ring_size - (size_t)(head - tail);
+
+    if (space == 0) {
+        __atomic_store_n(&ring->writer_waiting, 1, __ATOMIC_SEQ_CST);
+        tail = __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST);
+        space = channel->ring_size - (size_t)(head - tail);
+        if (space == 0) return 0;
+    }
+
+    size_t written = 0;
+    for (int i = 0; i < count && space > 0; i++) {
+        size_t len = iov[i].iov_len < space ? iov[i].iov_len : space;
+        const uint8_t* src = iov[i].iov_base;
+        size_t offset = (size_t)(head & mask);
+        size_t first = channel->ring_size - offset;
+        if (first > len) first = len;
+
+        memcpy(ring->data + offset, src, first);
+        memcpy(ring->data, src + first, len - first);
+        head += len;
+        space -= len;
+        written += len;
+    }
+
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+    return written;
+}
+
+// Copy available bytes out of the rx ring
+size_t shm_channel_read(ShmChannel* channel, void* buffer, size_t size) {
+    ShmRing* ring = channel->rx;
+    uint32_t mask = channel->ring_size - 1;
+    uint64_t tail = ring->tail;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    size_t len = (size_t)(head - tail);
+    if (len > size) len = size;
+    if (len == 0) return 0;
+
+    size_t offset = (size_t)(tail & mask);
+    size_t first = channel->ring_size - offset;
+    if (first > len) first = len;
+    memcpy(buffer, ring->data + offset, first);
+    memcpy((uint8_t*)buffer + first, ring->data, len - first);
+
+    __atomic_store_n(&ring->tail, tail + len, __ATOMIC_SEQ_CST);
+
+    // Wake a producer that found the ring full
+    if (__atomic_load_n(&ring->writer_waiting, __ATOMIC_SEQ_CST) &&
+        __atomic_exchange_n(&ring->writer_waiting, 0, __ATOMIC_SEQ_CST)) {
+        shm_channel_notify(channel);
+    }
+    return len;
+}
+
+// True if the tx ring has free space
+bool shm_channel_writable(ShmChannel* channel) {
+    ShmRing* ring = channel->tx;
+    return ring->head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) < channel->ring_size;
+}
+
+// Signal the peer
+void shm_channel_notify(ShmChannel* channel) {
+    uint64_t one = 1;
+    ssize_t ignored = write(channel->tx_event, &one, sizeof(one));
+    (void)ignored;
+}
+
+// Consume pending signals
+void shm_channel_drain(ShmChannel* channel) {
+    uint64_t value;
+    ssize_t ignored = read(channel->rx_event, &value, sizeof(value));
+    (void)ignored;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/uio.h>
+
+// Shared-memory channel between two processes on one host: a memfd
+// holding two single-producer byte rings, one per direction, and an
+// eventfd per direction for wakeups. The rings carry the same framed
+// byte stream as a socket.
+#define SHM_MAGIC 0x314d4850u           // "PHM1"
+#define SHM_MIN_RING_SIZE (64 * 1024)
+#define SHM_MAX_RING_SIZE (64 * 1024 * 1024)
+
+// Byte ring, head and tail on separate cache lines
+typedef struct {
+    _Alignas(64) uint64_t head;   // Bytes ever written (producer)
+    uint32_t writer_waiting;      // Producer found the ring full
+    _Alignas(64) uint64_t tail;   // Bytes ever read (consumer)
+    _Alignas(64) uint8_t data[];  // Ring storage
+} ShmRing;
+
+// Mapped region header
+typedef struct {
+    uint32_t magic;               // SHM_MAGIC
+    uint32_t ring_size;           // Data bytes per ring (power of two)
+} ShmHeader;
+
+// One endpoint of a channel
+typedef struct {
+    void* base;                   // Mapped region
+    size_t map_size;              // Region size
+    uint32_t ring_size;           // Data bytes per ring
+    ShmRing* rx;                  // Ring this side reads
+    ShmRing* tx;                  // Ring this side writes
+    int mem_fd;                   // Region memfd
+    int rx_event;                 // Signalled by the peer
+    int tx_event;                 // Signals the peer
+} ShmChannel;
+
+// Channel setup. The creating side (client) passes mem_fd and both
+// eventfds to the peer, which opens them with shm_channel_open.
+bool shm_channel_create(ShmChannel* channel, uint32_t ring_size);
+bool shm_channel_open(ShmChannel* channel, int mem_fd, int client_event, int server_event);
+void shm_channel_close(ShmChannel* channel);
+
+// Ring I/O, non-blocking. Return bytes moved, 0 if full or empty.
+size_t shm_channel_write(ShmChannel* channel, const struct iovec* iov, int count);
+size_t shm_channel_read(ShmChannel* channel, void* buffer, size_t size);
+bool shm_channel_writable(ShmChannel* channel);
+
+// Wakeups
+void shm_channel_notify(ShmChannel* channel);
+void shm_channel_drain(ShmChannel* channel);
+
+#endif // SHM_H
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include <string.h>
+#include "timer.h"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define MAX_DELTA ((1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+// Link entry into the slot matching its distance from the current tick
+static void wheel_insert(TimerWheel* wheel, TimerEntry* entry) {
+    uint64_t delta = entry->expires > wheel->current_tick
+                   ? entry->expires - wheel->current_tick : 0;
+    if (delta > MAX_DELTA) {
+        delta = MAX_DELTA;
+        entry->expires = wheel->current_tick + delta;
+    }
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           delta >= (1ULL << (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+
+    size_t slot = (entry->expires >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK;
+    TimerEntry** head = &wheel->slots[level][slot];
+
+    entry->next = *head;
+    if (entry->next) {
+        entry->next->pprev = &entry->next;
+    }
+    entry->pprev = head;
+    *head = entry;
+}
+
+// Unlink entry from its slot
+static void wheel_unlink(TimerEntry* entry) {
+    *entry->pprev = entry->next;
+    if (entry->next) {
+        entry->next->pprev = entry->pprev;
+    }
+    entry->next = NULL;
+    entry->pprev = NULL;
+}
+
+// Initialize empty wheel
+void timer_wheel_init(TimerWheel* wheel, uint32_t tick_ms, uint64_t now_ms) {
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->tick_ms = tick_ms ? tick_ms : 1;
+    wheel->start_ms = now_ms;
+}
+
+// Arm or re-arm timer to fire at expires_ms
+void timer_arm(TimerWheel* wheel, TimerEntry* entry, uint64_t expires_ms) {
+    if (entry->pprev) {
+        wheel_unlink(entry);
+    } else {
+        wheel->count++;
+    }
+
+    // Round up so a timer never fires early
+    uint64_t elapsed = expires_ms > wheel->start_ms ? expires_ms - wheel->start_ms : 0;
+    entry->expires = (elapsed + wheel->tick_ms - 1) / wheel->tick_ms;
+    if (entry->expires <= wheel->current_tick) {
+        entry->expires = wheel->current_tick + 1;
+    }
+
+    wheel_insert(wheel, entry);
+}
+
+// Disarm timer if armed
+void timer_cancel(TimerWheel* wheel, TimerEntry* entry) {
+    if (!entry->pprev) return;
+
+    wheel_unlink(entry);
+    wheel->count--;
+}
+
+// Check whether timer is armed
+bool timer_is_armed(const TimerEntry* entry) {
+    return entry->pprev != NULL;
+}
+
+// Move a higher-level slot down now that its range is current
+static void wheel_cascade(TimerWheel* wheel, int level) {
+    size_t slot = (wheel->current_tick >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK;
+    TimerEntry* entry = wheel->slots[level][slot];
+    wheel->slots[level][slot] = NULL;
+
+    while (entry) {
+        TimerEntry* next = entry->next;
+        entry->next = NULL;
+        entry->pprev = NULL;
+        wheel_insert(wheel, entry);
+        entry = next;
+    }
+}
+
+// Process every tick up to now_ms, firing expired timers.
+// Returns the number of timers fired.
+size_t timer_wheel_advance(TimerWheel* wheel, uint64_t now_ms,
+                           TimerCallback callback, void* user_data) {
+    if (now_ms < wheel->start_ms) return 0;
+
+    uint64_t target = (now_ms - wheel->start_ms) / wheel->tick_ms;
+    size_t fired = 0;
+
+    while (wheel->current_tick < target) {
+        wheel->current_tick++;
+
+        // Cascade when a lower level wraps
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            uint64_t mask = (1ULL << (TIMER_WHEEL_BITS * level)) - 1;
+            if ((wheel->current_tick & mask) != 0) break;
+            wheel_cascade(wheel, level);
+        }
+
+        TimerEntry** head = &wheel->slots[0][wheel->current_tick & SLOT_MASK];
+        while (*head) {
+            TimerEntry* entry = *head;
+            wheel_unlink(entry);
+            wheel->count--;
+            fired++;
+            if (callback) {
+                callback(entry, user_data);
+            }
+        }
+
+        // Skip empty stretches quickly when nothing is armed
+        if (wheel->count == 0) {
+            wheel->current_tick = target;
+        }
+    }
+
+    return fired;
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Wheel geometry: 4 levels of 64 slots. With 10ms ticks level 0 covers
+// 640ms, level 1 ~41s, level 2 ~44min and level 3 ~47h.
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+
+// Intrusive timer, embedded in the object it times
+typedef struct TimerEntry {
+    struct TimerEntry* next;      // Next entry in slot
+    struct TimerEntry** pprev;    // Link pointing at this entry, NULL if idle
+    uint64_t expires;             // Expiry tick
+} TimerEntry;
+
+// Hierarchical timing wheel
+typedef struct {
+    TimerEntry* slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS]; // Slot lists
+    uint64_t current_tick;        // Last processed tick
+    uint64_t start_ms;            // Time of tick 0
+    uint32_t tick_ms;             // Tick resolution
+    size_t count;                 // Armed timers
+} TimerWheel;
+
+// Expiry callback; the entry is already disarmed and may be re-armed
+typedef void (*TimerCallback)(TimerEntry* entry, void* user_data);
+
+// Wheel operations
+void timer_wheel_init(TimerWheel* wheel, uint32_t tick_ms, uint64_t now_ms);
+size_t timer_wheel_advance(TimerWheel* wheel, uint64_t now_ms,
+                           TimerCallback callback, void* user_data);
+
+// Timer operations, all O(1)
+void timer_arm(TimerWheel* wheel, TimerEntry* entry, uint64_t expires_ms);
+void timer_cancel(TimerWheel* wheel, TimerEntry* entry);
+bool timer_is_armed(const TimerEntry* entry);
+
+#endif // TIMER_H
\ No newline at end of file
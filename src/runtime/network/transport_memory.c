@@ -0,0 +1,401 @@
+#include "network.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+// In-process transport: endpoints are pairs of bounded byte pipes inside
+// one fabric, so several contexts and their clients can exchange frames
+// without touching the kernel. Writes block (EAGAIN) when the peer pipe
+// is full, exactly like a socket, and the same framing runs on top.
+#define MEMORY_PIPE_SIZE (256 * 1024)
+#define MEMORY_MAX_ENDPOINTS 4096
+#define MEMORY_MAX_LISTENERS 64
+#define MEMORY_ACCEPT_QUEUE 1024
+#define MEMORY_LISTENER_BASE (1 << 20)
+
+// One direction of a connection
+typedef struct {
+    uint8_t* data;               // Ring storage
+    size_t head;                 // Oldest byte
+    size_t count;                // Bytes buffered
+} MemoryPipe;
+
+// One end of a connection, reading from its own pipe
+typedef struct {
+    bool in_use;                 // Slot allocated
+    bool peer_closed;            // Peer end closed; drain then EOF
+    int peer;                    // Other end
+    MemoryPipe rx;               // Bytes written by the peer
+} MemoryEndpoint;
+
+// Listening port with its accept queue
+typedef struct {
+    bool in_use;                 // Slot allocated
+    uint16_t port;               // Fabric port
+    int pending[MEMORY_ACCEPT_QUEUE]; // Server ends awaiting accept
+    size_t pending_head;         // Oldest pending entry
+    size_t pending_count;        // Pending entries
+    size_t backlog;              // Pending entries allowed before refusing
+} MemoryListener;
+
+typedef struct {
+    pthread_mutex_t lock;        // Guards the whole fabric
+    pthread_cond_t activity;     // Signalled on every state change
+    MemoryEndpoint endpoints[MEMORY_MAX_ENDPOINTS];
+    MemoryListener listeners[MEMORY_MAX_LISTENERS];
+} MemoryFabric;
+
+static MemoryFabric* fabric_of(NetworkTransport* transport) {
+    return transport->state;
+}
+
+static MemoryEndpoint* endpoint_at(MemoryFabric* fabric, int handle) {
+    if (handle < 0 || handle >= MEMORY_MAX_ENDPOINTS) return NULL;
+    MemoryEndpoint* endpoint = &fabric->endpoints[handle];
+    return endpoint->in_use ? endpoint : NULL;
+}
+
+static MemoryListener* listener_at(MemoryFabric* fabric, int handle) {
+    int index = handle - MEMORY_LISTENER_BASE;
+    if (index < 0 || index >= MEMORY_MAX_LISTENERS) return NULL;
+    MemoryListener* listener = &fabric->listeners[index];
+    return listener->in_use ? listener : NULL;
+}
+
+// Allocate an endpoint, caller holds fabric lock
+static int endpoint_alloc(MemoryFabric* fabric) {
+    for (int i = 0; i < MEMORY_MAX_ENDPOINTS; i++) {
+        MemoryEndpoint* endpoint = &fabric->endpoints[i];
+        if (endpoint->in_use) continue;
+
+        endpoint->rx.data = malloc(MEMORY_PIPE_SIZE);
+        if (!endpoint->rx.data) return -1;
+        endpoint->rx.head = 0;
+        endpoint->rx.count = 0;
+        endpoint->in_use = true;
+        endpoint->peer_closed = false;
+        endpoint->peer = -1;
+        return i;
+    }
+    return -1;
+}
+
+static void endpoint_free(MemoryEndpoint* endpoint) {
+    free(endpoint->rx.data);
+    memset(endpoint, 0, sizeof(*endpoint));
+}
+
+// Register ctx->port as a fabric listener
+static bool memory_listen(NetworkTransport* transport, NetworkContext* ctx) {
+    MemoryFabric* fabric = fabric_of(transport);
+    int free_slot = -1;
+
+    pthread_mutex_lock(&fabric->lock);
+    for (int i = 0; i < MEMORY_MAX_LISTENERS; i++) {
+        if (fabric->listeners[i].in_use && fabric->listeners[i].port == ctx->port) {
+            pthread_mutex_unlock(&fabric->lock);
+            errno = EADDRINUSE;
+            return false;
+        }
+        if (!fabric->listeners[i].in_use && free_slot < 0) free_slot = i;
+    }
+    if (free_slot >= 0) {
+        MemoryListener* listener = &fabric->listeners[free_slot];
+        listener->in_use = true;
+        listener->port = ctx->port;
+        listener->pending_head = 0;
+        listener->pending_count = 0;
+        listener->backlog = ctx->backlog < MEMORY_ACCEPT_QUEUE ? ctx->backlog : MEMORY_ACCEPT_QUEUE;
+        ctx->server_socket = MEMORY_LISTENER_BASE + free_slot;
+    }
+    pthread_mutex_unlock(&fabric->lock);
+
+    return free_slot >= 0;
+}
+
+// Drop the listener, closing connections nobody accepted
+static void memory_unlisten(NetworkTransport* transport, NetworkContext* ctx) {
+    MemoryFabric* fabric = fabric_of(transport);
+
+    pthread_mutex_lock(&fabric->lock);
+    MemoryListener* listener = listener_at(fabric, ctx->server_socket);
+    if (listener) {
+        while (listener->pending_count > 0) {
+            int handle = listener->pending[listener->pending_head];
+            listener->pending_head = (listener->pending_head + 1) % MEMORY_ACCEPT_QUEUE;
+            listener->pending_count--;
+
+            MemoryEndpoint* endpoint = &fabric->endpoints[handle];
+            MemoryEndpoint* peer = endpoint_at(fabric, endpoint->peer);
+            if (peer) peer->peer_closed = true;
+            endpoint_free(endpoint);
+        }
+        listener->in_use = false;
+        pthread_cond_broadcast(&fabric->activity);
+    }
+    pthread_mutex_unlock(&fabric->lock);
+    ctx->server_socket = -1;
+}
+
+static int memory_accept(NetworkTransport* transport, int listener_handle) {
+    MemoryFabric* fabric = fabric_of(transport);
+    int handle = -1;
+
+    pthread_mutex_lock(&fabric->lock);
+    MemoryListener* listener = listener_at(fabric, listener_handle);
+    if (!listener) {
+        errno = EBADF;
+    } else if (listener->pending_count == 0) {
+        errno = EAGAIN;
+    } else {
+        handle = listener->pending[listener->pending_head];
+        listener->pending_head = (listener->pending_head + 1) % MEMORY_ACCEPT_QUEUE;
+        listener->pending_count--;
+    }
+    pthread_mutex_unlock(&fabric->lock);
+
+    return handle;
+}
+
+static ssize_t memory_read(NetworkTransport* transport, int handle, void* buffer,
+                           size_t size, NetworkConnection* conn) {
+    (void)conn;
+    MemoryFabric* fabric = fabric_of(transport);
+    ssize_t result;
+
+    pthread_mutex_lock(&fabric->lock);
+    MemoryEndpoint* endpoint = endpoint_at(fabric, handle);
+    if (!endpoint) {
+        errno = EBADF;
+        result = -1;
+    } else if (endpoint->rx.count == 0) {
+        errno = EAGAIN;
+        result = endpoint->peer_closed ? 0 : -1;
+    } else {
+        MemoryPipe* pipe = &endpoint->rx;
+        size_t len = pipe->count < size ? pipe->count : size;
+        size_t first = MEMORY_PIPE_SIZE - pipe->head;
+        if (first > len) first = len;
+
+        memcpy(buffer, pipe->data + pipe->head, first);
+        memcpy((uint8_t*)buffer + first, pipe->data, len - first);
+        pipe->head = (pipe->head + len) % MEMORY_PIPE_SIZE;
+        pipe->count -= len;
+        result = (ssize_t)len;
+
+        // Peer may be waiting for space
+        pthread_cond_broadcast(&fabric->activity);
+    }
+    pthread_mutex_unlock(&fabric->lock);
+
+    return result;
+}
+
+static ssize_t memory_write(NetworkTransport* transport, int handle,
+                            const struct iovec* iov, int count) {
+    MemoryFabric* fabric = fabric_of(transport);
+    ssize_t result = 0;
+
+    pthread_mutex_lock(&fabric->lock);
+    MemoryEndpoint* endpoint = endpoint_at(fabric, handle);
+    MemoryEndpoint* peer = endpoint ? endpoint_at(fabric, endpoint->peer) : NULL;
+    if (!endpoint || endpoint->peer_closed || !peer) {
+        errno = endpoint ? EPIPE : EBADF;
+        pthread_mutex_unlock(&fabric->lock);
+        return -1;
+    }
+
+    MemoryPipe* pipe = &peer->rx;
+    for (int i = 0; i < count && pipe->count < MEMORY_PIPE_SIZE; i++) {
+        size_t space = MEMORY_PIPE_SIZE - pipe->count;
+        size_t len = iov[i].iov_len < space ? iov[i].iov_len : space;
+        size_t tail = (pipe->head + pipe->count) % MEMORY_PIPE_SIZE;
+        size_t first = MEMORY_PIPE_SIZE - tail;
+        if (first > len) first = len;
+
+        memcpy(pipe->data + tail, iov[i].iov_base, first);
+        memcpy(pipe->data, (const uint8_t*)iov[i].iov_base + first, len - first);
+        pipe->count += len;
+        result += (ssize_t)len;
+    }
+
+    if (result == 0) {
+        errno = EAGAIN;
+        result = -1;
+    } else {
+        pthread_cond_broadcast(&fabric->activity);
+    }
+    pthread_mutex_unlock(&fabric->lock);
+
+    return result;
+}
+
+static void memory_close(NetworkTransport* transport, int handle) {
+    MemoryFabric* fabric = fabric_of(transport);
+
+    pthread_mutex_lock(&fabric->lock);
+    MemoryEndpoint* endpoint = endpoint_at(fabric, handle);
+    if (endpoint) {
+        MemoryEndpoint* peer = endpoint_at(fabric, endpoint->peer);
+        if (peer) peer->peer_closed = true;
+        endpoint_free(endpoint);
+        pthread_cond_broadcast(&fabric->activity);
+    }
+    pthread_mutex_unlock(&fabric->lock);
+}
+
+// Mark ready listener and connections, caller holds fabric lock
+static int memory_scan(MemoryFabric* fabric, NetworkContext* ctx) {
+    int ready = 0;
+
+    MemoryListener* listener = listener_at(fabric, ctx->server_socket);
+    if (listener && listener->pending_count > 0) {
+        ctx->listen_ready |= NET_LISTENER_SERVER;
+        ready++;
+    }
+
+    for (size_t i = 0; i < ctx->max_connections; i++) {
+        NetworkConnection* conn = &ctx->connections[i];
+        if (!conn->is_active) continue;
+
+        MemoryEndpoint* endpoint = endpoint_at(fabric, conn->socket);
+        if (!endpoint) continue;
+
+        uint8_t flags = 0;
+        if (endpoint->rx.count > 0 || endpoint->peer_closed) flags |= NET_READY_READ;
+        if (conn->want_write) {
+            MemoryEndpoint* peer = endpoint_at(fabric, endpoint->peer);
+            if (!peer || endpoint->peer_closed || peer->rx.count < MEMORY_PIPE_SIZE) {
+                flags |= NET_READY_WRITE;
+            }
+        }
+        if (flags) {
+            conn->ready |= flags;
+            ready++;
+        }
+    }
+    return ready;
+}
+
+// Report activity, sleeping on the fabric until something changes
+static int memory_poll(NetworkTransport* transport, NetworkContext* ctx, int timeout_ms) {
+    MemoryFabric* fabric = fabric_of(transport);
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&fabric->lock);
+    int ready = memory_scan(fabric, ctx);
+    while (ready == 0 && timeout_ms > 0) {
+        if (pthread_cond_timedwait(&fabric->activity, &fabric->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+        ready = memory_scan(fabric, ctx);
+    }
+    pthread_mutex_unlock(&fabric->lock);
+
+    return ready;
+}
+
+// Fabric ports ignore the host
+static int memory_connect(NetworkTransport* transport, const char* host, uint16_t port) {
+    (void)host;
+    return network_memory_connect(transport, port);
+}
+
+// Create an empty fabric
+NetworkTransport* network_memory_transport_create(void) {
+    NetworkTransport* transport = calloc(1, sizeof(NetworkTransport));
+    MemoryFabric* fabric = calloc(1, sizeof(MemoryFabric));
+    if (!transport || !fabric) {
+        free(transport);
+        free(fabric);
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&fabric->lock, NULL) != 0) {
+        free(transport);
+        free(fabric);
+        return NULL;
+    }
+    if (pthread_cond_init(&fabric->activity, NULL) != 0) {
+        pthread_mutex_destroy(&fabric->lock);
+        free(transport);
+        free(fabric);
+        return NULL;
+    }
+
+    transport->name = "memory";
+    transport->pollable = false;
+    transport->waitable = false;
+    transport->listen = memory_listen;
+    transport->unlisten = memory_unlisten;
+    transport->accept = memory_accept;
+    transport->connect = memory_connect;
+    transport->read = memory_read;
+    transport->write = memory_write;
+    transport->close = memory_close;
+    transport->poll = memory_poll;
+    transport->state = fabric;
+    return transport;
+}
+
+// Destroy fabric; every context using it must be stopped first
+void network_memory_transport_destroy(NetworkTransport* transport) {
+    if (!transport) return;
+
+    MemoryFabric* fabric = fabric_of(transport);
+    for (int i = 0; i < MEMORY_MAX_ENDPOINTS; i++) {
+        free(fabric->endpoints[i].rx.data);
+    }
+    pthread_cond_destroy(&fabric->activity);
+    pthread_mutex_destroy(&fabric->lock);
+    free(fabric);
+    free(transport);
+}
+
+// Connect to a listening port in the fabric. Returns the client handle,
+// used with the transport's read, write and close, or -1.
+int network_memory_connect(NetworkTransport* transport, uint16_t port) {
+    if (!transport || transport->listen != memory_listen) return -1;
+    MemoryFabric* fabric = fabric_of(transport);
+
+    pthread_mutex_lock(&fabric->lock);
+    MemoryListener* listener = NULL;
+    for (int i = 0; i < MEMORY_MAX_LISTENERS; i++) {
+        if (fabric->listeners[i].in_use && fabric->listeners[i].port == port) {
+            listener = &fabric->listeners[i];
+            break;
+        }
+    }
+    if (!listener || listener->pending_count >= listener->backlog) {
+        pthread_mutex_unlock(&fabric->lock);
+        errno = ECONNREFUSED;
+        return -1;
+    }
+
+    int client = endpoint_alloc(fabric);
+    int server = client >= 0 ? endpoint_alloc(fabric) : -1;
+    if (server < 0) {
+        if (client >= 0) endpoint_free(&fabric->endpoints[client]);
+        pthread_mutex_unlock(&fabric->lock);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    fabric->endpoints[client].peer = server;
+    fabric->endpoints[server].peer = client;
+    listener->pending[(listener->pending_head + listener->pending_count) % MEMORY_ACCEPT_QUEUE] = server;
+    listener->pending_count++;
+    pthread_cond_broadcast(&fabric->activity);
+    pthread_mutex_unlock(&fabric->lock);
+
+    return client;
+}
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include "network.h"
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <stdio.h>
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
+
+#define INVALID_SOCKET -1
+
+// Helper to set socket non-blocking
+static bool set_nonblocking(int sock) {
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags == -1) return false;
+    return fcntl(sock, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+// Helper to set socket options
+static bool set_socket_options(int sock) {
+    int yes = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (void*)&yes, sizeof(yes)) == -1) {
+        return false;
+    }
+
+    struct linger ling = {0, 0}; // Disable linger
+    if (setsockopt(sock, SOL_SOCKET, SO_LINGER, (void*)&ling, sizeof(ling)) == -1) {
+        return false;
+    }
+
+    return true;
+}
+
+// Frames are coalesced before writing, so Nagle only adds a delayed-ACK
+// stall to the tail of each flush. Fails harmlessly on AF_UNIX sockets.
+static void set_nodelay(int sock) {
+    int yes = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (void*)&yes, sizeof(yes));
+}
+
+// Listen on the configured TCP port
+static bool open_tcp_listener(NetworkContext* ctx) {
+    ctx->server_socket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (ctx->server_socket == INVALID_SOCKET) return false;
+
+    struct sockaddr_in server_addr = {0};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = INADDR_ANY;
+    server_addr.sin_port = htons(ctx->port);
+
+    if (!set_socket_options(ctx->server_socket) || !set_nonblocking(ctx->server_socket) ||
+        bind(ctx->server_socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) == -1 ||
+        listen(ctx->server_socket, (int)ctx->backlog) == -1) {
+        close(ctx->server_socket);
+        ctx->server_socket = INVALID_SOCKET;
+        return false;
+    }
+    return true;
+}
+
+// Listen on the configured AF_UNIX path, replacing a stale socket file
+static bool open_unix_listener(NetworkContext* ctx) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, ctx->unix_path, sizeof(addr.sun_path) - 1);
+
+    ctx->unix_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (ctx->unix_socket == INVALID_SOCKET) return false;
+
+    unlink(ctx->unix_path);
+    if (!set_nonblocking(ctx->unix_socket) ||
+        bind(ctx->unix_socket, (struct sockaddr*)&addr, sizeof(addr)) == -1 ||
+        listen(ctx->unix_socket, (int)ctx->backlog) == -1) {
+        close(ctx->unix_socket);
+        ctx->unix_socket = INVALID_SOCKET;
+        return false;
+    }
+    return true;
+}
+
+// Close listeners, removing the local socket file
+static void socket_unlisten(NetworkTransport* transport, NetworkContext* ctx) {
+    (void)transport;
+
+    if (ctx->server_socket != INVALID_SOCKET) {
+        close(ctx->server_socket);
+        ctx->server_socket = INVALID_SOCKET;
+    }
+    if (ctx->unix_socket != INVALID_SOCKET) {
+        close(ctx->unix_socket);
+        ctx->unix_socket = INVALID_SOCKET;
+        unlink(ctx->unix_path);
+    }
+}
+
+// Open the TCP listener and, if configured, the local one
+static bool socket_listen(NetworkTransport* transport, NetworkContext* ctx) {
+    if (!open_tcp_listener(ctx)) return false;
+
+    if (ctx->unix_path[0] && !open_unix_listener(ctx)) {
+        socket_unlisten(transport, ctx);
+        return false;
+    }
+    return true;
+}
+
+// Accept one pending client socket, non-blocking and close-on-exec
+static int socket_accept(NetworkTransport* transport, int listener) {
+    (void)transport;
+    struct sockaddr_storage client_addr;
+    socklen_t addr_len = sizeof(client_addr);
+
+#ifdef __linux__
+    int client_sock = accept4(listener, (struct sockaddr*)&client_addr, &addr_len,
+                              SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    int client_sock = accept(listener, (struct sockaddr*)&client_addr, &addr_len);
+    if (client_sock != INVALID_SOCKET && !set_nonblocking(client_sock)) {
+        close(client_sock);
+        errno = EINVAL;
+        return INVALID_SOCKET;
+    }
+#endif
+    if (client_sock != INVALID_SOCKET && client_addr.ss_family != AF_UNIX) {
+        set_nodelay(client_sock);
+    }
+    return client_sock;
+}
+
+// Start a non-blocking connect to host:port, trying each resolved
+// address. Name resolution itself blocks.
+static int socket_connect(NetworkTransport* transport, const char* host, uint16_t port) {
+    (void)transport;
+    struct addrinfo hints = {0};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    char service[8];
+    snprintf(service, sizeof(service), "%u", (unsigned)port);
+    struct addrinfo* addresses = NULL;
+    if (!host || getaddrinfo(host, service, &hints, &addresses) != 0) {
+        errno = EHOSTUNREACH;
+        return INVALID_SOCKET;
+    }
+
+    int sock = INVALID_SOCKET;
+    for (struct addrinfo* ai = addresses; ai; ai = ai->ai_next) {
+        sock = socket(ai->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (sock == INVALID_SOCKET) continue;
+
+        set_nodelay(sock);
+        if (connect(sock, ai->ai_addr, ai->ai_addrlen) == 0 || errno == EINPROGRESS) break;
+        close(sock);
+        sock = INVALID_SOCKET;
+    }
+    freeaddrinfo(addresses);
+    return sock;
+}
+
+// Receive, keeping descriptors passed with SCM_RIGHTS on conn. Only
+// AF_UNIX peers can pass them; extras beyond the first set are closed.
+static ssize_t socket_read(NetworkTransport* transport, int handle, void* buffer,
+                           size_t size, NetworkConnection* conn) {
+    (void)transport;
+    struct iovec iov = {buffer, size};
+
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int) * 3)];
+    } control;
+
+    struct msghdr hdr = {0};
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control.buf;
+    hdr.msg_controllen = sizeof(control.buf);
+
+    ssize_t bytes = recvmsg(handle, &hdr, MSG_CMSG_CLOEXEC);
+    if (bytes < 0) return bytes;
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        int fds[3];
+        memcpy(fds, CMSG_DATA(cmsg), (count < 3 ? count : 3) * sizeof(int));
+        for (size_t i = 0; i < count && i < 3; i++) {
+            if (conn && conn->passed_count < 3) {
+                conn->passed_fds[conn->passed_count++] = fds[i];
+            } else {
+                close(fds[i]);
+            }
+        }
+    }
+    return bytes;
+}
+
+// Gather-write without raising SIGPIPE
+static ssize_t socket_write(NetworkTransport* transport, int handle,
+                            const struct iovec* iov, int count) {
+    (void)transport;
+    struct msghdr hdr = {0};
+    hdr.msg_iov = (struct iovec*)iov;
+    hdr.msg_iovlen = (size_t)count;
+    return sendmsg(handle, &hdr, MSG_NOSIGNAL | MSG_DONTWAIT);
+}
+
+static void socket_close(NetworkTransport* transport, int handle) {
+    (void)transport;
+    close(handle);
+}
+
+// Ready entries taken per poll; level triggering reports the rest on
+// the next one
+#define POLL_BATCH 256
+
+// Wait for listener, connection and shared-memory activity on the
+// context's epoll set, which the poll loop keeps registered
+static int socket_poll(NetworkTransport* transport, NetworkContext* ctx, int timeout_ms) {
+    (void)transport;
+    if (ctx->poll_fd == INVALID_SOCKET) return 0;
+
+    struct epoll_event events[POLL_BATCH];
+    int activity = epoll_wait(ctx->poll_fd, events, POLL_BATCH, timeout_ms);
+    if (activity <= 0) return activity;
+
+    ctx->listen_ready = 0;
+    for (int i = 0; i < activity; i++) {
+        uint32_t source = (uint32_t)(events[i].data.u64 >> 32);
+        uint32_t index = (uint32_t)events[i].data.u64;
+        if (source == NET_POLL_LISTENER) {
+            ctx->listen_ready |= index;
+            continue;
+        }
+
+        if (index >= ctx->max_connections) continue;
+        NetworkConnection* conn = &ctx->connections[index];
+        if (!conn->is_active) continue;
+
+        // Errors and hangups surface through the read
+        if (source == NET_POLL_SHM) {
+            conn->ready |= NET_READY_EVENT;
+        } else {
+            if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) conn->ready |= NET_READY_READ;
+            if (events[i].events & EPOLLOUT) conn->ready |= NET_READY_WRITE;
+        }
+    }
+    return activity;
+}
+
+static NetworkTransport socket_transport = {
+    .name = "socket",
+    .pollable = true,
+    .waitable = true,
+    .listen = socket_listen,
+    .unlisten = socket_unlisten,
+    .accept = socket_accept,
+    .connect = socket_connect,
+    .read = socket_read,
+    .write = socket_write,
+    .close = socket_close,
+    .poll = socket_poll,
+    .state = NULL
+};
+
+// Default BSD socket transport
+NetworkTransport* network_socket_transport(void) {
+    return &socket_transport;
+}
\ No newline at end of file
@@ -0,0 +1,482 @@
+#include "network.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+
+// TLS transport: the socket transport underneath, with an SSL object per
+// handle. Handshakes run inside read and write as bytes arrive. Writes
+// stage up to one record; once OpenSSL accepts a staged record it must be
+// retried with the same bytes, so a blocked record is reported written
+// and flushed from the stage before anything new is taken.
+#define TLS_RECORD_SIZE 16384
+#define TLS_SESSION_CACHE 64
+#define TLS_MAX_HANDLES (1 << 20)
+
+// Per-handle state
+typedef struct {
+    SSL* ssl;                    // Connection
+    pthread_mutex_t lock;        // SSL objects are not thread-safe
+    uint8_t stage[TLS_RECORD_SIZE]; // Plaintext OpenSSL accepted but could not send
+    size_t staged;               // Bytes in stage
+    bool read_wants_write;       // Handshake stalled on a full socket
+    bool established;            // Handshake counted
+    int cache_slot;              // Client session cache entry, -1 if not cached
+    char peer[128];              // Cache key, "host:port"
+} TlsSession;
+
+// Cached client session for one peer
+typedef struct {
+    char peer[128];              // Cache key
+    SSL_SESSION* session;        // Latest ticket, NULL if none yet
+} TlsCacheEntry;
+
+typedef struct {
+    NetworkTransport* base;      // Socket transport
+    SSL_CTX* server_ctx;         // NULL without a certificate
+    SSL_CTX* client_ctx;         // Outbound connections
+    TlsSession** sessions;       // Indexed by handle
+    size_t max_handles;          // Entries in sessions
+    pthread_mutex_t lock;        // Guards cache and stats
+    TlsCacheEntry cache[TLS_SESSION_CACHE]; // Client sessions by peer
+    size_t cache_next;           // Next entry to replace
+    bool resume;                 // Resume cached client sessions
+    NetworkTlsStats stats;       // Handshake counters
+} TlsState;
+
+static int session_index = -1;
+static pthread_once_t session_index_once = PTHREAD_ONCE_INIT;
+
+static TlsState* tls_of(NetworkTransport* transport) {
+    return transport->state;
+}
+
+static TlsSession* session_at(TlsState* tls, int handle) {
+    if (handle < 0 || (size_t)handle >= tls->max_handles) return NULL;
+    return tls->sessions[handle];
+}
+
+// Count a finished handshake once, caller holds session lock
+static void note_established(TlsState* tls, TlsSession* session) {
+    if (session->established || !SSL_is_init_finished(session->ssl)) return;
+    session->established = true;
+
+    pthread_mutex_lock(&tls->lock);
+    tls->stats.handshakes++;
+    if (SSL_session_reused(session->ssl)) tls->stats.resumed++;
+#ifdef SSL_OP_ENABLE_KTLS
+    if (BIO_get_ktls_send(SSL_get_wbio(session->ssl))) tls->stats.ktls_send++;
+#endif
+    pthread_mutex_unlock(&tls->lock);
+}
+
+// Map an SSL result to socket conventions, caller holds session lock.
+// Returns -1 with errno set.
+static ssize_t ssl_failure(TlsState* tls, TlsSession* session, int result, bool reading) {
+    switch (SSL_get_error(session->ssl, result)) {
+        case SSL_ERROR_WANT_READ:
+            errno = EAGAIN;
+            return -1;
+
+        case SSL_ERROR_WANT_WRITE:
+            if (reading) session->read_wants_write = true;
+            errno = EAGAIN;
+            return -1;
+
+        case SSL_ERROR_ZERO_RETURN:
+            errno = 0;
+            return 0;
+
+        default:
+            ERR_clear_error();
+            pthread_mutex_lock(&tls->lock);
+            tls->stats.failures++;
+            pthread_mutex_unlock(&tls->lock);
+            errno = ECONNRESET;
+            return -1;
+    }
+}
+
+// Retry a staged record, caller holds session lock. Returns false with
+// errno set while it is still blocked or the connection failed.
+static bool flush_stage(TlsState* tls, TlsSession* session) {
+    if (session->staged == 0) return true;
+
+    size_t written;
+    if (!SSL_write_ex(session->ssl, session->stage, session->staged, &written)) {
+        ssl_failure(tls, session, 0, false);
+        if (errno == 0) errno = EPIPE;
+        return false;
+    }
+
+    note_established(tls, session);
+    session->staged -= written;
+    memmove(session->stage, session->stage + written, session->staged);
+    if (session->staged > 0) {
+        errno = EAGAIN;
+        return false;
+    }
+    return true;
+}
+
+// Attach an SSL object to a connected socket
+static bool session_create(TlsState* tls, int handle, SSL_CTX* ssl_ctx, bool server,
+                           const char* host, uint16_t port) {
+    if (handle < 0 || (size_t)handle >= tls->max_handles) return false;
+
+    TlsSession* session = calloc(1, sizeof(TlsSession));
+    if (!session) return false;
+    session->cache_slot = -1;
+    session->ssl = SSL_new(ssl_ctx);
+    if (!session->ssl || !SSL_set_fd(session->ssl, handle) ||
+        pthread_mutex_init(&session->lock, NULL) != 0) {
+        SSL_free(session->ssl);
+        free(session);
+        return false;
+    }
+    SSL_set_ex_data(session->ssl, session_index, tls);
+
+    if (server) {
+        SSL_set_accept_state(session->ssl);
+    } else {
+        SSL_set_connect_state(session->ssl);
+        if (host) SSL_set_tlsext_host_name(session->ssl, host);
+
+        snprintf(session->peer, sizeof(session->peer), "%s:%u", host ? host : "", (unsigned)port);
+
+        // Resume the last session with this peer
+        pthread_mutex_lock(&tls->lock);
+        int slot = -1;
+        for (int i = 0; i < TLS_SESSION_CACHE && tls->resume; i++) {
+            if (strcmp(tls->cache[i].peer, session->peer) == 0) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0 && tls->resume) {
+            slot = (int)tls->cache_next;
+            tls->cache_next = (tls->cache_next + 1) % TLS_SESSION_CACHE;
+            SSL_SESSION_free(tls->cache[slot].session);
+            tls->cache[slot].session = NULL;
+            memcpy(tls->cache[slot].peer, session->peer, sizeof(session->peer));
+        }
+        if (slot >= 0 && tls->cache[slot].session) {
+            SSL_set_session(session->ssl, tls->cache[slot].session);
+        }
+        pthread_mutex_unlock(&tls->lock);
+
+        session->cache_slot = slot;
+        if (host && SSL_CTX_get_verify_mode(ssl_ctx) != SSL_VERIFY_NONE) {
+            SSL_set1_host(session->ssl, host);
+        }
+    }
+
+    tls->sessions[handle] = session;
+    return true;
+}
+
+static void session_destroy(TlsState* tls, int handle) {
+    TlsSession* session = session_at(tls, handle);
+    if (!session) return;
+
+    tls->sessions[handle] = NULL;
+    if (session->established) SSL_shutdown(session->ssl);
+    SSL_free(session->ssl);
+    ERR_clear_error();
+    pthread_mutex_destroy(&session->lock);
+    free(session);
+}
+
+// Keep the newest ticket for the peer; TLS 1.3 tickets arrive after
+// the handshake, inside a later read
+static int on_new_session(SSL* ssl, SSL_SESSION* ticket) {
+    TlsState* tls = SSL_get_ex_data(ssl, session_index);
+    TlsSession* session = tls ? session_at(tls, SSL_get_fd(ssl)) : NULL;
+    if (!session || session->cache_slot < 0) return 0;
+
+    // The entry may have been handed to another peer since
+    pthread_mutex_lock(&tls->lock);
+    TlsCacheEntry* entry = &tls->cache[session->cache_slot];
+    bool keep = strcmp(entry->peer, session->peer) == 0;
+    if (keep) {
+        SSL_SESSION_free(entry->session);
+        entry->session = ticket;
+    }
+    pthread_mutex_unlock(&tls->lock);
+    return keep ? 1 : 0;
+}
+
+static bool tls_listen(NetworkTransport* transport, NetworkContext* ctx) {
+    TlsState* tls = tls_of(transport);
+    if (!tls->server_ctx) return false;
+    return tls->base->listen(tls->base, ctx);
+}
+
+static void tls_unlisten(NetworkTransport* transport, NetworkContext* ctx) {
+    TlsState* tls = tls_of(transport);
+    tls->base->unlisten(tls->base, ctx);
+}
+
+static int tls_accept(NetworkTransport* transport, int listener) {
+    TlsState* tls = tls_of(transport);
+    int handle = tls->base->accept(tls->base, listener);
+    if (handle < 0) return handle;
+
+    if (!session_create(tls, handle, tls->server_ctx, true, NULL, 0)) {
+        tls->base->close(tls->base, handle);
+        errno = ENOMEM;
+        return -1;
+    }
+    return handle;
+}
+
+static int tls_connect(NetworkTransport* transport, const char* host, uint16_t port) {
+    TlsState* tls = tls_of(transport);
+    int handle = tls->base->connect(tls->base, host, port);
+    if (handle < 0) return handle;
+
+    if (!session_create(tls, handle, tls->client_ctx, false, host, port)) {
+        tls->base->close(tls->base, handle);
+        errno = ENOMEM;
+        return -1;
+    }
+    return handle;
+}
+
+static ssize_t tls_read(NetworkTransport* transport, int handle, void* buffer,
+                        size_t size, NetworkConnection* conn) {
+    (void)conn;
+    TlsState* tls = tls_of(transport);
+    TlsSession* session = session_at(tls, handle);
+    if (!session) {
+        errno = EBADF;
+        return -1;
+    }
+
+    pthread_mutex_lock(&session->lock);
+    session->read_wants_write = false;
+
+    // A staged record may be what the peer is waiting for
+    if (!flush_stage(tls, session) && errno != EAGAIN) {
+        pthread_mutex_unlock(&session->lock);
+        return -1;
+    }
+
+    size_t bytes;
+    ssize_t result;
+    if (SSL_read_ex(session->ssl, buffer, size, &bytes)) {
+        result = (ssize_t)bytes;
+    } else {
+        result = ssl_failure(tls, session, 0, true);
+    }
+    note_established(tls, session);
+    pthread_mutex_unlock(&session->lock);
+    return result;
+}
+
+// Stage up to one record from iov and hand it to OpenSSL
+static ssize_t tls_write(NetworkTransport* transport, int handle,
+                         const struct iovec* iov, int count) {
+    TlsState* tls = tls_of(transport);
+    TlsSession* session = session_at(tls, handle);
+    if (!session) {
+        errno = EBADF;
+        return -1;
+    }
+
+    pthread_mutex_lock(&session->lock);
+    if (!flush_stage(tls, session)) {
+        pthread_mutex_unlock(&session->lock);
+        return -1;
+    }
+
+    for (int i = 0; i < count && session->staged < TLS_RECORD_SIZE; i++) {
+        size_t len = iov[i].iov_len;
+        if (len > TLS_RECORD_SIZE - session->staged) len = TLS_RECORD_SIZE - session->staged;
+        memcpy(session->stage + session->staged, iov[i].iov_base, len);
+        session->staged += len;
+    }
+
+    // Taken either way: sent now, or pinned in the stage until it is
+    size_t taken = session->staged;
+    if (!flush_stage(tls, session) && errno != EAGAIN) {
+        session->staged = 0;
+        pthread_mutex_unlock(&session->lock);
+        return -1;
+    }
+    pthread_mutex_unlock(&session->lock);
+    return (ssize_t)taken;
+}
+
+static void tls_close(NetworkTransport* transport, int handle) {
+    TlsState* tls = tls_of(transport);
+    session_destroy(tls, handle);
+    tls->base->close(tls->base, handle);
+}
+
+// Socket poll, plus work the descriptors cannot signal: staged records
+// wait for writability and decrypted bytes buffered in OpenSSL are
+// readable without the socket being so
+static int tls_poll(NetworkTransport* transport, NetworkContext* ctx, int timeout_ms) {
+    TlsState* tls = tls_of(transport);
+    int buffered = 0;
+
+    for (size_t i = 0; i < ctx->max_connections; i++) {
+        NetworkConnection* conn = &ctx->connections[i];
+        TlsSession* session = conn->is_active ? session_at(tls, conn->socket) : NULL;
+        if (!session) continue;
+
+        pthread_mutex_lock(&session->lock);
+        if (!flush_stage(tls, session) && errno == EAGAIN) conn->want_write = 1;
+        if (session->read_wants_write) conn->want_write = 1;
+        if (SSL_has_pending(session->ssl)) buffered++;
+        pthread_mutex_unlock(&session->lock);
+    }
+
+    int activity = tls->base->poll(tls->base, ctx, buffered ? 0 : timeout_ms);
+    if (activity < 0) return activity;
+
+    for (size_t i = 0; i < ctx->max_connections && (buffered || activity > 0); i++) {
+        NetworkConnection* conn = &ctx->connections[i];
+        TlsSession* session = conn->is_active ? session_at(tls, conn->socket) : NULL;
+        if (!session) continue;
+
+        pthread_mutex_lock(&session->lock);
+        bool ready = SSL_has_pending(session->ssl) ||
+                     (session->read_wants_write && (conn->ready & NET_READY_WRITE));
+        pthread_mutex_unlock(&session->lock);
+        if (ready && !(conn->ready & NET_READY_READ)) {
+            conn->ready |= NET_READY_READ;
+            activity++;
+        }
+    }
+    return activity;
+}
+
+static void make_session_index(void) {
+    session_index = SSL_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+}
+
+// Context restricted to TLS 1.3
+static SSL_CTX* new_context(const SSL_METHOD* method, const NetworkTlsConfig* config) {
+    SSL_CTX* ssl_ctx = SSL_CTX_new(method);
+    if (!ssl_ctx) return NULL;
+
+    SSL_CTX_set_min_proto_version(ssl_ctx, TLS1_3_VERSION);
+    SSL_CTX_set_mode(ssl_ctx, SSL_MODE_ENABLE_PARTIAL_WRITE |
+                              SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+#ifdef SSL_OP_ENABLE_KTLS
+    if (config->ktls) SSL_CTX_set_options(ssl_ctx, SSL_OP_ENABLE_KTLS);
+#endif
+    if (config->ca_file) {
+        if (SSL_CTX_load_verify_locations(ssl_ctx, config->ca_file, NULL) != 1) {
+            SSL_CTX_free(ssl_ctx);
+            return NULL;
+        }
+        SSL_CTX_set_verify(ssl_ctx, SSL_VERIFY_PEER, NULL);
+    }
+    return ssl_ctx;
+}
+
+// Create a TLS transport; NULL if the certificate or key cannot be loaded
+NetworkTransport* network_tls_transport_create(const NetworkTlsConfig* config) {
+    if (!config || (config->cert_file && !config->key_file)) return NULL;
+    pthread_once(&session_index_once, make_session_index);
+    if (session_index < 0) return NULL;
+
+    // OpenSSL writes to sockets without MSG_NOSIGNAL
+    struct sigaction action;
+    if (sigaction(SIGPIPE, NULL, &action) == 0 && action.sa_handler == SIG_DFL) {
+        signal(SIGPIPE, SIG_IGN);
+    }
+
+    NetworkTransport* transport = calloc(1, sizeof(NetworkTransport));
+    TlsState* tls = calloc(1, sizeof(TlsState));
+    struct rlimit limit;
+    if (tls) {
+        tls->max_handles = getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < TLS_MAX_HANDLES
+                         ? (size_t)limit.rlim_cur : TLS_MAX_HANDLES;
+        tls->sessions = calloc(tls->max_handles, sizeof(TlsSession*));
+    }
+    if (!transport || !tls || !tls->sessions || pthread_mutex_init(&tls->lock, NULL) != 0) {
+        if (tls) free(tls->sessions);
+        free(tls);
+        free(transport);
+        return NULL;
+    }
+    transport->state = tls;
+    tls->base = network_socket_transport();
+    tls->resume = !config->no_resume;
+
+    tls->client_ctx = new_context(TLS_client_method(), config);
+    if (!tls->client_ctx) {
+        network_tls_transport_destroy(transport);
+        return NULL;
+    }
+    SSL_CTX_set_session_cache_mode(tls->client_ctx,
+                                   SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(tls->client_ctx, on_new_session);
+
+    if (config->cert_file) {
+        tls->server_ctx = new_context(TLS_server_method(), config);
+        if (!tls->server_ctx ||
+            SSL_CTX_use_certificate_chain_file(tls->server_ctx, config->cert_file) != 1 ||
+            SSL_CTX_use_PrivateKey_file(tls->server_ctx, config->key_file, SSL_FILETYPE_PEM) != 1 ||
+            SSL_CTX_check_private_key(tls->server_ctx) != 1) {
+            network_tls_transport_destroy(transport);
+            return NULL;
+        }
+
+        // Stateless tickets: resuming clients skip the certificate exchange
+        static const unsigned char context_id[] = "phantomid";
+        SSL_CTX_set_session_id_context(tls->server_ctx, context_id, sizeof(context_id) - 1);
+        SSL_CTX_set_session_cache_mode(tls->server_ctx, SSL_SESS_CACHE_SERVER);
+    }
+
+    transport->name = "tls";
+    transport->pollable = true;
+    transport->waitable = false; // OpenSSL buffers plaintext the socket cannot show
+    transport->encrypted = true;
+    transport->listen = tls_listen;
+    transport->unlisten = tls_unlisten;
+    transport->accept = tls_accept;
+    transport->connect = tls_connect;
+    transport->read = tls_read;
+    transport->write = tls_write;
+    transport->close = tls_close;
+    transport->poll = tls_poll;
+    return transport;
+}
+
+// Destroy transport; every context and client using it must be closed first
+void network_tls_transport_destroy(NetworkTransport* transport) {
+    if (!transport) return;
+
+    TlsState* tls = tls_of(transport);
+    for (size_t i = 0; i < tls->max_handles; i++) {
+        if (tls->sessions[i]) session_destroy(tls, (int)i);
+    }
+    for (int i = 0; i < TLS_SESSION_CACHE; i++) {
+        SSL_SESSION_free(tls->cache[i].session);
+    }
+    SSL_CTX_free(tls->server_ctx);
+    SSL_CTX_free(tls->client_ctx);
+    pthread_mutex_destroy(&tls->lock);
+    free(tls->sessions);
+    free(tls);
+    free(transport);
+}
+
+void network_tls_get_stats(NetworkTransport* transport, NetworkTlsStats* stats) {
+    if (!transport || !stats || transport->listen != tls_listen) return;
+
+    TlsState* tls = tls_of(transport);
+    pthread_mutex_lock(&tls->lock);
+    *stats = tls->stats;
+    pthread_mutex_unlock(&tls->lock);
+}
\ No newline at end of file
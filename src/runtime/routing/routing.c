@@ -0,0 +1,511 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "routing.h"
+
+#define INDEX_EMPTY -1
+#define INDEX_TOMBSTONE -2
+#define MIN_NODES 64
+
+static uint32_t hash_id(const char* id) {
+    uint32_t hash = 2166136261u;
+    for (const char* p = id; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    return hash;
+}
+
+static bool valid_id(const char* id) {
+    return id && id[0] && strlen(id) < 64;
+}
+
+// Identity slot for id, ROUTING_NONE if absent
+static int32_t index_find(RoutingTable* rt, const char* id) {
+    size_t mask = rt->index_capacity - 1;
+    for (size_t i = hash_id(id) & mask;; i = (i + 1) & mask) {
+        int32_t slot = rt->index[i];
+        if (slot == INDEX_EMPTY) return ROUTING_NONE;
+        if (slot >= 0 && strcmp(rt->nodes[slot].id, id) == 0) return slot;
+    }
+}
+
+// Insert slot without growing; caller keeps the table under half full
+static void index_put(RoutingTable* rt, int32_t slot) {
+    size_t mask = rt->index_capacity - 1;
+    size_t i = hash_id(rt->nodes[slot].id) & mask;
+    while (rt->index[i] >= 0) {
+        i = (i + 1) & mask;
+    }
+    if (rt->index[i] == INDEX_EMPTY) {
+        rt->index_used++;
+    }
+    rt->index[i] = slot;
+}
+
+static void index_erase(RoutingTable* rt, const char* id) {
+    size_t mask = rt->index_capacity - 1;
+    for (size_t i = hash_id(id) & mask; rt->index[i] != INDEX_EMPTY; i = (i + 1) & mask) {
+        int32_t slot = rt->index[i];
+        if (slot >= 0 && strcmp(rt->nodes[slot].id, id) == 0) {
+            rt->index[i] = INDEX_TOMBSTONE;
+            return;
+        }
+    }
+}
+
+// Rebuild the index for the current identities, dropping tombstones
+static bool index_rebuild(RoutingTable* rt, size_t capacity) {
+    int32_t* index = malloc(capacity * sizeof(int32_t));
+    if (!index) return false;
+
+    for (size_t i = 0; i < capacity; i++) {
+        index[i] = INDEX_EMPTY;
+    }
+    free(rt->index);
+    rt->index = index;
+    rt->index_capacity = capacity;
+    rt->index_used = 0;
+
+    for (size_t slot = 0; slot < rt->node_capacity; slot++) {
+        if (rt->nodes[slot].id[0]) {
+            index_put(rt, (int32_t)slot);
+        }
+    }
+    return true;
+}
+
+// Take a free identity slot, growing the arrays when full
+static int32_t node_alloc(RoutingTable* rt) {
+    if (rt->free_head == ROUTING_NONE) {
+        size_t capacity = rt->node_capacity * 2;
+        RoutingNode* nodes = realloc(rt->nodes, capacity * sizeof(RoutingNode));
+        if (!nodes) return ROUTING_NONE;
+
+        memset(nodes + rt->node_capacity, 0, (capacity - rt->node_capacity) * sizeof(RoutingNode));
+        for (size_t i = capacity; i > rt->node_capacity; i--) {
+            nodes[i - 1].next_sibling = rt->free_head;
+            rt->free_head = (int32_t)(i - 1);
+        }
+        rt->nodes = nodes;
+        rt->node_capacity = capacity;
+    }
+
+    // Keep the index at most half occupied, tombstones included
+    if ((rt->index_used + 1) * 2 > rt->index_capacity) {
+        size_t capacity = rt->index_capacity;
+        while ((rt->node_count + 1) * 4 > capacity) capacity *= 2;
+        if (!index_rebuild(rt, capacity)) return ROUTING_NONE;
+    }
+
+    int32_t slot = rt->free_head;
+    rt->free_head = rt->nodes[slot].next_sibling;
+    return slot;
+}
+
+static void node_free(RoutingTable* rt, int32_t slot) {
+    memset(&rt->nodes[slot], 0, sizeof(RoutingNode));
+    rt->nodes[slot].next_sibling = rt->free_head;
+    rt->free_head = slot;
+}
+
+static void node_link(RoutingTable* rt, int32_t slot, int32_t parent) {
+    RoutingNode* node = &rt->nodes[slot];
+    node->parent = parent;
+    node->next_sibling = ROUTING_NONE;
+    if (parent != ROUTING_NONE) {
+        node->next_sibling = rt->nodes[parent].first_child;
+        rt->nodes[parent].first_child = slot;
+    }
+}
+
+static void node_unlink(RoutingTable* rt, int32_t slot) {
+    int32_t parent = rt->nodes[slot].parent;
+    if (parent == ROUTING_NONE) return;
+
+    int32_t* link = &rt->nodes[parent].first_child;
+    while (*link != slot) {
+        link = &rt->nodes[*link].next_sibling;
+    }
+    *link = rt->nodes[slot].next_sibling;
+    rt->nodes[slot].parent = ROUTING_NONE;
+}
+
+// Resolve the owner of root and push it down to every descendant that
+// inherits, stopping at subtrees with claims of their own. Walks sibling
+// and parent links, so deep trees need no stack.
+static void propagate(RoutingTable* rt, int32_t root) {
+    RoutingNode* top = &rt->nodes[root];
+    top->owner = top->claim != ROUTING_NONE ? top->claim
+               : top->parent != ROUTING_NONE ? rt->nodes[top->parent].owner : ROUTING_NONE;
+
+    int32_t slot = top->first_child;
+    while (slot != ROUTING_NONE) {
+        RoutingNode* node = &rt->nodes[slot];
+        if (node->claim == ROUTING_NONE) {
+            node->owner = rt->nodes[node->parent].owner;
+            if (node->first_child != ROUTING_NONE) {
+                slot = node->first_child;
+                continue;
+            }
+        }
+
+        while (slot != root && rt->nodes[slot].next_sibling == ROUTING_NONE) {
+            slot = rt->nodes[slot].parent;
+        }
+        slot = slot == root ? ROUTING_NONE : rt->nodes[slot].next_sibling;
+    }
+}
+
+// Peer slot for id, interning it if new. ROUTING_NONE when full.
+static int32_t peer_intern(RoutingTable* rt, const char* id) {
+    for (size_t i = 0; i < rt->peer_count; i++) {
+        if (strcmp(rt->peers[i].id, id) == 0) return (int32_t)i;
+    }
+    if (rt->peer_count == ROUTING_MAX_PEERS) return ROUTING_NONE;
+
+    RoutingPeer* peer = &rt->peers[rt->peer_count];
+    memset(peer, 0, sizeof(RoutingPeer));
+    strcpy(peer->id, id);
+    peer->handle = NETWORK_INVALID_HANDLE;
+    peer->next_hop = ROUTING_NONE;
+    peer->distance = UINT32_MAX;
+    return (int32_t)rt->peer_count++;
+}
+
+static void remove_link(RoutingPeer* peer, int32_t slot) {
+    for (uint32_t i = 0; i < peer->link_count; i++) {
+        if (peer->links[i] == slot) {
+            peer->links[i] = peer->links[--peer->link_count];
+            return;
+        }
+    }
+}
+
+// Breadth-first search from the local peer. Neighbours are their own next
+// hop; everyone else inherits the next hop of the peer it was reached from.
+static void compute_paths(RoutingTable* rt) {
+    int32_t queue[ROUTING_MAX_PEERS];
+    size_t head = 0, tail = 0;
+
+    for (size_t i = 0; i < rt->peer_count; i++) {
+        rt->peers[i].distance = UINT32_MAX;
+        rt->peers[i].next_hop = ROUTING_NONE;
+    }
+    rt->peers[ROUTING_LOCAL_PEER].distance = 0;
+    queue[tail++] = ROUTING_LOCAL_PEER;
+
+    while (head < tail) {
+        RoutingPeer* from = &rt->peers[queue[head++]];
+        for (uint32_t i = 0; i < from->link_count; i++) {
+            int32_t slot = from->links[i];
+            RoutingPeer* to = &rt->peers[slot];
+            if (to->distance != UINT32_MAX) continue;
+
+            to->distance = from->distance + 1;
+            to->next_hop = from == &rt->peers[ROUTING_LOCAL_PEER] ? slot : from->next_hop;
+            queue[tail++] = slot;
+        }
+    }
+    rt->paths_dirty = false;
+}
+
+// Create a table for the local peer
+RoutingTable* routing_create(const char* local_id) {
+    if (!valid_id(local_id)) return NULL;
+
+    RoutingTable* rt = calloc(1, sizeof(RoutingTable));
+    if (!rt) return NULL;
+
+    rt->peers = calloc(ROUTING_MAX_PEERS, sizeof(RoutingPeer));
+    rt->nodes = calloc(MIN_NODES, sizeof(RoutingNode));
+    if (!rt->peers || !rt->nodes || pthread_mutex_init(&rt->lock, NULL) != 0) {
+        free(rt->peers);
+        free(rt->nodes);
+        free(rt);
+        return NULL;
+    }
+
+    rt->node_capacity = MIN_NODES;
+    rt->free_head = ROUTING_NONE;
+    for (size_t i = MIN_NODES; i > 0; i--) {
+        rt->nodes[i - 1].next_sibling = rt->free_head;
+        rt->free_head = (int32_t)(i - 1);
+    }
+    if (!index_rebuild(rt, MIN_NODES * 2)) {
+        pthread_mutex_destroy(&rt->lock);
+        free(rt->peers);
+        free(rt->nodes);
+        free(rt);
+        return NULL;
+    }
+
+    peer_intern(rt, local_id);
+    rt->peers[ROUTING_LOCAL_PEER].distance = 0;
+
+    // Adverts from before a restart must look older than ours
+    rt->link_seq = (uint64_t)time(NULL) << 20;
+    return rt;
+}
+
+void routing_destroy(RoutingTable* rt) {
+    if (!rt) return;
+
+    pthread_mutex_destroy(&rt->lock);
+    free(rt->index);
+    free(rt->nodes);
+    free(rt->peers);
+    free(rt);
+}
+
+// Record a direct connection to peer_id
+bool routing_add_neighbor(RoutingTable* rt, const char* peer_id, NetworkHandle handle) {
+    if (!rt || !valid_id(peer_id) || handle == NETWORK_INVALID_HANDLE) return false;
+
+    pthread_mutex_lock(&rt->lock);
+    RoutingPeer* local = &rt->peers[ROUTING_LOCAL_PEER];
+    int32_t slot = peer_intern(rt, peer_id);
+    bool added = slot > ROUTING_LOCAL_PEER &&
+                 (rt->peers[slot].handle != NETWORK_INVALID_HANDLE ||
+                  local->link_count < ROUTING_MAX_LINKS);
+    if (added) {
+        if (rt->peers[slot].handle == NETWORK_INVALID_HANDLE) {
+            local->links[local->link_count++] = slot;
+        }
+        rt->peers[slot].handle = handle;
+        rt->paths_dirty = true;
+    }
+    pthread_mutex_unlock(&rt->lock);
+    return added;
+}
+
+// Forget the neighbour reached through handle
+bool routing_remove_neighbor(RoutingTable* rt, NetworkHandle handle) {
+    if (!rt || handle == NETWORK_INVALID_HANDLE) return false;
+
+    pthread_mutex_lock(&rt->lock);
+    bool removed = false;
+    for (size_t i = 1; i < rt->peer_count && !removed; i++) {
+        if (rt->peers[i].handle == handle) {
+            rt->peers[i].handle = NETWORK_INVALID_HANDLE;
+            remove_link(&rt->peers[ROUTING_LOCAL_PEER], (int32_t)i);
+            rt->paths_dirty = true;
+            removed = true;
+        }
+    }
+    pthread_mutex_unlock(&rt->lock);
+    return removed;
+}
+
+bool routing_has_neighbor(RoutingTable* rt, NetworkHandle handle) {
+    if (!rt || handle == NETWORK_INVALID_HANDLE) return false;
+
+    pthread_mutex_lock(&rt->lock);
+    bool found = false;
+    for (size_t i = 1; i < rt->peer_count && !found; i++) {
+        found = rt->peers[i].handle == handle;
+    }
+    pthread_mutex_unlock(&rt->lock);
+    return found;
+}
+
+// Encode our neighbours as a fresh advert. Returns its size, 0 if the
+// buffer is too small.
+size_t routing_encode_links(RoutingTable* rt, uint8_t* buffer, size_t size) {
+    if (!rt || !buffer || size < 10) return 0;
+
+    pthread_mutex_lock(&rt->lock);
+    RoutingPeer* local = &rt->peers[ROUTING_LOCAL_PEER];
+    uint64_t seq = ++rt->link_seq;
+    for (int i = 0; i < 8; i++) {
+        buffer[i] = (uint8_t)(seq >> (8 * i));
+    }
+    buffer[8] = (uint8_t)local->link_count;
+    buffer[9] = (uint8_t)(local->link_count >> 8);
+
+    size_t length = 10;
+    for (uint32_t i = 0; i < local->link_count && length; i++) {
+        const char* id = rt->peers[local->links[i]].id;
+        size_t id_len = strlen(id);
+        if (length + 1 + id_len > size) {
+            length = 0;
+            break;
+        }
+        buffer[length] = (uint8_t)id_len;
+        memcpy(buffer + length + 1, id, id_len);
+        length += 1 + id_len;
+    }
+    pthread_mutex_unlock(&rt->lock);
+    return length;
+}
+
+// Replace peer_id's advertised neighbours with a newer advert. Returns
+// false for stale or malformed adverts and our own.
+bool routing_apply_links(RoutingTable* rt, const char* peer_id, const uint8_t* advert, size_t size) {
+    if (!rt || !valid_id(peer_id) || !advert || size < 10) return false;
+
+    uint64_t seq = 0;
+    for (int i = 0; i < 8; i++) {
+        seq |= (uint64_t)advert[i] << (8 * i);
+    }
+    uint32_t count = (uint32_t)advert[8] | ((uint32_t)advert[9] << 8);
+    if (count > ROUTING_MAX_LINKS) return false;
+
+    pthread_mutex_lock(&rt->lock);
+    int32_t slot = peer_intern(rt, peer_id);
+    bool applied = slot > ROUTING_LOCAL_PEER && seq > rt->peers[slot].seq;
+    if (applied) {
+        int32_t links[ROUTING_MAX_LINKS];
+        size_t offset = 10;
+        for (uint32_t i = 0; i < count && applied; i++) {
+            char id[64];
+            size_t id_len = offset < size ? advert[offset] : 0;
+            if (id_len == 0 || id_len >= sizeof(id) || offset + 1 + id_len > size) {
+                applied = false;
+                break;
+            }
+            memcpy(id, advert + offset + 1, id_len);
+            id[id_len] = '\0';
+            offset += 1 + id_len;
+
+            links[i] = peer_intern(rt, id);
+            applied = links[i] != ROUTING_NONE;
+        }
+
+        if (applied) {
+            RoutingPeer* peer = &rt->peers[slot];
+            memcpy(peer->links, links, count * sizeof(int32_t));
+            peer->link_count = count;
+            peer->seq = seq;
+            rt->paths_dirty = true;
+        }
+    }
+    pthread_mutex_unlock(&rt->lock);
+    return applied;
+}
+
+// Slot for a new root identity. Caller holds lock.
+static int32_t node_insert(RoutingTable* rt, const char* node_id) {
+    int32_t slot = node_alloc(rt);
+    if (slot == ROUTING_NONE) return ROUTING_NONE;
+
+    RoutingNode* node = &rt->nodes[slot];
+    strcpy(node->id, node_id);
+    node->parent = ROUTING_NONE;
+    node->first_child = ROUTING_NONE;
+    node->next_sibling = ROUTING_NONE;
+    node->claim = ROUTING_NONE;
+    node->owner = ROUTING_NONE;
+    index_put(rt, slot);
+    rt->node_count++;
+    return slot;
+}
+
+// Add an identity under parent_id, or move it there if known. An unknown
+// or NULL parent makes it a root.
+bool routing_add_node(RoutingTable* rt, const char* node_id, const char* parent_id) {
+    if (!rt || !valid_id(node_id)) return false;
+
+    pthread_mutex_lock(&rt->lock);
+    int32_t parent = parent_id ? index_find(rt, parent_id) : ROUTING_NONE;
+    int32_t slot = index_find(rt, node_id);
+    bool added = true;
+    if (slot == ROUTING_NONE) {
+        slot = node_insert(rt, node_id);
+        added = slot != ROUTING_NONE;
+    } else {
+        // A node cannot move beneath itself
+        for (int32_t p = parent; p != ROUTING_NONE && added; p = rt->nodes[p].parent) {
+            added = p != slot;
+        }
+        if (added) {
+            node_unlink(rt, slot);
+        }
+    }
+
+    if (added) {
+        node_link(rt, slot, parent);
+        propagate(rt, slot);
+    }
+    pthread_mutex_unlock(&rt->lock);
+    return added;
+}
+
+// Remove an identity. Its children move to its parent, as in the
+// identity tree, or become roots.
+bool routing_remove_node(RoutingTable* rt, const char* node_id) {
+    if (!rt || !valid_id(node_id)) return false;
+
+    pthread_mutex_lock(&rt->lock);
+    int32_t slot = index_find(rt, node_id);
+    if (slot == ROUTING_NONE) {
+        pthread_mutex_unlock(&rt->lock);
+        return false;
+    }
+
+    int32_t parent = rt->nodes[slot].parent;
+    node_unlink(rt, slot);
+    int32_t child = rt->nodes[slot].first_child;
+    while (child != ROUTING_NONE) {
+        int32_t next = rt->nodes[child].next_sibling;
+        node_link(rt, child, parent);
+        propagate(rt, child);
+        child = next;
+    }
+
+    index_erase(rt, node_id);
+    node_free(rt, slot);
+    rt->node_count--;
+    pthread_mutex_unlock(&rt->lock);
+    return true;
+}
+
+// Claim the subtree at node_id for peer_id, adding the identity as a root
+// if unknown
+bool routing_set_owner(RoutingTable* rt, const char* node_id, const char* peer_id) {
+    if (!rt || !valid_id(node_id) || (peer_id && !valid_id(peer_id))) return false;
+
+    pthread_mutex_lock(&rt->lock);
+    int32_t claim = peer_id ? peer_intern(rt, peer_id) : ROUTING_NONE;
+    int32_t slot = index_find(rt, node_id);
+    if (slot == ROUTING_NONE && claim != ROUTING_NONE) {
+        slot = node_insert(rt, node_id);
+    }
+
+    bool set = slot != ROUTING_NONE && (!peer_id || claim != ROUTING_NONE);
+    if (set) {
+        rt->nodes[slot].claim = claim;
+        propagate(rt, slot);
+    }
+    pthread_mutex_unlock(&rt->lock);
+    return set;
+}
+
+// Find where to send traffic for node_id
+RoutingStatus routing_lookup(RoutingTable* rt, const char* node_id, RoutingResult* result) {
+    RoutingResult route = {ROUTE_UNKNOWN, NETWORK_INVALID_HANDLE, 0, ROUTING_NONE};
+    if (rt && valid_id(node_id)) {
+        pthread_mutex_lock(&rt->lock);
+        int32_t slot = index_find(rt, node_id);
+        route.owner = slot != ROUTING_NONE ? rt->nodes[slot].owner : ROUTING_NONE;
+
+        if (route.owner == ROUTING_LOCAL_PEER) {
+            route.status = ROUTE_LOCAL;
+        } else if (route.owner != ROUTING_NONE) {
+            if (rt->paths_dirty) {
+                compute_paths(rt);
+            }
+            const RoutingPeer* owner = &rt->peers[route.owner];
+            if (owner->distance == UINT32_MAX) {
+                route.status = ROUTE_UNREACHABLE;
+            } else {
+                route.status = ROUTE_REMOTE;
+                route.next_hop = rt->peers[owner->next_hop].handle;
+                route.hops = owner->distance;
+            }
+        }
+        pthread_mutex_unlock(&rt->lock);
+    }
+
+    if (result) *result = route;
+    return route.status;
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef ROUTING_H
+#define ROUTING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "../network/network.h"
+
+// Next-hop routing for identities spread over a cluster of peers.
+//
+// Identities form a tree mirroring the identity tree. A peer claims the
+// subtree rooted at an identity; identities without a claim of their own
+// belong to the nearest claimed ancestor. Owners are kept resolved per
+// identity and pushed down a subtree only when a claim, parent or join
+// changes, so a lookup is a hash probe.
+//
+// Peers advertise their direct neighbours as link state. The shortest
+// hop path from the local peer to every owner is recomputed with one BFS
+// over the peer graph the first lookup after links change.
+#define ROUTING_LOCAL_PEER 0
+#define ROUTING_MAX_PEERS 256
+#define ROUTING_MAX_LINKS 64
+#define ROUTING_NONE -1
+
+// Outcome of a lookup
+typedef enum {
+    ROUTE_LOCAL = 0,             // Owned here
+    ROUTE_REMOTE,                // Owned by a reachable peer
+    ROUTE_UNREACHABLE,           // Owner known, no path to it
+    ROUTE_UNKNOWN                // Identity or its owner unknown
+} RoutingStatus;
+
+typedef struct {
+    RoutingStatus status;        // Lookup outcome
+    NetworkHandle next_hop;      // Connection to forward on, ROUTE_REMOTE only
+    uint32_t hops;               // Peer hops to the owner
+    int32_t owner;               // Owning peer slot, ROUTING_NONE if unknown
+} RoutingResult;
+
+// Peer in the cluster graph; slot 0 is the local peer
+typedef struct {
+    char id[64];                 // Peer ID
+    NetworkHandle handle;        // Direct connection, invalid if not a neighbour
+    uint64_t seq;                // Newest link advert applied
+    int32_t links[ROUTING_MAX_LINKS]; // Advertised neighbour slots
+    uint32_t link_count;         // Entries in links
+    int32_t next_hop;            // Neighbour slot on the shortest path
+    uint32_t distance;           // Hops from the local peer, UINT32_MAX if unreachable
+} RoutingPeer;
+
+// Identity in the routing tree
+typedef struct {
+    char id[64];                 // Identity ID
+    int32_t parent;              // Parent slot, ROUTING_NONE for roots
+    int32_t first_child;         // Child list
+    int32_t next_sibling;
+    int32_t claim;               // Peer claiming this subtree, ROUTING_NONE if inherited
+    int32_t owner;               // Resolved owning peer, ROUTING_NONE if unknown
+} RoutingNode;
+
+typedef struct {
+    RoutingPeer* peers;          // Peer slots
+    size_t peer_count;           // Peers interned
+    RoutingNode* nodes;          // Identity slots
+    size_t node_capacity;        // Slots allocated
+    int32_t free_head;           // Released identity slots, chained by next_sibling
+    size_t node_count;           // Identities present
+    int32_t* index;              // ID hash to identity slot (open addressing)
+    size_t index_capacity;       // Index size (power of two)
+    size_t index_used;           // Occupied and deleted index entries
+    uint64_t link_seq;           // Sequence number of our next link advert
+    bool paths_dirty;            // Links changed since the last BFS
+    pthread_mutex_t lock;        // Guards the table
+} RoutingTable;
+
+// Lifecycle
+RoutingTable* routing_create(const char* local_id);
+void routing_destroy(RoutingTable* rt);
+
+// Peers. Link adverts are u64 LE sequence number, u16 LE count, then
+// count neighbour IDs each as a length byte and the ID bytes.
+bool routing_add_neighbor(RoutingTable* rt, const char* peer_id, NetworkHandle handle);
+bool routing_remove_neighbor(RoutingTable* rt, NetworkHandle handle);
+bool routing_has_neighbor(RoutingTable* rt, NetworkHandle handle);
+size_t routing_encode_links(RoutingTable* rt, uint8_t* buffer, size_t size);
+bool routing_apply_links(RoutingTable* rt, const char* peer_id, const uint8_t* advert, size_t size);
+
+// Identities. peer_id NULL drops a claim, so the subtree inherits again.
+bool routing_add_node(RoutingTable* rt, const char* node_id, const char* parent_id);
+bool routing_remove_node(RoutingTable* rt, const char* node_id);
+bool routing_set_owner(RoutingTable* rt, const char* node_id, const char* peer_id);
+
+// Route to an identity
+RoutingStatus routing_lookup(RoutingTable* rt, const char* node_id, RoutingResult* result);
+
+#endif // ROUTING_H
\ No newline at end of file
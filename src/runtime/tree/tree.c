@@ -214,6 +214,26 @@ bool tree_delete_node(TreeContext* ctx, const char* node_id) {
     return true;
 }
 
+// Nodes may message their ancestors and descendants
+bool tree_can_communicate(TreeContext* ctx, const char* source_id, const char* target_id) {
+    if (!ctx || !source_id || !target_id) return false;
+
+    pthread_mutex_lock(&ctx->lock);
+
+    TreeNode* source = tree_find_node(ctx, source_id);
+    TreeNode* target = tree_find_node(ctx, target_id);
+    bool related = false;
+    for (TreeNode* node = source; node && target && !related; node = node->parent) {
+        related = node == target;
+    }
+    for (TreeNode* node = target; node && source && !related; node = node->parent) {
+        related = node == source;
+    }
+
+    pthread_mutex_unlock(&ctx->lock);
+    return related;
+}
+
 // BFS traversal
 void tree_traverse_bfs(TreeContext* ctx, TreeVisitor visitor, void* user_data) {
     if (!ctx || !visitor || !ctx->root) return;
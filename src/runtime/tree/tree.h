@@ -33,6 +33,7 @@ void tree_destroy(TreeContext* ctx);
 TreeNode* tree_create_node(TreeContext* ctx, const char* parent_id);
 bool tree_delete_node(TreeContext* ctx, const char* node_id);
 TreeNode* tree_find_node(TreeContext* ctx, const char* node_id);
+bool tree_can_communicate(TreeContext* ctx, const char* source_id, const char* target_id);
 
 // Tree traversal callbacks
 typedef void (*TreeVisitor)(TreeNode* node, void* user_data);
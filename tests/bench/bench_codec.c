@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "../../src/interface/message.h"
+
+#define BENCH_ROUNDS 2000000
+
+static double elapsed_sec(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Encode and decode one message repeatedly through a reused buffer, the
+// way a connection's send and receive buffers would be used
+static void bench_message(const char* label, size_t payload_size) {
+    char* payload = malloc(payload_size + 1);
+    assert(payload);
+    memset(payload, 'x', payload_size);
+
+    Message msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MSG_DATA;
+    msg.flags = MSG_FLAG_RELIABLE;
+    msg.id = 12345;
+    msg.timestamp = (uint64_t)time(NULL);
+    strcpy(msg.source, "4f2a9c01");
+    strcpy(msg.target, "7b1d30e5");
+    msg.data = payload;
+    msg.data_size = payload_size;
+
+    uint8_t buffer[8192];
+    size_t wire_size = message_encoded_size(&msg);
+    assert(wire_size <= sizeof(buffer));
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_ROUNDS; i++) {
+        msg.id = (uint32_t)i;
+        assert(message_encode(&msg, buffer, sizeof(buffer)) == wire_size);
+    }
+    double encode_ns = elapsed_sec(&start) * 1e9 / BENCH_ROUNDS;
+
+    Message out;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_ROUNDS; i++) {
+        assert(message_decode(buffer, wire_size, &out) == wire_size);
+        message_release(&out);
+    }
+    double decode_ns = elapsed_sec(&start) * 1e9 / BENCH_ROUNDS;
+
+    printf("  %-18s %5zu bytes on the wire (struct + payload %zu)  encode %6.1f ns  decode %6.1f ns\n",
+           label, wire_size, sizeof(Message) + payload_size, encode_ns, decode_ns);
+    free(payload);
+}
+
+int main(void) {
+    printf("Starting message codec benchmarks...\n");
+    printf("\nBenchmarking encode and decode (%d rounds each)...\n", BENCH_ROUNDS);
+
+    bench_message("empty payload", 0);
+    bench_message("16 byte payload", 16);
+    bench_message("256 byte payload", 256);
+    bench_message("4096 byte payload", 4096);
+
+    printf("\nBenchmarks complete.\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../../src/runtime/network/network.h"
+
+#define BENCH_PORT 9200
+#define BENCH_PROBES 2000
+#define PROBE_PAYLOAD 64
+#define BULK_PAYLOAD 16000
+#define PROBE_TIMEOUT_NS 100000000ull
+
+// Server and client on loopback, each polled by its own thread. Probes
+// are presence-style updates echoed back on the channel they came in on;
+// bulk data frames are only consumed.
+typedef struct {
+    NetworkContext* network;
+    pthread_t thread;
+    atomic_bool running;
+} Node;
+
+static Node server_node;
+static Node client_node;
+static volatile uint64_t replies;
+static atomic_bool bulk_running;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void server_handler(NetworkContext* ctx, NetworkMessage* msg) {
+    if (msg->type != NET_MSG_NODE_UPDATED) return;
+
+    if (msg->datagram) {
+        network_send_unreliable(ctx, &msg->connection, 1, msg);
+    } else {
+        network_send_handle(ctx, msg->connection, msg);
+    }
+}
+
+static void client_handler(NetworkContext* ctx, NetworkMessage* msg) {
+    (void)ctx;
+    if (msg->type == NET_MSG_NODE_UPDATED) {
+        __sync_fetch_and_add(&replies, 1);
+    }
+}
+
+static void* node_main(void* arg) {
+    Node* node = arg;
+    while (atomic_load(&node->running)) {
+        network_run(node->network);
+    }
+    return NULL;
+}
+
+static void node_start(Node* node, uint16_t port, MessageHandler handler) {
+    node->network = network_create(port);
+    assert(node->network);
+    network_set_timeouts(node->network, 0, 0, 0);
+    network_set_message_handler(node->network, handler);
+    assert(network_set_datagram(node->network, true));
+    assert(network_start(node->network));
+    atomic_store(&node->running, true);
+    assert(pthread_create(&node->thread, NULL, node_main, node) == 0);
+}
+
+static void node_stop(Node* node) {
+    atomic_store(&node->running, false);
+    pthread_join(node->thread, NULL);
+    network_destroy(node->network);
+}
+
+// Keep the connection's stream busy with large frames
+static void* bulk_main(void* arg) {
+    NetworkHandle handle = *(NetworkHandle*)arg;
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + BULK_PAYLOAD);
+    assert(msg);
+    msg->type = NET_MSG_DATA;
+    msg->data_size = BULK_PAYLOAD;
+    while (atomic_load(&bulk_running)) {
+        if (!network_send_handle(client_node.network, handle, msg)) {
+            usleep(100);
+        }
+    }
+    free(msg);
+    return NULL;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Round-trip BENCH_PROBES probes one at a time and report percentiles.
+// Probes lost on the datagram path are counted, not timed.
+static void run_probes(NetworkHandle handle, bool datagram, const char* label) {
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + PROBE_PAYLOAD);
+    uint64_t* samples = malloc(BENCH_PROBES * sizeof(uint64_t));
+    assert(msg && samples);
+    msg->type = NET_MSG_NODE_UPDATED;
+    strcpy(msg->source_id, "probe");
+    msg->data_size = PROBE_PAYLOAD;
+
+    size_t timed = 0;
+    size_t lost = 0;
+    for (int i = 0; i < BENCH_PROBES; i++) {
+        uint64_t expected = replies + 1;
+        uint64_t start = now_ns();
+        if (datagram) {
+            assert(network_send_unreliable(client_node.network, &handle, 1, msg) == 1);
+        } else {
+            assert(network_send_handle(client_node.network, handle, msg));
+        }
+
+        while (__sync_fetch_and_add(&replies, 0) < expected && now_ns() - start < PROBE_TIMEOUT_NS) {
+        }
+        if (__sync_fetch_and_add(&replies, 0) < expected) {
+            // A late reply must not satisfy the next probe
+            lost++;
+            usleep(10000);
+            replies = __sync_fetch_and_add(&replies, 0);
+            continue;
+        }
+        samples[timed++] = now_ns() - start;
+    }
+
+    qsort(samples, timed, sizeof(uint64_t), compare_u64);
+    if (timed) {
+        printf("  %-24s p50 %7.1f us  p99 %7.1f us  p99.9 %7.1f us  lost %zu\n", label,
+               samples[timed / 2] / 1e3, samples[timed * 99 / 100] / 1e3,
+               samples[timed * 999 / 1000] / 1e3, lost);
+    }
+
+    free(samples);
+    free(msg);
+}
+
+static void bench_latency(NetworkHandle handle, bool loaded) {
+    printf("\nBenchmarking probe latency, %s (%d probes, %d byte payload)...\n",
+           loaded ? "stream busy with bulk frames" : "idle", BENCH_PROBES, PROBE_PAYLOAD);
+
+    pthread_t bulk;
+    if (loaded) {
+        atomic_store(&bulk_running, true);
+        assert(pthread_create(&bulk, NULL, bulk_main, &handle) == 0);
+        usleep(100000);
+    }
+
+    run_probes(handle, false, "TCP stream");
+    run_probes(handle, true, "UDP datagram");
+
+    if (loaded) {
+        atomic_store(&bulk_running, false);
+        pthread_join(bulk, NULL);
+    }
+}
+
+int main(void) {
+    printf("Starting datagram benchmarks...\n");
+
+    node_start(&server_node, BENCH_PORT, server_handler);
+    node_start(&client_node, BENCH_PORT + 1, client_handler);
+    assert(network_connect(client_node.network, "127.0.0.1", BENCH_PORT) != NETWORK_INVALID_HANDLE);
+
+    NetworkHandle handle = NETWORK_INVALID_HANDLE;
+    while (network_get_handles(client_node.network, &handle, 1) == 0) {
+        usleep(1000);
+    }
+
+    bench_latency(handle, false);
+    bench_latency(handle, true);
+
+    NetworkStats stats;
+    network_get_stats(client_node.network, &stats);
+    printf("\n  Client: %llu datagrams sent, %llu received, %llu dropped\n",
+           (unsigned long long)stats.datagrams_sent,
+           (unsigned long long)stats.datagrams_received,
+           (unsigned long long)stats.datagrams_dropped);
+
+    node_stop(&client_node);
+    node_stop(&server_node);
+
+    printf("\nBenchmarks complete.\n");
+    return 0;
+}
\ No newline at end of file
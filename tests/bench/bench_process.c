@@ -0,0 +1,295 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../../src/interface/message.h"
+
+#define BENCH_MESSAGES 200000
+#define LATENCY_PROBES 500
+#define PROBE_INTERVAL_US 1000
+
+// A run loop like phantom_run, either sleeping 10 ms after every pass as
+// it used to, or draining with a budget and sleeping only when idle
+typedef struct {
+    MessageContext* ctx;
+    bool budgeted;
+    atomic_bool running;
+} Loop;
+
+static volatile uint64_t handled;
+static uint64_t* latencies;
+static size_t latency_count;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Probes carry their send time in the timestamp field
+static bool bench_handler(Program* program, const Message* message) {
+    (void)program;
+    if (latencies && message->timestamp) {
+        latencies[latency_count++] = now_ns() - message->timestamp;
+    }
+    handled++;
+    return true;
+}
+
+static void* loop_main(void* arg) {
+    Loop* loop = arg;
+    MessageBudget budget = {.max_messages = 4096, .max_us = 2000};
+    while (atomic_load(&loop->running)) {
+        if (loop->budgeted) {
+            message_process_queue(loop->ctx, &budget);
+            if (message_pending(loop->ctx) == 0) {
+                message_wait(loop->ctx, 10);
+            }
+        } else {
+            message_process_queue(loop->ctx, NULL);
+            usleep(10000);
+        }
+    }
+    return NULL;
+}
+
+static void loop_start(Loop* loop, pthread_t* thread, bool budgeted) {
+    loop->ctx = message_create(NULL);
+    assert(loop->ctx);
+    assert(message_set_handler(loop->ctx, MSG_DATA, bench_handler));
+    loop->budgeted = budgeted;
+    atomic_store(&loop->running, true);
+    handled = 0;
+    assert(pthread_create(thread, NULL, loop_main, loop) == 0);
+}
+
+static void loop_stop(Loop* loop, pthread_t thread) {
+    atomic_store(&loop->running, false);
+    pthread_join(thread, NULL);
+    message_destroy(loop->ctx);
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void bench_throughput(bool budgeted) {
+    Loop loop;
+    pthread_t thread;
+    loop_start(&loop, &thread, budgeted);
+
+    Message msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MSG_DATA;
+    strcpy(msg.source, "producer");
+
+    uint64_t start = now_ns();
+    for (int i = 0; i < BENCH_MESSAGES; i++) {
+        while (!message_receive(loop.ctx, &msg)) {
+            sched_yield();
+        }
+    }
+    while (handled < BENCH_MESSAGES) {
+        sched_yield();
+    }
+    double seconds = (double)(now_ns() - start) / 1e9;
+
+    loop_stop(&loop, thread);
+    printf("  %-22s %12.0f msg/s\n", budgeted ? "budgeted batches" : "process + 10 ms sleep",
+           BENCH_MESSAGES / seconds);
+}
+
+static void bench_latency(bool budgeted) {
+    Loop loop;
+    pthread_t thread;
+    latencies = malloc(LATENCY_PROBES * sizeof(uint64_t));
+    latency_count = 0;
+    assert(latencies);
+    loop_start(&loop, &thread, budgeted);
+
+    Message msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MSG_DATA;
+    strcpy(msg.source, "probe");
+    for (int i = 0; i < LATENCY_PROBES; i++) {
+        msg.timestamp = now_ns();
+        assert(message_receive(loop.ctx, &msg));
+        usleep(PROBE_INTERVAL_US);
+    }
+    while (handled < LATENCY_PROBES) {
+        sched_yield();
+    }
+
+    loop_stop(&loop, thread);
+    qsort(latencies, latency_count, sizeof(uint64_t), compare_u64);
+    printf("  %-22s p50 %8.1f us  p99 %8.1f us\n",
+           budgeted ? "budgeted batches" : "process + 10 ms sleep",
+           latencies[latency_count / 2] / 1e3, latencies[latency_count * 99 / 100] / 1e3);
+    free(latencies);
+    latencies = NULL;
+}
+
+// Flood messages cost a little work each, as a data handler would
+static bool flood_handler(Program* program, const Message* message) {
+    (void)program;
+    volatile uint32_t sum = 0;
+    for (size_t i = 0; i < 200; i++) {
+        sum += (uint32_t)i * message->id;
+    }
+    return true;
+}
+
+static atomic_bool flooding;
+
+static void* flood_main(void* arg) {
+    MessageContext* ctx = arg;
+    Message msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MSG_DATA;
+    strcpy(msg.source, "flood");
+    while (atomic_load(&flooding)) {
+        if (!message_receive(ctx, &msg)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Control probes sent while another thread keeps the data lane full.
+// With shared_lane the probes queue behind the flood as in one FIFO.
+static void bench_flood(bool shared_lane) {
+    Loop loop;
+    pthread_t thread;
+    pthread_t flood;
+    latencies = malloc(LATENCY_PROBES * sizeof(uint64_t));
+    latency_count = 0;
+    assert(latencies);
+    loop_start(&loop, &thread, true);
+    assert(message_set_handler(loop.ctx, MSG_DATA, flood_handler));
+    assert(message_set_handler(loop.ctx, MSG_NODE, bench_handler));
+    if (shared_lane) {
+        assert(message_set_lane(loop.ctx, MSG_NODE, MSG_LANE_BULK));
+    }
+
+    atomic_store(&flooding, true);
+    assert(pthread_create(&flood, NULL, flood_main, loop.ctx) == 0);
+    usleep(50000);
+
+    Message msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MSG_NODE;
+    strcpy(msg.source, "probe");
+    for (int i = 0; i < LATENCY_PROBES; i++) {
+        msg.timestamp = now_ns();
+        while (!message_receive(loop.ctx, &msg)) {
+            sched_yield();
+        }
+        usleep(PROBE_INTERVAL_US);
+    }
+    while (handled < LATENCY_PROBES) {
+        sched_yield();
+    }
+
+    MessageLaneStats stats;
+    message_get_lane_stats(loop.ctx, MSG_LANE_BULK, &stats);
+    atomic_store(&flooding, false);
+    pthread_join(flood, NULL);
+    loop_stop(&loop, thread);
+
+    qsort(latencies, latency_count, sizeof(uint64_t), compare_u64);
+    printf("  %-22s p50 %8.1f us  p99 %8.1f us  (data: %llu dispatched, mean wait %.1f us)\n",
+           shared_lane ? "one shared lane" : "control lane",
+           latencies[latency_count / 2] / 1e3, latencies[latency_count * 99 / 100] / 1e3,
+           (unsigned long long)stats.dispatched,
+           stats.dispatched ? (double)stats.total_wait_us / (double)stats.dispatched : 0.0);
+    free(latencies);
+    latencies = NULL;
+}
+
+// Stands in for a large tree mutation from one busy source
+static bool slow_handler(Program* program, const Message* message) {
+    (void)program;
+    (void)message;
+    usleep(2000);
+    return true;
+}
+
+// Probes from one source while another keeps a slow handler busy. Run
+// inline, every probe waits behind the slow messages queued before it;
+// on workers the two sources are handled on different threads.
+static void bench_stall(size_t workers) {
+    Loop loop;
+    pthread_t thread;
+    latencies = malloc(LATENCY_PROBES * sizeof(uint64_t));
+    latency_count = 0;
+    assert(latencies);
+    loop_start(&loop, &thread, true);
+    assert(message_set_handler(loop.ctx, MSG_STATE, slow_handler));
+    assert(message_set_handler(loop.ctx, MSG_NODE, bench_handler));
+    assert(message_set_workers(loop.ctx, workers));
+
+    Message slow;
+    memset(&slow, 0, sizeof(slow));
+    slow.type = MSG_STATE;
+    strcpy(slow.source, "slow");
+    Message msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MSG_NODE;
+    strcpy(msg.source, "probe");
+    uint64_t start = now_ns();
+    for (int i = 0; i < LATENCY_PROBES; i++) {
+        if (i % 2 == 0) {
+            assert(message_receive(loop.ctx, &slow));
+        }
+        msg.timestamp = now_ns();
+        assert(message_receive(loop.ctx, &msg));
+        usleep(PROBE_INTERVAL_US);
+    }
+    while (handled < LATENCY_PROBES) {
+        sched_yield();
+    }
+    double elapsed = (now_ns() - start) / 1e9;
+    loop_stop(&loop, thread);
+
+    qsort(latencies, latency_count, sizeof(uint64_t), compare_u64);
+    char label[32];
+    snprintf(label, sizeof(label), workers ? "%zu workers" : "inline", workers);
+    printf("  %-22s p50 %8.1f us  p99 %8.1f us  (probes done in %.2f s)\n", label,
+           latencies[latency_count / 2] / 1e3, latencies[latency_count * 99 / 100] / 1e3,
+           elapsed);
+    free(latencies);
+    latencies = NULL;
+}
+
+int main(void) {
+    printf("Starting message processing benchmarks...\n");
+
+    printf("\nBenchmarking throughput (%d messages from one producer)...\n", BENCH_MESSAGES);
+    bench_throughput(false);
+    bench_throughput(true);
+
+    printf("\nBenchmarking dispatch latency (%d probes, one per %d us)...\n",
+           LATENCY_PROBES, PROBE_INTERVAL_US);
+    bench_latency(false);
+    bench_latency(true);
+
+    printf("\nBenchmarking control latency under a data flood (%d probes, one per %d us)...\n",
+           LATENCY_PROBES, PROBE_INTERVAL_US);
+    bench_flood(true);
+    bench_flood(false);
+
+    printf("\nBenchmarking latency beside a slow source (%d probes, one per %d us)...\n",
+           LATENCY_PROBES, PROBE_INTERVAL_US);
+    bench_stall(0);
+    bench_stall(4);
+
+    printf("\nBenchmarks complete.\n");
+    return 0;
+}
\ No newline at end of file
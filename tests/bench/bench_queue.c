@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "../../src/interface/message.h"
+
+#define BENCH_MESSAGES 2000000
+#define BENCH_CAPACITY 1024
+#define BENCH_BATCH 64
+#define MAX_PRODUCERS 32
+
+// The previous design, kept here as the baseline: a ring of messages
+// behind one mutex, drained one message per lock
+typedef struct {
+    Message* messages;
+    size_t capacity;
+    size_t count;
+    size_t head;
+    size_t tail;
+    pthread_mutex_t lock;
+} LockedQueue;
+
+static bool locked_push(LockedQueue* queue, const Message* message) {
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count >= queue->capacity) {
+        pthread_mutex_unlock(&queue->lock);
+        return false;
+    }
+    memcpy(&queue->messages[queue->tail], message, sizeof(Message));
+    queue->tail = (queue->tail + 1) % queue->capacity;
+    queue->count++;
+    pthread_mutex_unlock(&queue->lock);
+    return true;
+}
+
+static bool locked_pop(LockedQueue* queue, Message* message) {
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count == 0) {
+        pthread_mutex_unlock(&queue->lock);
+        return false;
+    }
+    memcpy(message, &queue->messages[queue->head], sizeof(Message));
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    pthread_mutex_unlock(&queue->lock);
+    return true;
+}
+
+static LockedQueue locked;
+static MessageQueue* ring;
+static bool use_ring;
+static size_t per_producer;
+
+static double elapsed_sec(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void* producer_main(void* arg) {
+    Message msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MSG_DATA;
+    strcpy(msg.source, "producer");
+    msg.id = (uint32_t)(uintptr_t)arg;
+
+    for (size_t i = 0; i < per_producer; i++) {
+        while (use_ring ? !message_queue_push(ring, &msg) : !locked_push(&locked, &msg)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// One consumer drains everything the producers send
+static void consume(size_t total) {
+    Message batch[BENCH_BATCH];
+    size_t received = 0;
+    while (received < total) {
+        size_t n = 0;
+        if (use_ring) {
+            n = message_queue_pop(ring, batch, BENCH_BATCH);
+        } else {
+            while (n < BENCH_BATCH && locked_pop(&locked, &batch[n])) n++;
+        }
+        if (n == 0) sched_yield();
+        received += n;
+    }
+}
+
+static double run(int producers) {
+    pthread_t threads[MAX_PRODUCERS];
+    per_producer = BENCH_MESSAGES / (size_t)producers;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < producers; i++) {
+        assert(pthread_create(&threads[i], NULL, producer_main, (void*)(uintptr_t)i) == 0);
+    }
+    consume(per_producer * (size_t)producers);
+    for (int i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return (double)(per_producer * (size_t)producers) / elapsed_sec(&start);
+}
+
+int main(void) {
+    printf("Starting message queue benchmarks...\n");
+
+    locked.messages = calloc(BENCH_CAPACITY, sizeof(Message));
+    locked.capacity = BENCH_CAPACITY;
+    pthread_mutex_init(&locked.lock, NULL);
+    ring = message_queue_create(BENCH_CAPACITY);
+    assert(locked.messages && ring);
+
+    printf("\nBenchmarking %d messages, one consumer draining up to %d at a time...\n",
+           BENCH_MESSAGES, BENCH_BATCH);
+    printf("  %-10s %16s %16s %8s\n", "producers", "mutex msg/s", "lock-free msg/s", "speedup");
+    for (int producers = 1; producers <= MAX_PRODUCERS; producers *= 2) {
+        use_ring = false;
+        double mutex_rate = run(producers);
+        use_ring = true;
+        double ring_rate = run(producers);
+        printf("  %-10d %16.0f %16.0f %7.2fx\n", producers, mutex_rate, ring_rate,
+               ring_rate / mutex_rate);
+    }
+
+    message_queue_destroy(ring);
+    pthread_mutex_destroy(&locked.lock);
+    free(locked.messages);
+
+    printf("\nBenchmarks complete.\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include "../../src/runtime/network/network.h"
+
+#define BENCH_PORT 9100
+#define BENCH_CONNECTS 300
+#define BENCH_FRAMES 4000
+#define BENCH_PAYLOAD 16000
+#define BENCH_WINDOW 8
+#define FRAME_SIZE (NETWORK_FRAME_HEADER_SIZE + BENCH_PAYLOAD)
+
+static NetworkContext* server;
+static volatile int server_stop;
+
+// Echo every data frame back to its sender
+static void echo_handler(NetworkContext* ctx, NetworkMessage* msg) {
+    network_send_handle(ctx, msg->connection, msg);
+}
+
+static void* server_main(void* arg) {
+    (void)arg;
+    while (!server_stop) {
+        network_run(server);
+    }
+    return NULL;
+}
+
+static double elapsed_sec(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Self-signed P-256 certificate for localhost
+static void make_certificate(const char* cert_path, const char* key_path) {
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    X509* cert = X509_new();
+    assert(key && cert);
+
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    assert(X509_sign(cert, key, EVP_sha256()) > 0);
+
+    FILE* file = fopen(cert_path, "w");
+    assert(file && PEM_write_X509(file, cert));
+    fclose(file);
+    file = fopen(key_path, "w");
+    assert(file && PEM_write_PrivateKey(file, key, NULL, NULL, 0, NULL, NULL));
+    fclose(file);
+
+    X509_free(cert);
+    EVP_PKEY_free(key);
+}
+
+static void wait_handle(int handle, short events) {
+    struct pollfd pfd = {handle, events, 0};
+    poll(&pfd, 1, 10);
+}
+
+// Write all of size bytes; TLS may need to read before it can write
+static void write_all(NetworkTransport* transport, int handle, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        struct iovec iov = {(void*)data, size};
+        ssize_t n = transport->write(transport, handle, &iov, 1);
+        if (n > 0) {
+            data += n;
+            size -= (size_t)n;
+        } else {
+            assert(n < 0 && errno == EAGAIN);
+            wait_handle(handle, POLLIN | POLLOUT);
+        }
+    }
+}
+
+static void read_all(NetworkTransport* transport, int handle, uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = transport->read(transport, handle, data, size, NULL);
+        if (n > 0) {
+            data += n;
+            size -= (size_t)n;
+        } else {
+            assert(n < 0 && errno == EAGAIN);
+            wait_handle(handle, POLLIN);
+        }
+    }
+}
+
+static void fill_frame(uint8_t* frame, uint32_t payload) {
+    memset(frame, 0, NETWORK_FRAME_HEADER_SIZE);
+    frame[0] = (uint8_t)payload;
+    frame[1] = (uint8_t)(payload >> 8);
+    frame[2] = (uint8_t)(payload >> 16);
+    frame[4] = NET_MSG_DATA;
+    for (uint32_t i = 0; i < payload; i++) {
+        frame[NETWORK_FRAME_HEADER_SIZE + i] = (uint8_t)(i * 31);
+    }
+}
+
+static void start_server(NetworkTransport* transport) {
+    server = network_create(BENCH_PORT);
+    assert(server && network_set_transport(server, transport));
+    network_set_io_threads(server, 0);
+    network_set_timeouts(server, 0, 0, 0);
+    network_set_message_handler(server, echo_handler);
+    assert(network_start(server));
+    server_stop = 0;
+
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, server_main, NULL) == 0);
+    pthread_detach(thread);
+}
+
+static void stop_server(void) {
+    server_stop = 1;
+    usleep(200 * 1000);
+    network_destroy(server);
+}
+
+// Connect, echo one small frame and close, BENCH_CONNECTS times
+static double bench_connects(NetworkTransport* client) {
+    uint8_t frame[NETWORK_FRAME_HEADER_SIZE + 64];
+    uint8_t reply[sizeof(frame)];
+    fill_frame(frame, 64);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_CONNECTS; i++) {
+        int handle = client->connect(client, "127.0.0.1", BENCH_PORT);
+        assert(handle >= 0);
+        write_all(client, handle, frame, sizeof(frame));
+        read_all(client, handle, reply, sizeof(reply));
+        assert(memcmp(reply, frame, sizeof(frame)) == 0);
+        client->close(client, handle);
+    }
+    return BENCH_CONNECTS / elapsed_sec(&start);
+}
+
+// Echo BENCH_FRAMES large frames, BENCH_WINDOW in flight
+static double bench_throughput(NetworkTransport* client) {
+    static uint8_t frame[FRAME_SIZE];
+    static uint8_t reply[FRAME_SIZE];
+    fill_frame(frame, BENCH_PAYLOAD);
+
+    int handle = client->connect(client, "127.0.0.1", BENCH_PORT);
+    assert(handle >= 0);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_FRAMES; i += BENCH_WINDOW) {
+        for (int w = 0; w < BENCH_WINDOW; w++) {
+            write_all(client, handle, frame, sizeof(frame));
+        }
+        for (int w = 0; w < BENCH_WINDOW; w++) {
+            read_all(client, handle, reply, sizeof(reply));
+        }
+    }
+    double seconds = elapsed_sec(&start);
+    assert(memcmp(reply, frame, sizeof(frame)) == 0);
+    client->close(client, handle);
+
+    // Both directions cross the connection
+    return 2.0 * BENCH_FRAMES * FRAME_SIZE / seconds / (1024 * 1024);
+}
+
+int main(void) {
+    printf("Starting TLS transport benchmarks...\n");
+
+    char cert_path[] = "/tmp/bench_tls_cert_XXXXXX";
+    char key_path[] = "/tmp/bench_tls_key_XXXXXX";
+    close(mkstemp(cert_path));
+    close(mkstemp(key_path));
+    make_certificate(cert_path, key_path);
+
+    NetworkTlsConfig server_config = {cert_path, key_path, NULL, true, false};
+    NetworkTlsConfig resume_config = {NULL, NULL, NULL, true, false};
+    NetworkTlsConfig full_config = {NULL, NULL, NULL, true, true};
+    NetworkTransport* tls_server = network_tls_transport_create(&server_config);
+    NetworkTransport* resume_client = network_tls_transport_create(&resume_config);
+    NetworkTransport* full_client = network_tls_transport_create(&full_config);
+    assert(tls_server && resume_client && full_client);
+
+    printf("\nBenchmarking connection setup (%d connects, one echo each)...\n", BENCH_CONNECTS);
+    start_server(network_socket_transport());
+    double plain_rate = bench_connects(network_socket_transport());
+    stop_server();
+
+    start_server(tls_server);
+    double full_rate = bench_connects(full_client);
+    double resume_rate = bench_connects(resume_client);
+    printf("  plaintext:        %8.0f connects/s\n", plain_rate);
+    printf("  TLS full:         %8.0f connects/s\n", full_rate);
+    printf("  TLS resumed:      %8.0f connects/s\n", resume_rate);
+
+    printf("\nBenchmarking echo throughput (%d x %d byte frames)...\n", BENCH_FRAMES, BENCH_PAYLOAD);
+    double tls_mbps = bench_throughput(resume_client);
+    stop_server();
+
+    start_server(network_socket_transport());
+    double plain_mbps = bench_throughput(network_socket_transport());
+    stop_server();
+    printf("  plaintext:        %8.1f MiB/s\n", plain_mbps);
+    printf("  TLS:              %8.1f MiB/s (%.0f%% of plaintext)\n",
+           tls_mbps, 100.0 * tls_mbps / plain_mbps);
+
+    NetworkTlsStats stats;
+    network_tls_get_stats(tls_server, &stats);
+    printf("\nServer: %lu handshakes, %lu resumed, %lu kernel TLS, %lu failures\n",
+           (unsigned long)stats.handshakes, (unsigned long)stats.resumed,
+           (unsigned long)stats.ktls_send, (unsigned long)stats.failures);
+    assert(stats.resumed >= BENCH_CONNECTS - 1);
+    assert(stats.failures == 0);
+
+    network_tls_transport_destroy(full_client);
+    network_tls_transport_destroy(resume_client);
+    network_tls_transport_destroy(tls_server);
+    unlink(cert_path);
+    unlink(key_path);
+
+    printf("\nBenchmarks complete.\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <time.h>
+#include "../../src/runtime/network/network.h"
+
+#define BENCH_PORT 9000
+#define BENCH_CLIENTS 64
+#define BENCH_ROUNDS 2000
+#define BENCH_PAYLOAD 256
+#define FRAME_SIZE (NETWORK_FRAME_HEADER_SIZE + BENCH_PAYLOAD)
+
+// Echo every data frame back to its sender
+static void echo_handler(NetworkContext* ctx, NetworkMessage* msg) {
+    network_send_handle(ctx, msg->connection, msg);
+}
+
+static double elapsed_sec(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Read exactly size bytes, driving the server while the pipe is empty
+static void read_frame(NetworkTransport* transport, NetworkContext* server, int client, uint8_t* frame) {
+    size_t got = 0;
+    while (got < FRAME_SIZE) {
+        ssize_t n = transport->read(transport, client, frame + got, FRAME_SIZE - got, NULL);
+        if (n > 0) {
+            got += (size_t)n;
+        } else {
+            assert(n < 0 && errno == EAGAIN);
+            network_run(server);
+        }
+    }
+}
+
+// Round trips of one frame per client per round through an echo server,
+// all in one thread on the in-memory transport
+static void bench_memory_echo(void) {
+    printf("\nBenchmarking in-memory echo (%d clients x %d rounds, %d byte payload)...\n",
+           BENCH_CLIENTS, BENCH_ROUNDS, BENCH_PAYLOAD);
+
+    NetworkTransport* transport = network_memory_transport_create();
+    NetworkContext* server = network_create(BENCH_PORT);
+    assert(transport && server);
+    assert(network_set_transport(server, transport));
+    network_set_io_threads(server, 0);
+    network_set_timeouts(server, 0, 0, 0);
+    network_set_message_handler(server, echo_handler);
+    assert(network_start(server));
+
+    int clients[BENCH_CLIENTS];
+    for (int i = 0; i < BENCH_CLIENTS; i++) {
+        clients[i] = network_memory_connect(transport, BENCH_PORT);
+        assert(clients[i] >= 0);
+    }
+    network_run(server);
+    assert(server->active_connections == BENCH_CLIENTS);
+
+    uint8_t frame[FRAME_SIZE] = {0};
+    frame[0] = BENCH_PAYLOAD & 0xff;
+    frame[1] = BENCH_PAYLOAD >> 8;
+    frame[4] = NET_MSG_DATA;
+    uint8_t reply[FRAME_SIZE];
+    struct iovec iov = {frame, sizeof(frame)};
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int i = 0; i < BENCH_CLIENTS; i++) {
+            assert(transport->write(transport, clients[i], &iov, 1) == FRAME_SIZE);
+        }
+        network_run(server);
+        for (int i = 0; i < BENCH_CLIENTS; i++) {
+            read_frame(transport, server, clients[i], reply);
+            assert(memcmp(reply, frame, FRAME_SIZE) == 0);
+        }
+    }
+    double seconds = elapsed_sec(&start);
+
+    size_t total = (size_t)BENCH_CLIENTS * BENCH_ROUNDS;
+    printf("  %zu round trips in %.3f s: %.0f msg/s, %.2f us per round trip\n",
+           total, seconds, (double)total / seconds, seconds * 1e6 / (double)total);
+
+    NetworkStats stats;
+    network_get_stats(server, &stats);
+    assert(stats.frames_received == total);
+    assert(stats.frames_sent == total);
+
+    for (int i = 0; i < BENCH_CLIENTS; i++) {
+        transport->close(transport, clients[i]);
+    }
+    network_destroy(server);
+    network_memory_transport_destroy(transport);
+}
+
+// Two servers in one fabric: clients of each cross-post through the other
+static void bench_memory_multi_node(void) {
+    printf("\nBenchmarking two in-memory nodes...\n");
+
+    NetworkTransport* transport = network_memory_transport_create();
+    NetworkContext* nodes[2];
+    int clients[2];
+    for (int n = 0; n < 2; n++) {
+        nodes[n] = network_create((uint16_t)(BENCH_PORT + n));
+        assert(nodes[n] && network_set_transport(nodes[n], transport));
+        network_set_io_threads(nodes[n], 0);
+        network_set_timeouts(nodes[n], 0, 0, 0);
+        network_set_message_handler(nodes[n], echo_handler);
+        assert(network_start(nodes[n]));
+        clients[n] = network_memory_connect(transport, (uint16_t)(BENCH_PORT + n));
+        assert(clients[n] >= 0);
+        network_run(nodes[n]);
+    }
+
+    uint8_t frame[FRAME_SIZE] = {0};
+    frame[0] = BENCH_PAYLOAD & 0xff;
+    frame[1] = BENCH_PAYLOAD >> 8;
+    frame[4] = NET_MSG_DATA;
+    uint8_t reply[FRAME_SIZE];
+    struct iovec iov = {frame, sizeof(frame)};
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int round = 0; round < BENCH_ROUNDS * 8; round++) {
+        int n = round & 1;
+        assert(transport->write(transport, clients[n], &iov, 1) == FRAME_SIZE);
+        read_frame(transport, nodes[n], clients[n], reply);
+    }
+    double seconds = elapsed_sec(&start);
+    printf("  %d round trips in %.3f s: %.2f us per round trip\n",
+           BENCH_ROUNDS * 8, seconds, seconds * 1e6 / (BENCH_ROUNDS * 8));
+
+    for (int n = 0; n < 2; n++) {
+        transport->close(transport, clients[n]);
+        network_destroy(nodes[n]);
+    }
+    network_memory_transport_destroy(transport);
+}
+
+int main(void) {
+    printf("Starting transport benchmarks...\n");
+
+    bench_memory_echo();
+    bench_memory_multi_node();
+
+    printf("\nBenchmarks complete.\n");
+    return 0;
+}
\ No newline at end of file
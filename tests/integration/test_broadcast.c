@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "../../src/runtime/network/network.h"
+
+// A hub and four clients on one memory fabric. The last client stops
+// reading partway through, so its pipe fills and broadcasts to it queue
+// up until its budget runs out.
+#define PEER_COUNT 4
+#define FULL_PEER (PEER_COUNT - 1)
+#define BASE_PORT 7200
+#define WAIT_MS 10000
+#define FRAME_DATA (32 * 1024)
+#define CONN_BUDGET (256 * 1024)
+#define OUT_QUEUE_DEPTH 256     // As in network.c
+
+static NetworkTransport* fabric;
+static NetworkContext* hub;
+static NetworkContext* peers[PEER_COUNT];
+static int received[PEER_COUNT];
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void peer_handler(NetworkContext* network, NetworkMessage* msg) {
+    if (msg->type != NET_MSG_DATA) return;
+    for (int i = 0; i < PEER_COUNT; i++) {
+        if (peers[i] == network) received[i]++;
+    }
+}
+
+static size_t handle_count(NetworkContext* network) {
+    NetworkHandle handles[PEER_COUNT + 1];
+    return network_get_handles(network, handles, PEER_COUNT + 1);
+}
+
+// Run the hub and every peer still reading
+static void pump(int readers) {
+    network_run(hub);
+    for (int i = 0; i < readers; i++) {
+        network_run(peers[i]);
+    }
+}
+
+// Frame data that does not compress, so its size on the wire is known
+static NetworkMessage* make_message(uint32_t size) {
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + size);
+    assert(msg);
+    msg->type = NET_MSG_DATA;
+    strcpy(msg->source_id, "hub");
+    msg->data_size = size;
+    uint32_t state = 2463534242u;
+    for (uint32_t i = 0; i < size; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        msg->data[i] = (uint8_t)state;
+    }
+    return msg;
+}
+
+static NetworkContext* create_network(int index, size_t io_threads) {
+    NetworkContext* network = network_create((uint16_t)(BASE_PORT + index));
+    assert(network);
+    assert(network_set_transport(network, fabric));
+    network_set_io_threads(network, io_threads);
+    network_set_poll_timeout(network, 0);
+    return network;
+}
+
+static void start_hub(int index, size_t io_threads) {
+    hub = create_network(index, io_threads);
+    network_set_outbound_limits(hub, CONN_BUDGET, 64 * 1024 * 1024, NET_SLOW_DISCONNECT);
+    assert(network_start(hub));
+
+    for (int i = 0; i < PEER_COUNT; i++) {
+        peers[i] = create_network(index + 1 + i, 0);
+        network_set_message_handler(peers[i], peer_handler);
+        assert(network_start(peers[i]));
+        assert(network_add_peer(peers[i], "fabric", (uint16_t)(BASE_PORT + index)));
+        received[i] = 0;
+    }
+
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (handle_count(hub) < PEER_COUNT) {
+        assert(now_ms() < deadline);
+        pump(PEER_COUNT);
+    }
+}
+
+static void stop_hub(void) {
+    for (int i = 0; i < PEER_COUNT; i++) {
+        network_destroy(peers[i]);
+    }
+    network_destroy(hub);
+}
+
+// The hub's connection to the client that stopped reading
+static NetworkConnection* stalled_connection(void) {
+    for (size_t i = 0; i < hub->max_connections; i++) {
+        NetworkConnection* conn = &hub->connections[i];
+        if (conn->is_active && conn->out_count > 0) return conn;
+    }
+    return NULL;
+}
+
+// Tests inline broadcasts count each target once: delivered when the
+// frame was written in full, queued when it waits behind a full pipe,
+// dropped when the slow peer is over budget
+void test_broadcast_counts(void) {
+    printf("\nTesting broadcast counts without I/O threads...\n");
+
+    start_hub(0, 0);
+    NetworkMessage* msg = make_message(FRAME_DATA);
+    NetworkBroadcastResult result;
+
+    // Every pipe has room
+    assert(network_broadcast(hub, msg, &result));
+    assert(result.delivered == PEER_COUNT);
+    assert(result.queued == 0 && result.dropped == 0);
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (received[0] < 1 || received[FULL_PEER] < 1) {
+        assert(now_ms() < deadline);
+        pump(PEER_COUNT);
+    }
+
+    // The last peer stops reading; the others keep draining their pipes
+    NetworkBuffer* held = NULL;
+    int broadcasts = 0;
+    while (result.dropped == 0) {
+        assert(broadcasts++ < 64);
+        network_broadcast(hub, msg, &result);
+        assert(result.delivered + result.queued + result.dropped == PEER_COUNT);
+        assert(result.delivered >= PEER_COUNT - 1);
+        for (int i = 0; i < 8; i++) {
+            pump(FULL_PEER);
+        }
+
+        // Hold a reference to the newest frame the stalled peer queued
+        NetworkConnection* conn = stalled_connection();
+        if (result.queued == 1 && !held) {
+            assert(conn && conn->out_count > 0);
+            held = conn->out_ring[(conn->out_head + conn->out_count - 1) % OUT_QUEUE_DEPTH];
+            network_buffer_retain(held);
+
+            // Everyone else wrote it and the broadcast let go of its own
+            assert(held->refcount == 2);
+        }
+    }
+    assert(held);
+    assert(result.delivered == PEER_COUNT - 1 && result.queued == 0 && result.dropped == 1);
+
+    // The slow peer was cut off and its queue cleared
+    NetworkStats stats;
+    network_get_stats(hub, &stats);
+    assert(stats.slow_disconnects == 1);
+    assert(held->refcount == 1);
+    network_buffer_release(held);
+
+    deadline = now_ms() + WAIT_MS;
+    while (handle_count(hub) > PEER_COUNT - 1) {
+        assert(now_ms() < deadline);
+        pump(FULL_PEER);
+    }
+    assert(network_broadcast(hub, msg, &result));
+    assert(result.delivered == PEER_COUNT - 1 && result.queued == 0 && result.dropped == 0);
+
+    network_get_stats(hub, &stats);
+    assert(stats.outbound_bytes == 0);
+    free(msg);
+    stop_hub();
+
+    printf("Broadcast count tests passed!\n");
+}
+
+// Tests broadcasts handed to I/O threads report every target as queued
+void test_broadcast_threads(void) {
+    printf("\nTesting broadcast counts with I/O threads...\n");
+
+    start_hub(10, 2);
+    NetworkMessage* msg = make_message(64);
+    NetworkBroadcastResult result;
+
+    assert(network_broadcast(hub, msg, &result));
+    assert(result.delivered == 0);
+    assert(result.queued == PEER_COUNT && result.dropped == 0);
+
+    uint64_t deadline = now_ms() + WAIT_MS;
+    for (int i = 0; i < PEER_COUNT; i++) {
+        while (received[i] < 1) {
+            assert(now_ms() < deadline);
+            pump(PEER_COUNT);
+        }
+    }
+    free(msg);
+    stop_hub();
+
+    printf("Threaded broadcast tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting broadcast integration tests...\n");
+    fabric = network_memory_transport_create();
+    assert(fabric);
+
+    test_broadcast_counts();
+    test_broadcast_threads();
+
+    network_memory_transport_destroy(fabric);
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "../../src/runtime/network/network.h"
+
+// A sender with compression and an ID dictionary, and three receivers
+// on one memory fabric: one with the same dictionary, one without
+// compression, and one with a different dictionary
+#define SENDER_PORT 7380
+#define RECEIVER_COUNT 3
+#define MATCHED 0
+#define PLAIN 1
+#define MISMATCHED 2
+#define THRESHOLD 256
+#define PAYLOAD_SIZE (16 * 1024)
+#define WAIT_MS 10000
+
+static const char dictionary[] = "node-0000node-0001node-0002parent-root/tree/child-";
+static const char other_dictionary[] = "an unrelated dictionary of no use here";
+
+static NetworkTransport* fabric;
+static NetworkContext* sender;
+static NetworkContext* receivers[RECEIVER_COUNT];
+static int received[RECEIVER_COUNT];
+static uint8_t received_data[RECEIVER_COUNT][PAYLOAD_SIZE];
+static uint32_t received_size[RECEIVER_COUNT];
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void receiver_handler(NetworkContext* network, NetworkMessage* msg) {
+    if (msg->type != NET_MSG_DATA) return;
+    for (int i = 0; i < RECEIVER_COUNT; i++) {
+        if (receivers[i] == network) {
+            memcpy(received_data[i], msg->data, msg->data_size);
+            received_size[i] = msg->data_size;
+            received[i]++;
+        }
+    }
+}
+
+static void pump(void) {
+    network_run(sender);
+    for (int i = 0; i < RECEIVER_COUNT; i++) {
+        network_run(receivers[i]);
+    }
+}
+
+static NetworkContext* create_network(uint16_t port) {
+    NetworkContext* network = network_create(port);
+    assert(network);
+    assert(network_set_transport(network, fabric));
+    network_set_io_threads(network, 0);
+    network_set_poll_timeout(network, 0);
+    return network;
+}
+
+// The sender's connection that negotiated compression
+static NetworkConnection* compressing_connection(void) {
+    NetworkHandle handles[RECEIVER_COUNT];
+    size_t count = network_get_handles(sender, handles, RECEIVER_COUNT);
+    for (size_t i = 0; i < count; i++) {
+        NetworkConnection* conn = network_resolve(sender, handles[i]);
+        if (conn->features & NET_FEATURE_COMPRESSION) return conn;
+    }
+    return NULL;
+}
+
+static void start_networks(void) {
+    fabric = network_memory_transport_create();
+    assert(fabric);
+    sender = create_network(SENDER_PORT);
+    assert(network_set_compression(sender, THRESHOLD, dictionary, sizeof(dictionary) - 1));
+    assert(network_start(sender));
+
+    for (int i = 0; i < RECEIVER_COUNT; i++) {
+        receivers[i] = create_network((uint16_t)(SENDER_PORT + 1 + i));
+        network_set_message_handler(receivers[i], receiver_handler);
+    }
+    assert(network_set_compression(receivers[MATCHED], THRESHOLD, dictionary,
+                                   sizeof(dictionary) - 1));
+    assert(network_set_compression(receivers[MISMATCHED], THRESHOLD, other_dictionary,
+                                   sizeof(other_dictionary) - 1));
+
+    for (int i = 0; i < RECEIVER_COUNT; i++) {
+        assert(network_start(receivers[i]));
+        assert(network_add_peer(receivers[i], "fabric", SENDER_PORT));
+    }
+
+    NetworkHandle handles[RECEIVER_COUNT];
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (network_get_handles(sender, handles, RECEIVER_COUNT) < RECEIVER_COUNT) {
+        assert(now_ms() < deadline);
+        pump();
+    }
+}
+
+static void stop_networks(void) {
+    for (int i = 0; i < RECEIVER_COUNT; i++) {
+        network_destroy(receivers[i]);
+    }
+    network_destroy(sender);
+    network_memory_transport_destroy(fabric);
+}
+
+// ID-heavy payload, as subtree syncs carry
+static NetworkMessage* make_ids(uint32_t size) {
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + size);
+    assert(msg);
+    msg->type = NET_MSG_DATA;
+    strcpy(msg->source_id, "sender");
+    msg->data_size = size;
+    char id[32];
+    uint32_t filled = 0;
+    for (int n = 0; filled < size; n++) {
+        int len = snprintf(id, sizeof(id), "node-%04d/", n % 1000);
+        for (int c = 0; c < len && filled < size; c++) {
+            msg->data[filled++] = (uint8_t)id[c];
+        }
+    }
+    return msg;
+}
+
+// Payload that does not compress
+static NetworkMessage* make_random(uint32_t size) {
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + size);
+    assert(msg);
+    msg->type = NET_MSG_DATA;
+    strcpy(msg->source_id, "sender");
+    msg->data_size = size;
+    uint32_t state = 2463534242u;
+    for (uint32_t i = 0; i < size; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        msg->data[i] = (uint8_t)state;
+    }
+    return msg;
+}
+
+// Broadcast msg and wait until every receiver has it intact
+static void broadcast_all(const NetworkMessage* msg, NetworkStats* before, NetworkStats* after) {
+    int base[RECEIVER_COUNT];
+    memcpy(base, received, sizeof(base));
+    network_get_stats(sender, before);
+
+    NetworkBroadcastResult result;
+    assert(network_broadcast(sender, (NetworkMessage*)msg, &result));
+    assert(result.dropped == 0);
+
+    uint64_t deadline = now_ms() + WAIT_MS;
+    for (int i = 0; i < RECEIVER_COUNT; i++) {
+        while (received[i] == base[i]) {
+            assert(now_ms() < deadline);
+            pump();
+        }
+        assert(received[i] == base[i] + 1);
+        assert(received_size[i] == msg->data_size);
+        assert(memcmp(received_data[i], msg->data, msg->data_size) == 0);
+    }
+    network_get_stats(sender, after);
+}
+
+// Tests compression is negotiated only with a peer holding the same
+// dictionary
+void test_compression_negotiated(void) {
+    printf("\nTesting compression negotiation...\n");
+
+    int compressed = 0;
+    NetworkHandle handles[RECEIVER_COUNT];
+    assert(network_get_handles(sender, handles, RECEIVER_COUNT) == RECEIVER_COUNT);
+    for (int i = 0; i < RECEIVER_COUNT; i++) {
+        if (network_resolve(sender, handles[i])->features & NET_FEATURE_COMPRESSION) {
+            compressed++;
+        }
+    }
+    assert(compressed == 1);
+
+    // Each receiver sees the same outcome from its side
+    for (int i = 0; i < RECEIVER_COUNT; i++) {
+        NetworkHandle handle;
+        assert(network_get_handles(receivers[i], &handle, 1) == 1);
+        bool negotiated = network_resolve(receivers[i], handle)->features & NET_FEATURE_COMPRESSION;
+        assert(negotiated == (i == MATCHED));
+    }
+
+    printf("Compression negotiation tests passed!\n");
+}
+
+// Tests one broadcast reaches a compressing peer as a compressed frame
+// and the others as plain frames, all decoding to the same bytes
+void test_compressed_round_trip(void) {
+    printf("\nTesting compressed round trip...\n");
+
+    NetworkMessage* msg = make_ids(PAYLOAD_SIZE);
+    NetworkConnection* conn = compressing_connection();
+    assert(conn);
+    uint64_t sent_before = conn->data_sent;
+    NetworkStats before, after;
+    broadcast_all(msg, &before, &after);
+
+    // Compressed once for the one peer that takes it
+    assert(after.frames_compressed == before.frames_compressed + 1);
+    assert(after.compress_saved - before.compress_saved > PAYLOAD_SIZE / 2);
+    assert(conn->data_sent - sent_before < PAYLOAD_SIZE / 2);
+    free(msg);
+
+    printf("Compressed round trip tests passed!\n");
+}
+
+// Tests payloads below the threshold, and payloads compression would
+// not shrink, go out plain
+void test_not_compressed(void) {
+    printf("\nTesting frames left plain...\n");
+
+    NetworkStats before, after;
+    NetworkMessage* small = make_ids(THRESHOLD - 1);
+    broadcast_all(small, &before, &after);
+    assert(after.frames_compressed == before.frames_compressed);
+    free(small);
+
+    NetworkMessage* noise = make_random(PAYLOAD_SIZE);
+    broadcast_all(noise, &before, &after);
+    assert(after.frames_compressed == before.frames_compressed);
+    free(noise);
+
+    printf("Plain frame tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting compression tests...\n");
+
+    start_networks();
+    test_compression_negotiated();
+    test_compressed_round_trip();
+    test_not_compressed();
+    stop_networks();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "../../src/runtime/network/network.h"
+
+#define WAIT_MS 5000
+
+// Two nodes on loopback, each polled by its own thread
+typedef struct {
+    NetworkContext* network;
+    pthread_t thread;
+    atomic_bool running;
+    int received;
+    int datagrams;
+    bool authenticated;
+    char last_data[2048];
+} Node;
+
+static Node nodes[2];
+static uint16_t base_port;
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static Node* node_of(NetworkContext* network) {
+    return nodes[0].network == network ? &nodes[0] : &nodes[1];
+}
+
+static void message_handler(NetworkContext* network, NetworkMessage* msg) {
+    Node* node = node_of(network);
+    snprintf(node->last_data, sizeof(node->last_data), "%.*s", (int)msg->data_size,
+             (const char*)msg->data);
+    node->authenticated = msg->authenticated;
+    if (msg->datagram) __sync_fetch_and_add(&node->datagrams, 1);
+    __sync_fetch_and_add(&node->received, 1);
+}
+
+static void* node_main(void* arg) {
+    Node* node = arg;
+    while (atomic_load(&node->running)) {
+        network_run(node->network);
+    }
+    return NULL;
+}
+
+static void wait_for(volatile int* counter, int expected) {
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (__sync_fetch_and_add((int*)counter, 0) < expected) {
+        assert(now_ms() < deadline);
+        usleep(1000);
+    }
+}
+
+// Start both nodes, node 0 dialing node 1. Returns node 0's handle for
+// the connection once it is handshaken.
+static NetworkHandle start_pair(bool datagrams, const char* secret) {
+    memset(nodes, 0, sizeof(nodes));
+    for (int i = 0; i < 2; i++) {
+        nodes[i].network = network_create((uint16_t)(base_port + i));
+        assert(nodes[i].network);
+        network_set_message_handler(nodes[i].network, message_handler);
+        if (datagrams || i == 1) {
+            assert(network_set_datagram(nodes[i].network, true));
+        }
+        if (secret) {
+            assert(network_set_auth_key(nodes[i].network, secret, strlen(secret)));
+        }
+        assert(network_start(nodes[i].network));
+        atomic_store(&nodes[i].running, true);
+        assert(pthread_create(&nodes[i].thread, NULL, node_main, &nodes[i]) == 0);
+    }
+    assert(network_connect(nodes[0].network, "127.0.0.1", (uint16_t)(base_port + 1)) !=
+           NETWORK_INVALID_HANDLE);
+
+    // Node 0 lists the connection once it has handled node 1's HELLO
+    NetworkHandle handle = NETWORK_INVALID_HANDLE;
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (network_get_handles(nodes[0].network, &handle, 1) == 0) {
+        assert(now_ms() < deadline);
+        usleep(1000);
+    }
+    return handle;
+}
+
+static void stop_pair(void) {
+    for (int i = 0; i < 2; i++) {
+        atomic_store(&nodes[i].running, false);
+        pthread_join(nodes[i].thread, NULL);
+        network_destroy(nodes[i].network);
+    }
+}
+
+static NetworkMessage* make_message(const char* text, size_t size) {
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + size);
+    assert(msg);
+    msg->type = NET_MSG_DATA;
+    strcpy(msg->source_id, "node-a");
+    strcpy(msg->target_id, "node-b");
+    msg->data_size = (uint32_t)size;
+    memset(msg->data, 'x', size);
+    memcpy(msg->data, text, strlen(text));
+    return msg;
+}
+
+// Tests small frames travel as datagrams and large ones on the stream
+void test_datagram_delivery(void) {
+    printf("\nTesting datagram delivery...\n");
+
+    NetworkHandle handle = start_pair(true, NULL);
+
+    NetworkMessage* small = make_message("presence", 8);
+    for (int i = 0; i < 10; i++) {
+        assert(network_send_unreliable(nodes[0].network, &handle, 1, small) == 1);
+    }
+    wait_for(&nodes[1].received, 10);
+    assert(nodes[1].datagrams == 10);
+    assert(strcmp(nodes[1].last_data, "presence") == 0);
+
+    NetworkMessage* large = make_message("bulk", DATAGRAM_MAX_SIZE);
+    assert(network_send_unreliable(nodes[0].network, &handle, 1, large) == 1);
+    wait_for(&nodes[1].received, 11);
+    assert(nodes[1].datagrams == 10);
+    assert(strncmp(nodes[1].last_data, "bulkxxxx", 8) == 0);
+
+    NetworkStats stats;
+    network_get_stats(nodes[0].network, &stats);
+    assert(stats.datagrams_sent == 10 && stats.datagrams_dropped == 0);
+    network_get_stats(nodes[1].network, &stats);
+    assert(stats.datagrams_received == 10);
+
+    // Datagrams from an address with no connection are dropped
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)(base_port + 1));
+    uint8_t forged[32] = {8, 0, 0, 0, NET_MSG_DATA};
+    assert(sendto(sock, forged, sizeof(forged) - 16, 0, (struct sockaddr*)&addr, sizeof(addr)) == 16);
+    close(sock);
+
+    uint64_t deadline = now_ms() + WAIT_MS;
+    do {
+        assert(now_ms() < deadline);
+        usleep(1000);
+        network_get_stats(nodes[1].network, &stats);
+    } while (stats.datagrams_dropped == 0);
+    assert(nodes[1].received == 11);
+
+    free(small);
+    free(large);
+    stop_pair();
+    printf("Datagram delivery tests passed!\n");
+}
+
+// Tests a peer without the channel is sent frames on the stream
+void test_datagram_fallback(void) {
+    printf("\nTesting fallback to the connection...\n");
+
+    NetworkHandle handle = start_pair(false, NULL);
+    NetworkMessage* msg = make_message("update", 6);
+    assert(network_send_unreliable(nodes[0].network, &handle, 1, msg) == 1);
+    wait_for(&nodes[1].received, 1);
+    assert(nodes[1].datagrams == 0);
+
+    NetworkHandle stale = handle + 1;
+    assert(network_send_unreliable(nodes[0].network, &stale, 1, msg) == 0);
+
+    free(msg);
+    stop_pair();
+    printf("Fallback tests passed!\n");
+}
+
+// Tests datagrams between authenticated peers carry verified tags
+void test_datagram_auth(void) {
+    printf("\nTesting authenticated datagrams...\n");
+
+    NetworkHandle handle = start_pair(true, "0123456789abcdef-datagram-secret");
+    NetworkMessage* msg = make_message("signed", 6);
+
+    for (int i = 0; i < 5; i++) {
+        assert(network_send_unreliable(nodes[0].network, &handle, 1, msg) == 1);
+    }
+    wait_for(&nodes[1].received, 5);
+    assert(nodes[1].datagrams == 5);
+    assert(nodes[1].authenticated);
+
+    NetworkStats stats;
+    network_get_stats(nodes[1].network, &stats);
+    assert(stats.auth_failures == 0);
+
+    free(msg);
+    stop_pair();
+    printf("Authenticated datagram tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting datagram integration tests...\n");
+
+    base_port = (uint16_t)(21000 + getpid() % 20000);
+    test_datagram_delivery();
+    test_datagram_fallback();
+    test_datagram_auth();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
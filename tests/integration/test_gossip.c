@@ -0,0 +1,250 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../../src/runtime/network/network.h"
+#include "../../src/runtime/network/gossip.h"
+
+// Eight nodes on loopback wired as a 3-cube: three peers each and a
+// diameter of three. With the fanout at the degree every node relays to
+// all other neighbours, so every event must reach every node.
+#define NODE_COUNT 8
+#define CUBE_DIMENSIONS 3
+#define WAIT_MS 10000
+
+typedef struct {
+    NetworkContext* network;
+    GossipContext* gossip;
+    pthread_t thread;
+    atomic_bool running;
+    int delivered;
+    int max_round;              // Largest hop count seen, plus one
+    char last_data[64];
+} Node;
+
+static Node nodes[NODE_COUNT];
+static uint16_t base_port;
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static Node* node_of(NetworkContext* network) {
+    for (int i = 0; i < NODE_COUNT; i++) {
+        if (nodes[i].network == network) return &nodes[i];
+    }
+    return NULL;
+}
+
+// Network frames go to the node's gossip layer
+static void message_handler(NetworkContext* network, NetworkMessage* msg) {
+    Node* node = node_of(network);
+    assert(node && gossip_receive(node->gossip, msg));
+}
+
+static void event_handler(GossipContext* gossip, const GossipEvent* event, void* user_data) {
+    (void)gossip;
+    Node* node = user_data;
+    int round = event->hops + 1;
+    if (round > node->max_round) node->max_round = round;
+    snprintf(node->last_data, sizeof(node->last_data), "%.*s", (int)event->size,
+             (const char*)event->data);
+    __sync_fetch_and_add(&node->delivered, 1);
+}
+
+static void* node_main(void* arg) {
+    Node* node = arg;
+    while (atomic_load(&node->running)) {
+        network_run(node->network);
+    }
+    return NULL;
+}
+
+static void node_resume(Node* node) {
+    atomic_store(&node->running, true);
+    assert(pthread_create(&node->thread, NULL, node_main, node) == 0);
+}
+
+static void node_pause(Node* node) {
+    atomic_store(&node->running, false);
+    pthread_join(node->thread, NULL);
+}
+
+static size_t peer_count(Node* node) {
+    NetworkHandle handles[NODE_COUNT * 2];
+    return network_get_handles(node->network, handles, NODE_COUNT * 2);
+}
+
+// Wait until every node has a handshaken connection per cube edge
+static void wait_for_mesh(void) {
+    uint64_t deadline = now_ms() + WAIT_MS;
+    for (int i = 0; i < NODE_COUNT; i++) {
+        while (peer_count(&nodes[i]) < CUBE_DIMENSIONS) {
+            assert(now_ms() < deadline);
+            usleep(5000);
+        }
+    }
+}
+
+// Wait until every node has delivered its expected event count
+static void wait_for_delivery(const int* expected) {
+    uint64_t deadline = now_ms() + WAIT_MS;
+    for (int i = 0; i < NODE_COUNT; i++) {
+        while (__sync_fetch_and_add(&nodes[i].delivered, 0) < expected[i]) {
+            assert(now_ms() < deadline);
+            usleep(1000);
+        }
+    }
+}
+
+static void start_cluster(void) {
+    base_port = (uint16_t)(20000 + getpid() % 20000);
+    for (int i = 0; i < NODE_COUNT; i++) {
+        char id[32];
+        snprintf(id, sizeof(id), "node-%d", i);
+        nodes[i].network = network_create((uint16_t)(base_port + i));
+        nodes[i].gossip = gossip_create(nodes[i].network, id);
+        assert(nodes[i].network && nodes[i].gossip);
+        network_set_reconnect(nodes[i].network, 20, 200);
+        network_set_message_handler(nodes[i].network, message_handler);
+        gossip_set_fanout(nodes[i].gossip, CUBE_DIMENSIONS, 0);
+        gossip_set_handler(nodes[i].gossip, event_handler, &nodes[i]);
+
+        // The lower-numbered end of each edge dials
+        for (int bit = 1; bit < NODE_COUNT; bit <<= 1) {
+            int peer = i ^ bit;
+            if (peer > i) {
+                assert(network_add_peer(nodes[i].network, "127.0.0.1", (uint16_t)(base_port + peer)));
+            }
+        }
+    }
+    for (int i = 0; i < NODE_COUNT; i++) {
+        assert(network_start(nodes[i].network));
+        node_resume(&nodes[i]);
+    }
+}
+
+static void stop_cluster(void) {
+    for (int i = 0; i < NODE_COUNT; i++) {
+        node_pause(&nodes[i]);
+    }
+    for (int i = 0; i < NODE_COUNT; i++) {
+        network_destroy(nodes[i].network);
+        gossip_destroy(nodes[i].gossip);
+    }
+}
+
+// Tests events reach every node exactly once with each node sending at
+// most fanout copies. The first copy need not take a shortest path, so
+// rounds are only bounded by the node count.
+void test_gossip_spread(void) {
+    printf("\nTesting gossip across a loopback cluster...\n");
+
+    wait_for_mesh();
+
+    // Origins do not deliver their own events
+    int expected[NODE_COUNT];
+    for (int i = 0; i < NODE_COUNT; i++) expected[i] = i == 0 ? 0 : 1;
+    assert(gossip_publish(nodes[0].gossip, NET_MSG_NODE_CREATED, "node-abc", 8));
+    wait_for_delivery(expected);
+
+    for (int i = 0; i < NODE_COUNT; i++) expected[i] = (i == 0 || i == 5) ? 1 : 2;
+    assert(gossip_publish(nodes[5].gossip, NET_MSG_NODE_DELETED, "node-def", 8));
+    wait_for_delivery(expected);
+
+    // Let duplicates settle, then check nothing was delivered twice
+    usleep(100000);
+    for (int i = 0; i < NODE_COUNT; i++) {
+        GossipStats stats;
+        gossip_get_stats(nodes[i].gossip, &stats);
+        assert(nodes[i].delivered == expected[i]);
+        assert(nodes[i].max_round >= 1 && nodes[i].max_round < NODE_COUNT);
+        assert(stats.relayed <= 2 * CUBE_DIMENSIONS);
+        assert(stats.received == stats.delivered + stats.duplicates);
+    }
+    assert(strcmp(nodes[0].last_data, "node-def") == 0);
+
+    // Anything but an event is left to the caller
+    NetworkMessage plain = {.type = NET_MSG_DATA};
+    assert(!gossip_receive(nodes[0].gossip, &plain));
+
+    printf("Gossip spread tests passed!\n");
+}
+
+// Tests a restarted node is redialed by its peers and rejoins the cluster
+void test_gossip_reconnect(void) {
+    printf("\nTesting reconnect after a node restarts...\n");
+
+    NetworkStats before;
+    network_get_stats(nodes[0].network, &before);
+
+    node_pause(&nodes[1]);
+    network_stop(nodes[1].network);
+    usleep(50000);
+    assert(network_start(nodes[1].network));
+    node_resume(&nodes[1]);
+
+    wait_for_mesh();
+    NetworkStats after;
+    network_get_stats(nodes[0].network, &after);
+    assert(after.dials > before.dials);
+
+    int expected[NODE_COUNT];
+    for (int i = 0; i < NODE_COUNT; i++) expected[i] = nodes[i].delivered + (i == 7 ? 0 : 1);
+    assert(gossip_publish(nodes[7].gossip, NET_MSG_NODE_UPDATED, "node-xyz", 8));
+    wait_for_delivery(expected);
+    assert(strcmp(nodes[1].last_data, "node-xyz") == 0);
+
+    printf("Reconnect tests passed!\n");
+}
+
+// Tests an unreachable peer is redialed with growing delays
+void test_dial_backoff(void) {
+    printf("\nTesting redial backoff...\n");
+
+    NetworkContext* network = network_create((uint16_t)(base_port + NODE_COUNT));
+    assert(network);
+    network_set_reconnect(network, 20, 160);
+    assert(network_start(network));
+
+    // Nothing listens on the port below the cluster
+    assert(network_add_peer(network, "127.0.0.1", (uint16_t)(base_port - 1)));
+    assert(network_add_peer(network, "127.0.0.1", (uint16_t)(base_port - 1)));
+    uint64_t end = now_ms() + 1000;
+    while (now_ms() < end) {
+        network_run(network);
+    }
+
+    // Delays of 20, 40, 80, then 160ms with up to half again of jitter;
+    // the last attempt may still be in flight
+    NetworkStats stats;
+    network_get_stats(network, &stats);
+    assert(stats.dials >= 4 && stats.dials <= 10);
+    assert(stats.dial_failures + 1 >= stats.dials);
+    assert(stats.handshakes == 0);
+
+    assert(network_remove_peer(network, "127.0.0.1", (uint16_t)(base_port - 1)));
+    assert(!network_remove_peer(network, "127.0.0.1", (uint16_t)(base_port - 1)));
+    network_destroy(network);
+
+    printf("Redial backoff tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting gossip integration tests...\n");
+
+    start_cluster();
+    test_gossip_spread();
+    test_gossip_reconnect();
+    test_dial_backoff();
+    stop_cluster();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
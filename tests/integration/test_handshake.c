@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "../../src/runtime/network/network.h"
+
+// Handshakes between networks, and from raw memory-fabric clients
+// posing as older, newer and legacy peers
+#define SERVER_PORT 7370
+#define CLIENT_PORT 7371
+#define WAIT_MS 10000
+
+static NetworkTransport* fabric;
+static NetworkContext* server;
+static int received;
+static char last_data[64];
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void message_handler(NetworkContext* network, NetworkMessage* msg) {
+    (void)network;
+    if (msg->type != NET_MSG_DATA) return;
+    snprintf(last_data, sizeof(last_data), "%.*s", (int)msg->data_size, (const char*)msg->data);
+    received++;
+}
+
+static NetworkContext* create_network(uint16_t port) {
+    NetworkContext* network = network_create(port);
+    assert(network);
+    assert(network_set_transport(network, fabric));
+    network_set_io_threads(network, 0);
+    network_set_poll_timeout(network, 0);
+    return network;
+}
+
+// The server's connection to its only client, negotiated or not
+static NetworkConnection* server_connection(void) {
+    for (size_t i = 0; i < server->max_connections; i++) {
+        if (server->connections[i].is_active) return &server->connections[i];
+    }
+    return NULL;
+}
+
+static void wait_closed(void) {
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (server->active_connections > 0) {
+        assert(now_ms() < deadline);
+        network_run(server);
+    }
+}
+
+static void write_raw(int client, const void* data, size_t size) {
+    struct iovec iov = {(void*)data, size};
+    assert(fabric->write(fabric, client, &iov, 1) == (ssize_t)size);
+}
+
+// Send a plain data frame from a raw client and wait for the server
+static void send_raw_data(int client, const char* text) {
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + strlen(text));
+    assert(msg);
+    msg->type = NET_MSG_DATA;
+    strcpy(msg->source_id, "raw");
+    msg->data_size = (uint32_t)strlen(text);
+    memcpy(msg->data, text, msg->data_size);
+    NetworkBuffer* frame = network_buffer_encode(msg);
+    assert(frame);
+    write_raw(client, frame->data, frame->size);
+    network_buffer_release(frame);
+    free(msg);
+
+    int target = received + 1;
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (received < target) {
+        assert(now_ms() < deadline);
+        network_run(server);
+    }
+    assert(strcmp(last_data, text) == 0);
+}
+
+// Read one frame the server wrote to a raw client
+static uint32_t read_raw(int client, uint8_t* frame, size_t size) {
+    size_t have = 0;
+    uint64_t deadline = now_ms() + WAIT_MS;
+    for (;;) {
+        if (have >= NETWORK_FRAME_HEADER_SIZE) {
+            uint32_t length = (uint32_t)frame[0] | ((uint32_t)frame[1] << 8) |
+                              ((uint32_t)frame[2] << 16) | ((uint32_t)frame[3] << 24);
+            assert(NETWORK_FRAME_HEADER_SIZE + length <= size);
+            if (have == NETWORK_FRAME_HEADER_SIZE + length) return length;
+        }
+        assert(now_ms() < deadline);
+        network_run(server);
+
+        size_t want = have < NETWORK_FRAME_HEADER_SIZE ? NETWORK_FRAME_HEADER_SIZE - have : 1;
+        ssize_t got = fabric->read(fabric, client, frame + have, want, NULL);
+        if (got > 0) have += (size_t)got;
+    }
+}
+
+// Tests a HELLO survives encoding, and short payloads from older peers
+// decode with the later fields cleared
+void test_hello_encoding(void) {
+    printf("\nTesting HELLO encoding...\n");
+
+    NetworkHello hello = {
+        .version = NETWORK_PROTOCOL_VERSION,
+        .min_version = NETWORK_PROTOCOL_MIN_VERSION,
+        .max_batch = 300,
+        .features = NET_FEATURE_FLOW_CONTROL | NET_FEATURE_RELIABLE,
+        .max_frame = NETWORK_MAX_FRAME_SIZE,
+        .flow_window = 1 << 20,
+        .dictionary = 0xdeadbeefu,
+        .datagram_port = 7999,
+        .instance = 0x0123456789abcdefull
+    };
+    memset(hello.nonce, 0x5a, sizeof(hello.nonce));
+
+    uint8_t frame[NETWORK_FRAME_HEADER_SIZE + NETWORK_HELLO_SIZE + 16];
+    assert(network_encode_hello(&hello, frame, NETWORK_FRAME_HEADER_SIZE + NETWORK_HELLO_SIZE - 1) == 0);
+    assert(network_encode_hello(&hello, frame, sizeof(frame)) ==
+           NETWORK_FRAME_HEADER_SIZE + NETWORK_HELLO_SIZE);
+    assert(frame[4] == NET_CONTROL_HELLO && frame[5] == NET_FRAME_FLAG_CONTROL);
+
+    NetworkHello decoded;
+    const uint8_t* payload = frame + NETWORK_FRAME_HEADER_SIZE;
+    assert(network_decode_hello(payload, NETWORK_HELLO_SIZE, &decoded));
+    assert(decoded.version == hello.version && decoded.min_version == hello.min_version);
+    assert(decoded.max_batch == 300 && decoded.features == hello.features);
+    assert(decoded.max_frame == hello.max_frame && decoded.flow_window == hello.flow_window);
+    assert(decoded.dictionary == hello.dictionary);
+    assert(memcmp(decoded.nonce, hello.nonce, sizeof(hello.nonce)) == 0);
+    assert(decoded.datagram_port == 7999 && decoded.instance == hello.instance);
+
+    // Fields from newer peers past ours are ignored
+    memset(frame + NETWORK_FRAME_HEADER_SIZE + NETWORK_HELLO_SIZE, 0xff, 16);
+    assert(network_decode_hello(payload, NETWORK_HELLO_SIZE + 16, &decoded));
+    assert(decoded.instance == hello.instance);
+
+    // A first-generation HELLO carries only the fixed fields
+    assert(network_decode_hello(payload, NETWORK_HELLO_MIN_SIZE, &decoded));
+    assert(decoded.features == hello.features && decoded.flow_window == hello.flow_window);
+    assert(decoded.dictionary == 0 && decoded.datagram_port == 0 && decoded.instance == 0);
+    assert(network_decode_hello(payload, 20, &decoded));
+    assert(decoded.dictionary == hello.dictionary && decoded.instance == 0);
+
+    assert(!network_decode_hello(payload, NETWORK_HELLO_MIN_SIZE - 1, &decoded));
+    assert(!network_decode_hello(NULL, NETWORK_HELLO_SIZE, &decoded));
+
+    printf("HELLO encoding tests passed!\n");
+}
+
+// Tests two networks settle on the features both offer
+void test_negotiation(void) {
+    printf("\nTesting feature negotiation...\n");
+
+    assert(network_set_compression(server, 64, NULL, 0));
+    NetworkContext* client = create_network(CLIENT_PORT);
+    network_set_features(client, NET_FEATURE_FLOW_CONTROL);
+    assert(network_start(client));
+    assert(network_add_peer(client, "fabric", SERVER_PORT));
+
+    NetworkHandle handle;
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (!server_connection() || !server_connection()->negotiated ||
+           network_get_handles(client, &handle, 1) < 1 ||
+           !network_resolve(client, handle)->negotiated) {
+        assert(now_ms() < deadline);
+        network_run(client);
+        network_run(server);
+    }
+
+    NetworkConnection* theirs = network_resolve(client, handle);
+    NetworkConnection* ours = server_connection();
+    assert(ours->version == NETWORK_PROTOCOL_VERSION && theirs->version == NETWORK_PROTOCOL_VERSION);
+    assert(ours->features == NET_FEATURE_FLOW_CONTROL);
+    assert(theirs->features == NET_FEATURE_FLOW_CONTROL);
+    assert(ours->session < 0 && theirs->session < 0);
+
+    network_destroy(client);
+    wait_closed();
+    assert(network_set_compression(server, 0, NULL, 0));
+
+    printf("Feature negotiation tests passed!\n");
+}
+
+// Tests a peer sending a first-generation HELLO, and one from a newer
+// version with fields we do not know, are both answered and served
+void test_other_versions(void) {
+    printf("\nTesting older and newer peers...\n");
+
+    uint8_t versions[2] = {NETWORK_PROTOCOL_VERSION, NETWORK_PROTOCOL_VERSION + 1};
+    size_t sizes[2] = {NETWORK_HELLO_MIN_SIZE, NETWORK_HELLO_SIZE + 16};
+    for (int i = 0; i < 2; i++) {
+        int client = network_memory_connect(fabric, SERVER_PORT);
+        assert(client >= 0);
+
+        NetworkHello hello = {
+            .version = versions[i],
+            .min_version = NETWORK_PROTOCOL_MIN_VERSION,
+            .features = NET_FEATURE_FLOW_CONTROL | NET_FEATURE_BATCH,
+            .max_frame = NETWORK_MAX_FRAME_SIZE
+        };
+        uint8_t frame[NETWORK_FRAME_HEADER_SIZE + NETWORK_HELLO_SIZE + 16] = {0};
+        assert(network_encode_hello(&hello, frame, sizeof(frame)));
+        frame[0] = (uint8_t)sizes[i];
+        write_raw(client, frame, NETWORK_FRAME_HEADER_SIZE + sizes[i]);
+
+        // The server answers with its own
+        uint8_t answer[NETWORK_FRAME_HEADER_SIZE + NETWORK_HELLO_SIZE];
+        uint32_t length = read_raw(client, answer, sizeof(answer));
+        assert(answer[4] == NET_CONTROL_HELLO && answer[5] == NET_FRAME_FLAG_CONTROL);
+        NetworkHello reply;
+        assert(network_decode_hello(answer + NETWORK_FRAME_HEADER_SIZE, length, &reply));
+        assert(reply.version == NETWORK_PROTOCOL_VERSION);
+
+        NetworkConnection* conn = server_connection();
+        assert(conn->negotiated && conn->version == NETWORK_PROTOCOL_VERSION);
+        assert(conn->features == NET_FEATURE_FLOW_CONTROL);
+        send_raw_data(client, "versioned");
+
+        fabric->close(fabric, client);
+        wait_closed();
+    }
+
+    printf("Older and newer peer tests passed!\n");
+}
+
+// Tests a peer that never sends a HELLO is served as legacy: no
+// features and no handshake sent to it
+void test_legacy_peer(void) {
+    printf("\nTesting legacy peers...\n");
+
+    int client = network_memory_connect(fabric, SERVER_PORT);
+    assert(client >= 0);
+    send_raw_data(client, "legacy");
+    send_raw_data(client, "still legacy");
+
+    NetworkConnection* conn = server_connection();
+    assert(conn && !conn->negotiated && conn->version == 0 && conn->features == 0);
+    assert(conn->established);
+
+    // Replies arrive as plain frames with nothing ahead of them
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + 5);
+    assert(msg);
+    msg->type = NET_MSG_DATA;
+    msg->data_size = 5;
+    memcpy(msg->data, "hello", 5);
+    assert(network_send_handle(server, network_get_handle(server, conn), msg));
+    free(msg);
+
+    uint8_t frame[64];
+    assert(read_raw(client, frame, sizeof(frame)) == 5);
+    assert(frame[4] == NET_MSG_DATA && frame[5] == 0);
+    assert(memcmp(frame + NETWORK_FRAME_HEADER_SIZE, "hello", 5) == 0);
+
+    fabric->close(fabric, client);
+    wait_closed();
+
+    printf("Legacy peer tests passed!\n");
+}
+
+// Tests a peer whose versions do not overlap ours is cut off
+void test_version_mismatch(void) {
+    printf("\nTesting version mismatch...\n");
+
+    int client = network_memory_connect(fabric, SERVER_PORT);
+    assert(client >= 0);
+    network_run(server);
+    assert(server->active_connections == 1);
+    int before = received;
+
+    NetworkHello hello = {
+        .version = NETWORK_PROTOCOL_VERSION + 2,
+        .min_version = NETWORK_PROTOCOL_VERSION + 1
+    };
+    uint8_t frame[NETWORK_FRAME_HEADER_SIZE + NETWORK_HELLO_SIZE];
+    assert(network_encode_hello(&hello, frame, sizeof(frame)));
+    write_raw(client, frame, sizeof(frame));
+    wait_closed();
+    assert(received == before);
+
+    fabric->close(fabric, client);
+
+    printf("Version mismatch tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting handshake tests...\n");
+
+    fabric = network_memory_transport_create();
+    assert(fabric);
+    server = create_network(SERVER_PORT);
+    network_set_message_handler(server, message_handler);
+    assert(network_start(server));
+
+    test_hello_encoding();
+    test_negotiation();
+    test_other_versions();
+    test_legacy_peer();
+    test_version_mismatch();
+
+    network_destroy(server);
+    network_memory_transport_destroy(fabric);
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../../src/runtime/network/network.h"
+
+// A socket-transport server with a local listener, and raw same-host
+// clients speaking frames over AF_UNIX and then over shared memory
+#define SERVER_PORT 7360
+#define RING_SIZE (64 * 1024)
+#define WAIT_MS 10000
+
+static NetworkContext* server;
+static char unix_path[108];
+static int received;
+static NetworkHandle last_connection;
+static char last_source[64];
+static char last_data[64];
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void message_handler(NetworkContext* network, NetworkMessage* msg) {
+    (void)network;
+    if (msg->type != NET_MSG_DATA) return;
+    last_connection = msg->connection;
+    snprintf(last_source, sizeof(last_source), "%s", msg->source_id);
+    snprintf(last_data, sizeof(last_data), "%.*s", (int)msg->data_size, (const char*)msg->data);
+    received++;
+}
+
+static int connect_unix(void) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    assert(fd >= 0);
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, unix_path);
+    assert(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    return fd;
+}
+
+static NetworkBuffer* encode_data(const char* source, const char* text) {
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + strlen(text));
+    assert(msg);
+    msg->type = NET_MSG_DATA;
+    strcpy(msg->source_id, source);
+    msg->data_size = (uint32_t)strlen(text);
+    memcpy(msg->data, text, msg->data_size);
+    NetworkBuffer* buffer = network_buffer_encode(msg);
+    assert(buffer);
+    free(msg);
+    return buffer;
+}
+
+// Run the server until it has delivered count more frames
+static void wait_received(int count) {
+    int target = received + count;
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (received < target) {
+        assert(now_ms() < deadline);
+        network_run(server);
+    }
+}
+
+// Read one whole frame into frame, running the server while waiting.
+// Returns the payload size after the header.
+static uint32_t read_frame(int fd, ShmChannel* channel, uint8_t* frame, size_t size) {
+    size_t have = 0;
+    uint64_t deadline = now_ms() + WAIT_MS;
+    for (;;) {
+        if (have >= NETWORK_FRAME_HEADER_SIZE) {
+            uint32_t length = (uint32_t)frame[0] | ((uint32_t)frame[1] << 8) |
+                              ((uint32_t)frame[2] << 16) | ((uint32_t)frame[3] << 24);
+            assert(NETWORK_FRAME_HEADER_SIZE + length <= size);
+            if (have == NETWORK_FRAME_HEADER_SIZE + length) return length;
+        }
+        assert(now_ms() < deadline);
+        network_run(server);
+
+        // One byte at a time past the header, so only this frame is read
+        size_t want = have < NETWORK_FRAME_HEADER_SIZE ? NETWORK_FRAME_HEADER_SIZE - have : 1;
+        if (channel) {
+            have += shm_channel_read(channel, frame + have, want);
+        } else {
+            ssize_t got = recv(fd, frame + have, want, MSG_DONTWAIT);
+            if (got > 0) have += (size_t)got;
+        }
+    }
+}
+
+// Tests a client on the local listener is served like any other: its
+// frames reach the message handler and replies come back
+void test_unix_listener(void) {
+    printf("\nTesting the AF_UNIX listener...\n");
+
+    int fd = connect_unix();
+    NetworkBuffer* frame = encode_data("local", "over unix");
+    assert(send(fd, frame->data, frame->size, 0) == (ssize_t)frame->size);
+    network_buffer_release(frame);
+
+    wait_received(1);
+    assert(strcmp(last_source, "local") == 0);
+    assert(strcmp(last_data, "over unix") == 0);
+    assert(server->active_connections == 1);
+
+    NetworkMessage* reply = calloc(1, sizeof(NetworkMessage) + 5);
+    assert(reply);
+    reply->type = NET_MSG_DATA;
+    strcpy(reply->source_id, "server");
+    reply->data_size = 5;
+    memcpy(reply->data, "reply", 5);
+    assert(network_send_handle(server, last_connection, reply));
+    free(reply);
+
+    uint8_t buffer[256];
+    uint32_t length = read_frame(fd, NULL, buffer, sizeof(buffer));
+    assert(buffer[4] == NET_MSG_DATA && buffer[6] == 6 && buffer[7] == 0);
+    assert(length == 11 && memcmp(buffer + NETWORK_FRAME_HEADER_SIZE, "serverreply", 11) == 0);
+
+    close(fd);
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (server->active_connections > 0) {
+        assert(now_ms() < deadline);
+        network_run(server);
+    }
+
+    printf("AF_UNIX listener tests passed!\n");
+}
+
+// Tests a local client moves onto a shared-memory channel: the server
+// echoes the attach first on the rings, and frames then flow through
+// them both ways
+void test_shm_attach(void) {
+    printf("\nTesting the shared-memory channel...\n");
+
+    int fd = connect_unix();
+    ShmChannel channel;
+    assert(shm_channel_create(&channel, RING_SIZE));
+    assert(network_offer_shm(fd, &channel));
+
+    NetworkStats stats;
+    uint64_t deadline = now_ms() + WAIT_MS;
+    do {
+        assert(now_ms() < deadline);
+        network_run(server);
+        network_get_stats(server, &stats);
+    } while (stats.shm_attached < 1);
+    assert(stats.shm_attached == 1);
+
+    uint8_t buffer[256];
+    assert(read_frame(fd, &channel, buffer, sizeof(buffer)) == 0);
+    assert(buffer[4] == NET_CONTROL_SHM_ATTACH && buffer[5] == NET_FRAME_FLAG_CONTROL);
+
+    NetworkBuffer* frame = encode_data("local-shm", "over shm");
+    struct iovec iov = {frame->data, frame->size};
+    assert(shm_channel_write(&channel, &iov, 1) == frame->size);
+    shm_channel_notify(&channel);
+    network_buffer_release(frame);
+
+    wait_received(1);
+    assert(strcmp(last_source, "local-shm") == 0);
+    assert(strcmp(last_data, "over shm") == 0);
+
+    NetworkMessage* reply = calloc(1, sizeof(NetworkMessage) + 3);
+    assert(reply);
+    reply->type = NET_MSG_DATA;
+    strcpy(reply->source_id, "server");
+    reply->data_size = 3;
+    memcpy(reply->data, "shm", 3);
+    assert(network_send_handle(server, last_connection, reply));
+    free(reply);
+
+    assert(read_frame(fd, &channel, buffer, sizeof(buffer)) == 9);
+    assert(memcmp(buffer + NETWORK_FRAME_HEADER_SIZE, "servershm", 9) == 0);
+
+    // Nothing went over the socket after the attach
+    assert(recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) < 0);
+
+    close(fd);
+    shm_channel_close(&channel);
+    deadline = now_ms() + WAIT_MS;
+    while (server->active_connections > 0) {
+        assert(now_ms() < deadline);
+        network_run(server);
+    }
+
+    printf("Shared-memory channel tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting local transport tests...\n");
+
+    snprintf(unix_path, sizeof(unix_path), "/tmp/phantom-test-%d.sock", (int)getpid());
+    server = network_create(SERVER_PORT);
+    assert(server);
+    network_set_io_threads(server, 0);
+    network_set_poll_timeout(server, 0);
+    assert(network_set_unix_path(server, unix_path));
+    network_set_message_handler(server, message_handler);
+    assert(network_start(server));
+    assert(access(unix_path, F_OK) == 0);
+
+    test_unix_listener();
+    test_shm_attach();
+
+    network_destroy(server);
+    assert(access(unix_path, F_OK) != 0);
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
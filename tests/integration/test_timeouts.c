@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+#include "../../src/runtime/network/network.h"
+
+// A server on a memory fabric with short deadlines. Raw clients never
+// speak, so only the handshake deadline can evict them; a network
+// client handshakes and then either goes quiet or keeps the link alive
+// with heartbeats.
+#define SERVER_PORT 7350
+#define CLIENT_PORT 7351
+#define RAW_CLIENTS 32
+#define HANDSHAKE_MS 50
+#define IDLE_MS 150
+#define HEARTBEAT_MS 30
+#define WAIT_MS 10000
+#define TIMER_TICK_MS 10    // As in network.c
+
+static NetworkTransport* fabric;
+static NetworkContext* server;
+static int disconnects;
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void on_disconnect(NetworkContext* network, NetworkConnection* conn) {
+    (void)network;
+    (void)conn;
+    disconnects++;
+}
+
+static NetworkContext* create_network(uint16_t port) {
+    NetworkContext* network = network_create(port);
+    assert(network);
+    assert(network_set_transport(network, fabric));
+    network_set_io_threads(network, 0);
+    network_set_poll_timeout(network, 0);
+    return network;
+}
+
+static uint64_t timeouts(void) {
+    NetworkStats stats;
+    network_get_stats(server, &stats);
+    return stats.timeouts;
+}
+
+// Connect a network client and run both sides until it is handshaken
+static NetworkContext* connect_client(uint32_t heartbeat_ms) {
+    NetworkContext* client = create_network(CLIENT_PORT);
+    network_set_timeouts(client, 0, heartbeat_ms, 0);
+    assert(network_start(client));
+    assert(network_add_peer(client, "fabric", SERVER_PORT));
+
+    NetworkHandle handle;
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (network_get_handles(server, &handle, 1) < 1 ||
+           !network_resolve(server, handle)->established) {
+        assert(now_ms() < deadline);
+        network_run(client);
+        network_run(server);
+    }
+    return client;
+}
+
+// Tests peers that never speak are evicted at the handshake deadline,
+// all in the same pass
+void test_handshake_timeout(void) {
+    printf("\nTesting handshake deadline...\n");
+
+    int clients[RAW_CLIENTS];
+    for (int i = 0; i < RAW_CLIENTS; i++) {
+        clients[i] = network_memory_connect(fabric, SERVER_PORT);
+        assert(clients[i] >= 0);
+    }
+    uint64_t start = now_ms();
+    network_run(server);
+    assert(server->active_connections == RAW_CLIENTS);
+
+    uint64_t base = timeouts();
+    while (server->active_connections > 0) {
+        assert(now_ms() - start < WAIT_MS);
+        network_run(server);
+        if (server->active_connections < RAW_CLIENTS) {
+            assert(server->active_connections == 0);
+        }
+        usleep(1000);
+    }
+    assert(now_ms() - start >= HANDSHAKE_MS - TIMER_TICK_MS);
+    assert(timeouts() - base == RAW_CLIENTS);
+    assert(disconnects == RAW_CLIENTS);
+
+    for (int i = 0; i < RAW_CLIENTS; i++) {
+        fabric->close(fabric, clients[i]);
+    }
+    disconnects = 0;
+
+    printf("Handshake deadline tests passed!\n");
+}
+
+// Tests a handshaken peer that goes quiet is evicted after the idle
+// timeout, not the handshake deadline
+void test_idle_timeout(void) {
+    printf("\nTesting idle timeout...\n");
+
+    NetworkContext* client = connect_client(0);
+    uint64_t base = timeouts();
+
+    // The client stops running, so nothing reaches the server
+    uint64_t start = now_ms();
+    while (server->active_connections > 0) {
+        assert(now_ms() - start < WAIT_MS);
+        network_run(server);
+        if (now_ms() - start < IDLE_MS / 2) {
+            assert(server->active_connections == 1);
+        }
+        usleep(1000);
+    }
+    assert(now_ms() - start >= IDLE_MS - 2 * TIMER_TICK_MS);
+    assert(timeouts() - base == 1);
+    assert(disconnects == 1);
+
+    network_destroy(client);
+    disconnects = 0;
+
+    printf("Idle timeout tests passed!\n");
+}
+
+// Tests heartbeat pings keep a quiet link past several idle timeouts
+void test_heartbeat(void) {
+    printf("\nTesting heartbeats...\n");
+
+    NetworkContext* client = connect_client(HEARTBEAT_MS);
+    uint64_t base = timeouts();
+
+    uint64_t start = now_ms();
+    while (now_ms() - start < 4 * IDLE_MS) {
+        network_run(client);
+        network_run(server);
+        usleep(1000);
+    }
+    assert(server->active_connections == 1);
+    assert(timeouts() == base);
+    assert(disconnects == 0);
+
+    NetworkStats stats;
+    network_get_stats(client, &stats);
+    assert(stats.pings_sent >= 4 * IDLE_MS / HEARTBEAT_MS / 2);
+
+    network_destroy(client);
+    network_run(server);
+    assert(server->active_connections == 0);
+    assert(timeouts() == base);
+    disconnects = 0;
+
+    printf("Heartbeat tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting connection timeout tests...\n");
+
+    fabric = network_memory_transport_create();
+    assert(fabric);
+    server = create_network(SERVER_PORT);
+    network_set_timeouts(server, IDLE_MS, 0, HANDSHAKE_MS);
+    network_set_disconnect_handler(server, on_disconnect);
+    assert(network_start(server));
+
+    test_handshake_timeout();
+    test_idle_timeout();
+    test_heartbeat();
+
+    network_destroy(server);
+    network_memory_transport_destroy(fabric);
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
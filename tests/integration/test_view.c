@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "../../src/runtime/network/network.h"
+
+// A sender and a receiver both connected to a relay on one memory
+// fabric. The relay takes frames as views and forwards each to the
+// receiver without building a message.
+#define RELAY_PORT 7340
+#define SENDER_PORT 7341
+#define RECEIVER_PORT 7342
+#define WAIT_MS 10000
+#define COMPRESS_THRESHOLD 64
+
+static NetworkTransport* fabric;
+static NetworkContext* relay;
+static NetworkContext* sender;
+static NetworkContext* receiver;
+static NetworkHandle to_relay;     // Sender's connection to the relay
+static NetworkHandle from_sender;  // Relay's connection from the sender
+static NetworkHandle to_receiver;  // Relay's connection to the receiver
+
+// What the relay saw of the last view
+static int views;
+static bool in_place;
+static bool inflated;
+static bool view_reliable;
+static bool retain_next;
+static NetworkMessage* retained;
+
+// What the receiver got
+static int received;
+static bool received_reliable;
+static char received_source[64];
+static char received_target[64];
+static uint8_t received_data[NETWORK_MAX_FRAME_SIZE];
+static uint32_t received_size;
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static bool inside(const void* p, size_t size, const NetworkConnection* conn) {
+    const uint8_t* bytes = p;
+    return bytes >= conn->rx_buffer && bytes + size <= conn->rx_buffer + conn->rx_capacity;
+}
+
+static void relay_handler(NetworkContext* network, const NetworkView* view) {
+    if (view->type != NET_MSG_DATA) return;
+
+    NetworkConnection* conn = network_resolve(network, view->connection);
+    assert(conn && view->connection == from_sender);
+    in_place = inside(view->source_id, view->source_len, conn) &&
+               inside(view->target_id, view->target_len, conn) &&
+               inside(view->data, view->data_size, conn);
+    inflated = view->data == network->rx_message->data;
+    view_reliable = view->reliable;
+    if (retain_next) {
+        retained = network_view_retain(view);
+        retain_next = false;
+    }
+    assert(network_forward(network, to_receiver, view));
+    views++;
+}
+
+static void receiver_handler(NetworkContext* network, NetworkMessage* msg) {
+    (void)network;
+    if (msg->type != NET_MSG_DATA) return;
+    snprintf(received_source, sizeof(received_source), "%s", msg->source_id);
+    snprintf(received_target, sizeof(received_target), "%s", msg->target_id);
+    memcpy(received_data, msg->data, msg->data_size);
+    received_size = msg->data_size;
+    received_reliable = msg->reliable;
+    received++;
+}
+
+static void pump(void) {
+    network_run(sender);
+    network_run(relay);
+    network_run(receiver);
+}
+
+static size_t handle_count(NetworkContext* network) {
+    NetworkHandle handles[4];
+    return network_get_handles(network, handles, 4);
+}
+
+static NetworkContext* create_network(uint16_t port) {
+    NetworkContext* network = network_create(port);
+    assert(network);
+    assert(network_set_transport(network, fabric));
+    network_set_io_threads(network, 0);
+    network_set_poll_timeout(network, 0);
+    assert(network_set_compression(network, COMPRESS_THRESHOLD, NULL, 0));
+    return network;
+}
+
+// Connect one client to the relay and return the relay's handle for it
+static NetworkHandle join_relay(NetworkContext* client) {
+    NetworkHandle before[2];
+    size_t count = network_get_handles(relay, before, 2);
+    assert(network_start(client));
+    assert(network_add_peer(client, "fabric", RELAY_PORT));
+
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (handle_count(relay) < count + 1 || handle_count(client) < 1) {
+        assert(now_ms() < deadline);
+        pump();
+    }
+
+    NetworkHandle handles[2];
+    assert(network_get_handles(relay, handles, 2) == count + 1);
+    for (size_t i = 0; i <= count; i++) {
+        if (count == 0 || handles[i] != before[0]) return handles[i];
+    }
+    assert(0);
+    return NETWORK_INVALID_HANDLE;
+}
+
+static void start_networks(void) {
+    fabric = network_memory_transport_create();
+    assert(fabric);
+    relay = create_network(RELAY_PORT);
+    sender = create_network(SENDER_PORT);
+    receiver = create_network(RECEIVER_PORT);
+    network_set_view_handler(relay, relay_handler);
+    network_set_message_handler(receiver, receiver_handler);
+    assert(network_start(relay));
+
+    from_sender = join_relay(sender);
+    to_receiver = join_relay(receiver);
+    assert(network_get_handles(sender, &to_relay, 1) == 1);
+}
+
+static void stop_networks(void) {
+    network_destroy(sender);
+    network_destroy(receiver);
+    network_destroy(relay);
+    network_memory_transport_destroy(fabric);
+}
+
+static NetworkMessage* make_message(const char* target, uint32_t size) {
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + size);
+    assert(msg);
+    msg->type = NET_MSG_DATA;
+    strcpy(msg->source_id, "sender");
+    strcpy(msg->target_id, target);
+    msg->data_size = size;
+    return msg;
+}
+
+// Payload that does not compress
+static void fill_random(NetworkMessage* msg, uint32_t seed) {
+    for (uint32_t i = 0; i < msg->data_size; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        msg->data[i] = (uint8_t)seed;
+    }
+}
+
+// Run until the receiver has count more frames
+static void wait_received(int count) {
+    int target = received + count;
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (received < target) {
+        assert(now_ms() < deadline);
+        pump();
+    }
+}
+
+static void assert_received(const NetworkMessage* msg) {
+    assert(strcmp(received_source, msg->source_id) == 0);
+    assert(strcmp(received_target, msg->target_id) == 0);
+    assert(received_size == msg->data_size);
+    assert(memcmp(received_data, msg->data, msg->data_size) == 0);
+}
+
+// Tests a view points into the receive buffer and is forwarded intact
+void test_view_in_place(void) {
+    printf("\nTesting views over the receive buffer...\n");
+
+    NetworkMessage* msg = make_message("node-r", 4000);
+    fill_random(msg, 2463534242u);
+    int before = views;
+    assert(network_send_handle(sender, to_relay, msg));
+    wait_received(1);
+
+    assert(views == before + 1);
+    assert(in_place && !inflated && !view_reliable);
+    assert(!received_reliable);
+    assert_received(msg);
+    free(msg);
+
+    printf("Receive buffer view tests passed!\n");
+}
+
+// Tests a reliable frame is viewed past its sequence number and
+// forwarded reliably
+void test_view_reliable(void) {
+    printf("\nTesting reliable views...\n");
+
+    NetworkMessage* msg = make_message("node-r", 1000);
+    fill_random(msg, 88172645u);
+    assert(network_send_reliable(sender, to_relay, msg));
+    wait_received(1);
+
+    assert(in_place && view_reliable);
+    assert(received_reliable);
+    assert_received(msg);
+    free(msg);
+
+    printf("Reliable view tests passed!\n");
+}
+
+// Tests a compressed frame is viewed in the inflate scratch
+void test_view_compressed(void) {
+    printf("\nTesting compressed views...\n");
+
+    NetworkMessage* msg = make_message("node-r", 8000);
+    for (uint32_t i = 0; i < msg->data_size; i++) {
+        msg->data[i] = (uint8_t)"node-r payload "[i % 15];
+    }
+    NetworkStats before;
+    network_get_stats(sender, &before);
+    assert(network_send_handle(sender, to_relay, msg));
+    wait_received(1);
+
+    NetworkStats after;
+    network_get_stats(sender, &after);
+    assert(after.frames_compressed == before.frames_compressed + 1);
+    assert(inflated && !in_place);
+    assert_received(msg);
+    free(msg);
+
+    printf("Compressed view tests passed!\n");
+}
+
+// Tests a retained view keeps its frame after the handler returns and
+// later frames reuse the receive buffer
+void test_view_retain(void) {
+    printf("\nTesting retained views...\n");
+
+    NetworkMessage* first = make_message("node-kept", 2000);
+    NetworkMessage* second = make_message("node-r", 2000);
+    fill_random(first, 123456789u);
+    fill_random(second, 987654321u);
+
+    retain_next = true;
+    assert(network_send_handle(sender, to_relay, first));
+    wait_received(1);
+    assert(retained && !retain_next);
+    for (int i = 0; i < 4; i++) {
+        assert(network_send_handle(sender, to_relay, second));
+        wait_received(1);
+    }
+
+    assert(retained->type == NET_MSG_DATA);
+    assert(strcmp(retained->source_id, "sender") == 0);
+    assert(strcmp(retained->target_id, "node-kept") == 0);
+    assert(retained->connection == from_sender);
+    assert(retained->data_size == first->data_size);
+    assert(memcmp(retained->data, first->data, first->data_size) == 0);
+    free(retained);
+    retained = NULL;
+    free(second);
+    free(first);
+
+    printf("Retained view tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting message view tests...\n");
+
+    start_networks();
+    test_view_in_place();
+    test_view_reliable();
+    test_view_compressed();
+    test_view_retain();
+    stop_networks();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+#include "../../src/runtime/network/network.h"
+
+#define SERVER_PORT 7320
+#define ACCEPT_BATCH_MAX 256          // As in network.c
+#define ACCEPT_RATE_WINDOW_MS 1000    // As in network.c
+#define BACKLOG 300
+
+static NetworkTransport* fabric;
+static NetworkContext* server;
+
+// Tests connects beyond the listen backlog are refused until accepts
+// make room again
+void test_backlog(void) {
+    printf("\nTesting listen backlog...\n");
+
+    for (int i = 0; i < BACKLOG; i++) {
+        assert(network_memory_connect(fabric, SERVER_PORT) >= 0);
+    }
+    errno = 0;
+    assert(network_memory_connect(fabric, SERVER_PORT) < 0);
+    assert(errno == ECONNREFUSED);
+
+    // Non-positive backlogs are ignored
+    network_set_backlog(server, 0);
+    assert(server->backlog == BACKLOG);
+
+    printf("Listen backlog tests passed!\n");
+}
+
+// Tests each wakeup drains at most ACCEPT_BATCH_MAX connections and the
+// rest wait for the next one
+void test_accept_batches(void) {
+    printf("\nTesting accept batching...\n");
+
+    network_run(server);
+    NetworkStats stats;
+    network_get_stats(server, &stats);
+    assert(stats.accepted == ACCEPT_BATCH_MAX);
+    assert(stats.accept_wakeups == 1);
+    assert(stats.max_accept_batch == ACCEPT_BATCH_MAX);
+    assert(server->active_connections == ACCEPT_BATCH_MAX);
+
+    network_run(server);
+    network_get_stats(server, &stats);
+    assert(stats.accepted == BACKLOG);
+    assert(stats.accept_wakeups == 2);
+    assert(stats.max_accept_batch == ACCEPT_BATCH_MAX);
+    assert(stats.accept_errors == 0 && stats.rejected == 0);
+    assert(server->active_connections == BACKLOG);
+
+    // Nothing pending, nothing to wake for
+    network_run(server);
+    network_get_stats(server, &stats);
+    assert(stats.accept_wakeups == 2);
+
+    // The queue has room again
+    assert(network_memory_connect(fabric, SERVER_PORT) >= 0);
+    network_run(server);
+    network_get_stats(server, &stats);
+    assert(stats.accepted == BACKLOG + 1);
+    assert(stats.accept_wakeups == 3);
+
+    printf("Accept batching tests passed!\n");
+}
+
+// Tests the accept rate covers every admission of a closed window
+void test_accept_rate(void) {
+    printf("\nTesting accept rate...\n");
+
+    NetworkStats stats;
+    network_get_stats(server, &stats);
+    assert(stats.accept_rate == 0);
+
+    usleep((ACCEPT_RATE_WINDOW_MS + 50) * 1000);
+    assert(network_memory_connect(fabric, SERVER_PORT) >= 0);
+    network_run(server);
+
+    // BACKLOG + 2 admissions over a little more than one window
+    network_get_stats(server, &stats);
+    assert(stats.accepted == BACKLOG + 2);
+    assert(stats.accept_rate > 0);
+    assert(stats.accept_rate <= (BACKLOG + 2) * 1000.0 / ACCEPT_RATE_WINDOW_MS);
+    assert(stats.accept_rate >= (BACKLOG + 2) * 1000.0 / (ACCEPT_RATE_WINDOW_MS * 10));
+
+    printf("Accept rate tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting accept tests...\n");
+
+    fabric = network_memory_transport_create();
+    assert(fabric);
+    server = network_create(SERVER_PORT);
+    assert(server);
+    assert(network_set_transport(server, fabric));
+    network_set_io_threads(server, 0);
+    network_set_poll_timeout(server, 0);
+    network_set_backlog(server, BACKLOG);
+    assert(network_start(server));
+
+    test_backlog();
+    test_accept_batches();
+    test_accept_rate();
+
+    network_destroy(server);
+    network_memory_transport_destroy(fabric);
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
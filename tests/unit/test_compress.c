@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../../src/runtime/network/compress.h"
+
+#define BLOCK_SIZE (64 * 1024)
+
+static uint8_t input[BLOCK_SIZE];
+static uint8_t packed[COMPRESS_BOUND(BLOCK_SIZE)];
+static uint8_t output[BLOCK_SIZE];
+
+// Build a payload of ID strings like a subtree sync
+static size_t fill_ids(uint8_t* buffer, size_t size) {
+    size_t length = 0;
+    for (int i = 0; length + 64 < size; i++) {
+        length += (size_t)snprintf((char*)buffer + length, size - length,
+                                   "phantom-node-%08d/parent-%06d;", i * 7, i / 16);
+    }
+    return length;
+}
+
+// Compress and decompress, checking the bytes survive
+static size_t round_trip(CompressContext* cc, const uint8_t* data, size_t size,
+                         const void* dict, size_t dict_size) {
+    size_t packed_size = compress_block(cc, data, size, packed, sizeof(packed));
+    assert(packed_size > 0 && packed_size <= COMPRESS_BOUND(size));
+
+    size_t out_size = 0;
+    assert(decompress_block(packed, packed_size, output, sizeof(output), &out_size,
+                            dict, dict_size));
+    assert(out_size == size);
+    assert(memcmp(output, data, size) == 0);
+    return packed_size;
+}
+
+// Tests repetitive, random and tiny blocks round trip
+void test_compress_round_trip(void) {
+    printf("\nTesting block compression round trips...\n");
+
+    static CompressContext cc;
+    compress_init(&cc);
+
+    size_t size = fill_ids(input, sizeof(input));
+    size_t packed_size = round_trip(&cc, input, size, NULL, 0);
+    printf("  %zu ID bytes -> %zu\n", size, packed_size);
+    assert(packed_size * 3 < size);
+
+    // Incompressible data expands by at most the bound
+    srand(42);
+    for (size_t i = 0; i < sizeof(input); i++) input[i] = (uint8_t)rand();
+    round_trip(&cc, input, sizeof(input), NULL, 0);
+
+    // Runs exercise overlapping matches
+    memset(input, 'a', 1000);
+    assert(round_trip(&cc, input, 1000, NULL, 0) < 32);
+
+    for (size_t n = 0; n < 20; n++) {
+        round_trip(&cc, input, n, NULL, 0);
+    }
+
+    // Output that does not fit is refused
+    size = fill_ids(input, 4096);
+    assert(compress_block(&cc, input, size, packed, 16) == 0);
+
+    printf("Block compression round trip tests passed!\n");
+}
+
+// Tests a dictionary makes short ID-heavy blocks compress
+void test_compress_dictionary(void) {
+    printf("\nTesting block compression with a dictionary...\n");
+
+    static CompressContext cc;
+    static uint8_t dict[8192];
+    compress_init(&cc);
+    size_t dict_size = fill_ids(dict, sizeof(dict));
+
+    const char* block = "phantom-node-00000014/parent-000000;phantom-node-00000021/parent-000000;";
+    size_t size = strlen(block);
+    size_t plain = round_trip(&cc, (const uint8_t*)block, size, NULL, 0);
+
+    compress_set_dictionary(&cc, dict, dict_size);
+    assert(cc.dict_id == compress_dictionary_id(dict, dict_size) && cc.dict_id != 0);
+    size_t primed = round_trip(&cc, (const uint8_t*)block, size, cc.dict, cc.dict_size);
+    printf("  %zu bytes -> %zu plain, %zu with dictionary\n", size, plain, primed);
+    assert(primed < plain);
+
+    // Without the dictionary the block cannot be decoded
+    size_t packed_size = compress_block(&cc, block, size, packed, sizeof(packed));
+    size_t out_size = 0;
+    assert(!decompress_block(packed, packed_size, output, sizeof(output), &out_size, NULL, 0));
+
+    compress_set_dictionary(&cc, NULL, 0);
+    assert(cc.dict_id == 0);
+    assert(round_trip(&cc, (const uint8_t*)block, size, NULL, 0) == plain);
+
+    printf("Block compression dictionary tests passed!\n");
+}
+
+// Tests corrupt input is rejected without overrunning the output
+void test_compress_malformed(void) {
+    printf("\nTesting malformed compressed input...\n");
+
+    static CompressContext cc;
+    compress_init(&cc);
+    size_t size = fill_ids(input, 4096);
+    size_t packed_size = compress_block(&cc, input, size, packed, sizeof(packed));
+    size_t out_size = 0;
+
+    // Truncated at every length
+    for (size_t n = 1; n < packed_size; n++) {
+        if (decompress_block(packed, n, output, sizeof(output), &out_size, NULL, 0)) {
+            assert(out_size < size);
+        }
+    }
+
+    // Too small an output buffer
+    assert(!decompress_block(packed, packed_size, output, size - 1, &out_size, NULL, 0));
+
+    // Offset reaching before the start
+    const uint8_t bad_offset[] = {0x10, 'x', 0x10, 0x00, 0x50, 'a', 'b', 'c', 'd', 'e'};
+    assert(!decompress_block(bad_offset, sizeof(bad_offset), output, sizeof(output),
+                             &out_size, NULL, 0));
+
+    // Random bytes never write past the buffer
+    srand(7);
+    for (int round = 0; round < 1000; round++) {
+        for (size_t i = 0; i < 256; i++) packed[i] = (uint8_t)rand();
+        decompress_block(packed, 256, output, 512, &out_size, NULL, 0);
+    }
+
+    printf("Malformed input tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting compression tests...\n");
+
+    test_compress_round_trip();
+    test_compress_dictionary();
+    test_compress_malformed();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+#include "../../src/interface/dispatch.h"
+
+#define TEST_READERS 4
+#define TEST_WRITES 2000
+#define WAIT_MS 10000
+
+static int calls[4];
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void handler_a(void) { calls[0]++; }
+static void handler_b(void) { calls[1]++; }
+static void handler_c(void) { calls[2]++; }
+
+// Tests base and custom types resolve to their handlers
+void test_dispatch_lookup(void) {
+    printf("\nTesting dispatch lookup...\n");
+
+    DispatchTable table;
+    assert(dispatch_init(&table));
+
+    assert(dispatch_lookup(&table, 0) == NULL);
+    assert(dispatch_lookup(&table, DISPATCH_CUSTOM_BASE) == NULL);
+
+    assert(dispatch_set(&table, 0, handler_a));
+    assert(dispatch_set(&table, DISPATCH_BASE_TYPES - 1, handler_b));
+    assert(dispatch_set(&table, DISPATCH_CUSTOM_BASE, handler_c));
+    assert(dispatch_set(&table, DISPATCH_CUSTOM_BASE + 3 * DISPATCH_PAGE_SIZE + 7, handler_a));
+
+    assert(dispatch_lookup(&table, 0) == handler_a);
+    assert(dispatch_lookup(&table, DISPATCH_BASE_TYPES - 1) == handler_b);
+    assert(dispatch_lookup(&table, DISPATCH_CUSTOM_BASE) == handler_c);
+    assert(dispatch_lookup(&table, DISPATCH_CUSTOM_BASE + 3 * DISPATCH_PAGE_SIZE + 7) == handler_a);
+    assert(dispatch_lookup(&table, DISPATCH_CUSTOM_BASE + 1) == NULL);
+    assert(dispatch_lookup(&table, DISPATCH_CUSTOM_BASE + DISPATCH_PAGE_SIZE) == NULL);
+
+    // Types between the ranges or past the last page are rejected
+    assert(!dispatch_set(&table, DISPATCH_BASE_TYPES, handler_a));
+    assert(!dispatch_set(&table, DISPATCH_CUSTOM_BASE - 1, handler_a));
+    assert(!dispatch_set(&table, DISPATCH_CUSTOM_BASE + DISPATCH_MAX_PAGES * DISPATCH_PAGE_SIZE,
+                         handler_a));
+    assert(dispatch_lookup(&table, DISPATCH_BASE_TYPES) == NULL);
+    assert(dispatch_lookup(&table, UINT32_MAX) == NULL);
+
+    // Replacing and clearing
+    assert(dispatch_set(&table, 0, handler_c));
+    assert(dispatch_lookup(&table, 0) == handler_c);
+    assert(dispatch_set(&table, DISPATCH_CUSTOM_BASE, NULL));
+    assert(dispatch_lookup(&table, DISPATCH_CUSTOM_BASE) == NULL);
+
+    dispatch_lookup(&table, 0)();
+    assert(calls[2] == 1);
+
+    // With no lookup in progress, updates free what they replace
+    assert(table.retired == NULL && table.retired_pages == NULL);
+
+    dispatch_cleanup(&table);
+    printf("Dispatch lookup tests passed!\n");
+}
+
+// Tests a lookup in progress keeps what it may read until it finishes,
+// and one that began after an update holds nothing back
+void test_dispatch_reclaim(void) {
+    printf("\nTesting reclamation of superseded tables...\n");
+
+    DispatchTable table;
+    assert(dispatch_init(&table));
+    assert(dispatch_lookup(&table, 0) == NULL);
+    DispatchReader* reader = dispatch_reader;
+    assert(reader && reader->in_use && reader->epoch == 0);
+
+    // Announce as a lookup does while it holds the snapshot
+    reader->epoch = dispatch_epoch;
+    assert(dispatch_set(&table, 0, handler_a));
+    assert(dispatch_set(&table, DISPATCH_CUSTOM_BASE, handler_b));
+    assert(dispatch_set(&table, DISPATCH_CUSTOM_BASE + 1, handler_c));
+    assert(table.retired && table.retired->next_retired && table.retired->next_retired->next_retired);
+    assert(table.retired_pages && !table.retired_pages->next_retired);
+    dispatch_reclaim(&table);
+    assert(table.retired && table.retired_pages);
+
+    // A lookup starting now loads the newest snapshot
+    reader->epoch = dispatch_epoch;
+    dispatch_reclaim(&table);
+    assert(table.retired == NULL && table.retired_pages == NULL);
+
+    // Only what was retired after the announcement stays
+    reader->epoch = 0;
+    assert(dispatch_set(&table, 1, handler_a));
+    assert(table.retired == NULL);
+    reader->epoch = dispatch_epoch;
+    assert(dispatch_set(&table, 1, handler_b));
+    assert(table.retired && !table.retired->next_retired);
+    reader->epoch = 0;
+    dispatch_reclaim(&table);
+    assert(table.retired == NULL);
+
+    assert(dispatch_lookup(&table, 1) == handler_b);
+    assert(dispatch_lookup(&table, DISPATCH_CUSTOM_BASE + 1) == handler_c);
+    dispatch_cleanup(&table);
+    printf("Dispatch reclamation tests passed!\n");
+}
+
+// Each reader thread takes a slot of its own and gives it back on exit
+static void* slot_main(void* arg) {
+    DispatchTable* table = arg;
+    assert(dispatch_lookup(table, 0) == handler_a);
+    return dispatch_reader;
+}
+
+// Tests reader slots are per thread and reused after threads exit
+void test_dispatch_reader_slots(void) {
+    printf("\nTesting dispatch reader slots...\n");
+
+    DispatchTable table;
+    assert(dispatch_init(&table));
+    assert(dispatch_set(&table, 0, handler_a));
+
+    for (int i = 0; i < 2 * DISPATCH_MAX_READERS; i++) {
+        pthread_t thread;
+        void* slot;
+        assert(pthread_create(&thread, NULL, slot_main, &table) == 0);
+        pthread_join(thread, &slot);
+        assert(slot && slot != dispatch_reader);
+    }
+
+    dispatch_cleanup(&table);
+    printf("Dispatch reader slot tests passed!\n");
+}
+
+static DispatchTable shared_table;
+static volatile int writing;
+
+// Every lookup sees a complete table: the fixed entries never vanish
+static void* reader_main(void* arg) {
+    (void)arg;
+    while (__sync_fetch_and_add(&writing, 0)) {
+        assert(dispatch_lookup(&shared_table, 1) == handler_a);
+        assert(dispatch_lookup(&shared_table, DISPATCH_CUSTOM_BASE + 1) == handler_b);
+        DispatchFn changing = dispatch_lookup(&shared_table, DISPATCH_CUSTOM_BASE + 2);
+        assert(changing == NULL || changing == handler_a || changing == handler_c);
+    }
+    return NULL;
+}
+
+// Tests lookups stay consistent while handlers are replaced
+void test_dispatch_concurrent(void) {
+    printf("\nTesting lookups during updates...\n");
+
+    assert(dispatch_init(&shared_table));
+    assert(dispatch_set(&shared_table, 1, handler_a));
+    assert(dispatch_set(&shared_table, DISPATCH_CUSTOM_BASE + 1, handler_b));
+    writing = 1;
+
+    pthread_t readers[TEST_READERS];
+    for (int i = 0; i < TEST_READERS; i++) {
+        assert(pthread_create(&readers[i], NULL, reader_main, NULL) == 0);
+    }
+    for (int i = 0; i < TEST_WRITES; i++) {
+        assert(dispatch_set(&shared_table, DISPATCH_CUSTOM_BASE + 2, i % 2 ? handler_a : handler_c));
+        assert(dispatch_set(&shared_table, 2, i % 2 ? handler_b : NULL));
+    }
+
+    // Lookups never stop, yet each finishes, so everything retired is
+    // freed without waiting for them all to pause at once
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (shared_table.retired || shared_table.retired_pages) {
+        assert(now_ms() < deadline);
+        dispatch_reclaim(&shared_table);
+    }
+    __sync_fetch_and_sub(&writing, 1);
+    for (int i = 0; i < TEST_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+
+    assert(dispatch_lookup(&shared_table, DISPATCH_CUSTOM_BASE + 2) == handler_a);
+
+    // Snapshots retired under readers go with the next quiet update
+    assert(dispatch_set(&shared_table, 3, handler_c));
+    assert(shared_table.retired == NULL && shared_table.retired_pages == NULL);
+    dispatch_cleanup(&shared_table);
+    printf("Concurrent dispatch tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting dispatch table tests...\n");
+
+    test_dispatch_lookup();
+    test_dispatch_reclaim();
+    test_dispatch_reader_slots();
+    test_dispatch_concurrent();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
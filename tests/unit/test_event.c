@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "../../src/runtime/event/event.h"
+
+#define TAG_PIPE EVENT_USER
+#define TAG_OTHER (EVENT_USER << 1)
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void* delayed_wake(void* arg) {
+    usleep(20000);
+    event_loop_wake(arg);
+    return NULL;
+}
+
+// Tests wakes end a wait, from any thread, and collapse into one
+void test_wake(void) {
+    printf("\nTesting wakes...\n");
+
+    EventLoop* loop = event_loop_create();
+    assert(loop);
+
+    assert(event_loop_wait(loop, 0) == 0);
+
+    event_loop_wake(loop);
+    event_loop_wake(loop);
+    event_loop_wake(loop);
+    assert(event_loop_wait(loop, 0) == EVENT_WAKE);
+    assert(event_loop_wait(loop, 0) == 0);
+
+    // A sleeping loop wakes as soon as another thread asks
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, delayed_wake, loop) == 0);
+    uint64_t start = now_ms();
+    assert(event_loop_wait(loop, 5000) == EVENT_WAKE);
+    assert(now_ms() - start < 2000);
+    pthread_join(thread, NULL);
+
+    // Wakes after a wait are not lost
+    event_loop_wake(loop);
+    assert(event_loop_wait(loop, 0) == EVENT_WAKE);
+
+    event_loop_destroy(loop);
+    printf("Wake tests passed!\n");
+}
+
+// Tests watched descriptors report their tag while readable
+void test_watch(void) {
+    printf("\nTesting watched descriptors...\n");
+
+    EventLoop* loop = event_loop_create();
+    int fds[2];
+    assert(loop && pipe(fds) == 0);
+
+    assert(!event_loop_watch(loop, fds[0], EVENT_TIMER));
+    assert(event_loop_watch(loop, fds[0], TAG_PIPE));
+    assert(!event_loop_watch(loop, fds[0], TAG_OTHER));
+    assert(event_loop_wait(loop, 0) == 0);
+
+    // Level triggered: unread bytes keep reporting
+    assert(write(fds[1], "x", 1) == 1);
+    assert(event_loop_wait(loop, 1000) == TAG_PIPE);
+    assert(event_loop_wait(loop, 0) == TAG_PIPE);
+
+    event_loop_wake(loop);
+    assert(event_loop_wait(loop, 0) == (TAG_PIPE | EVENT_WAKE));
+
+    char c;
+    assert(read(fds[0], &c, 1) == 1);
+    assert(event_loop_wait(loop, 0) == 0);
+
+    event_loop_unwatch(loop, fds[0]);
+    assert(write(fds[1], "x", 1) == 1);
+    assert(event_loop_wait(loop, 0) == 0);
+
+    close(fds[0]);
+    close(fds[1]);
+    event_loop_destroy(loop);
+    printf("Watch tests passed!\n");
+}
+
+// Tests the timer expires periodically until disarmed
+void test_timer(void) {
+    printf("\nTesting the periodic timer...\n");
+
+    EventLoop* loop = event_loop_create();
+    assert(loop);
+    assert(event_loop_set_timer(loop, 10));
+
+    uint64_t start = now_ms();
+    for (int i = 0; i < 5; i++) {
+        assert(event_loop_wait(loop, 1000) == EVENT_TIMER);
+    }
+    uint64_t elapsed = now_ms() - start;
+    assert(elapsed >= 40 && elapsed < 1000);
+
+    assert(event_loop_set_timer(loop, 0));
+    usleep(30000);
+    assert(event_loop_wait(loop, 0) == 0);
+    assert(event_loop_wait(loop, 20) == 0);
+
+    event_loop_destroy(loop);
+    printf("Timer tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting event loop tests...\n");
+
+    test_wake();
+    test_watch();
+    test_timer();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
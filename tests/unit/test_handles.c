@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../../src/runtime/network/network.h"
+
+#define SERVER_PORT 7310
+
+static NetworkTransport* fabric;
+static NetworkContext* server;
+
+// Connect a raw client and return the server's handle for it
+static NetworkHandle connect_client(int* client) {
+    size_t before = server->active_connections;
+    *client = network_memory_connect(fabric, SERVER_PORT);
+    assert(*client >= 0);
+    network_run(server);
+    assert(server->active_connections == before + 1);
+
+    // The newest connection is the one without a binding yet
+    for (size_t i = 0; i < server->max_connections; i++) {
+        NetworkConnection* conn = &server->connections[i];
+        if (conn->is_active && !conn->node_id[0]) {
+            assert(network_bind_node(server, conn, "client"));
+            return network_get_handle(server, conn);
+        }
+    }
+    assert(0);
+    return NETWORK_INVALID_HANDLE;
+}
+
+// Close a raw client and let the server notice
+static void close_client(int client) {
+    size_t before = server->active_connections;
+    fabric->close(fabric, client);
+    network_run(server);
+    assert(server->active_connections == before - 1);
+}
+
+// Frame bytes waiting for a raw client
+static size_t pending_bytes(int client) {
+    uint8_t buffer[4096];
+    size_t total = 0;
+    ssize_t got;
+    while ((got = fabric->read(fabric, client, buffer, sizeof(buffer), NULL)) > 0) {
+        total += (size_t)got;
+    }
+    return total;
+}
+
+// Tests a handle stops resolving once its slot is released, and a stale
+// handle cannot reach the connection that reused the slot
+void test_stale_handle(void) {
+    printf("\nTesting stale handles after slot reuse...\n");
+
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + 4);
+    assert(msg);
+    msg->type = NET_MSG_DATA;
+    msg->data_size = 4;
+    memcpy(msg->data, "ping", 4);
+
+    int first;
+    NetworkHandle old = connect_client(&first);
+    assert(old != NETWORK_INVALID_HANDLE);
+    NetworkConnection* conn = network_resolve(server, old);
+    assert(conn);
+    assert(network_send_handle(server, old, msg));
+    assert(pending_bytes(first) > 0);
+
+    close_client(first);
+    assert(network_resolve(server, old) == NULL);
+    assert(!network_send_handle(server, old, msg));
+
+    // The free list hands the same slot to the next connection
+    int second;
+    NetworkHandle fresh = connect_client(&second);
+    assert(network_resolve(server, fresh) == conn);
+    assert((uint32_t)fresh == (uint32_t)old);
+    assert(fresh != old);
+
+    // Only the fresh handle reaches it
+    assert(network_resolve(server, old) == NULL);
+    assert(!network_send_handle(server, old, msg));
+    assert(pending_bytes(second) == 0);
+    assert(network_send_handle(server, fresh, msg));
+    assert(pending_bytes(second) > 0);
+
+    // Invalid and out-of-range handles never resolve
+    assert(network_resolve(server, NETWORK_INVALID_HANDLE) == NULL);
+    assert(network_resolve(server, fresh + server->max_connections) == NULL);
+    assert(!network_send_handle(server, NETWORK_INVALID_HANDLE, msg));
+
+    close_client(second);
+    free(msg);
+    printf("Stale handle tests passed!\n");
+}
+
+// Tests handles of a reused slot never repeat across many reuses
+void test_generation_wrap(void) {
+    printf("\nTesting handle generations...\n");
+
+    int client;
+    NetworkHandle first = connect_client(&client);
+    NetworkConnection* conn = network_resolve(server, first);
+    close_client(client);
+
+    NetworkHandle previous = first;
+    for (int i = 0; i < 100; i++) {
+        NetworkHandle handle = connect_client(&client);
+        assert(network_resolve(server, handle) == conn);
+        assert(handle != previous && handle != first);
+        previous = handle;
+        close_client(client);
+    }
+
+    // Generation 0 is skipped when the counter wraps
+    conn->generation = UINT32_MAX;
+    NetworkHandle last = connect_client(&client);
+    assert(network_resolve(server, last) == conn);
+    close_client(client);
+    assert(conn->generation == 1);
+    assert(network_resolve(server, last) == NULL);
+
+    printf("Handle generation tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting connection handle tests...\n");
+
+    fabric = network_memory_transport_create();
+    assert(fabric);
+    server = network_create(SERVER_PORT);
+    assert(server);
+    assert(network_set_transport(server, fabric));
+    network_set_io_threads(server, 0);
+    network_set_poll_timeout(server, 0);
+    assert(network_start(server));
+
+    test_stale_handle();
+    test_generation_wrap();
+
+    network_destroy(server);
+    network_memory_transport_destroy(fabric);
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,713 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "../../src/interface/message.h"
+
+#define TEST_PRODUCERS 8
+#define TEST_CONSUMERS 4
+#define TEST_PER_PRODUCER 20000
+
+static Message make_message(uint32_t id) {
+    Message msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MSG_DATA;
+    msg.id = id;
+    snprintf(msg.source, sizeof(msg.source), "node-%u", id);
+    return msg;
+}
+
+// Tests messages come out in order and the queue bounds hold
+void test_queue_order(void) {
+    printf("\nTesting queue order and bounds...\n");
+
+    MessageQueue* queue = message_queue_create(6);
+    assert(queue);
+
+    // Capacity rounds up to 8
+    for (uint32_t i = 0; i < 8; i++) {
+        Message msg = make_message(i);
+        assert(message_queue_push(queue, &msg));
+    }
+    Message extra = make_message(99);
+    assert(!message_queue_push(queue, &extra));
+    assert(message_queue_count(queue) == 8);
+
+    Message out[8];
+    assert(message_queue_pop(queue, out, 3) == 3);
+    for (uint32_t i = 0; i < 3; i++) {
+        assert(out[i].id == i);
+    }
+    assert(strcmp(out[2].source, "node-2") == 0);
+
+    // Freed slots are reused across many laps
+    uint32_t next_in = 8;
+    uint32_t next_out = 3;
+    for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < 3; i++) {
+            Message msg = make_message(next_in++);
+            assert(message_queue_push(queue, &msg));
+        }
+        assert(!message_queue_push(queue, &extra));
+        assert(message_queue_pop(queue, out, 3) == 3);
+        for (int i = 0; i < 3; i++) {
+            assert(out[i].id == next_out++);
+        }
+    }
+
+    assert(message_queue_pop(queue, out, 8) == 5);
+    assert(out[4].id == next_out + 4);
+    assert(message_queue_pop(queue, out, 8) == 0);
+    assert(message_queue_count(queue) == 0);
+
+    message_queue_destroy(queue);
+    printf("Queue order tests passed!\n");
+}
+
+static MessageQueue* shared_queue;
+static unsigned char delivered[TEST_PRODUCERS * TEST_PER_PRODUCER];
+static volatile int producers_left;
+
+static void* producer_main(void* arg) {
+    uint32_t base = (uint32_t)(uintptr_t)arg * TEST_PER_PRODUCER;
+    for (uint32_t i = 0; i < TEST_PER_PRODUCER; i++) {
+        Message msg = make_message(base + i);
+        while (!message_queue_push(shared_queue, &msg)) {
+            sched_yield();
+        }
+    }
+    __sync_fetch_and_sub(&producers_left, 1);
+    return NULL;
+}
+
+static void* consumer_main(void* arg) {
+    (void)arg;
+    Message batch[16];
+    for (;;) {
+        size_t n = message_queue_pop(shared_queue, batch, 16);
+        if (n == 0) {
+            if (__sync_fetch_and_add(&producers_left, 0) == 0 &&
+                message_queue_count(shared_queue) == 0) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+        for (size_t i = 0; i < n; i++) {
+            assert(batch[i].id < TEST_PRODUCERS * TEST_PER_PRODUCER);
+            __sync_fetch_and_add(&delivered[batch[i].id], 1);
+        }
+    }
+    return NULL;
+}
+
+// Tests every message is delivered exactly once under contention
+void test_queue_concurrent(void) {
+    printf("\nTesting concurrent producers and consumers...\n");
+
+    shared_queue = message_queue_create(256);
+    assert(shared_queue);
+    memset(delivered, 0, sizeof(delivered));
+    producers_left = TEST_PRODUCERS;
+
+    pthread_t producers[TEST_PRODUCERS];
+    pthread_t consumers[TEST_CONSUMERS];
+    for (uintptr_t i = 0; i < TEST_CONSUMERS; i++) {
+        assert(pthread_create(&consumers[i], NULL, consumer_main, NULL) == 0);
+    }
+    for (uintptr_t i = 0; i < TEST_PRODUCERS; i++) {
+        assert(pthread_create(&producers[i], NULL, producer_main, (void*)i) == 0);
+    }
+    for (int i = 0; i < TEST_PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    for (int i = 0; i < TEST_CONSUMERS; i++) {
+        pthread_join(consumers[i], NULL);
+    }
+
+    for (size_t i = 0; i < TEST_PRODUCERS * TEST_PER_PRODUCER; i++) {
+        assert(delivered[i] == 1);
+    }
+
+    message_queue_destroy(shared_queue);
+    printf("Concurrent queue tests passed!\n");
+}
+
+static int handled;
+
+static bool count_handler(Program* program, const Message* message) {
+    (void)program;
+    handled += (int)message->id;
+    return true;
+}
+
+// Tests messages reach the handler registered for their type
+void test_dispatch(void) {
+    printf("\nTesting message dispatch...\n");
+
+    Program program;
+    memset(&program, 0, sizeof(program));
+    assert(message_init(&program));
+    const MessageInterface* messages = get_message_interface();
+
+    Message msg = make_message(5);
+    assert(!message_dispatch(&program, &msg));
+    assert(messages->register_handler(&program, MSG_DATA, count_handler));
+    assert(messages->register_handler(&program, MSG_CUSTOM + 42, count_handler));
+    assert(message_dispatch(&program, &msg));
+    msg.type = MSG_CUSTOM + 42;
+    assert(message_dispatch(&program, &msg));
+    msg.type = MSG_CUSTOM + 43;
+    assert(!message_dispatch(&program, &msg));
+    assert(handled == 10);
+
+    message_cleanup(&program);
+    printf("Message dispatch tests passed!\n");
+}
+
+// Tests send stamps messages and drains them from the outgoing queue
+void test_send_drain(void) {
+    printf("\nTesting send and drain...\n");
+
+    Program program;
+    memset(&program, 0, sizeof(program));
+    assert(message_init(&program));
+    const MessageInterface* messages = get_message_interface();
+
+    Message msg = make_message(0);
+    assert(messages->send(&program, "node-b", &msg));
+    assert(messages->broadcast(&program, &msg));
+
+    Message out[4];
+    assert(message_drain_outgoing(&program, out, 4) == 2);
+    assert(strcmp(out[0].target, "node-b") == 0);
+    assert(out[1].target[0] == '\0');
+    assert(out[1].id == out[0].id + 1);
+    assert(out[0].timestamp != 0);
+    assert(message_drain_outgoing(&program, out, 4) == 0);
+
+    message_cleanup(&program);
+    printf("Send and drain tests passed!\n");
+}
+
+// Tests payloads are shared by queued copies and recycled when released
+void test_payload_sharing(void) {
+    printf("\nTesting payload sharing...\n");
+
+    Program program;
+    memset(&program, 0, sizeof(program));
+    assert(message_init(&program));
+    const MessageInterface* messages = get_message_interface();
+
+    // One payload sent twice is shared, not copied
+    Message msg = make_message(0);
+    assert(message_alloc_data(&msg, 100));
+    memset(msg.data, 'p', 100);
+    assert(messages->send(&program, "node-b", &msg));
+    assert(messages->forward(&program, "node-c", &msg));
+    void* shared = msg.data;
+    message_release(&msg);
+    assert(msg.data == NULL && msg.payload == NULL);
+
+    Message out[4];
+    assert(message_drain_outgoing(&program, out, 4) == 2);
+    assert(out[0].data == shared && out[1].data == shared);
+    assert(((char*)out[1].data)[99] == 'p');
+    message_release(&out[0]);
+    message_release(&out[1]);
+
+    // The freed buffer is reused for the next payload of its class
+    assert(message_alloc_data(&msg, 200));
+    assert(msg.data == shared);
+    message_release(&msg);
+
+    // Borrowed data is copied into a pooled buffer when queued
+    char text[] = "borrowed";
+    msg = make_message(1);
+    msg.data = text;
+    msg.data_size = sizeof(text);
+    assert(messages->broadcast(&program, &msg));
+    text[0] = 'X';
+    assert(message_drain_outgoing(&program, out, 4) == 1);
+    assert(out[0].payload && out[0].data != text);
+    assert(strcmp(out[0].data, "borrowed") == 0);
+    message_release(&out[0]);
+
+    // Payloads larger than every class are still usable
+    assert(message_alloc_data(&msg, 1 << 20));
+    memset(msg.data, 0, 1 << 20);
+    assert(messages->send(&program, "node-b", &msg));
+    message_release(&msg);
+
+    // Cleanup releases what is still queued
+    message_cleanup(&program);
+    printf("Payload sharing tests passed!\n");
+}
+
+// Tests the wire codec round-trips messages compactly
+void test_codec(void) {
+    printf("\nTesting wire codec...\n");
+
+    Message msg = make_message(77);
+    msg.type = MSG_CUSTOM + 5;
+    msg.flags = MSG_FLAG_RELIABLE | MSG_FLAG_AUTHENTICATED;
+    msg.timestamp = 0x0102030405060708ull;
+    strcpy(msg.target, "node-target");
+    char text[] = "presence";
+    msg.data = text;
+    msg.data_size = 8;
+
+    // Two messages back to back, as in a receive buffer
+    uint8_t buffer[256];
+    size_t size = message_encoded_size(&msg);
+    assert(size == MESSAGE_WIRE_HEADER_SIZE + 1 + 7 + 1 + 11 + 1 + 8);
+    assert(message_encode(&msg, buffer, size - 1) == 0);
+    assert(message_encode(&msg, buffer, sizeof(buffer)) == size);
+    Message second = make_message(78);
+    size_t second_size = message_encode(&second, buffer + size, sizeof(buffer) - size);
+    assert(second_size == MESSAGE_WIRE_HEADER_SIZE + 1 + 7 + 1 + 1);
+
+    // Little-endian fixed header
+    assert(buffer[0] == MESSAGE_WIRE_VERSION);
+    assert(buffer[2] == (uint8_t)(MSG_CUSTOM + 5) && buffer[3] == (MSG_CUSTOM + 5) >> 8);
+    assert(buffer[8] == 0x08 && buffer[15] == 0x01);
+
+    Message out;
+    assert(message_decode(buffer, size + second_size, &out) == size);
+    assert(out.type == MSG_CUSTOM + 5 && out.id == 77);
+    assert(out.flags == MSG_FLAG_RELIABLE);
+    assert(out.timestamp == msg.timestamp);
+    assert(strcmp(out.source, "node-77") == 0);
+    assert(strcmp(out.target, "node-target") == 0);
+    assert(out.data_size == 8 && memcmp(out.data, "presence", 8) == 0);
+    assert(out.payload && out.data != text);
+    message_release(&out);
+
+    assert(message_decode(buffer + size, second_size, &out) == second_size);
+    assert(out.id == 78 && out.target[0] == '\0' && out.data == NULL && out.payload == NULL);
+
+    // Truncated or malformed input is rejected
+    for (size_t cut = 0; cut < size; cut++) {
+        assert(message_decode(buffer, cut, &out) == 0);
+    }
+    buffer[0] = MESSAGE_WIRE_VERSION + 1;
+    assert(message_decode(buffer, size, &out) == 0);
+    buffer[0] = MESSAGE_WIRE_VERSION;
+    buffer[MESSAGE_WIRE_HEADER_SIZE] = 64;
+    assert(message_decode(buffer, sizeof(buffer), &out) == 0);
+
+    // Types outside 16 bits cannot be encoded
+    msg.type = (MessageType)70000;
+    assert(message_encode(&msg, buffer, sizeof(buffer)) == 0);
+
+    printf("Wire codec tests passed!\n");
+}
+
+static uint32_t dispatched[256];
+static size_t dispatched_count;
+
+static bool record_handler(Program* program, const Message* message) {
+    (void)program;
+    dispatched[dispatched_count++] = message->id;
+    return true;
+}
+
+static MessageContext* wake_ctx;
+
+static void* delayed_receive(void* arg) {
+    (void)arg;
+    usleep(20000);
+    Message msg = make_message(1);
+    assert(message_receive(wake_ctx, &msg));
+    return NULL;
+}
+
+// Tests queued messages are dispatched in budgeted, type-grouped batches
+void test_process_queue(void) {
+    printf("\nTesting batched queue processing...\n");
+
+    MessageContext* ctx = message_create(NULL);
+    assert(ctx);
+    assert(message_set_handler(ctx, MSG_DATA, record_handler));
+    assert(message_set_handler(ctx, MSG_NODE, record_handler));
+
+    // Interleaved types come out grouped, each group in arrival order
+    for (uint32_t i = 0; i < 6; i++) {
+        Message msg = make_message(i);
+        msg.type = i % 2 ? MSG_DATA : MSG_NODE;
+        assert(message_receive(ctx, &msg));
+    }
+    assert(message_pending(ctx) == 6);
+    assert(message_process_queue(ctx, NULL) == 6);
+    uint32_t grouped[] = {0, 2, 4, 1, 3, 5};
+    assert(dispatched_count == 6 && memcmp(dispatched, grouped, sizeof(grouped)) == 0);
+
+    // An ordered message keeps its batch in arrival order
+    dispatched_count = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        Message msg = make_message(i);
+        msg.type = i % 2 ? MSG_DATA : MSG_NODE;
+        msg.flags = i == 3 ? MSG_FLAG_ORDERED : MSG_FLAG_NONE;
+        assert(message_receive(ctx, &msg));
+    }
+    assert(message_process_queue(ctx, NULL) == 4);
+    for (uint32_t i = 0; i < 4; i++) {
+        assert(dispatched[i] == i);
+    }
+
+    // The count budget stops processing with messages still queued
+    dispatched_count = 0;
+    for (uint32_t i = 0; i < 200; i++) {
+        Message msg = make_message(i);
+        assert(message_receive(ctx, &msg));
+    }
+    MessageBudget budget = {.max_messages = 150};
+    assert(message_process_queue(ctx, &budget) == 150);
+    assert(message_pending(ctx) == 50);
+    assert(message_process_queue(ctx, &budget) == 50);
+    assert(dispatched_count == 200 && dispatched[199] == 199);
+    assert(message_process_queue(ctx, &budget) == 0);
+
+    // Messages without a handler are dropped and their payloads released
+    Message orphan = make_message(7);
+    orphan.type = MSG_STATE;
+    assert(message_alloc_data(&orphan, 32));
+    assert(message_receive(ctx, &orphan));
+    message_release(&orphan);
+    assert(message_process_queue(ctx, NULL) == 1);
+
+    // Waiting returns as soon as a message arrives
+    wake_ctx = ctx;
+    assert(!message_wait(ctx, 5));
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, delayed_receive, NULL) == 0);
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    assert(message_wait(ctx, 5000));
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_join(thread, NULL);
+    assert(end.tv_sec - start.tv_sec < 2);
+    assert(message_process_queue(ctx, NULL) == 1);
+
+    message_destroy(ctx);
+    printf("Batched processing tests passed!\n");
+}
+
+static MessageType types_seen[256];
+static size_t types_count;
+
+static bool record_type(Program* program, const Message* message) {
+    (void)program;
+    if (types_count < 256) types_seen[types_count] = message->type;
+    types_count++;
+    return true;
+}
+
+static void receive_type(MessageContext* ctx, MessageType type, MessageFlags flags, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        Message msg = make_message((uint32_t)i);
+        msg.type = type;
+        msg.flags = flags;
+        assert(message_receive(ctx, &msg));
+    }
+}
+
+// Tests lanes by type and flag, weighted rounds and lane statistics
+void test_lanes(void) {
+    printf("\nTesting priority lanes...\n");
+
+    MessageContext* ctx = message_create(NULL);
+    assert(ctx);
+    assert(message_set_handler(ctx, MSG_DATA, record_type));
+    assert(message_set_handler(ctx, MSG_NODE, record_type));
+    assert(message_set_handler(ctx, MSG_STATE, record_type));
+    assert(message_set_handler(ctx, MSG_CUSTOM + 3, record_type));
+
+    // Control messages queued behind a flood are dispatched first
+    receive_type(ctx, MSG_DATA, MSG_FLAG_NONE, 500);
+    receive_type(ctx, MSG_NODE, MSG_FLAG_NONE, 3);
+    receive_type(ctx, MSG_STATE, MSG_FLAG_PRIORITY, 1);
+    MessageBudget budget = {.max_messages = 8};
+    assert(message_process_queue(ctx, &budget) == 8);
+    for (size_t i = 0; i < 4; i++) {
+        assert(types_seen[i] == MSG_NODE || types_seen[i] == MSG_STATE);
+    }
+    for (size_t i = 4; i < 8; i++) {
+        assert(types_seen[i] == MSG_DATA);
+    }
+
+    MessageLaneStats stats;
+    assert(message_get_lane_stats(ctx, MSG_LANE_CONTROL, &stats));
+    assert(stats.depth == 0 && stats.dispatched == 4);
+    assert(message_get_lane_stats(ctx, MSG_LANE_BULK, &stats));
+    assert(stats.depth == 496 && stats.dispatched == 4);
+    assert(stats.max_wait_us >= stats.total_wait_us / 4);
+    assert(message_process_queue(ctx, NULL) == 496);
+
+    // Each round gives a lane its weight in units of eight messages
+    assert(message_set_lane_weight(ctx, MSG_LANE_CONTROL, 2));
+    assert(message_set_lane_weight(ctx, MSG_LANE_BULK, 1));
+    assert(message_set_lane(ctx, MSG_CUSTOM + 3, MSG_LANE_CONTROL));
+    receive_type(ctx, MSG_DATA, MSG_FLAG_NONE, 100);
+    receive_type(ctx, MSG_CUSTOM + 3, MSG_FLAG_NONE, 100);
+    types_count = 0;
+    budget.max_messages = 48;
+    assert(message_process_queue(ctx, &budget) == 48);
+    size_t control = 0;
+    for (size_t i = 0; i < 48; i++) {
+        if (types_seen[i] == MSG_CUSTOM + 3) control++;
+    }
+    assert(control == 32);
+    assert(message_process_queue(ctx, NULL) == 152);
+
+    // Ordered messages keep arrival order across lanes, over several calls
+    types_count = 0;
+    receive_type(ctx, MSG_DATA, MSG_FLAG_NONE, 20);
+    receive_type(ctx, MSG_DATA, MSG_FLAG_ORDERED, 1);
+    receive_type(ctx, MSG_NODE, MSG_FLAG_ORDERED, 1);
+    receive_type(ctx, MSG_CUSTOM + 3, MSG_FLAG_NONE, 1);
+    budget.max_messages = 8;
+    while (message_process_queue(ctx, &budget) > 0) {
+    }
+    assert(types_count == 23);
+    for (size_t i = 0; i < 21; i++) {
+        assert(types_seen[i] == MSG_DATA);
+    }
+    assert(types_seen[21] == MSG_NODE && types_seen[22] == MSG_CUSTOM + 3);
+    assert(message_pending(ctx) == 0);
+
+    // A full lane refuses messages and counts them
+    assert(message_get_lane_stats(ctx, MSG_LANE_BULK, &stats));
+    uint64_t dropped = stats.dropped;
+    size_t accepted = 0;
+    Message msg = make_message(0);
+    while (message_receive(ctx, &msg)) {
+        accepted++;
+    }
+    assert(accepted > 0);
+    assert(message_get_lane_stats(ctx, MSG_LANE_BULK, &stats));
+    assert(stats.dropped == dropped + 1 && stats.depth == accepted);
+
+    // Other lanes still take messages
+    receive_type(ctx, MSG_NODE, MSG_FLAG_NONE, 1);
+    assert(message_process_queue(ctx, NULL) == accepted + 1);
+
+    // Types past the lane table use the normal lane
+    assert(!message_set_lane(ctx, MSG_CUSTOM + MESSAGE_LANE_CUSTOM_TYPES, MSG_LANE_BULK));
+    assert(!message_set_lane(ctx, MSG_DATA, MSG_LANE_COUNT));
+    assert(!message_set_lane_weight(ctx, MSG_LANE_BULK, 0));
+
+    message_destroy(ctx);
+    printf("Priority lane tests passed!\n");
+}
+
+#define WORKER_KEYS 16
+#define WORKER_PER_KEY 500
+
+static uint32_t key_next[WORKER_KEYS][2];  // Per key and type
+static uint32_t key_total[WORKER_KEYS];    // Per key, past the highest seen
+static bool key_strict;
+static int key_out_of_order;
+static pthread_t key_thread[WORKER_KEYS];
+static int worker_handled;
+static int slow_release;
+
+// Checks a key's messages keep their order, on one thread. Types may
+// be grouped within a batch unless the key is sent ordered.
+static bool keyed_handler(Program* program, const Message* message) {
+    (void)program;
+    int key = atoi(message->source[0] ? message->source + 4 : message->target + 4);
+    int slot = message->type == MSG_STATE;
+    if (key_total[key] == 0) key_thread[key] = pthread_self();
+    if (message->id < key_next[key][slot] || (key_strict && message->id != key_total[key]) ||
+        !pthread_equal(key_thread[key], pthread_self())) {
+        __sync_fetch_and_add(&key_out_of_order, 1);
+    }
+    key_next[key][slot] = message->id + 1;
+    if (message->id >= key_total[key]) key_total[key] = message->id + 1;
+    __sync_fetch_and_add(&worker_handled, 1);
+    return true;
+}
+
+// Blocks its worker until released
+static bool slow_handler(Program* program, const Message* message) {
+    (void)program;
+    (void)message;
+    while (!__atomic_load_n(&slow_release, __ATOMIC_ACQUIRE)) {
+        usleep(1000);
+    }
+    __sync_fetch_and_add(&worker_handled, 1);
+    return true;
+}
+
+// Releases the slow handler once the processor has had time to block
+static void* release_later(void* arg) {
+    (void)arg;
+    usleep(50000);
+    __atomic_store_n(&slow_release, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void wait_handled(int expected) {
+    for (int i = 0; i < 5000 && __sync_fetch_and_add(&worker_handled, 0) < expected; i++) {
+        usleep(1000);
+    }
+    assert(__sync_fetch_and_add(&worker_handled, 0) == expected);
+}
+
+// Tests handlers run on workers, in order per key and in parallel
+void test_workers(void) {
+    printf("\nTesting handler workers...\n");
+
+    MessageContext* ctx = message_create(NULL);
+    assert(ctx);
+    assert(message_set_handler(ctx, MSG_DATA, keyed_handler));
+    assert(message_set_handler(ctx, MSG_STATE, keyed_handler));
+    assert(message_set_lane(ctx, MSG_DATA, MSG_LANE_NORMAL));
+    assert(!message_set_workers(ctx, MESSAGE_MAX_WORKERS + 1));
+    assert(message_set_workers(ctx, 4));
+
+    // Keys interleave and change type within one lane, some keyed by
+    // target. The second round is sent ordered.
+    for (int round = 0; round < 2; round++) {
+        size_t queued = 0;
+        worker_handled = 0;
+        key_strict = round == 1;
+        for (uint32_t i = 0; i < WORKER_PER_KEY; i++) {
+            for (int key = 0; key < WORKER_KEYS; key++) {
+                Message msg = make_message(round * WORKER_PER_KEY + i);
+                msg.type = (i + (uint32_t)key) % 3 ? MSG_DATA : MSG_STATE;
+                msg.flags = round ? MSG_FLAG_ORDERED : MSG_FLAG_NONE;
+                snprintf(msg.source, sizeof(msg.source), "key-%d", key);
+                if (key % 4 == 0) {
+                    msg.source[0] = '\0';
+                    snprintf(msg.target, sizeof(msg.target), "key-%d", key);
+                }
+                while (!message_receive(ctx, &msg)) {
+                    queued += message_process_queue(ctx, NULL);
+                }
+            }
+        }
+        queued += message_process_queue(ctx, NULL);
+        assert(queued == WORKER_KEYS * WORKER_PER_KEY);
+        wait_handled(WORKER_KEYS * WORKER_PER_KEY);
+        assert(key_out_of_order == 0);
+    }
+    key_strict = false;
+
+    // More than one thread ran handlers
+    size_t threads = 0;
+    for (int key = 0; key < WORKER_KEYS; key++) {
+        bool seen = false;
+        for (int other = 0; other < key; other++) {
+            if (pthread_equal(key_thread[key], key_thread[other])) seen = true;
+        }
+        if (!seen) threads++;
+    }
+    assert(threads > 1);
+
+    // A blocked handler holds up only its own worker's keys
+    worker_handled = 0;
+    assert(message_set_handler(ctx, MSG_NODE, slow_handler));
+    Message slow = make_message(0);
+    slow.type = MSG_NODE;
+    strcpy(slow.source, "key-0");
+    assert(message_receive(ctx, &slow));
+    for (int key = 1; key < WORKER_KEYS; key++) {
+        Message msg = make_message(key_total[key]);
+        snprintf(msg.source, sizeof(msg.source), "key-%d", key);
+        assert(message_receive(ctx, &msg));
+    }
+    assert(message_process_queue(ctx, NULL) == WORKER_KEYS);
+    for (int i = 0; i < 5000 && __sync_fetch_and_add(&worker_handled, 0) == 0; i++) {
+        usleep(1000);
+    }
+    int handled = __sync_fetch_and_add(&worker_handled, 0);
+    assert(handled > 0 && handled < WORKER_KEYS);
+
+    // Going back to inline dispatch waits for the workers to finish
+    __atomic_store_n(&slow_release, 1, __ATOMIC_RELEASE);
+    assert(message_set_workers(ctx, 0));
+    assert(worker_handled == WORKER_KEYS);
+    assert(key_out_of_order == 0);
+
+    // A full worker queue holds the processor until the worker drains it
+    __atomic_store_n(&slow_release, 0, __ATOMIC_RELEASE);
+    worker_handled = 0;
+    assert(message_set_workers(ctx, 1));
+    pthread_t releaser;
+    assert(pthread_create(&releaser, NULL, release_later, NULL) == 0);
+    size_t handed = 0;
+    for (int i = 0; i < 3000; i++) {
+        while (!message_receive(ctx, &slow)) {
+            handed += message_process_queue(ctx, NULL);
+        }
+    }
+    handed += message_process_queue(ctx, NULL);
+    pthread_join(releaser, NULL);
+    assert(handed == 3000);
+    wait_handled(3000);
+    assert(message_set_workers(ctx, 0));
+
+    message_destroy(ctx);
+    printf("Worker tests passed!\n");
+}
+
+static int wakeups;
+
+static void count_wakeup(void* arg) {
+    (void)arg;
+    __sync_fetch_and_add(&wakeups, 1);
+}
+
+// Tests an armed wakeup fires once for the next message
+void test_wakeup(void) {
+    printf("\nTesting wakeups...\n");
+
+    MessageContext* ctx = message_create(NULL);
+    assert(ctx);
+    message_set_wakeup(ctx, count_wakeup, NULL);
+
+    // Unarmed, producers do not call it
+    Message msg = make_message(1);
+    assert(message_receive(ctx, &msg));
+    assert(wakeups == 0);
+
+    // Armed with messages waiting, the caller must not sleep, and later
+    // messages do not wake it
+    assert(!message_arm_wakeup(ctx));
+    assert(message_receive(ctx, &msg));
+    assert(wakeups == 0);
+    assert(message_process_queue(ctx, NULL) == 2);
+
+    // Armed while idle, only the first message wakes
+    assert(message_arm_wakeup(ctx));
+    assert(message_receive(ctx, &msg));
+    assert(message_receive(ctx, &msg));
+    assert(wakeups == 1);
+    assert(message_process_queue(ctx, NULL) == 2);
+
+    message_destroy(ctx);
+    printf("Wakeup tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting message queue tests...\n");
+
+    test_queue_order();
+    test_queue_concurrent();
+    test_send_drain();
+    test_dispatch();
+    test_payload_sharing();
+    test_codec();
+    test_process_queue();
+    test_lanes();
+    test_workers();
+    test_wakeup();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
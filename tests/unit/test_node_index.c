@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "../../src/runtime/network/network.h"
+
+// Raw clients on a memory fabric give the server real connections to
+// bind without any handshake
+#define SERVER_PORT 7300
+#define CLIENT_COUNT 64
+
+static NetworkTransport* fabric;
+static NetworkContext* server;
+static NetworkConnection* conns[CLIENT_COUNT];
+static int clients[CLIENT_COUNT];
+
+static void start_server(void) {
+    fabric = network_memory_transport_create();
+    assert(fabric);
+    server = network_create(SERVER_PORT);
+    assert(server);
+    assert(network_set_transport(server, fabric));
+    network_set_io_threads(server, 0);
+    network_set_poll_timeout(server, 0);
+    assert(network_start(server));
+
+    for (int i = 0; i < CLIENT_COUNT; i++) {
+        clients[i] = network_memory_connect(fabric, SERVER_PORT);
+        assert(clients[i] >= 0);
+    }
+    network_run(server);
+    assert(server->active_connections == CLIENT_COUNT);
+
+    // Accepted in order into the free slots from the bottom
+    int found = 0;
+    for (size_t i = 0; i < server->max_connections && found < CLIENT_COUNT; i++) {
+        if (server->connections[i].is_active) conns[found++] = &server->connections[i];
+    }
+    assert(found == CLIENT_COUNT);
+}
+
+static void stop_server(void) {
+    network_destroy(server);
+    network_memory_transport_destroy(fabric);
+}
+
+// Tests bind, find, unbind and rebinding an ID to another connection
+void test_bind_find(void) {
+    printf("\nTesting node binding...\n");
+
+    assert(network_find_node(server, "node-a") == NULL);
+    assert(network_bind_node(server, conns[0], "node-a"));
+    assert(network_bind_node(server, conns[1], "node-b"));
+    assert(network_find_node(server, "node-a") == conns[0]);
+    assert(network_find_node(server, "node-b") == conns[1]);
+    assert(server->node_index.count == 2);
+
+    // Bad IDs are refused
+    assert(!network_bind_node(server, conns[2], ""));
+    char long_id[80];
+    memset(long_id, 'x', sizeof(long_id) - 1);
+    long_id[sizeof(long_id) - 1] = '\0';
+    assert(!network_bind_node(server, conns[2], long_id));
+
+    // A connection rebinding drops its old ID
+    assert(network_bind_node(server, conns[0], "node-c"));
+    assert(network_find_node(server, "node-a") == NULL);
+    assert(network_find_node(server, "node-c") == conns[0]);
+
+    // An ID bound again moves to the new connection
+    assert(network_bind_node(server, conns[2], "node-b"));
+    assert(network_find_node(server, "node-b") == conns[2]);
+    assert(conns[1]->node_id[0] == '\0' && conns[1]->index_slot < 0);
+    assert(server->node_index.count == 2);
+
+    network_unbind_node(server, conns[0]);
+    network_unbind_node(server, conns[2]);
+    assert(network_find_node(server, "node-c") == NULL);
+    assert(network_find_node(server, "node-b") == NULL);
+    assert(server->node_index.count == 0);
+
+    // Unbinding twice is harmless
+    network_unbind_node(server, conns[2]);
+    assert(server->node_index.count == 0);
+
+    printf("Node binding tests passed!\n");
+}
+
+// Tests deletions never leave more than a quarter of the table as
+// tombstones, and every binding survives the rebuilds
+void test_tombstone_rebuild(void) {
+    printf("\nTesting tombstone rebuild...\n");
+
+    NetworkNodeIndex* index = &server->node_index;
+    size_t limit = index->capacity / 4;
+    int rebuilds = 0;
+    char id[32];
+
+    for (int i = 0; i < CLIENT_COUNT; i++) {
+        snprintf(id, sizeof(id), "node-%d-0", i);
+        assert(network_bind_node(server, conns[i], id));
+    }
+
+    // Every rebind tombstones the old ID's entry
+    for (int round = 1; rebuilds < 2; round++) {
+        assert(round < 1000);
+        for (int i = 0; i < CLIENT_COUNT; i++) {
+            size_t before = index->tombstones;
+            snprintf(id, sizeof(id), "node-%d-%d", i, round);
+            assert(network_bind_node(server, conns[i], id));
+            assert(index->tombstones <= limit);
+            if (index->tombstones < before) {
+                assert(before == limit);
+                rebuilds++;
+            }
+        }
+        assert(index->count == CLIENT_COUNT);
+
+        for (int i = 0; i < CLIENT_COUNT; i++) {
+            snprintf(id, sizeof(id), "node-%d-%d", i, round);
+            assert(network_find_node(server, id) == conns[i]);
+            assert(index->entries[conns[i]->index_slot].conn_index ==
+                   (int32_t)(conns[i] - server->connections));
+            snprintf(id, sizeof(id), "node-%d-%d", i, round - 1);
+            assert(network_find_node(server, id) == NULL);
+        }
+    }
+
+    printf("Tombstone rebuild tests passed!\n");
+}
+
+// Tests a closed connection's binding goes with it
+void test_disconnect_unbinds(void) {
+    printf("\nTesting unbind on disconnect...\n");
+
+    assert(network_bind_node(server, conns[5], "node-gone"));
+    size_t count = server->node_index.count;
+    fabric->close(fabric, clients[5]);
+    network_run(server);
+
+    assert(network_find_node(server, "node-gone") == NULL);
+    assert(server->node_index.count == count - 1);
+
+    printf("Unbind on disconnect tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting node index tests...\n");
+
+    start_server();
+    test_bind_find();
+    test_tombstone_rebuild();
+    test_disconnect_unbinds();
+    stop_server();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+#include "../../src/runtime/network/reliable.h"
+
+#define TEST_FRAMES 200
+
+// Frames are small integers; sends are recorded in order
+static int frames[TEST_FRAMES];
+static uint32_t sent_seqs[TEST_FRAMES * 4];
+static bool sent_resend[TEST_FRAMES * 4];
+static size_t sent_count;
+static size_t send_limit;
+static int released;
+
+static bool record_send(void* frame, uint32_t seq, bool resend, void* arg) {
+    (void)arg;
+    assert(*(int*)frame == (int)(seq % TEST_FRAMES));
+    if (sent_count >= send_limit) return false;
+    sent_seqs[sent_count] = seq;
+    sent_resend[sent_count] = resend;
+    sent_count++;
+    return true;
+}
+
+static void count_release(void* frame) {
+    (void)frame;
+    released++;
+}
+
+static void reset_sends(void) {
+    sent_count = 0;
+    send_limit = TEST_FRAMES * 4;
+}
+
+// Tests the window bounds frames in flight and acks open it
+void test_window(void) {
+    printf("\nTesting the send window...\n");
+
+    ReliableSender sender;
+    assert(reliable_sender_init(&sender));
+    released = 0;
+    reset_sends();
+
+    uint32_t seq;
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        frames[i] = i;
+        assert(reliable_push(&sender, &frames[i], &seq));
+        assert(seq == (uint32_t)i);
+    }
+    assert(reliable_held(&sender) == TEST_FRAMES);
+    assert(reliable_deadline(&sender) == 0);
+
+    // Only a window's worth goes out, in order
+    assert(reliable_transmit(&sender, 1000, record_send, NULL) == RELIABLE_WINDOW);
+    for (size_t i = 0; i < sent_count; i++) {
+        assert(sent_seqs[i] == i && !sent_resend[i]);
+    }
+    assert(reliable_transmit(&sender, 1000, record_send, NULL) == 0);
+    assert(reliable_deadline(&sender) == 1000 + RELIABLE_INITIAL_RTO_MS);
+
+    // Acking frames never pushed is refused
+    assert(!reliable_ack(&sender, TEST_FRAMES + 1, 0, 1010, count_release));
+
+    // A cumulative ack slides the window by what it covers
+    assert(reliable_ack(&sender, 10, 0, 1010, count_release));
+    assert(released == 10);
+    assert(reliable_held(&sender) == TEST_FRAMES - 10);
+    reset_sends();
+    assert(reliable_transmit(&sender, 1010, record_send, NULL) == 10);
+    assert(sent_seqs[0] == RELIABLE_WINDOW);
+
+    // A refused send leaves the frame waiting
+    assert(reliable_ack(&sender, 20, 0, 1020, count_release));
+    reset_sends();
+    send_limit = 3;
+    assert(reliable_transmit(&sender, 1020, record_send, NULL) == 3);
+    send_limit = TEST_FRAMES;
+    assert(reliable_transmit(&sender, 1020, record_send, NULL) == 7);
+    assert(sent_seqs[3] == RELIABLE_WINDOW + 13);
+
+    // Stale acks are harmless
+    assert(reliable_ack(&sender, 5, 0, 1030, count_release));
+    assert(released == 20);
+
+    reliable_sender_free(&sender, count_release);
+    assert(released == TEST_FRAMES);
+    printf("Window tests passed!\n");
+}
+
+// Tests selective acks, retransmit timing and rewinds
+void test_retransmit(void) {
+    printf("\nTesting retransmission...\n");
+
+    ReliableSender sender;
+    assert(reliable_sender_init(&sender));
+    released = 0;
+    reset_sends();
+
+    uint32_t seq;
+    for (int i = 0; i < 8; i++) {
+        frames[i] = i;
+        assert(reliable_push(&sender, &frames[i], &seq));
+    }
+    assert(reliable_transmit(&sender, 1000, record_send, NULL) == 8);
+
+    // 0 and 3 lost: the receiver expects 0 and has 1, 2, 4..7
+    uint64_t sack = (1ull << 0) | (1ull << 1) | (0xfull << 3);
+    assert(reliable_ack(&sender, 0, sack, 1040, count_release));
+    assert(released == 6);
+    assert(reliable_held(&sender) == 8);
+
+    // The round trip sample set the timeout; nothing is due before it
+    uint64_t deadline = reliable_deadline(&sender);
+    assert(deadline == 1000 + sender.rto_ms);
+    assert(sender.rto_ms >= RELIABLE_MIN_RTO_MS && sender.rto_ms < RELIABLE_INITIAL_RTO_MS);
+    reset_sends();
+    assert(reliable_retransmit(&sender, deadline - 1, record_send, NULL) == 0);
+
+    // Only the gaps are resent, and the timeout backs off
+    uint32_t rto = sender.rto_ms;
+    assert(reliable_retransmit(&sender, deadline, record_send, NULL) == 2);
+    assert(sent_seqs[0] == 0 && sent_seqs[1] == 3);
+    assert(sent_resend[0] && sent_resend[1]);
+    assert(sender.rto_ms == rto * 2);
+
+    // Acks for resent frames give no sample and keep the backoff
+    assert(reliable_ack(&sender, 8, 0, deadline + 5, count_release));
+    assert(released == 8 && reliable_held(&sender) == 0);
+    assert(sender.rto_ms == rto * 2);
+    assert(reliable_deadline(&sender) == 0);
+
+    // A rewind sends in-flight frames again, skipping acknowledged ones
+    for (int i = 8; i < 12; i++) {
+        frames[i] = i;
+        assert(reliable_push(&sender, &frames[i], &seq));
+    }
+    reset_sends();
+    assert(reliable_transmit(&sender, 2000, record_send, NULL) == 4);
+    assert(reliable_ack(&sender, 8, 1ull << 1, 2010, count_release));
+    reliable_rewind(&sender);
+    reset_sends();
+    assert(reliable_transmit(&sender, 2020, record_send, NULL) == 3);
+    assert(sent_seqs[0] == 8 && sent_seqs[1] == 9 && sent_seqs[2] == 11);
+    assert(sent_resend[0] && sent_resend[2]);
+
+    // Acks for frames a rewind queued again skip sending them
+    reliable_rewind(&sender);
+    assert(reliable_ack(&sender, 12, 0, 2030, count_release));
+    assert(sender.next == 12 && reliable_held(&sender) == 0);
+    reset_sends();
+    assert(reliable_transmit(&sender, 2040, record_send, NULL) == 0);
+
+    reliable_sender_free(&sender, count_release);
+    assert(released == 12);
+    printf("Retransmission tests passed!\n");
+}
+
+// Tests the queue bound and sequence number wraparound
+void test_wrap(void) {
+    printf("\nTesting queue bounds and wraparound...\n");
+
+    ReliableSender sender;
+    assert(reliable_sender_init(&sender));
+    released = 0;
+    reset_sends();
+
+    // Start just short of the wrap
+    sender.una = sender.next = sender.tail = UINT32_MAX - 20;
+
+    uint32_t seq;
+    static int filler[RELIABLE_QUEUE];
+    for (uint32_t i = 0; i < RELIABLE_QUEUE; i++) {
+        filler[i] = (int)((UINT32_MAX - 20 + i) % TEST_FRAMES);
+        assert(reliable_push(&sender, &filler[i], &seq));
+    }
+    int extra = 0;
+    assert(!reliable_push(&sender, &extra, &seq));
+
+    for (int round = 0; round < 4; round++) {
+        assert(reliable_transmit(&sender, 1000, record_send, NULL) == RELIABLE_WINDOW);
+        assert(reliable_ack(&sender, sender.next, 0, 1001, count_release));
+    }
+    assert(released == 4 * RELIABLE_WINDOW);
+    assert(sender.una == (uint32_t)(UINT32_MAX - 20 + 4 * RELIABLE_WINDOW));
+    assert(reliable_push(&sender, &extra, &seq));
+    assert(seq == (uint32_t)(UINT32_MAX - 20 + RELIABLE_QUEUE));
+    reliable_sender_free(&sender, count_release);
+    assert(released == RELIABLE_QUEUE + 1);
+
+    // The receiver tracks across the wrap as well
+    ReliableReceiver receiver = {.expected = UINT32_MAX - 1};
+    assert(reliable_accept(&receiver, UINT32_MAX - 1));
+    assert(reliable_accept(&receiver, 1));
+    assert(reliable_accept(&receiver, UINT32_MAX));
+    assert(receiver.expected == 0 && receiver.received == 1);
+    assert(reliable_accept(&receiver, 0));
+    assert(receiver.expected == 2 && receiver.received == 0);
+    printf("Wraparound tests passed!\n");
+}
+
+// Tests the receiver suppresses duplicates and acks what arrived
+void test_receive(void) {
+    printf("\nTesting receive tracking...\n");
+
+    ReliableReceiver receiver = {0};
+    assert(reliable_accept(&receiver, 0));
+    assert(!reliable_accept(&receiver, 0));
+    assert(receiver.expected == 1);
+
+    // Out of order arrivals are recorded past the gap
+    assert(reliable_accept(&receiver, 3));
+    assert(reliable_accept(&receiver, 5));
+    assert(!reliable_accept(&receiver, 3));
+    assert(receiver.expected == 1 && receiver.received == ((1ull << 1) | (1ull << 3)));
+
+    // Filling the gap slides over the run that arrived early
+    assert(reliable_accept(&receiver, 1));
+    assert(receiver.expected == 2);
+    assert(reliable_accept(&receiver, 2));
+    assert(receiver.expected == 4 && receiver.received == 1);
+    assert(reliable_accept(&receiver, 4));
+    assert(receiver.expected == 6 && receiver.received == 0);
+
+    // The window's far edge is accepted, beyond it is not
+    assert(reliable_accept(&receiver, 6 + RELIABLE_WINDOW));
+    assert(!reliable_accept(&receiver, 7 + RELIABLE_WINDOW));
+    assert(!reliable_accept(&receiver, 2));
+
+    // Acks from the receiver release exactly what it has
+    ReliableSender sender;
+    assert(reliable_sender_init(&sender));
+    released = 0;
+    reset_sends();
+    uint32_t seq;
+    for (int i = 0; i < 8; i++) {
+        frames[i] = i;
+        assert(reliable_push(&sender, &frames[i], &seq));
+    }
+    reliable_transmit(&sender, 1000, record_send, NULL);
+
+    ReliableReceiver peer = {0};
+    for (uint32_t s = 0; s < 8; s++) {
+        if (s != 2 && s != 6) assert(reliable_accept(&peer, s));
+    }
+    assert(reliable_ack(&sender, peer.expected, peer.received, 1010, count_release));
+    assert(released == 6 && sender.una == 2);
+
+    reset_sends();
+    assert(reliable_retransmit(&sender, 5000, record_send, NULL) == 2);
+    assert(sent_seqs[0] == 2 && sent_seqs[1] == 6);
+    reliable_sender_free(&sender, count_release);
+    printf("Receive tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting reliable delivery tests...\n");
+
+    test_window();
+    test_retransmit();
+    test_wrap();
+    test_receive();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
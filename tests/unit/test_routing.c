@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../../src/runtime/routing/routing.h"
+
+// Build a link advert listing the given neighbours
+static size_t make_advert(uint8_t* buffer, uint64_t seq, const char** links, int count) {
+    for (int i = 0; i < 8; i++) buffer[i] = (uint8_t)(seq >> (8 * i));
+    buffer[8] = (uint8_t)count;
+    buffer[9] = 0;
+
+    size_t length = 10;
+    for (int i = 0; i < count; i++) {
+        size_t id_len = strlen(links[i]);
+        buffer[length] = (uint8_t)id_len;
+        memcpy(buffer + length + 1, links[i], id_len);
+        length += 1 + id_len;
+    }
+    return length;
+}
+
+// Tests identities inherit the owner of their nearest claimed ancestor
+void test_routing_ownership(void) {
+    printf("\nTesting subtree ownership...\n");
+
+    RoutingTable* rt = routing_create("peer-a");
+    assert(rt != NULL);
+    assert(routing_add_neighbor(rt, "peer-b", 7));
+
+    RoutingResult result;
+    assert(routing_lookup(rt, "root", &result) == ROUTE_UNKNOWN);
+
+    // root (local) -> org (peer-b) -> team -> user
+    assert(routing_set_owner(rt, "root", "peer-a"));
+    assert(routing_add_node(rt, "org", "root"));
+    assert(routing_add_node(rt, "team", "org"));
+    assert(routing_add_node(rt, "user", "team"));
+    assert(routing_lookup(rt, "user", &result) == ROUTE_LOCAL);
+
+    assert(routing_set_owner(rt, "org", "peer-b"));
+    assert(routing_lookup(rt, "root", NULL) == ROUTE_LOCAL);
+    assert(routing_lookup(rt, "user", &result) == ROUTE_REMOTE);
+    assert(result.next_hop == 7 && result.hops == 1);
+
+    // A nested claim shields its subtree from changes above it
+    assert(routing_set_owner(rt, "team", "peer-a"));
+    assert(routing_set_owner(rt, "org", NULL));
+    assert(routing_lookup(rt, "org", NULL) == ROUTE_LOCAL);
+    assert(routing_set_owner(rt, "org", "peer-b"));
+    assert(routing_lookup(rt, "org", NULL) == ROUTE_REMOTE);
+    assert(routing_lookup(rt, "user", NULL) == ROUTE_LOCAL);
+
+    // Moving a subtree takes the new parent's owner
+    assert(routing_set_owner(rt, "team", NULL));
+    assert(routing_lookup(rt, "user", NULL) == ROUTE_REMOTE);
+    assert(routing_add_node(rt, "team", "root"));
+    assert(routing_lookup(rt, "user", NULL) == ROUTE_LOCAL);
+    assert(!routing_add_node(rt, "team", "user"));
+
+    // Unknown parents make roots without an owner
+    assert(routing_add_node(rt, "orphan", "missing"));
+    assert(routing_lookup(rt, "orphan", NULL) == ROUTE_UNKNOWN);
+    assert(!routing_set_owner(rt, "missing", NULL));
+
+    routing_destroy(rt);
+    printf("Ownership tests passed!\n");
+}
+
+// Tests removing an identity moves its children to their grandparent
+void test_routing_remove(void) {
+    printf("\nTesting identity removal...\n");
+
+    RoutingTable* rt = routing_create("peer-a");
+    assert(rt != NULL);
+    assert(routing_add_neighbor(rt, "peer-b", 3));
+
+    assert(routing_set_owner(rt, "root", "peer-a"));
+    assert(routing_add_node(rt, "mid", "root"));
+    assert(routing_set_owner(rt, "mid", "peer-b"));
+    assert(routing_add_node(rt, "left", "mid"));
+    assert(routing_add_node(rt, "right", "mid"));
+    assert(routing_lookup(rt, "left", NULL) == ROUTE_REMOTE);
+
+    assert(routing_remove_node(rt, "mid"));
+    assert(!routing_remove_node(rt, "mid"));
+    assert(routing_lookup(rt, "mid", NULL) == ROUTE_UNKNOWN);
+    assert(routing_lookup(rt, "left", NULL) == ROUTE_LOCAL);
+    assert(routing_lookup(rt, "right", NULL) == ROUTE_LOCAL);
+
+    // Children of a removed root become roots
+    assert(routing_remove_node(rt, "root"));
+    assert(routing_lookup(rt, "left", NULL) == ROUTE_UNKNOWN);
+
+    // Slots and index entries are reused across many joins and leaves
+    char id[32];
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < 1000; i++) {
+            snprintf(id, sizeof(id), "user-%d", i);
+            assert(routing_add_node(rt, id, i ? "user-0" : "right"));
+        }
+        assert(routing_lookup(rt, "user-999", NULL) == ROUTE_UNKNOWN);
+        assert(routing_set_owner(rt, "right", "peer-b"));
+        assert(routing_lookup(rt, "user-999", NULL) == ROUTE_REMOTE);
+        assert(routing_set_owner(rt, "right", NULL));
+        for (int i = 0; i < 1000; i++) {
+            snprintf(id, sizeof(id), "user-%d", i);
+            assert(routing_remove_node(rt, id));
+        }
+    }
+    assert(rt->node_count == 2);
+
+    routing_destroy(rt);
+    printf("Removal tests passed!\n");
+}
+
+// Tests next hops follow the shortest path through advertised links:
+//   a - b - c - d
+//    \         /
+//     e ------
+void test_routing_paths(void) {
+    printf("\nTesting shortest paths...\n");
+
+    RoutingTable* rt = routing_create("a");
+    assert(rt != NULL);
+    assert(routing_add_neighbor(rt, "b", 11));
+    assert(routing_add_neighbor(rt, "e", 15));
+
+    uint8_t advert[256];
+    const char* b_links[] = {"a", "c"};
+    const char* c_links[] = {"b", "d"};
+    const char* e_links[] = {"a", "d"};
+    assert(routing_apply_links(rt, "b", advert, make_advert(advert, 1, b_links, 2)));
+    assert(routing_apply_links(rt, "c", advert, make_advert(advert, 1, c_links, 2)));
+
+    assert(routing_set_owner(rt, "on-c", "c"));
+    assert(routing_set_owner(rt, "on-d", "d"));
+
+    RoutingResult result;
+    assert(routing_lookup(rt, "on-c", &result) == ROUTE_REMOTE);
+    assert(result.next_hop == 11 && result.hops == 2);
+    assert(routing_lookup(rt, "on-d", &result) == ROUTE_REMOTE);
+    assert(result.next_hop == 11 && result.hops == 3);
+
+    // e's advert opens a shorter way to d
+    assert(routing_apply_links(rt, "e", advert, make_advert(advert, 1, e_links, 2)));
+    assert(routing_lookup(rt, "on-d", &result) == ROUTE_REMOTE);
+    assert(result.next_hop == 15 && result.hops == 2);
+
+    // Stale adverts are ignored, newer ones replace
+    const char* e_alone[] = {"a"};
+    assert(!routing_apply_links(rt, "e", advert, make_advert(advert, 1, e_alone, 1)));
+    assert(routing_lookup(rt, "on-d", &result) == ROUTE_REMOTE && result.hops == 2);
+    assert(routing_apply_links(rt, "e", advert, make_advert(advert, 2, e_alone, 1)));
+    assert(routing_lookup(rt, "on-d", &result) == ROUTE_REMOTE && result.hops == 3);
+
+    // Losing b leaves c and d cut off
+    assert(routing_remove_neighbor(rt, 11));
+    assert(!routing_remove_neighbor(rt, 11));
+    assert(!routing_has_neighbor(rt, 11) && routing_has_neighbor(rt, 15));
+    assert(routing_lookup(rt, "on-c", &result) == ROUTE_UNREACHABLE);
+    assert(result.next_hop == NETWORK_INVALID_HANDLE);
+
+    // Truncated adverts are rejected
+    size_t length = make_advert(advert, 3, e_links, 2);
+    assert(!routing_apply_links(rt, "e", advert, length - 1));
+    assert(!routing_apply_links(rt, "a", advert, length));
+
+    // Our own adverts list our neighbours
+    assert(routing_add_neighbor(rt, "b", 12));
+    length = routing_encode_links(rt, advert, sizeof(advert));
+    assert(length == 10 + 2 + 2);
+    assert(advert[8] == 2 && advert[9] == 0);
+    assert(routing_encode_links(rt, advert, 12) == 0);
+
+    RoutingTable* peer = routing_create("z");
+    assert(peer != NULL);
+    assert(routing_apply_links(peer, "a", advert, length));
+    routing_destroy(peer);
+
+    routing_destroy(rt);
+    printf("Path tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting routing tests...\n");
+
+    test_routing_ownership();
+    test_routing_remove();
+    test_routing_paths();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
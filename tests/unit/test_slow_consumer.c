@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "../../src/runtime/network/network.h"
+
+// A raw memory-fabric client that never reads leaves the server's
+// queue to it growing once the client's pipe is full
+#define SERVER_PORT 7330
+#define FRAME_DATA (16 * 1024)
+#define CONN_BUDGET (64 * 1024)
+#define FLOW_WINDOW (64 * 1024)
+#define WAIT_MS 10000
+
+static NetworkTransport* fabric;
+static NetworkContext* server;
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+// Data frame that does not compress, addressed to target
+static NetworkMessage* make_message(const char* target) {
+    NetworkMessage* msg = calloc(1, sizeof(NetworkMessage) + FRAME_DATA);
+    assert(msg);
+    msg->type = NET_MSG_DATA;
+    strcpy(msg->source_id, "server");
+    strcpy(msg->target_id, target);
+    msg->data_size = FRAME_DATA;
+    uint32_t state = 2463534242u;
+    for (uint32_t i = 0; i < FRAME_DATA; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        msg->data[i] = (uint8_t)state;
+    }
+    return msg;
+}
+
+static NetworkContext* create_network(uint16_t port) {
+    NetworkContext* network = network_create(port);
+    assert(network);
+    assert(network_set_transport(network, fabric));
+    network_set_io_threads(network, 0);
+    network_set_poll_timeout(network, 0);
+    return network;
+}
+
+// Connect a raw client and return the server's handle for it
+static NetworkHandle connect_client(int* client) {
+    *client = network_memory_connect(fabric, SERVER_PORT);
+    assert(*client >= 0);
+    network_run(server);
+    assert(server->active_connections == 1);
+
+    NetworkHandle handle = NETWORK_INVALID_HANDLE;
+    for (size_t i = 0; i < server->max_connections && handle == NETWORK_INVALID_HANDLE; i++) {
+        handle = network_get_handle(server, &server->connections[i]);
+    }
+    return handle;
+}
+
+// Send until the client's pipe is full and frames start to queue
+static void fill(NetworkHandle handle, NetworkMessage* msg) {
+    NetworkConnection* conn = network_resolve(server, handle);
+    for (int i = 0; conn->out_count == 0; i++) {
+        assert(i < 64);
+        assert(network_send_handle(server, handle, msg));
+    }
+}
+
+// Read everything the server writes until its queue to the client drains
+static void drain(int client, NetworkHandle handle) {
+    static uint8_t buffer[64 * 1024];
+    NetworkConnection* conn = network_resolve(server, handle);
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (conn->out_count > 0) {
+        assert(now_ms() < deadline);
+        while (fabric->read(fabric, client, buffer, sizeof(buffer), NULL) > 0) {
+        }
+        network_run(server);
+    }
+    while (fabric->read(fabric, client, buffer, sizeof(buffer), NULL) > 0) {
+    }
+}
+
+static void close_client(int client) {
+    fabric->close(fabric, client);
+    network_run(server);
+    assert(server->active_connections == 0);
+}
+
+// Tests the oldest unsent frames make way for new ones within budget
+void test_drop_oldest(void) {
+    printf("\nTesting drop-oldest policy...\n");
+
+    network_set_outbound_limits(server, CONN_BUDGET, 1 << 30, NET_SLOW_DROP_OLDEST);
+    int client;
+    NetworkHandle handle = connect_client(&client);
+    NetworkConnection* conn = network_resolve(server, handle);
+    NetworkMessage* msg = make_message("node");
+
+    fill(handle, msg);
+    NetworkStats before;
+    network_get_stats(server, &before);
+    for (int i = 0; i < 16; i++) {
+        assert(network_send_handle(server, handle, msg));
+        assert(conn->out_bytes <= CONN_BUDGET);
+    }
+
+    NetworkStats after;
+    network_get_stats(server, &after);
+    assert(after.frames_evicted - before.frames_evicted >= 16 - CONN_BUDGET / FRAME_DATA);
+    assert(after.frames_dropped == before.frames_dropped);
+    assert(after.outbound_bytes == (int64_t)conn->out_bytes);
+
+    drain(client, handle);
+    network_get_stats(server, &after);
+    assert(after.outbound_bytes == 0);
+    close_client(client);
+    free(msg);
+
+    printf("Drop-oldest tests passed!\n");
+}
+
+// Tests a frame replaces a queued one with the same key, and frames with
+// a different key fall back to dropping the oldest
+void test_coalesce(void) {
+    printf("\nTesting coalesce policy...\n");
+
+    network_set_outbound_limits(server, CONN_BUDGET, 1 << 30, NET_SLOW_COALESCE);
+    int client;
+    NetworkHandle handle = connect_client(&client);
+    NetworkConnection* conn = network_resolve(server, handle);
+    NetworkMessage* msg = make_message("node");
+    NetworkMessage* other = make_message("other");
+
+    // Fill the budget with frames of one key
+    fill(handle, msg);
+    while (conn->out_bytes + FRAME_DATA <= CONN_BUDGET) {
+        assert(network_send_handle(server, handle, msg));
+    }
+
+    NetworkStats before;
+    network_get_stats(server, &before);
+    uint32_t queued = conn->out_count;
+    for (int i = 0; i < 8; i++) {
+        assert(network_send_handle(server, handle, msg));
+        assert(conn->out_count == queued);
+    }
+    NetworkStats after;
+    network_get_stats(server, &after);
+    assert(after.frames_coalesced - before.frames_coalesced == 8);
+    assert(after.frames_evicted == before.frames_evicted);
+
+    assert(network_send_handle(server, handle, other));
+    network_get_stats(server, &after);
+    assert(after.frames_coalesced - before.frames_coalesced == 8);
+    assert(after.frames_evicted > before.frames_evicted);
+    assert(conn->out_bytes <= CONN_BUDGET);
+
+    drain(client, handle);
+    close_client(client);
+    free(other);
+    free(msg);
+
+    printf("Coalesce tests passed!\n");
+}
+
+// Tests a peer over budget is cut off and its queue released
+void test_disconnect(void) {
+    printf("\nTesting disconnect policy...\n");
+
+    network_set_outbound_limits(server, CONN_BUDGET, 1 << 30, NET_SLOW_DISCONNECT);
+    int client;
+    NetworkHandle handle = connect_client(&client);
+    NetworkMessage* msg = make_message("node");
+
+    fill(handle, msg);
+    NetworkStats before;
+    network_get_stats(server, &before);
+    int sent = 0;
+    while (network_send_handle(server, handle, msg)) {
+        assert(++sent < 64);
+    }
+
+    NetworkStats after;
+    network_get_stats(server, &after);
+    assert(after.slow_disconnects == before.slow_disconnects + 1);
+    assert(after.frames_dropped == before.frames_dropped + 1);
+    assert(after.outbound_bytes == 0);
+
+    // The poll loop reaps the connection
+    network_run(server);
+    assert(network_resolve(server, handle) == NULL);
+    assert(server->active_connections == 0);
+    fabric->close(fabric, client);
+    free(msg);
+
+    printf("Disconnect policy tests passed!\n");
+}
+
+// Tests a sender stops at the receiver's window and resumes as the
+// receiver consumes and grants more credit
+void test_credit(void) {
+    printf("\nTesting flow credit...\n");
+
+    network_set_outbound_limits(server, 1 << 22, 1 << 30, NET_SLOW_DROP_OLDEST);
+    NetworkContext* receiver = create_network(SERVER_PORT + 1);
+    network_set_flow_window(receiver, FLOW_WINDOW);
+    assert(network_start(receiver));
+    assert(network_add_peer(receiver, "fabric", SERVER_PORT));
+
+    NetworkHandle handle = NETWORK_INVALID_HANDLE;
+    uint64_t deadline = now_ms() + WAIT_MS;
+    while (network_get_handles(server, &handle, 1) < 1) {
+        assert(now_ms() < deadline);
+        network_run(server);
+        network_run(receiver);
+    }
+    NetworkConnection* conn = network_resolve(server, handle);
+    assert(conn->send_window == FLOW_WINDOW);
+
+    // Four times the window, with the receiver not reading
+    NetworkMessage* msg = make_message("node");
+    int count = 4 * FLOW_WINDOW / FRAME_DATA;
+    for (int i = 0; i < count; i++) {
+        assert(network_send_handle(server, handle, msg));
+    }
+    NetworkStats stats;
+    network_get_stats(server, &stats);
+    assert(stats.credit_stalls > 0);
+    assert(conn->out_state == NET_OUT_WAIT_CREDIT);
+    assert(conn->data_sent <= FLOW_WINDOW);
+    assert(conn->out_count > 0);
+
+    // Credit comes back as the receiver consumes
+    network_get_stats(receiver, &stats);
+    uint64_t base = stats.frames_received;
+    while (stats.frames_received - base < (uint64_t)count) {
+        assert(now_ms() < deadline);
+        network_run(receiver);
+        network_run(server);
+        network_get_stats(receiver, &stats);
+    }
+    assert(conn->out_count == 0);
+    assert(conn->data_sent > 3 * FLOW_WINDOW);
+    assert(conn->data_sent <= conn->send_window + conn->peer_consumed);
+
+    network_destroy(receiver);
+    network_run(server);
+    free(msg);
+
+    printf("Flow credit tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting slow consumer tests...\n");
+
+    fabric = network_memory_transport_create();
+    assert(fabric);
+    server = create_network(SERVER_PORT);
+    assert(network_start(server));
+
+    test_drop_oldest();
+    test_coalesce();
+    test_disconnect();
+    test_credit();
+
+    network_destroy(server);
+    network_memory_transport_destroy(fabric);
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <assert.h>
+#include "../../src/runtime/network/timer.h"
+
+#define TEST_TIMERS 512
+
+// Records when each timer fired
+typedef struct {
+    TimerEntry entry;
+    uint64_t fired_at;
+    int fire_count;
+} TestTimer;
+
+static uint64_t test_now;
+
+static void record_fire(TimerEntry* entry, void* user_data) {
+    (void)user_data;
+    TestTimer* timer = (TestTimer*)entry;
+    timer->fired_at = test_now;
+    timer->fire_count++;
+}
+
+// Advance the wheel one millisecond at a time
+static void advance_to(TimerWheel* wheel, uint64_t target) {
+    while (test_now < target) {
+        test_now++;
+        timer_wheel_advance(wheel, test_now, record_fire, NULL);
+    }
+}
+
+// Tests timers fire at their deadline, never early
+void test_timer_expiry(void) {
+    printf("\nTesting timer expiry...\n");
+
+    TimerWheel wheel;
+    test_now = 1000;
+    timer_wheel_init(&wheel, 10, test_now);
+
+    // Spread deadlines across every wheel level
+    static TestTimer timers[TEST_TIMERS];
+    uint64_t deadline = 1;
+    for (int i = 0; i < TEST_TIMERS; i++) {
+        timers[i].fire_count = 0;
+        timer_arm(&wheel, &timers[i].entry, test_now + deadline);
+        deadline = deadline * 3 / 2 + 7;
+        if (deadline > 3000000) deadline = (uint64_t)i * 997 % 3000000 + 1;
+    }
+    assert(wheel.count == TEST_TIMERS);
+
+    uint64_t start = test_now;
+    advance_to(&wheel, start + 3000000 + 20);
+
+    assert(wheel.count == 0);
+    for (int i = 0; i < TEST_TIMERS; i++) {
+        uint64_t expected = timers[i].entry.expires * 10 + 1000;
+        assert(timers[i].fire_count == 1);
+        assert(timers[i].fired_at >= expected);
+        assert(timers[i].fired_at < expected + 10);
+    }
+
+    printf("Timer expiry tests passed!\n");
+}
+
+// Tests cancel and re-arm
+void test_timer_rearm(void) {
+    printf("\nTesting timer cancel and re-arm...\n");
+
+    TimerWheel wheel;
+    test_now = 0;
+    timer_wheel_init(&wheel, 10, test_now);
+
+    TestTimer a = {0}, b = {0};
+    timer_arm(&wheel, &a.entry, 100);
+    timer_arm(&wheel, &b.entry, 100);
+    assert(timer_is_armed(&a.entry));
+
+    // Cancelled timer never fires
+    timer_cancel(&wheel, &a.entry);
+    assert(!timer_is_armed(&a.entry));
+    assert(wheel.count == 1);
+
+    // Re-armed timer fires at its new deadline only
+    timer_arm(&wheel, &b.entry, 5000);
+    assert(wheel.count == 1);
+    advance_to(&wheel, 4990);
+    assert(a.fire_count == 0 && b.fire_count == 0);
+    advance_to(&wheel, 5000);
+    assert(b.fire_count == 1);
+
+    // Cancel of an idle timer is a no-op
+    timer_cancel(&wheel, &b.entry);
+    assert(wheel.count == 0);
+
+    printf("Timer re-arm tests passed!\n");
+}
+
+int main(void) {
+    printf("Starting timer tests...\n");
+
+    test_timer_expiry();
+    test_timer_rearm();
+
+    printf("\nAll tests passed successfully!\n");
+    return 0;
+}
\ No newline at end of file